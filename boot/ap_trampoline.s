@@ -0,0 +1,74 @@
+; ap_trampoline.s - Démarrage d'un processeur d'application (AP)
+; smp_init() copie ce bloc à AP_TRAMPOLINE_BASE (adresse < 1 Mio, alignée sur
+; 4 Kio : le vecteur SIPI est son numéro de page), remplit les paramètres puis
+; envoie INIT-SIPI-SIPI. L'AP part en mode réel à CS:IP = 0x0800:0000.
+
+AP_TRAMPOLINE_BASE equ 0x8000
+%define TRAMPOLINE_ADDR(label) (AP_TRAMPOLINE_BASE + ((label) - ap_trampoline_start))
+
+section .text
+
+global ap_trampoline_start
+global ap_trampoline_params
+global ap_trampoline_end
+
+bits 16
+ap_trampoline_start:
+    cli
+    cld
+    xor ax, ax
+    mov ds, ax
+
+    ; GDT du BSP (plate, code 0x08 / données 0x10) le temps du passage en mode protégé
+    o32 lgdt [TRAMPOLINE_ADDR(ap_trampoline_gdt)]
+    mov eax, cr0
+    or eax, 1
+    mov cr0, eax
+    jmp dword 0x08:TRAMPOLINE_ADDR(ap_trampoline_pm)
+
+bits 32
+ap_trampoline_pm:
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+    mov ss, ax
+
+    ; Même pagination que le BSP : CR4 (PSE, SSE) avant CR3, puis CR0 (PG, WP)
+    mov eax, [TRAMPOLINE_ADDR(ap_trampoline_cr4)]
+    mov cr4, eax
+    mov eax, [TRAMPOLINE_ADDR(ap_trampoline_cr3)]
+    mov cr3, eax
+    mov eax, [TRAMPOLINE_ADDR(ap_trampoline_cr0)]
+    mov cr0, eax
+
+    mov esp, [TRAMPOLINE_ADDR(ap_trampoline_stack)]
+    push dword [TRAMPOLINE_ADDR(ap_trampoline_index)]
+    push dword 0                ; Adresse de retour : smp_ap_main ne revient pas
+    mov eax, [TRAMPOLINE_ADDR(ap_trampoline_entry)]
+    jmp eax
+
+; Paramètres écrits par le BSP avant chaque SIPI (ordre de ap_trampoline_params_t)
+align 4
+ap_trampoline_params:
+ap_trampoline_gdt:
+    dw 0                        ; Limite
+    dd 0                        ; Base
+    dw 0                        ; Alignement
+ap_trampoline_cr0:
+    dd 0
+ap_trampoline_cr3:
+    dd 0
+ap_trampoline_cr4:
+    dd 0
+ap_trampoline_stack:
+    dd 0
+ap_trampoline_entry:
+    dd 0
+ap_trampoline_index:
+    dd 0
+ap_trampoline_end:
+
+; Section GNU stack (sécurité - pile non exécutable)
+section .note.GNU-stack
@@ -1,12 +1,29 @@
 extern keyboard_interrupt_handler
 extern timer_handler
+extern timer_yield_handler
+extern lapic_timer_handler
+extern reschedule_ipi_handler
+extern smp_tlb_shootdown_handler
 extern ne2k_irq_handler
 extern syscall_handler
+extern syscall_sysenter_handler
+extern smp_kernel_enter
+extern smp_kernel_leave
 
 global irq0
 global irq1
 global irq3
 global isr_syscall
+global isr_sysenter
+global isr_lapic_timer
+global isr_reschedule
+global isr_tlb_shootdown
+global isr_spurious
+
+; Chaque entrée charge GS = 0x30 (bloc du CPU), puis prend le verrou noyau
+; global, rendu par smp_kernel_leave avant le retour. Un handler qui appelle
+; schedule() ne revient qu'à la réélection de sa tâche : la profondeur du
+; verrou est sauvée avec elle (task_switch_finish).
 
 ; ISR pour le timer (IRQ 0) - Version robuste
 irq0:
@@ -22,17 +39,23 @@ irq0:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
     mov gs, ax
 
-    ; EOI avant le handler C : schedule() fait iret et ne revient jamais.
+    ; EOI avant le handler C : schedule() peut basculer vers une autre tâche
+    ; et ne revenir ici qu'à la réélection de celle-ci.
     ; Sans ceci, IRQ0 reste in-service et le PIC bloque IRQ1 (clavier).
     mov al, 0x20
     out 0x20, al
+
+    call smp_kernel_enter
     
     ; Passe un pointeur vers la structure de registres au handler C
     push esp
     call timer_handler
     add esp, 4
+
+    call smp_kernel_leave
     
     ; Restaure l'état complet du processeur
     popad
@@ -58,10 +81,13 @@ irq1:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
     mov gs, ax
     
     ; Appelle le handler C du clavier
+    call smp_kernel_enter
     call keyboard_interrupt_handler
+    call smp_kernel_leave
     
     ; Envoie EOI au PIC pour IRQ 1
     mov al, 0x20          ; Commande EOI
@@ -88,8 +114,11 @@ irq3:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
     mov gs, ax
+    call smp_kernel_enter
     call ne2k_irq_handler
+    call smp_kernel_leave
     mov al, 0x20
     out 0x20, al
     popad
@@ -112,11 +141,14 @@ isr_schedule:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
     mov gs, ax
 
+    call smp_kernel_enter
     push esp
-    call timer_handler ; Le timer handler appelle schedule, c'est ce qu'on veut
+    call timer_yield_handler ; Décision de planification du CPU, sans tick
     add esp, 4
+    call smp_kernel_leave
 
     popad
     pop gs
@@ -140,10 +172,12 @@ isr_syscall:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
     mov gs, ax
     
     ; Prépare la structure cpu_state_t sur la pile
     ; L'ordre doit correspondre à la structure dans task.h
+    call smp_kernel_enter
     push esp      ; Pointeur vers la structure
     
     ; Appelle le handler C des syscalls
@@ -151,6 +185,7 @@ isr_syscall:
     
     ; Nettoie la pile
     add esp, 4
+    call smp_kernel_leave
     
     ; Restaure l'état du CPU
     popad
@@ -162,6 +197,131 @@ isr_syscall:
     ; Retour d'interruption
     iret
 
+; Entrée SYSENTER (MSR posés par gdt_init_cpu) : interruptions masquées,
+; ESP = &esp0 du TSS du CPU, EBP = cadre os_vsyscall_frame_t du stub
+; utilisateur. On bâtit le même cpu_state_t qu'INT 0x80 ; le handler C le
+; complète depuis le cadre et renvoie 1 si SYSEXIT peut rendre la main.
+isr_sysenter:
+    mov esp, [esp]
+    push dword 0x23     ; SS utilisateur
+    push ebp            ; ESP utilisateur : le cadre du stub
+    pushfd
+    or dword [esp], 0x200 ; SYSENTER a masqué IF, le retour le rétablit
+    push dword 0x1B     ; CS utilisateur
+    push dword 0        ; EIP : posé par le handler C
+    push ds
+    push es
+    push fs
+    push gs
+    pushad
+
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
+    mov gs, ax
+
+    call smp_kernel_enter
+    push esp
+    call syscall_sysenter_handler
+    add esp, 4
+    push eax
+    call smp_kernel_leave
+    pop eax
+
+    ; popad et pop ne touchent pas aux drapeaux : ZF garde le choix du retour
+    test eax, eax
+    popad
+    pop gs
+    pop fs
+    pop es
+    pop ds
+    jz .iret
+    ; EDX = reprise et ECX = pile utilisateur, posés par le handler C.
+    ; STI ne prend effet qu'après SYSEXIT : aucune IRQ sur la pile noyau vide.
+    add esp, 20
+    sti
+    sysexit
+.iret:
+    iret
+
+; Timer LAPIC des AP (vecteur 0x40) : l'EOI LAPIC est faite par le handler C
+isr_lapic_timer:
+    push ds
+    push es
+    push fs
+    push gs
+    pushad
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
+    mov gs, ax
+    call smp_kernel_enter
+    push esp
+    call lapic_timer_handler
+    add esp, 4
+    call smp_kernel_leave
+    popad
+    pop gs
+    pop fs
+    pop es
+    pop ds
+    iret
+
+; IPI de replanification (vecteur 0x41) : sort un CPU de son sommeil sans tick
+isr_reschedule:
+    push ds
+    push es
+    push fs
+    push gs
+    pushad
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
+    mov gs, ax
+    call smp_kernel_enter
+    push esp
+    call reschedule_ipi_handler
+    add esp, 4
+    call smp_kernel_leave
+    popad
+    pop gs
+    pop fs
+    pop es
+    pop ds
+    iret
+
+; Shootdown TLB (vecteur 0x42) : pas de verrou noyau, l'émetteur le détient
+; en attendant l'acquittement
+isr_tlb_shootdown:
+    push ds
+    push es
+    push fs
+    push gs
+    pushad
+    mov ax, 0x10
+    mov ds, ax
+    mov es, ax
+    mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
+    mov gs, ax
+    call smp_tlb_shootdown_handler
+    popad
+    pop gs
+    pop fs
+    pop es
+    pop ds
+    iret
+
+; Interruption parasite du LAPIC (vecteur 0xFF) : ni EOI ni état à sauver
+isr_spurious:
+    iret
+
 ; Common C-level fault handler
 extern fault_handler_c
 
@@ -201,12 +361,15 @@ isr_common_stub:
     mov ds, ax
     mov es, ax
     mov fs, ax
+    mov ax, 0x30        ; GS : bloc du CPU courant (smp_cpu)
     mov gs, ax
 
     ; 4. Call the C handler, passing a pointer to the stack frame
+    call smp_kernel_enter
     push esp
     call fault_handler_c
     add esp, 4 ; Clean up the stack pointer argument
+    call smp_kernel_leave
 
     ; 5. Restore data segment registers
     pop ds
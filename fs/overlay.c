@@ -16,6 +16,7 @@ typedef struct {
 
 static ov_node_t g_ov[OV_MAX_NODES];
 static os_dirent_t overlay_page_entries[OV_MAX_NODES];
+static uint32_t g_ov_generation;
 
 static int ov_len(const char* s) {
     int n = 0;
@@ -147,8 +148,19 @@ static int ov_direct_child(const char* prefix, const char* path, char* name, int
     return 1;
 }
 
+// Toute mutation change la génération : les caches de l'initrd (exec) se revalident.
+static void ov_commit(void) {
+    g_ov_generation++;
+    overlay_save_disk();
+}
+
+uint32_t overlay_generation(void) {
+    return g_ov_generation;
+}
+
 void overlay_init(void) {
     int i;
+    g_ov_generation++;
     for (i = 0; i < OV_MAX_NODES; i++) {
         g_ov[i].used = 0;
         g_ov[i].path[0] = '\0';
@@ -210,7 +222,7 @@ int overlay_mkdir(const char* path) {
     n->size = 0;
     n->data[0] = '\0';
     ov_copy(n->path, want, OV_PATH_MAX);
-    overlay_save_disk();
+    ov_commit();
     return OV_OK;
 }
 
@@ -234,7 +246,7 @@ int overlay_write(const char* path, const char* data, uint32_t n) {
     if (n > OV_DATA_MAX) n = OV_DATA_MAX;
     for (i = 0; i < n; i++) node->data[i] = data[i];
     node->size = n;
-    overlay_save_disk();
+    ov_commit();
     return (int)n;
 }
 
@@ -269,7 +281,7 @@ int overlay_append(const char* path, const char* data, uint32_t n) {
     if (node->size + n > OV_DATA_MAX) return OV_ERR_NOSPACE;
     for (i = 0; i < n; i++) node->data[node->size + i] = data[i];
     node->size += n;
-    overlay_save_disk();
+    ov_commit();
     return (int)n;
 }
 
@@ -301,7 +313,7 @@ int overlay_unlink(const char* path) {
     n->used = 0;
     n->path[0] = '\0';
     n->size = 0;
-    overlay_save_disk();
+    ov_commit();
     return OV_OK;
 }
 
@@ -363,7 +375,7 @@ int overlay_rename(const char* oldpath, const char* newpath) {
             g_ov[i].path[newn + k] = '\0';
         }
     }
-    overlay_save_disk();
+    ov_commit();
     return OV_OK;
 }
 
@@ -443,7 +455,7 @@ int overlay_copy(const char* src, const char* dst) {
             n->data[b] = g_ov[i].data[b];
         }
     }
-    overlay_save_disk();
+    ov_commit();
     return OV_OK;
 }
 
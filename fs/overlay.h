@@ -42,6 +42,8 @@ int overlay_stat(const char* path, os_dirent_t* out);
 int overlay_listdir(const char* path, os_dirent_t* out, int start, int max_n);
 int overlay_listdir_page(const char* path, os_dirent_t* out, uint32_t start, int max_n);
 int overlay_is_dir(const char* path);
+/* Compteur incrémenté à chaque mutation (écriture, suppression, restauration...). */
+uint32_t overlay_generation(void);
 
 int overlay_snapshot(uint8_t* buf, uint32_t max, uint32_t* out_size);
 int overlay_restore(const uint8_t* buf, uint32_t n);
@@ -0,0 +1,61 @@
+#ifndef OS_ARENA_H
+#define OS_ARENA_H
+
+#include <stdint.h>
+
+/* Arène "bump" partagée noyau / Ring 3 : allocation O(1) dans un tampon
+ * fourni par l'appelant, libération globale par os_arena_reset(). Aucune
+ * libération individuelle, donc aucune fragmentation. */
+#define OS_ARENA_ALIGN 16U
+
+typedef struct {
+    uint8_t* base;
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t peak;      /* Plus haut niveau observé depuis l'initialisation */
+} os_arena_t;
+
+static inline void os_arena_init(os_arena_t* arena, void* buffer, uint32_t capacity) {
+    uint32_t skew;
+    if (!arena) return;
+    arena->base = (uint8_t*)buffer;
+    arena->capacity = buffer ? capacity : 0U;
+    /* La base est réalignée afin que chaque bloc le soit aussi. */
+    skew = (uint32_t)buffer & (OS_ARENA_ALIGN - 1U);
+    if (skew && arena->capacity > OS_ARENA_ALIGN - skew) {
+        arena->base += OS_ARENA_ALIGN - skew;
+        arena->capacity -= OS_ARENA_ALIGN - skew;
+    } else if (skew) {
+        arena->capacity = 0U;
+    }
+    arena->used = 0U;
+    arena->peak = 0U;
+}
+
+/* Retourne NULL si la taille est nulle ou si l'arène est épuisée. */
+static inline void* os_arena_alloc(os_arena_t* arena, uint32_t size) {
+    uint32_t rounded;
+    void* block;
+    if (!arena || size == 0U || size > 0xFFFFFFFFU - (OS_ARENA_ALIGN - 1U)) return 0;
+    rounded = (size + OS_ARENA_ALIGN - 1U) & ~(OS_ARENA_ALIGN - 1U);
+    if (rounded > arena->capacity - arena->used) return 0;
+    block = arena->base + arena->used;
+    arena->used += rounded;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return block;
+}
+
+/* Marque / restaure un niveau pour libérer un sous-ensemble LIFO. */
+static inline uint32_t os_arena_mark(const os_arena_t* arena) {
+    return arena ? arena->used : 0U;
+}
+
+static inline void os_arena_rewind(os_arena_t* arena, uint32_t mark) {
+    if (arena && mark <= arena->used) arena->used = mark;
+}
+
+static inline void os_arena_reset(os_arena_t* arena) {
+    if (arena) arena->used = 0U;
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef OS_BATCH_H
+#define OS_BATCH_H
+
+#include <stdint.h>
+#include "os_syscalls.h"
+#include "os_ring.h"
+
+/* Lot de syscalls (SYS_BATCH) : une région anonyme (SYS_SHM_CREATE sans
+ * nom) coupée en deux anneaux os_ring.h. La première moitié est la file de
+ * soumission (os_batch_sqe_t : numéro de syscall et registres EBX..ESI),
+ * la seconde la file de complétion (os_batch_cqe_t : user_data et EAX).
+ * Un seul SYS_BATCH sert toute la file ; seules les opérations fichier,
+ * liste et IPC qui ne bloquent pas sont acceptées (sinon OS_BATCH_BAD_OP). */
+#define OS_BATCH_SQE_SLOT 32U
+#define OS_BATCH_CQE_SLOT 16U
+
+typedef struct {
+    uint32_t op;          /* SYS_* */
+    uint32_t user_data;   /* Rendu tel quel dans la complétion */
+    uint32_t args[4];     /* EBX, ECX, EDX, ESI */
+} os_batch_sqe_t;
+
+typedef struct {
+    uint32_t user_data;
+    int32_t result;       /* EAX du syscall */
+} os_batch_cqe_t;
+
+typedef struct {
+    os_ring_t* sq;
+    os_ring_t* cq;
+} os_batch_t;
+
+static inline int os_batch_init(os_batch_t* batch, void* region, uint32_t bytes) {
+    if (!batch || !region) return OS_BATCH_BAD_RING;
+    batch->sq = os_ring_init(region, bytes / 2U, OS_BATCH_SQE_SLOT);
+    batch->cq = os_ring_init((uint8_t*)region + bytes / 2U, bytes / 2U, OS_BATCH_CQE_SLOT);
+    return batch->sq && batch->cq ? 0 : OS_BATCH_BAD_RING;
+}
+
+static inline int os_batch_push(os_batch_t* batch, uint32_t op, uint32_t user_data,
+                                uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    os_batch_sqe_t sqe;
+    sqe.op = op;
+    sqe.user_data = user_data;
+    sqe.args[0] = arg0;
+    sqe.args[1] = arg1;
+    sqe.args[2] = arg2;
+    sqe.args[3] = arg3;
+    return os_ring_push(batch->sq, &sqe, sizeof(sqe));
+}
+
+static inline int os_batch_reap(os_batch_t* batch, os_batch_cqe_t* out) {
+    int rc = os_ring_pop(batch->cq, out, sizeof(*out));
+    if (rc < 0) return rc;
+    return (uint32_t)rc == sizeof(*out) ? 0 : OS_BATCH_BAD_RING;
+}
+
+#endif
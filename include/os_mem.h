@@ -0,0 +1,145 @@
+#ifndef OS_MEM_H
+#define OS_MEM_H
+
+#include <stdint.h>
+
+/* Copie, remplissage et comparaison partagés par le noyau et l'espace
+ * utilisateur, sans libc. Répartition par taille :
+ *   - moins de OS_MEM_SMALL_LIMIT octets : boucle d'octets (pas de coût
+ *     de démarrage des instructions de chaîne) ;
+ *   - au-delà : rep movsd / rep stosd, reliquat en rep movsb / stosb ;
+ *   - à partir de OS_MEM_SSE2_THRESHOLD, si la cible a SSE2 (noyau : -msse2),
+ *     destination alignée sur 16 puis blocs de 64 octets en registres XMM.
+ * Le drapeau de direction est supposé à zéro (ABI i386). */
+#define OS_MEM_SMALL_LIMIT 16U
+#define OS_MEM_SSE2_THRESHOLD 256U
+
+typedef uint32_t __attribute__((may_alias)) os_mem_word_t;
+
+static inline void* os_memcpy(void* dst, const void* src, uint32_t size) {
+    uint8_t* d = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    uint32_t dwords;
+
+    if (size < OS_MEM_SMALL_LIMIT) {
+        while (size > 0U) {
+            *d++ = *s++;
+            size--;
+        }
+        return dst;
+    }
+#if defined(__SSE2__)
+    if (size >= OS_MEM_SSE2_THRESHOLD) {
+        uint32_t head = (0U - (uint32_t)(unsigned long)d) & 15U;
+        uint32_t blocks;
+        size -= head;
+        __asm__ volatile("rep movsb" : "+D"(d), "+S"(s), "+c"(head) : : "memory");
+        blocks = size / 64U;
+        size &= 63U;
+        __asm__ volatile(
+            "1:\n\t"
+            "movdqu   (%1), %%xmm0\n\t"
+            "movdqu 16(%1), %%xmm1\n\t"
+            "movdqu 32(%1), %%xmm2\n\t"
+            "movdqu 48(%1), %%xmm3\n\t"
+            "movdqa %%xmm0,   (%0)\n\t"
+            "movdqa %%xmm1, 16(%0)\n\t"
+            "movdqa %%xmm2, 32(%0)\n\t"
+            "movdqa %%xmm3, 48(%0)\n\t"
+            "add $64, %0\n\t"
+            "add $64, %1\n\t"
+            "dec %2\n\t"
+            "jnz 1b\n\t"
+            : "+r"(d), "+r"(s), "+r"(blocks)
+            :
+            : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3");
+    }
+#endif
+    dwords = size >> 2;
+    size &= 3U;
+    __asm__ volatile("rep movsl" : "+D"(d), "+S"(s), "+c"(dwords) : : "memory");
+    __asm__ volatile("rep movsb" : "+D"(d), "+S"(s), "+c"(size) : : "memory");
+    return dst;
+}
+
+static inline void* os_memset(void* dst, int value, uint32_t size) {
+    uint8_t* d = (uint8_t*)dst;
+    uint8_t byte = (uint8_t)value;
+    uint32_t pattern = (uint32_t)byte * 0x01010101U;
+    uint32_t dwords;
+
+    if (size < OS_MEM_SMALL_LIMIT) {
+        while (size > 0U) {
+            *d++ = byte;
+            size--;
+        }
+        return dst;
+    }
+#if defined(__SSE2__)
+    if (size >= OS_MEM_SSE2_THRESHOLD) {
+        uint32_t head = (0U - (uint32_t)(unsigned long)d) & 15U;
+        uint32_t blocks;
+        size -= head;
+        __asm__ volatile("rep stosb" : "+D"(d), "+c"(head) : "a"(pattern) : "memory");
+        blocks = size / 64U;
+        size &= 63U;
+        __asm__ volatile(
+            "movd %2, %%xmm0\n\t"
+            "pshufd $0, %%xmm0, %%xmm0\n\t"
+            "1:\n\t"
+            "movdqa %%xmm0,   (%0)\n\t"
+            "movdqa %%xmm0, 16(%0)\n\t"
+            "movdqa %%xmm0, 32(%0)\n\t"
+            "movdqa %%xmm0, 48(%0)\n\t"
+            "add $64, %0\n\t"
+            "dec %1\n\t"
+            "jnz 1b\n\t"
+            : "+r"(d), "+r"(blocks)
+            : "r"(pattern)
+            : "memory", "cc", "xmm0");
+    }
+#endif
+    dwords = size >> 2;
+    size &= 3U;
+    __asm__ volatile("rep stosl" : "+D"(d), "+c"(dwords) : "a"(pattern) : "memory");
+    __asm__ volatile("rep stosb" : "+D"(d), "+c"(size) : "a"(pattern) : "memory");
+    return dst;
+}
+
+/* Même contrat que memcmp : signe de la première différence d'octets. */
+static inline int os_memcmp(const void* lhs, const void* rhs, uint32_t size) {
+    const uint8_t* a = (const uint8_t*)lhs;
+    const uint8_t* b = (const uint8_t*)rhs;
+
+#if defined(__SSE2__)
+    while (size >= 16U) {
+        uint32_t mask;
+        __asm__ volatile(
+            "movdqu (%1), %%xmm0\n\t"
+            "movdqu (%2), %%xmm1\n\t"
+            "pcmpeqb %%xmm1, %%xmm0\n\t"
+            "pmovmskb %%xmm0, %0\n\t"
+            : "=r"(mask)
+            : "r"(a), "r"(b), "m"(*(const uint8_t(*)[16])a), "m"(*(const uint8_t(*)[16])b)
+            : "xmm0", "xmm1");
+        if (mask != 0xFFFFU) break;
+        a += 16;
+        b += 16;
+        size -= 16U;
+    }
+#endif
+    while (size >= 4U && *(const os_mem_word_t*)a == *(const os_mem_word_t*)b) {
+        a += 4;
+        b += 4;
+        size -= 4U;
+    }
+    while (size > 0U) {
+        if (*a != *b) return (int)*a - (int)*b;
+        a++;
+        b++;
+        size--;
+    }
+    return 0;
+}
+
+#endif
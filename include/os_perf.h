@@ -0,0 +1,32 @@
+#ifndef OS_PERF_H
+#define OS_PERF_H
+
+#include <stdint.h>
+#include "os_syscalls.h"
+
+/* Profil en cycles TSC (SYS_PERF_READ) : une case par numéro de syscall,
+ * par ligne IRQ du PIC, pour les interruptions locales et pour schedule().
+ * Le temps passé hors CPU (tâche bloquée ou préemptée) n'est pas compté ;
+ * les interruptions servies pendant la mesure le sont. */
+#define OS_PERF_IRQ_LINES 16U
+#define OS_PERF_SLOT_SYSCALL(n) (n)
+#define OS_PERF_SLOT_IRQ(n) (MAX_SYSCALLS + (n))
+#define OS_PERF_SLOT_LAPIC_TIMER (MAX_SYSCALLS + OS_PERF_IRQ_LINES)
+#define OS_PERF_SLOT_RESCHED_IPI (OS_PERF_SLOT_LAPIC_TIMER + 1U)
+#define OS_PERF_SLOT_SCHEDULE (OS_PERF_SLOT_LAPIC_TIMER + 2U)
+#define OS_PERF_SLOT_COUNT (OS_PERF_SLOT_LAPIC_TIMER + 3U)
+
+/* Case n de l'histogramme : durées de 2^n à 2^(n+1)-1 cycles ; la première
+ * reçoit aussi 0, la dernière tout ce qui dépasse. */
+#define OS_PERF_HIST_BUCKETS 32U
+
+typedef struct {
+    uint32_t count;          // 0 : case vide, min/max non significatifs
+    uint32_t reserved;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint32_t hist[OS_PERF_HIST_BUCKETS];
+} os_perf_stat_t;
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef OS_RING_H
+#define OS_RING_H
+
+#include <stdint.h>
+#include "os_syscalls.h"
+
+/* Anneau SPSC (un producteur, un consommateur) posé dans une région
+ * partagée (SYS_SHM_*). Le producteur n'écrit que head et les slots, le
+ * consommateur que tail : ni verrou ni syscall tant que l'anneau n'est ni
+ * vide ni plein. Les compteurs tournent modulo 2^32, le slot est
+ * compteur & slot_mask. x86 garde l'ordre de deux écritures et de deux
+ * lectures : une barrière compilateur suffit pour publier un slot, seule
+ * l'attente (écriture puis lecture de l'autre côté) demande une barrière
+ * complète.
+ *
+ * Sommeil : le consommateur lève consumer_waiting et revérifie l'anneau
+ * (os_ring_prepare_wait) avant SYS_DOORBELL_WAIT ; le producteur ne sonne
+ * (SYS_DOORBELL_RING) que si os_ring_needs_doorbell() après publication. */
+#define OS_RING_HEADER_SIZE 128U
+#define OS_RING_EMPTY (-1)
+#define OS_RING_FULL (-2)
+#define OS_RING_TOO_BIG (-3)
+
+/* En-tête de 128 octets : une ligne de cache par côté. */
+typedef struct {
+    volatile uint32_t head;
+    uint32_t slot_size;      /* Octets par slot, longueur de 4 octets comprise */
+    uint32_t slot_mask;      /* Nombre de slots - 1 (puissance de deux) */
+    uint32_t reserved0[13];
+    volatile uint32_t tail;
+    volatile uint32_t consumer_waiting;
+    uint32_t reserved1[14];
+} os_ring_t;
+
+/* Anneau d'événements noyau (SYS_EVENT_RING) : chaque slot porte un
+ * os_ipc_payload_t entier, relu en message d'émetteur 0. */
+#define OS_RING_EVENT_SLOT_SIZE 128U
+
+static inline void os_ring_barrier(void) {
+    __asm__ volatile("" : : : "memory");
+}
+
+/* Décalage du slot depuis l'en-tête : un slot de 128 octets ne chevauche
+ * jamais deux pages, le noyau l'écrit par sa frame. */
+static inline uint32_t os_ring_slot_offset(uint32_t index, uint32_t slot_mask, uint32_t slot_size) {
+    return OS_RING_HEADER_SIZE + (index & slot_mask) * slot_size;
+}
+
+/* Découpe bytes octets en la plus grande puissance de deux de slots ;
+ * NULL si la zone n'en contient aucun. */
+static inline os_ring_t* os_ring_init(void* memory, uint32_t bytes, uint32_t slot_size) {
+    os_ring_t* ring = (os_ring_t*)memory;
+    uint32_t fit;
+    uint32_t slots = 1U;
+    uint32_t i;
+    if (!memory || slot_size < 8U || (slot_size & 3U) != 0U || bytes < OS_RING_HEADER_SIZE) return 0;
+    fit = (bytes - OS_RING_HEADER_SIZE) / slot_size;
+    if (fit == 0U) return 0;
+    while (slots <= fit / 2U) slots <<= 1;
+    for (i = 0U; i < OS_RING_HEADER_SIZE / 4U; i++) ((volatile uint32_t*)memory)[i] = 0U;
+    ring->slot_size = slot_size;
+    ring->slot_mask = slots - 1U;
+    return ring;
+}
+
+static inline uint32_t os_ring_count(const os_ring_t* ring) {
+    return ring->head - ring->tail;
+}
+
+static inline int os_ring_push(os_ring_t* ring, const void* data, uint32_t size) {
+    uint32_t mask = ring->slot_mask;
+    uint32_t slot_size = ring->slot_size;
+    uint32_t head = ring->head;
+    const uint8_t* source = (const uint8_t*)data;
+    uint8_t* slot;
+    uint32_t i;
+    if (size > slot_size - 4U) return OS_RING_TOO_BIG;
+    if (head - ring->tail > mask) return OS_RING_FULL;
+    slot = (uint8_t*)ring + os_ring_slot_offset(head, mask, slot_size);
+    *(uint32_t*)slot = size;
+    for (i = 0U; i < size; i++) slot[4U + i] = source[i];
+    os_ring_barrier();
+    ring->head = head + 1U;
+    return 0;
+}
+
+/* Renvoie la taille du plus ancien enregistrement ; trop grand pour max,
+ * il reste en tête (OS_RING_TOO_BIG). */
+static inline int os_ring_pop(os_ring_t* ring, void* out, uint32_t max) {
+    uint32_t mask = ring->slot_mask;
+    uint32_t slot_size = ring->slot_size;
+    uint32_t tail = ring->tail;
+    uint8_t* destination = (uint8_t*)out;
+    const uint8_t* slot;
+    uint32_t size;
+    uint32_t i;
+    if (tail == ring->head) return OS_RING_EMPTY;
+    os_ring_barrier();
+    slot = (const uint8_t*)ring + os_ring_slot_offset(tail, mask, slot_size);
+    size = *(const uint32_t*)slot;
+    if (size > slot_size - 4U) size = slot_size - 4U;
+    if (size > max) return OS_RING_TOO_BIG;
+    for (i = 0U; i < size; i++) destination[i] = slot[4U + i];
+    os_ring_barrier();
+    ring->tail = tail + 1U;
+    return (int)size;
+}
+
+/* Renvoie 1 si le consommateur peut dormir ; 0 si un enregistrement est
+ * arrivé entre-temps. */
+static inline int os_ring_prepare_wait(os_ring_t* ring) {
+    ring->consumer_waiting = 1U;
+    __sync_synchronize();
+    if (ring->head != ring->tail) {
+        ring->consumer_waiting = 0U;
+        return 0;
+    }
+    return 1;
+}
+
+static inline void os_ring_finish_wait(os_ring_t* ring) {
+    ring->consumer_waiting = 0U;
+}
+
+/* Le producteur abaisse le drapeau en sonnant : une rafale ne sonne qu'une fois. */
+static inline int os_ring_needs_doorbell(os_ring_t* ring) {
+    __sync_synchronize();
+    if (ring->consumer_waiting == 0U) return 0;
+    ring->consumer_waiting = 0U;
+    return 1;
+}
+
+static inline int os_ring_pop_event(os_ring_t* ring, os_ipc_message_t* out) {
+    os_ipc_payload_t payload;
+    uint32_t i;
+    int rc = os_ring_pop(ring, &payload, sizeof(payload));
+    if (rc < 0) return rc;
+    if ((uint32_t)rc != sizeof(payload) || payload.size > OS_IPC_MAX_DATA) return OS_IPC_BAD_MESSAGE;
+    out->sender_pid = 0;
+    out->type = payload.type;
+    out->size = payload.size;
+    out->request_id = payload.request_id;
+    for (i = 0U; i < payload.size; i++) out->data[i] = payload.data[i];
+    return 0;
+}
+
+#endif
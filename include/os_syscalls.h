@@ -222,7 +222,91 @@
 #define SYS_VFS_FAT16_UNLINK 117
 /* EBX = ancien nom FAT16 8.3, ECX = nouveau nom 8.3 ; réservé aux droits backend mutate de `vfs`. */
 #define SYS_VFS_FAT16_RENAME 118
-#define MAX_SYSCALLS 119
+/* EBX = os_memstats_t* ; fragmentation PMM et pages résidentes par tâche. */
+#define SYS_MEMSTATS 119
+/* EBX = durée en ms (0 : simple yield) ; renvoie le tick du réveil. Un message
+ * IPC reçu ou une sonnerie (SYS_DOORBELL_RING) écourte le sommeil. */
+#define SYS_SLEEP 120
+/* EBX = tick absolu (horloge de SYS_TICKS) ; revient de suite s'il est passé. */
+#define SYS_SLEEP_UNTIL 121
+/* Réception IPC bloquante. EBX = os_ipc_message_t*, ECX = os_ipc_filter_t*
+ * (NULL : tout message), EDX = délai en ms (0 : sans attente,
+ * OS_IPC_WAIT_FOREVER : sans échéance). Retient le plus ancien message qui
+ * passe le filtre, les autres gardent leur ordre ; OS_IPC_EMPTY à l'échéance. */
+#define SYS_IPC_RECV_WAIT 122
+/* Appel synchrone. EBX = PID du service, ECX = requête (os_ipc_payload_t*),
+ * EDX = réponse (os_ipc_message_t*), ESI = délai en ms (comme
+ * SYS_IPC_RECV_WAIT). Attend le message du même PID portant le même
+ * request_id ; le CPU passe directement au service réveillé. */
+#define SYS_IPC_CALL 123
+/* Boucle serveur. EBX = PID du client à qui répondre (0 : aucun),
+ * ECX = réponse, EDX = message suivant, ESI = délai en ms. Le CPU passe
+ * directement au client réveillé par la réponse. */
+#define SYS_IPC_REPLY_WAIT 124
+/* Région partagée (OS_SHM_*). EBX = nom de service détenu par l'appelant
+ * (NULL ou "" : région anonyme, ni partageable ni mappable ailleurs),
+ * ECX = pages (1..OS_SHM_REGION_MAX_PAGES) ; renvoie l'identifiant, région
+ * zéro-remplie déjà mappée en lecture-écriture chez le créateur. */
+#define SYS_SHM_CREATE 125
+/* EBX = identifiant, ECX = PID bénéficiaire, EDX = droits OS_SHM_RIGHT_* ;
+ * réservé au créateur tant qu'il détient le service de la région. */
+#define SYS_SHM_GRANT 126
+/* EBX = identifiant, ECX = PID bénéficiaire ; démappe la région chez lui. */
+#define SYS_SHM_REVOKE 127
+/* EBX = identifiant ; mappe la région selon les droits accordés et renvoie
+ * son adresse (os_shm_address). */
+#define SYS_SHM_MAP 128
+/* EBX = identifiant ; le bénéficiaire démappe et rend son droit, le
+ * créateur détruit la région chez tous. */
+#define SYS_SHM_RELEASE 129
+/* EBX = délai en ms (comme SYS_IPC_RECV_WAIT). Dort jusqu'à une sonnerie
+ * (SYS_DOORBELL_RING) ou un message IPC ; renvoie 1 si la sonnette a été
+ * consommée, 0 sinon. Une sonnette déjà levée revient de suite. */
+#define SYS_DOORBELL_WAIT 130
+/* EBX = PID ; lève sa sonnette et réveille un sommeil (os_ring.h). */
+#define SYS_DOORBELL_RING 131
+/* EBX = région (0 : détache) que l'appelant peut écrire. Elle devient un
+ * os_ring_t de slots OS_RING_EVENT_SLOT_SIZE : les messages du noyau
+ * (émetteur 0) y sont écrits au lieu de la boîte aux lettres. */
+#define SYS_EVENT_RING 132
+/* EBX = région anonyme de l'appelant (os_batch.h). Exécute les entrées de
+ * la file de soumission tant que la file de complétion a de la place ;
+ * renvoie le nombre d'entrées traitées. */
+#define SYS_BATCH 133
+/* EBX = os_trace_record_t[], ECX = capacité ; copie les derniers
+ * enregistrements de la trace noyau (os_trace.h), du plus ancien au plus
+ * récent, et renvoie leur nombre. Non destructif. */
+#define SYS_TRACE_READ 134
+/* EBX = première case, ECX = os_perf_stat_t[], EDX = capacité ; copie les
+ * compteurs de cycles (os_perf.h) et renvoie le nombre de cases copiées,
+ * 0 au-delà de OS_PERF_SLOT_COUNT. */
+#define SYS_PERF_READ 135
+/* Remet tous les compteurs de SYS_PERF_READ à zéro. */
+#define SYS_PERF_RESET 136
+/* EBX = multiplicateur de la cadence IRQ0 (1 à OS_PROFILE_MAX_MULTIPLIER) :
+ * démarre une session d'échantillonnage ; EBX = 0 l'arrête, vide les
+ * échantillons restants sur le port série et renvoie leur nombre total. */
+#define SYS_PROFILE 137
+#define OS_PROFILE_MAX_MULTIPLIER 10U
+#define MAX_SYSCALLS 138
+
+/* Entrée rapide SYSENTER : les programmes appellent os_syscall
+ * (userspace/start.s) au lieu de INT 0x80, registres inchangés. Le stub
+ * empile ce cadre et passe son adresse dans EBP ; SYSEXIT reprend sur
+ * resume avec ESP = &ebp. Sans SEP (CPUID), le stub fait INT 0x80. */
+typedef struct {
+    uint32_t resume;      /* Reprise après SYSEXIT : restaure EBP, EDX, ECX */
+    uint32_t ebp;
+    uint32_t edx;
+    uint32_t ecx;
+    uint32_t ret;         /* Adresse de retour de l'appel os_syscall */
+} os_vsyscall_frame_t;
+
+#define OS_SYSCALL_INSN "call os_syscall"
+
+/* Fréquence de l'horloge de SYS_TICKS. */
+#define OS_TIMER_HZ 100U
+#define OS_TIMER_MS_PER_TICK (1000U / OS_TIMER_HZ)
 
 typedef struct {
     uint16_t source_port;
@@ -347,6 +431,28 @@ typedef struct {
 /* L’endpoint d’un propriétaire de service est saturé par la politique de
  * service avant la capacité brute de la tâche. */
 #define OS_IPC_SERVICE_FULL (-44)
+#define OS_IPC_WAIT_FOREVER 0xFFFFFFFFU
+
+/* Régions partagées : gros transferts sans copie, l'IPC ne porte que
+ * l'identifiant. Chaque région a une fenêtre fixe, à la même adresse dans
+ * tous les espaces qui la mappent. */
+#define OS_SHM_REGION_CAPACITY 16U
+#define OS_SHM_REGION_MAX_PAGES 16U
+#define OS_SHM_WINDOW_BASE 0x70000000U
+#define OS_SHM_RIGHT_READ 1U
+#define OS_SHM_RIGHT_WRITE 2U
+#define OS_SHM_BAD_ARGUMENT (-45)
+#define OS_SHM_FULL         (-46)
+#define OS_SHM_DENIED       (-47)
+#define OS_SHM_NO_MEMORY    (-48)
+/* SYS_BATCH : région ou anneaux invalides ; syscall hors de la liste des
+ * opérations groupables (résultat d'une complétion). */
+#define OS_BATCH_BAD_RING   (-49)
+#define OS_BATCH_BAD_OP     (-58)
+
+static inline void* os_shm_address(uint32_t id) {
+    return (void*)(OS_SHM_WINDOW_BASE + (id - 1U) * OS_SHM_REGION_MAX_PAGES * 4096U);
+}
 
 /* Registre Foundation : simple découverte de nom, pas une capability. */
 #define OS_SERVICE_NAME_MAX 16U
@@ -405,7 +511,7 @@ typedef struct {
 
 #define OS_NAME_MAX 64
 #define OS_PROC_NAME_MAX 32
-#define OS_TASK_GLOBAL_CAPACITY 16U
+#define OS_TASK_GLOBAL_CAPACITY 32U
 
 #define OS_DIRENT_FILE 0
 #define OS_DIRENT_DIR  1
@@ -612,12 +718,57 @@ typedef struct {
     uint32_t endpoint_capacity;
 } os_service_status_t;
 
+/* Classes du tas noyau : 16, 32, ... 1024 octets puis la demi-page utile. */
+#define OS_HEAP_CLASS_COUNT 8U
+
+/* Occupation d'un cache slab du tas noyau (kmalloc/kfree). */
+typedef struct {
+    uint32_t object_size;
+    uint32_t slab_pages;
+    uint32_t objects_in_use;
+    uint32_t objects_free;
+} os_heap_cache_info_t;
+
 typedef struct {
     uint32_t total_pages;
     uint32_t used_pages;
     uint32_t free_pages;
+    /* Allocations > dernière classe : pages PMM rendues au kfree. */
+    uint32_t heap_large_allocs;
+    uint32_t heap_large_pages;
+    os_heap_cache_info_t heap_caches[OS_HEAP_CLASS_COUNT];
 } os_meminfo_t;
 
+/* Ordres buddy 0..20 : blocs libres de 2^ordre pages. */
+#define OS_MEM_ORDER_COUNT 21U
+
+/* Empreinte d'une tâche : frames utilisateur mappées (partagées comprises)
+ * et tables de pages privées. Les tâches noyau partagent l'espace noyau. */
+typedef struct {
+    int32_t pid;
+    uint32_t resident_pages;
+    uint32_t table_pages;
+    char name[OS_PROC_NAME_MAX];
+} os_task_mem_t;
+
+/* Instantané SYS_MEMSTATS : compteurs tenus à jour par le PMM et le VMM,
+ * sans parcours du bitmap ni des tables. */
+typedef struct {
+    uint32_t total_pages;
+    uint32_t free_pages;
+    uint32_t direct_pages;
+    uint32_t zero_pool_pages;
+    /* Plus grand bloc libre, donc plus grande allocation contiguë possible. */
+    uint32_t largest_free_run;
+    uint32_t free_blocks[OS_MEM_ORDER_COUNT];
+    /* Échecs d'allocation, classés par ordre de la demande. */
+    uint32_t alloc_failures;
+    uint32_t alloc_failures_by_order[OS_MEM_ORDER_COUNT];
+    uint32_t last_failed_pages;
+    uint32_t task_count;
+    os_task_mem_t tasks[OS_TASK_GLOBAL_CAPACITY];
+} os_memstats_t;
+
 /* Charge fournie par l'émetteur : son identité est ajoutée par le noyau.
  * request_id est opaque et permet au protocole utilisateur de corréler une réponse.
  */
@@ -637,6 +788,19 @@ typedef struct {
     uint8_t data[OS_IPC_MAX_DATA];
 } os_ipc_message_t;
 
+/* Filtre de SYS_IPC_RECV_WAIT : seuls les champs cités par match sont
+ * comparés (sender_pid 0 désigne le noyau, d'où les drapeaux). */
+#define OS_IPC_MATCH_SENDER 0x1U
+#define OS_IPC_MATCH_TYPE 0x2U
+#define OS_IPC_MATCH_REQUEST 0x4U
+
+typedef struct {
+    uint32_t match;
+    int32_t sender_pid;
+    uint32_t type;
+    uint32_t request_id;
+} os_ipc_filter_t;
+
 /* Notification synthétique, émise par le noyau (sender_pid = 0) dans l’IPC
  * existant. La charge est : nom NUL-paddé, ancien PID, nouveau PID, raison. */
 #define OS_IPC_SERVICE_EVENT 0x53525601U
@@ -685,6 +849,26 @@ static inline uint32_t os_ipc_decode_u32(const uint8_t* in) {
            ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
 }
 
+/* Message court remis en registres à une tâche bloquée dans SYS_IPC_CALL ou
+ * SYS_IPC_REPLY_WAIT, sans passer par son endpoint : EAX = OS_IPC_SHORT |
+ * taille, EBX = PID émetteur, ECX = type, EDX = request_id, ESI et EDI = les
+ * OS_IPC_SHORT_MAX premiers octets. L'appelant le recopie dans son message. */
+#define OS_IPC_SHORT_MAX 8U
+#define OS_IPC_SHORT 0x100
+
+static inline int os_ipc_short_unpack(int rc, uint32_t sender_pid, uint32_t type,
+                                      uint32_t request_id, uint32_t word0, uint32_t word1,
+                                      os_ipc_message_t* out) {
+    if ((rc & ~0xFF) != OS_IPC_SHORT) return rc;
+    out->sender_pid = (int32_t)sender_pid;
+    out->type = type;
+    out->request_id = request_id;
+    out->size = (uint32_t)rc & 0xFFU;
+    os_ipc_encode_u32(out->data, word0);
+    os_ipc_encode_u32(out->data + 4, word1);
+    return 0;
+}
+
 static inline int os_service_make_event(os_ipc_payload_t* payload, const char* name,
                                         int32_t old_owner_pid, int32_t new_owner_pid,
                                         uint32_t reason) {
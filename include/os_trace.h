@@ -0,0 +1,51 @@
+#ifndef OS_TRACE_H
+#define OS_TRACE_H
+
+#include <stdint.h>
+
+/* Trace binaire du noyau (SYS_TRACE_READ) : un enregistrement de taille fixe
+ * par événement, horodaté au TSC du CPU qui l'a émis. Les arguments dépendent
+ * de l'événement (voir chaque OS_TRACE_*). */
+#define OS_TRACE_SCHED_SWITCH 1U   /* PID sortant, PID élu, bascules de l'élu */
+#define OS_TRACE_TASK_REAP    2U   /* PID retiré de la file */
+#define OS_TRACE_TASK_EXIT    3U   /* PID, code de sortie, raison OS_TASK_EVENT_* */
+#define OS_TRACE_TASK_CREATE  4U   /* PID, point d'entrée, sommet de pile */
+#define OS_TRACE_ELF_LOAD     5U   /* Point d'entrée, en-têtes de programme, image partagée */
+#define OS_TRACE_ELF_SEGMENT  6U   /* Adresse, taille mémoire, PF_W */
+#define OS_TRACE_USER_STACK   7U   /* Bas, sommet de la zone de pile */
+#define OS_TRACE_EXEC         8U   /* Résultat de SYS_EXEC (PID ou erreur) */
+#define OS_TRACE_SPAWN        9U   /* Résultat de SYS_SPAWN */
+#define OS_TRACE_GETS_CHAR    10U  /* Caractère, position dans la ligne */
+#define OS_TRACE_GETC         11U  /* Caractère, source (0 tampon, 1 scrutation), appel n */
+#define OS_TRACE_KBD_SCANCODE 12U  /* Scancode, source (0 IRQ1, 1 scrutation), compteur */
+#define OS_TRACE_EVENT_COUNT  13U
+
+typedef struct {
+    uint64_t tsc;
+    uint32_t seq;        /* Index d'écriture + 1, 0 pendant l'écriture */
+    uint16_t event;      /* OS_TRACE_* */
+    uint8_t cpu;
+    uint8_t reserved;
+    int32_t pid;         /* Tâche courante, -1 hors tâche */
+    uint32_t args[3];
+} os_trace_record_t;
+
+static inline const char* os_trace_event_name(uint32_t event) {
+    switch (event) {
+        case OS_TRACE_SCHED_SWITCH: return "sched-switch";
+        case OS_TRACE_TASK_REAP: return "task-reap";
+        case OS_TRACE_TASK_EXIT: return "task-exit";
+        case OS_TRACE_TASK_CREATE: return "task-create";
+        case OS_TRACE_ELF_LOAD: return "elf-load";
+        case OS_TRACE_ELF_SEGMENT: return "elf-segment";
+        case OS_TRACE_USER_STACK: return "user-stack";
+        case OS_TRACE_EXEC: return "exec";
+        case OS_TRACE_SPAWN: return "spawn";
+        case OS_TRACE_GETS_CHAR: return "gets-char";
+        case OS_TRACE_GETC: return "getc";
+        case OS_TRACE_KBD_SCANCODE: return "kbd-scancode";
+        default: return "?";
+    }
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "os_syscalls.h"
+#include "os_mem.h"
 
 #define OS_IPC_VFS_READ       0x56465301U
 #define OS_IPC_VFS_READ_REPLY 0x56465302U
@@ -41,6 +42,8 @@
 #define OS_IPC_VFS_BACKEND_LIST_REPLY 0x56465323U
 #define OS_IPC_VFS_BACKEND_OBSERVE       0x56465324U
 #define OS_IPC_VFS_BACKEND_OBSERVE_REPLY 0x56465325U
+#define OS_IPC_VFS_BULK_READ       0x56465326U
+#define OS_IPC_VFS_BULK_READ_REPLY 0x56465327U
 /* Canal privé entre le médiateur `vfs` et le worker Ring 3 `vfs-virtual`. */
 #define OS_IPC_VFS_WORKER_READ       0x56465701U
 #define OS_IPC_VFS_WORKER_READ_REPLY 0x56465702U
@@ -77,6 +80,13 @@
 #define OS_VFS_BACKEND_RIGHT_MUTATE 2U
 #define OS_VFS_BACKEND_RIGHT_ALL (OS_VFS_BACKEND_RIGHT_READ | OS_VFS_BACKEND_RIGHT_MUTATE)
 #define OS_VFS_STAT_REPLY_SIZE 12U
+/* Lecture en masse : le médiateur lit le fichier dans une région partagée
+ * (OS_SHM_*) qu'il accorde en lecture au client ; la réponse ne porte que
+ * statut, taille et identifiant de région, à mapper par SYS_SHM_MAP. */
+#define OS_VFS_BULK_PAGES 8U
+#define OS_VFS_BULK_MAX (OS_VFS_BULK_PAGES * 4096U)
+#define OS_VFS_BULK_READ_REQUEST_SIZE OS_VFS_PATH_MAX
+#define OS_VFS_BULK_READ_REPLY_SIZE 12U
 /* Réponse LIST : statut (4), nombre d’entrées retournées (4) et texte
  * NUL-paddé de noms séparés par '\n' (72), soit 80 octets au total. */
 #define OS_VFS_LIST_DATA_MAX 72U
@@ -119,6 +129,12 @@ typedef struct {
     uint32_t flags;
 } os_vfs_stat_reply_t;
 
+typedef struct {
+    int32_t status;
+    uint32_t size;
+    uint32_t region;
+} os_vfs_bulk_read_reply_t;
+
 typedef struct {
     int32_t status;
     uint32_t count;
@@ -269,7 +285,7 @@ static inline int os_vfs_make_worker_read_reply(os_ipc_payload_t* payload, int32
 static inline int os_vfs_parse_worker_read_reply(const os_ipc_message_t* message,
                                                  int32_t* status_out, uint8_t* data_out,
                                                  uint32_t* size_out, uint32_t request_id) {
-    uint32_t i, size, raw;
+    uint32_t size, raw;
     if (!message || !status_out || !data_out || !size_out || message->type != OS_IPC_VFS_WORKER_READ_REPLY ||
         message->size != OS_VFS_WORKER_READ_REPLY_SIZE || message->request_id != request_id)
         return OS_VFS_STATUS_INVALID;
@@ -280,7 +296,7 @@ static inline int os_vfs_parse_worker_read_reply(const os_ipc_message_t* message
     if (size > OS_VFS_READ_MAX) return OS_VFS_STATUS_INVALID;
     *status_out = (int32_t)raw;
     *size_out = size;
-    for (i = 0U; i < size; i++) data_out[i] = message->data[8U + i];
+    os_memcpy(data_out, &message->data[8U], size);
     return OS_VFS_STATUS_OK;
 }
 
@@ -1269,4 +1285,47 @@ static inline int os_vfs_parse_read_reply(const os_ipc_message_t* message,
     return 0;
 }
 
+static inline int os_vfs_make_bulk_read_request(os_ipc_payload_t* payload, const char* path,
+                                                uint32_t request_id) {
+    if (os_vfs_make_read_request(payload, path, request_id) != 0) return OS_VFS_STATUS_INVALID;
+    payload->type = OS_IPC_VFS_BULK_READ;
+    return 0;
+}
+
+static inline int os_vfs_parse_bulk_read_request(const os_ipc_message_t* message, char* path_out) {
+    uint32_t i;
+    if (!message || !path_out || message->type != OS_IPC_VFS_BULK_READ ||
+        message->size != OS_VFS_BULK_READ_REQUEST_SIZE) return OS_VFS_STATUS_INVALID;
+    for (i = 0U; i < OS_VFS_PATH_MAX; i++) path_out[i] = (char)message->data[i];
+    if (!os_vfs_path_is_safe(path_out)) return OS_VFS_STATUS_INVALID;
+    return 0;
+}
+
+static inline int os_vfs_make_bulk_read_reply(os_ipc_payload_t* payload, int32_t status, uint32_t size,
+                                              uint32_t region, uint32_t request_id) {
+    uint32_t i;
+    if (!payload || size > OS_VFS_BULK_MAX) return OS_VFS_STATUS_INVALID;
+    payload->type = OS_IPC_VFS_BULK_READ_REPLY;
+    payload->size = OS_VFS_BULK_READ_REPLY_SIZE;
+    payload->request_id = request_id;
+    os_vfs_encode_i32(&payload->data[0], status);
+    os_vfs_encode_u32(&payload->data[4], size);
+    os_vfs_encode_u32(&payload->data[8], region);
+    for (i = OS_VFS_BULK_READ_REPLY_SIZE; i < OS_IPC_MAX_DATA; i++) payload->data[i] = 0U;
+    return 0;
+}
+
+static inline int os_vfs_parse_bulk_read_reply(const os_ipc_message_t* message,
+                                               os_vfs_bulk_read_reply_t* reply_out,
+                                               uint32_t expected_request_id) {
+    if (!message || !reply_out || message->type != OS_IPC_VFS_BULK_READ_REPLY ||
+        message->size != OS_VFS_BULK_READ_REPLY_SIZE ||
+        message->request_id != expected_request_id) return OS_VFS_STATUS_INVALID;
+    reply_out->status = os_vfs_decode_i32(&message->data[0]);
+    reply_out->size = os_vfs_decode_u32(&message->data[4]);
+    reply_out->region = os_vfs_decode_u32(&message->data[8]);
+    if (reply_out->size > OS_VFS_BULK_MAX) return OS_VFS_STATUS_INVALID;
+    return 0;
+}
+
 #endif
@@ -0,0 +1,46 @@
+#include "deferred.h"
+#include "timer.h"
+#include <stddef.h>
+
+volatile uint32_t deferred_work_pending = 0U;
+static deferred_work_t* deferred_work_list = NULL;
+
+/* Contexte IRQ0 : rien d'autre que deux écritures de mot. */
+static void deferred_work_fire(timer_event_t* event) {
+    deferred_work_t* work = (deferred_work_t*)event;
+    work->pending = 1U;
+    deferred_work_pending = 1U;
+}
+
+void deferred_work_init(deferred_work_t* work, deferred_work_fn run) {
+    if (!work) return;
+    timer_event_init(&work->timer, deferred_work_fire);
+    work->run = run;
+    work->pending = 0U;
+    if (work->registered) return;
+    work->registered = 1U;
+    work->next = deferred_work_list;
+    deferred_work_list = work;
+}
+
+void deferred_work_schedule(deferred_work_t* work, uint32_t now, uint32_t delay) {
+    if (!work || !work->registered) return;
+    timer_arm(&work->timer, now + (delay != 0U ? delay : 1U));
+}
+
+uint32_t deferred_work_run(uint32_t now) {
+    deferred_work_t* work;
+    uint32_t count = 0U;
+    /* Baissé avant le parcours : une échéance tirée pendant un rappel relève
+     * le drapeau et sera servie au passage suivant. */
+    deferred_work_pending = 0U;
+    __asm__ volatile("" : : : "memory");
+    for (work = deferred_work_list; work; work = work->next) {
+        if (!work->pending) continue;
+        work->pending = 0U;
+        __asm__ volatile("" : : : "memory");
+        if (work->run) work->run(work, now);
+        count++;
+    }
+    return count;
+}
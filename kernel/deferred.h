@@ -0,0 +1,32 @@
+#ifndef DEFERRED_H
+#define DEFERRED_H
+
+#include <stdint.h>
+#include "timer_wheel.h"
+
+/* Travail différé : une échéance de la roue (rappel dans IRQ0) ne fait que
+ * lever pending ; le travail lui-même tourne plus tard, verrou noyau tenu et
+ * interruptions actives, au prochain passage de deferred_work_run() (entrée
+ * de syscall, boucle d'inactivité). Le chemin chaud ne lit qu'un mot. Un
+ * travail périodique se réarme depuis son rappel (deferred_work_schedule). */
+struct deferred_work;
+typedef void (*deferred_work_fn)(struct deferred_work* work, uint32_t now);
+
+typedef struct deferred_work {
+    timer_event_t timer;            // Premier champ : l'échéance retrouve son travail
+    deferred_work_fn run;
+    volatile uint32_t pending;      // Levé par l'échéance, baissé avant run()
+    uint8_t registered;
+    struct deferred_work* next;     // Travaux connus, parcourus par deferred_work_run()
+} deferred_work_t;
+
+/* Non nul dès qu'un travail attend : seul test fait à chaque syscall. */
+extern volatile uint32_t deferred_work_pending;
+
+void deferred_work_init(deferred_work_t* work, deferred_work_fn run);
+/* (Ré)arme le travail delay ticks après now (au moins un tick). */
+void deferred_work_schedule(deferred_work_t* work, uint32_t now, uint32_t delay);
+/* Exécute les travaux échus ; renvoie leur nombre. Verrou noyau tenu. */
+uint32_t deferred_work_run(uint32_t now);
+
+#endif
@@ -5,9 +5,11 @@
 #include "kernel/mem/vmm.h"
 #include "kernel/mem/pmm.h"
 #include "kernel/mem/string.h"
+#include "kernel/trace.h"
+#include "fs/initrd.h"
+#include "fs/overlay.h"
 
 extern void print_string_serial(const char* str);
-extern void print_hex_serial(uint32_t n);
 
 int elf_validate(uint8_t* elf_data) {
     if (!elf_data) return 0;
@@ -19,7 +21,181 @@ int elf_validate(uint8_t* elf_data) {
     return 1;
 }
 
-uint32_t elf_load(uint8_t* file_data, vmm_directory_t* vmm_dir) {
+/*
+ * Cache des exécutables de l'initrd, indexé par le chemin demandé. Une entrée
+ * garde le résultat de la résolution (initrd puis bin/), les PT_LOAD recopiés
+ * avec leurs bornes précalculées et le point d'entrée : un nouveau lancement
+ * ne relit ni la table de l'initrd ni les en-têtes. Elle porte aussi le modèle
+ * d'espace d'adressage rempli au premier chargement : pages de texte prises
+ * dans l'initrd (PAGE_BORROWED), pages en lecture seule ou copy-on-write dont
+ * le cache garde sa propre référence. Les fichiers initrd sont immuables ;
+ * seule l'overlay peut masquer un chemin, d'où la revalidation quand sa
+ * génération change.
+ */
+#define ELF_IMAGE_CAPACITY 8U
+#define ELF_IMAGE_PAGES 128U
+#define ELF_IMAGE_SEGMENTS 8U
+#define ELF_IMAGE_PATH 128U
+
+struct elf_image {
+    char path[ELF_IMAGE_PATH];          // Clé : chemin tel que demandé, "" si libre
+    char resolved[ELF_IMAGE_PATH];      // Nom dans l'initrd (path ou bin/path)
+    const uint8_t* file_data;
+    uint32_t generation;                // overlay_generation() à la dernière validation
+    uint32_t last_use;
+    uint32_t entry;
+    uint32_t segment_count;
+    elf32_phdr_t segments[ELF_IMAGE_SEGMENTS];
+    uint32_t share_end[ELF_IMAGE_SEGMENTS];
+    uint32_t direct_end[ELF_IMAGE_SEGMENTS];
+    uint8_t template_state;             // ELF_TEMPLATE_*
+    uint32_t page_count;
+    uint32_t pages[ELF_IMAGE_PAGES];    // Adresse virtuelle | PAGE_COW | PAGE_BORROWED
+    uint32_t frames[ELF_IMAGE_PAGES];
+};
+
+#define ELF_TEMPLATE_EMPTY 0U   // Rempli au prochain chargement
+#define ELF_TEMPLATE_READY 1U
+#define ELF_TEMPLATE_NONE  2U   // Trop de pages : chaque chargement copie
+
+static elf_image_t elf_images[ELF_IMAGE_CAPACITY];
+static uint32_t elf_image_clock = 0;
+
+static uint32_t elf_page_end(uint32_t addr) {
+    return (addr + PAGE_SIZE - 1U) & ~(PAGE_SIZE - 1U);
+}
+
+static int elf_segments_overlap(const elf32_phdr_t* a, const elf32_phdr_t* b) {
+    uint32_t a_start = a->p_vaddr & ~(PAGE_SIZE - 1U);
+    uint32_t b_start = b->p_vaddr & ~(PAGE_SIZE - 1U);
+    return a_start < elf_page_end(b->p_vaddr + b->p_memsz) &&
+           b_start < elf_page_end(a->p_vaddr + a->p_memsz);
+}
+
+static int elf_page_writable(const elf32_phdr_t* pheaders, uint32_t phnum, uint32_t page_addr) {
+    for (uint32_t i = 0; i < phnum; i++) {
+        const elf32_phdr_t* ph = &pheaders[i];
+        if (!(ph->p_flags & PF_W)) continue;
+        if (page_addr >= (ph->p_vaddr & ~(PAGE_SIZE - 1U)) && page_addr < elf_page_end(ph->p_vaddr + ph->p_memsz)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Fin (exclue) des pages partageables du segment : aucune si une page est commune à un autre segment.
+static uint32_t elf_segment_share_end(const elf32_phdr_t* pheaders, uint32_t phnum, uint32_t index) {
+    const elf32_phdr_t* ph = &pheaders[index];
+    uint32_t start = ph->p_vaddr & ~(PAGE_SIZE - 1U);
+    for (uint32_t i = 0; i < phnum; i++) {
+        if (i != index && elf_segments_overlap(ph, &pheaders[i])) return start;
+    }
+    // Au-delà du fichier, les pages sont peuplées à la demande et restent privées.
+    return ph->p_filesz ? elf_page_end(ph->p_vaddr + ph->p_filesz) : start;
+}
+
+/*
+ * Pages prises telles quelles dans l'initrd, déjà résident (module Multiboot) :
+ * segment en lecture seule sans page commune, pages entièrement couvertes par
+ * le fichier et alignées dans l'archive. Renvoie la fin (exclue) de la plage
+ * qui commence à elf_page_end(p_vaddr) ; le reste du segment est copié.
+ */
+static uint32_t elf_segment_direct_end(const uint8_t* file_data, const elf32_phdr_t* pheaders,
+                                       uint32_t phnum, uint32_t index) {
+    const elf32_phdr_t* ph = &pheaders[index];
+    uint32_t start = elf_page_end(ph->p_vaddr);
+    uint32_t base = (uint32_t)file_data;
+    uint32_t end = (ph->p_vaddr + ph->p_filesz) & ~(PAGE_SIZE - 1U);
+    if ((ph->p_flags & PF_W) || end <= start) return start;
+    if (((base + ph->p_offset - ph->p_vaddr) & (PAGE_SIZE - 1U)) != 0U) return start;
+    // Seuls les fichiers de l'initrd sont immuables et jamais rendus au PMM.
+    if (!current_initrd || base < current_initrd->location ||
+        base + ph->p_offset + (end - ph->p_vaddr) > current_initrd->location + current_initrd->size) {
+        return start;
+    }
+    for (uint32_t i = 0; i < phnum; i++) {
+        if (i != index && elf_segments_overlap(ph, &pheaders[i])) return start;
+    }
+    return end;
+}
+
+static void elf_template_drop(elf_image_t* image) {
+    for (uint32_t i = 0; i < image->page_count; i++) {
+        if (!(image->pages[i] & PAGE_BORROWED)) (void)pmm_page_unref((void*)image->frames[i]);
+    }
+    image->page_count = 0;
+    if (image->template_state == ELF_TEMPLATE_READY) image->template_state = ELF_TEMPLATE_EMPTY;
+}
+
+static void elf_image_drop(elf_image_t* image) {
+    elf_template_drop(image);
+    image->path[0] = '\0';
+    image->file_data = 0;
+}
+
+static elf_image_t* elf_image_find(const char* path) {
+    for (uint32_t i = 0; i < ELF_IMAGE_CAPACITY; i++) {
+        if (elf_images[i].path[0] && strcmp(elf_images[i].path, path) == 0) return &elf_images[i];
+    }
+    return 0;
+}
+
+// Prend un emplacement libre, sinon évince l'image la moins récemment chargée.
+static elf_image_t* elf_image_claim(void) {
+    elf_image_t* victim = &elf_images[0];
+    for (uint32_t i = 0; i < ELF_IMAGE_CAPACITY; i++) {
+        elf_image_t* image = &elf_images[i];
+        if (!image->path[0]) {
+            victim = image;
+            break;
+        }
+        if (image->last_use < victim->last_use) victim = image;
+    }
+    if (victim->path[0]) elf_image_drop(victim);
+    return victim;
+}
+
+static int elf_copy_path(char* dest, const char* prefix, const char* path) {
+    uint32_t n = 0;
+    while (prefix[n]) {
+        dest[n] = prefix[n];
+        n++;
+    }
+    for (uint32_t i = 0; path[i]; i++) {
+        if (n + 1U >= ELF_IMAGE_PATH) return -1;
+        dest[n++] = path[i];
+    }
+    dest[n] = '\0';
+    return 0;
+}
+
+/* Un nœud de l'overlay au même chemin : l'exécutable reste celui de l'initrd,
+ * mais l'entrée n'est pas gardée en cache tant que l'overlay le recouvre. */
+static int elf_path_shadowed(const char* resolved) {
+    return overlay_stat(resolved, 0) == OV_OK;
+}
+
+// Résout, valide et analyse : l'entrée n'est publiée qu'entière (et seulement hors overlay).
+static elf_image_t* elf_image_parse(const char* path) {
+    char resolved[ELF_IMAGE_PATH];
+    uint8_t* file_data;
+    elf_image_t* image;
+    uint32_t count = 0;
+    uint32_t template_pages = 0;
+    int slash = 0;
+
+    if (elf_copy_path(resolved, "", path) != 0) return 0;
+    file_data = (uint8_t*)initrd_read_file(resolved);
+    for (uint32_t i = 0; path[i]; i++) {
+        if (path[i] == '/') slash = 1;
+    }
+    if (!file_data && path[0] && !slash && elf_copy_path(resolved, "bin/", path) == 0) {
+        file_data = (uint8_t*)initrd_read_file(resolved);
+    }
+    if (!file_data) {
+        print_string_serial("ERREUR: Fichier non trouve dans l'initrd\n");
+        return 0;
+    }
     if (!elf_validate(file_data)) {
         print_string_serial("ERROR: Invalid ELF file.\n");
         return 0;
@@ -27,70 +203,197 @@ uint32_t elf_load(uint8_t* file_data, vmm_directory_t* vmm_dir) {
 
     elf32_ehdr_t* header = (elf32_ehdr_t*)file_data;
     elf32_phdr_t* pheaders = (elf32_phdr_t*)(file_data + header->e_phoff);
+    for (uint32_t i = 0; i < header->e_phnum; i++) {
+        if (pheaders[i].p_type == PT_LOAD) count++;
+    }
+    if (count > ELF_IMAGE_SEGMENTS) {
+        print_string_serial("ERROR: Too many ELF segments.\n");
+        return 0;
+    }
 
-    print_string_serial("ELF Loader: Starting...\n");
-
-    // It is safer to modify a non-active page directory by temporarily mapping
-    // pages into the kernel's address space. However, the current design
-    // switches to the new directory first. The code below assumes this design
-    // but is now corrected for BSS handling and permissions.
-
-    for (int i = 0; i < header->e_phnum; i++) {
-        if (pheaders[i].p_type == PT_LOAD) {
-            uint32_t vaddr = pheaders[i].p_vaddr;
-            uint32_t filesz = pheaders[i].p_filesz;
-            uint32_t memsz = pheaders[i].p_memsz;
-            uint32_t flags = pheaders[i].p_flags;
-            uint8_t* segment_data = file_data + pheaders[i].p_offset;
-
-            // Determine page flags
-            uint32_t page_flags = PAGE_PRESENT | PAGE_USER;
-            if (flags & PF_W) {
-                page_flags |= PAGE_WRITE;
-            }
+    image = elf_image_claim();
+    image->segment_count = 0;
+    for (uint32_t i = 0; i < header->e_phnum; i++) {
+        if (pheaders[i].p_type == PT_LOAD) image->segments[image->segment_count++] = pheaders[i];
+    }
+    for (uint32_t i = 0; i < image->segment_count; i++) {
+        uint32_t start = image->segments[i].p_vaddr & ~(PAGE_SIZE - 1U);
+        image->share_end[i] = elf_segment_share_end(image->segments, image->segment_count, i);
+        image->direct_end[i] = elf_segment_direct_end(file_data, image->segments, image->segment_count, i);
+        template_pages += (image->share_end[i] - start) / PAGE_SIZE;
+    }
+    (void)elf_copy_path(image->path, "", path);
+    (void)elf_copy_path(image->resolved, "", resolved);
+    image->file_data = file_data;
+    image->generation = overlay_generation();
+    image->entry = header->e_entry;
+    image->page_count = 0;
+    image->template_state = template_pages > 0 && template_pages <= ELF_IMAGE_PAGES ?
+                            ELF_TEMPLATE_EMPTY : ELF_TEMPLATE_NONE;
+    if (elf_path_shadowed(resolved)) {
+        // Analyse à usage unique : introuvable ensuite, sans modèle retenu, l'emplacement reste libre
+        image->path[0] = '\0';
+        image->template_state = ELF_TEMPLATE_NONE;
+    }
+    return image;
+}
+
+elf_image_t* elf_image_get(const char* path) {
+    elf_image_t* image;
+    if (!path || !path[0]) return 0;
+    image = elf_image_find(path);
+    if (image && image->generation != overlay_generation()) {
+        // L'overlay a changé : seule une écriture sur ce chemin invalide l'entrée
+        if (elf_path_shadowed(image->resolved)) {
+            elf_image_drop(image);
+            image = 0;
+        } else {
+            image->generation = overlay_generation();
+        }
+    }
+    if (!image) image = elf_image_parse(path);
+    if (image) image->last_use = ++elf_image_clock;
+    return image;
+}
 
-            print_string_serial("  - Segment: vaddr=0x");
-            print_hex_serial(vaddr);
-            print_string_serial(", memsz=0x");
-            print_hex_serial(memsz);
-            print_string_serial(", perms=");
-            print_string_serial((flags & PF_W) ? "RW" : "R-");
-            print_string_serial("\n");
-
-            // Map all pages for this segment
-            uint32_t start_addr = vaddr & ~0xFFF; // Page-align start address
-            uint32_t end_addr = (vaddr + memsz + 0xFFF) & ~0xFFF;
-            for (uint32_t page_addr = start_addr; page_addr < end_addr; page_addr += PAGE_SIZE) {
-                void* phys_page = pmm_alloc_page();
-                if (!phys_page) {
-                    print_string_serial("ERROR: pmm_alloc_page failed for ELF segment.\n");
-                    /* Le chargeur rend l’échec à l’appelant. Après restauration du
-                     * répertoire actif, task_destroy_user_vmm() détruit le VMM partiel,
-                     * restitue les pages utilisateur et les tables privées au PMM. */
+// Copie dans la frame la part du segment qui recouvre page_addr ; une frame neuve est aussi mise à zéro autour.
+static void elf_fill_page(uint8_t* window, uint32_t page_addr, const elf32_phdr_t* ph,
+                          const uint8_t* file_data, int fresh) {
+    uint32_t page_limit = page_addr + PAGE_SIZE;
+    uint32_t copy_start = ph->p_vaddr > page_addr ? ph->p_vaddr : page_addr;
+    uint32_t copy_end = ph->p_vaddr + ph->p_filesz < page_limit ? ph->p_vaddr + ph->p_filesz : page_limit;
+    if (copy_end < copy_start) copy_end = copy_start;
+    if (fresh) {
+        memset(window, 0, copy_start - page_addr);
+        memset(window + (copy_end - page_addr), 0, page_limit - copy_end);
+    }
+    if (copy_end > copy_start) {
+        memcpy(window + (copy_start - page_addr), file_data + ph->p_offset + (copy_start - ph->p_vaddr),
+               copy_end - copy_start);
+    }
+}
+
+// Remplit par la fenêtre noyau : le répertoire de la tâche n'a pas à être actif.
+static int elf_fill_frame(uint32_t frame, uint32_t page_addr, const elf32_phdr_t* ph,
+                          const uint8_t* file_data, int fresh) {
+    uint8_t* window = (uint8_t*)vmm_kmap(frame, 1U);
+    if (!window) return -1;
+    elf_fill_page(window, page_addr, ph, file_data, fresh);
+    (void)vmm_kunmap(window, 1U);
+    return 0;
+}
+
+// Pose les pages du modèle ; une frame saturée en références reste absente et sera copiée.
+static int elf_template_map(const elf_image_t* image, vmm_directory_t* vmm_dir) {
+    for (uint32_t i = 0; i < image->page_count; i++) {
+        uint32_t page_addr = image->pages[i] & ~(PAGE_SIZE - 1U);
+        uint32_t flags = PAGE_PRESENT | PAGE_USER | (image->pages[i] & (PAGE_COW | PAGE_BORROWED));
+        void* frame = (void*)image->frames[i];
+        if (!(flags & PAGE_BORROWED) && pmm_page_ref(frame) != 0) continue;
+        if (vmm_map_page_in_directory(vmm_dir, frame, (void*)page_addr, flags) != 0) {
+            if (!(flags & PAGE_BORROWED)) (void)pmm_page_unref(frame);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+uint32_t elf_image_map(elf_image_t* image, vmm_directory_t* vmm_dir) {
+    const elf32_phdr_t* segments = image->segments;
+    uint32_t count = image->segment_count;
+    const uint8_t* file_data = image->file_data;
+    int from_template = image->template_state == ELF_TEMPLATE_READY;
+    int recording = image->template_state == ELF_TEMPLATE_EMPTY;
+
+    if (from_template && elf_template_map(image, vmm_dir) != 0) {
+        print_string_serial("ERROR: Could not map shared ELF page.\n");
+        return 0;
+    }
+
+    // Le répertoire de la tâche n'est pas activé : chaque page est mappée avec
+    // ses droits définitifs et remplie par la fenêtre noyau.
+    for (uint32_t i = 0; i < count; i++) {
+        const elf32_phdr_t* ph = &segments[i];
+        uint32_t start_addr = ph->p_vaddr & ~(PAGE_SIZE - 1U);
+        uint32_t end_addr = elf_page_end(ph->p_vaddr + ph->p_memsz);
+        uint32_t share_end = image->share_end[i];
+        uint32_t direct_start = elf_page_end(ph->p_vaddr);
+        uint32_t direct_end = image->direct_end[i];
+        // Pages entièrement au-delà du fichier (bss) : peuplées au premier accès.
+        uint32_t lazy_start = elf_page_end(ph->p_vaddr + ph->p_filesz);
+        if (lazy_start < start_addr) lazy_start = start_addr;
+        if (lazy_start < end_addr &&
+            vmm_add_area(vmm_dir, lazy_start, end_addr, (ph->p_flags & PF_W) ? PAGE_WRITE : 0U) != 0) {
+            lazy_start = end_addr;
+        }
+
+        TRACE(TRACE_LEVEL_VERBOSE, OS_TRACE_ELF_SEGMENT, ph->p_vaddr, ph->p_memsz, ph->p_flags & PF_W);
+
+        for (uint32_t page_addr = start_addr; page_addr < end_addr; page_addr += PAGE_SIZE) {
+            page_t* existing = vmm_get_page(page_addr, 0, vmm_dir);
+            if (existing && existing->present && existing->user) {
+                // Posée par le modèle, ou commune à deux segments (alors déjà privée).
+                if (page_addr < share_end) continue;
+                if (elf_fill_frame(existing->frame * PAGE_SIZE, page_addr, ph, file_data, 0) != 0) {
+                    print_string_serial("ERROR: Could not map ELF page in kernel window.\n");
+                    if (recording) elf_template_drop(image);
                     return 0;
                 }
-                if (vmm_map_page_in_directory(vmm_dir, phys_page, (void*)page_addr, page_flags) != 0) {
-                    pmm_free_page(phys_page);
-                    print_string_serial("ERROR: Could not map ELF segment page.\n");
+                continue;
+            }
+            if (page_addr >= lazy_start) continue;
+
+            if (page_addr >= direct_start && page_addr < direct_end) {
+                uint32_t frame = (uint32_t)file_data + ph->p_offset + (page_addr - ph->p_vaddr);
+                if (vmm_map_page_in_directory(vmm_dir, (void*)frame, (void*)page_addr,
+                                              PAGE_PRESENT | PAGE_USER | PAGE_BORROWED) != 0) {
+                    print_string_serial("ERROR: Could not map initrd ELF page.\n");
+                    if (recording) elf_template_drop(image);
                     return 0;
                 }
+                if (recording) {
+                    image->pages[image->page_count] = page_addr | PAGE_BORROWED;
+                    image->frames[image->page_count] = frame;
+                    image->page_count++;
+                }
+                continue;
             }
 
-            // Copy data from file (filesz)
-            if (filesz > 0) {
-                memcpy((void*)vaddr, segment_data, filesz);
+            void* phys_page = pmm_alloc_high_page();
+            if (!phys_page) {
+                print_string_serial("ERROR: pmm_alloc_page failed for ELF segment.\n");
+                /* Le chargeur rend l’échec à l’appelant : task_destroy_user_vmm()
+                 * détruit le VMM partiel, restitue les pages utilisateur et les
+                 * tables privées au PMM. */
+                if (recording) elf_template_drop(image);
+                return 0;
+            }
+            uint32_t rw = elf_page_writable(segments, count, page_addr) ? PAGE_WRITE : 0U;
+            if (vmm_map_page_in_directory(vmm_dir, phys_page, (void*)page_addr, PAGE_PRESENT | PAGE_USER | rw) != 0) {
+                pmm_free_page(phys_page);
+                print_string_serial("ERROR: Could not map ELF segment page.\n");
+                if (recording) elf_template_drop(image);
+                return 0;
+            }
+            if (elf_fill_frame((uint32_t)phys_page, page_addr, ph, file_data, 1) != 0) {
+                print_string_serial("ERROR: Could not map ELF page in kernel window.\n");
+                if (recording) elf_template_drop(image);
+                return 0;
             }
 
-            // Zero-fill the .bss section part of the segment (memsz - filesz)
-            if (memsz > filesz) {
-                memset((void*)(vaddr + filesz), 0, memsz - filesz);
+            if (recording && page_addr < share_end && pmm_page_ref(phys_page) == 0) {
+                uint32_t cow = (ph->p_flags & PF_W) ? PAGE_COW : 0U;
+                image->pages[image->page_count] = page_addr | cow;
+                image->frames[image->page_count] = (uint32_t)phys_page;
+                image->page_count++;
+                if (cow) {
+                    (void)vmm_map_page_in_directory(vmm_dir, phys_page, (void*)page_addr, PAGE_PRESENT | PAGE_USER | PAGE_COW);
+                }
             }
         }
     }
+    if (recording) image->template_state = ELF_TEMPLATE_READY;
 
-    print_string_serial("ELF loading complete. Entry point: 0x");
-    print_hex_serial(header->e_entry);
-    print_string_serial("\n");
-
-    return header->e_entry;
+    TRACE(TRACE_LEVEL_HOT, OS_TRACE_ELF_LOAD, image->entry, count, from_template);
+    return image->entry;
 }
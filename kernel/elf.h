@@ -87,8 +87,16 @@ typedef struct {
 
 #include "mem/vmm.h" // Pour vmm_directory_t
 
+/* Exécutable de l'initrd pré-analysé (cache interne à elf.c). */
+typedef struct elf_image elf_image_t;
+
 // Fonctions publiques
-uint32_t elf_load(uint8_t* elf_data, vmm_directory_t* vmm_dir);
+/* Image du chemin path (initrd, puis bin/path) ; NULL si absent, masqué par
+ * l'overlay ou invalide. Un chemin déjà vu ne relit ni l'initrd ni les en-têtes. */
+elf_image_t* elf_image_get(const char* path);
+/* Peuple vmm_dir, qui n'a pas à être actif, depuis l'image et son modèle
+ * d'espace d'adressage ; renvoie le point d'entrée, 0 en cas d'échec. */
+uint32_t elf_image_map(elf_image_t* image, vmm_directory_t* vmm_dir);
 int elf_validate(uint8_t* elf_data);
 void elf_print_info(uint8_t* elf_data);
 
@@ -1,4 +1,5 @@
 #include "gdt.h"
+#include "smp.h"
 #include "kernel/mem/string.h" // For memset
 
 // GDT pointer and entries
@@ -7,57 +8,109 @@ typedef struct {
     uint32_t base;
 } __attribute__((packed)) gdt_ptr_t;
 
-gdt_entry_t gdt_entries[6];
-gdt_ptr_t   gdt_ptr;
-tss_entry_t tss_entry;
+// Une GDT par CPU : même segments plats, mais TSS (ltr le marque occupé) et
+// segment GS par CPU (SMP_PERCPU_SELECTOR) propres à chacun.
+gdt_entry_t gdt_entries[SMP_MAX_CPUS][GDT_ENTRY_COUNT];
+gdt_ptr_t   gdt_ptrs[SMP_MAX_CPUS];
+tss_entry_t tss_entries[SMP_MAX_CPUS];
 
 // External assembly functions
 extern void gdt_flush(uint32_t);
 extern void tss_flush();
+extern void isr_sysenter(void);
 
-// Set a GDT entry
-void gdt_set_gate(int num, uint32_t base, uint32_t limit, uint8_t access, uint8_t gran) {
-    gdt_entries[num].base_low    = (base & 0xFFFF);
-    gdt_entries[num].base_middle = (base >> 16) & 0xFF;
-    gdt_entries[num].base_high   = (base >> 24) & 0xFF;
+/* SYSENTER/SYSEXIT : CS noyau 0x08 (SS 0x10 implicite), SYSEXIT rend CS
+ * 0x1B et SS 0x23, d'où l'ordre code/données noyau puis user de la GDT.
+ * L'ESP d'entrée pointe sur esp0 du TSS du CPU : le stub y lit la pile
+ * noyau de la tâche courante, que le scheduler tient déjà à jour. */
+#define GDT_CPUID_EDX_SEP (1U << 11)
+#define GDT_MSR_SYSENTER_CS  0x174U
+#define GDT_MSR_SYSENTER_ESP 0x175U
+#define GDT_MSR_SYSENTER_EIP 0x176U
 
-    gdt_entries[num].limit_low   = (limit & 0xFFFF);
-    gdt_entries[num].granularity = (limit >> 16) & 0x0F;
+static void gdt_wrmsr(uint32_t msr, uint32_t value) {
+    __asm__ volatile("wrmsr" : : "c"(msr), "a"(value), "d"(0U));
+}
 
-    gdt_entries[num].granularity |= gran & 0xF0;
-    gdt_entries[num].access      = access;
+static int gdt_sysenter_supported(void) {
+    uint32_t eax = 1U, ebx, ecx = 0U, edx;
+    __asm__ volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    (void)ebx;
+    // Même test que userspace/start.s : les deux côtés choisissent ensemble
+    return (edx & GDT_CPUID_EDX_SEP) != 0U;
 }
 
-// Initialize GDT and TSS
-void gdt_init() {
-    gdt_ptr.limit = (sizeof(gdt_entry_t) * 6) - 1;
-    gdt_ptr.base  = (uint32_t)&gdt_entries;
+static void gdt_sysenter_init(tss_entry_t* tss) {
+    if (!gdt_sysenter_supported()) return;
+    gdt_wrmsr(GDT_MSR_SYSENTER_CS, 0x08U);
+    gdt_wrmsr(GDT_MSR_SYSENTER_ESP, (uint32_t)&tss->esp0);
+    gdt_wrmsr(GDT_MSR_SYSENTER_EIP, (uint32_t)isr_sysenter);
+}
+
+static void gdt_set_gate_in(gdt_entry_t* entries, int num, uint32_t base, uint32_t limit,
+                            uint8_t access, uint8_t gran) {
+    entries[num].base_low    = (base & 0xFFFF);
+    entries[num].base_middle = (base >> 16) & 0xFF;
+    entries[num].base_high   = (base >> 24) & 0xFF;
 
-    gdt_set_gate(0, 0, 0, 0, 0);                // Null segment
-    gdt_set_gate(1, 0, 0xFFFFFFFF, 0x9A, 0xCF); // Kernel Code Segment
-    gdt_set_gate(2, 0, 0xFFFFFFFF, 0x92, 0xCF); // Kernel Data Segment
-    gdt_set_gate(3, 0, 0xFFFFFFFF, 0xFA, 0xCF); // User Code Segment
-    gdt_set_gate(4, 0, 0xFFFFFFFF, 0xF2, 0xCF); // User Data Segment
+    entries[num].limit_low   = (limit & 0xFFFF);
+    entries[num].granularity = (limit >> 16) & 0x0F;
+
+    entries[num].granularity |= gran & 0xF0;
+    entries[num].access      = access;
+}
+
+// Set a GDT entry (GDT du BSP)
+void gdt_set_gate(int num, uint32_t base, uint32_t limit, uint8_t access, uint8_t gran) {
+    gdt_set_gate_in(gdt_entries[0], num, base, limit, access, gran);
+}
+
+// Initialize GDT and TSS of the calling CPU
+void gdt_init_cpu(uint32_t index) {
+    gdt_entry_t* entries = gdt_entries[index];
+    tss_entry_t* tss = &tss_entries[index];
+    cpu_t* cpu = &smp_cpus[index];
+
+    gdt_ptrs[index].limit = (sizeof(gdt_entry_t) * GDT_ENTRY_COUNT) - 1;
+    gdt_ptrs[index].base  = (uint32_t)entries;
+
+    gdt_set_gate_in(entries, 0, 0, 0, 0, 0);                // Null segment
+    gdt_set_gate_in(entries, 1, 0, 0xFFFFFFFF, 0x9A, 0xCF); // Kernel Code Segment
+    gdt_set_gate_in(entries, 2, 0, 0xFFFFFFFF, 0x92, 0xCF); // Kernel Data Segment
+    gdt_set_gate_in(entries, 3, 0, 0xFFFFFFFF, 0xFA, 0xCF); // User Code Segment
+    gdt_set_gate_in(entries, 4, 0, 0xFFFFFFFF, 0xF2, 0xCF); // User Data Segment
 
     // Create TSS entry
-    uint32_t tss_base = (uint32_t)&tss_entry;
-    uint32_t tss_limit = sizeof(tss_entry);
-    gdt_set_gate(5, tss_base, tss_limit, 0x89, 0x00); // 0x89 = Present, DPL=0, TSS
+    uint32_t tss_base = (uint32_t)tss;
+    uint32_t tss_limit = sizeof(tss_entry_t);
+    gdt_set_gate_in(entries, 5, tss_base, tss_limit, 0x89, 0x00); // 0x89 = Present, DPL=0, TSS
+
+    // Segment GS du CPU : base sur son cpu_t, dont le premier mot pointe sur lui-même
+    cpu->self = cpu;
+    cpu->index = index;
+    gdt_set_gate_in(entries, 6, (uint32_t)cpu, sizeof(cpu_t) - 1U, 0x92, 0x40);
 
     // Initialize TSS
-    memset(&tss_entry, 0, sizeof(tss_entry));
-    tss_entry.ss0  = 0x10;  // Kernel data segment selector
-    tss_entry.esp0 = 0x0;   // Will be set by the scheduler
-    tss_entry.cs   = 0x0b;
-    tss_entry.ss = tss_entry.ds = tss_entry.es = tss_entry.fs = tss_entry.gs = 0x13;
+    memset(tss, 0, sizeof(tss_entry_t));
+    tss->ss0  = 0x10;  // Kernel data segment selector
+    tss->esp0 = 0x0;   // Will be set by the scheduler
+    tss->cs   = 0x0b;
+    tss->ss = tss->ds = tss->es = tss->fs = tss->gs = 0x13;
+    gdt_sysenter_init(tss);
 
     // Flush GDT and TSS
-    gdt_flush((uint32_t)&gdt_ptr);
+    gdt_flush((uint32_t)&gdt_ptrs[index]);
     tss_flush();
+    asm volatile("mov %0, %%gs" : : "r"((uint16_t)SMP_PERCPU_SELECTOR));
+}
+
+void gdt_init() {
+    gdt_init_cpu(0U);
 }
 
 // Called by scheduler to update kernel stack pointer
 void tss_set_stack(uint32_t ss, uint32_t esp) {
-    tss_entry.ss0 = ss;
-    tss_entry.esp0 = esp;
+    tss_entry_t* tss = &tss_entries[smp_cpu()->index];
+    tss->ss0 = ss;
+    tss->esp0 = esp;
 }
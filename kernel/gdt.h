@@ -44,7 +44,12 @@ typedef struct {
     uint16_t iomap_base;
 } __attribute__((packed)) tss_entry_t;
 
+// null, code/données noyau, code/données user, TSS, GS par CPU (0x30)
+#define GDT_ENTRY_COUNT 7
+
 void gdt_init();
+/* GDT, TSS et segment GS du CPU appelant ; gdt_init() est le cas du BSP. */
+void gdt_init_cpu(uint32_t index);
 void gdt_set_gate(int num, uint32_t base, uint32_t limit, uint8_t access, uint8_t gran);
 void tss_set_stack(uint32_t ss, uint32_t esp);
 
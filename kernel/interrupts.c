@@ -1,6 +1,9 @@
 #include "idt.h"
 #include "keyboard.h"
 #include "timer.h"
+#include "mem/vmm.h"
+#include "syscall/syscall.h"
+#include "smp.h"
 
 // Déclaration pour le nouveau handler
 void keyboard_interrupt_handler();
@@ -10,6 +13,7 @@ void io_delay();
 extern unsigned char inb(unsigned short port);
 extern void outb(unsigned short port, unsigned char data);
 extern void print_string_serial(const char* str);
+extern void print_hex_serial(uint32_t n);
 
 // Externe pour les ISR qui seront définies en assembleur
 extern void isr0(); extern void isr1(); extern void isr2(); extern void isr3();
@@ -25,6 +29,10 @@ extern void irq1(); // ISR pour le clavier
 extern void irq3(); // ISR pour la NE2000
 extern void isr_syscall(); // ISR pour les appels système
 extern void isr_schedule(); // ISR pour le scheduling volontaire
+extern void isr_lapic_timer(); // Timer LAPIC des AP
+extern void isr_reschedule(); // IPI de replanification
+extern void isr_tlb_shootdown(); // IPI d'invalidation TLB
+extern void isr_spurious(); // Interruption parasite du LAPIC
 
 // Structure pour les registres passés par l'ISR stub
 typedef struct {
@@ -34,8 +42,18 @@ typedef struct {
     uint32_t eip, cs, eflags, useresp, ss;
 } registers_t;
 
+#define USER_SPACE_LIMIT 0xC0000000U
+
 // C-level fault handler
 void fault_handler_c(registers_t *r) {
+    uint32_t faulting_address = 0;
+
+    if (r->int_no == 14) { // Page Fault
+        asm volatile("mov %%cr2, %0" : "=r" (faulting_address));
+        // Copy-on-write : l'accès est rejoué au retour d'interruption.
+        if (vmm_handle_page_fault(faulting_address, r->err_code) == 0) return;
+    }
+
     print_string_serial("\n!!! KERNEL EXCEPTION !!!\n");
     print_string_serial("Interrupt: ");
     print_hex_serial(r->int_no);
@@ -45,14 +63,20 @@ void fault_handler_c(registers_t *r) {
     print_hex_serial(r->eip);
     print_string_serial("\n");
 
-    if (r->int_no == 14) { // Page Fault
-        uint32_t faulting_address;
-        asm volatile("mov %%cr2, %0" : "=r" (faulting_address));
+    if (r->int_no == 14) {
         print_string_serial("Page Fault at address ");
         print_hex_serial(faulting_address);
         print_string_serial("\n");
     }
 
+    /* Une faute venue de Ring 3, ou du noyau sur une adresse utilisateur
+     * pendant un syscall, ne concerne que la tâche courante : elle est tuée. */
+    if (current_task && current_task->type == TASK_TYPE_USER &&
+        ((r->cs & 3U) == 3U || (r->int_no == 14 && faulting_address < USER_SPACE_LIMIT))) {
+        print_string_serial("Faulting user task killed.\n");
+        syscall_exit_current((cpu_state_t*)r, OS_TASK_EXIT_KILLED, OS_TASK_EVENT_KILLED);
+    }
+
     print_string_serial("System Halted.\n");
     for(;;);
 }
@@ -248,6 +272,10 @@ void interrupts_init() {
     idt_set_gate(35, (uint32_t)irq3, 0x08, 0x8E);        // NE2000 ISA
     idt_set_gate(0x30, (uint32_t)isr_schedule, 0x08, 0xEE); // Scheduler (Ring 3)
     idt_set_gate(0x80, (uint32_t)isr_syscall, 0x08, 0xEE); // Syscalls (Ring 3 accessible)
+    idt_set_gate(SMP_LAPIC_TIMER_VECTOR, (uint32_t)isr_lapic_timer, 0x08, 0x8E); // Timer LAPIC
+    idt_set_gate(SMP_RESCHEDULE_VECTOR, (uint32_t)isr_reschedule, 0x08, 0x8E);   // IPI de replanification
+    idt_set_gate(SMP_TLB_SHOOTDOWN_VECTOR, (uint32_t)isr_tlb_shootdown, 0x08, 0x8E); // IPI d'invalidation TLB
+    idt_set_gate(SMP_SPURIOUS_VECTOR, (uint32_t)isr_spurious, 0x08, 0x8E);     // LAPIC parasite
     print_string_serial("Step 6: Entrées IDT configurées\n");
 
     // 7. Diagnostic du PIC avant activation
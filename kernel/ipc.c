@@ -1,4 +1,5 @@
 #include "ipc.h"
+#include <stddef.h>
 
 void ipc_endpoint_init(ipc_endpoint_t* endpoint) {
     uint32_t i;
@@ -38,25 +39,59 @@ int ipc_endpoint_send(ipc_endpoint_t* endpoint, int32_t sender_pid,
     return 0;
 }
 
+int ipc_filter_accepts(const os_ipc_filter_t* filter, int32_t sender_pid, uint32_t type,
+                       uint32_t request_id) {
+    if (!filter) return 1;
+    if ((filter->match & OS_IPC_MATCH_SENDER) && sender_pid != filter->sender_pid) return 0;
+    if ((filter->match & OS_IPC_MATCH_TYPE) && type != filter->type) return 0;
+    if ((filter->match & OS_IPC_MATCH_REQUEST) && request_id != filter->request_id) return 0;
+    return 1;
+}
+
+int ipc_filter_matches(const os_ipc_filter_t* filter, const os_ipc_message_t* message) {
+    return ipc_filter_accepts(filter, message->sender_pid, message->type, message->request_id);
+}
+
 int ipc_endpoint_receive(ipc_endpoint_t* endpoint, os_ipc_message_t* out) {
+    return ipc_endpoint_receive_matching(endpoint, NULL, out);
+}
+
+int ipc_endpoint_receive_matching(ipc_endpoint_t* endpoint, const os_ipc_filter_t* filter,
+                                  os_ipc_message_t* out) {
     os_ipc_message_t* source;
+    uint32_t position;
     uint32_t i;
     if (!endpoint || !out) return OS_IPC_BAD_MESSAGE;
-    if (endpoint->count == 0U) return OS_IPC_EMPTY;
-
-    source = &endpoint->messages[endpoint->read_index];
-    out->sender_pid = source->sender_pid;
-    out->type = source->type;
-    out->size = source->size;
-    out->request_id = source->request_id;
-    for (i = 0U; i < OS_IPC_MAX_DATA; i++) out->data[i] = source->data[i];
+    for (position = 0U; position < endpoint->count; position++) {
+        uint32_t index = (endpoint->read_index + position) % IPC_ENDPOINT_CAPACITY;
+        if (ipc_filter_matches(filter, &endpoint->messages[index])) break;
+    }
+    if (position == endpoint->count) return OS_IPC_EMPTY;
 
+    *out = endpoint->messages[(endpoint->read_index + position) % IPC_ENDPOINT_CAPACITY];
+    if (position == 0U) {
+        // Cas courant : la tête convient, la file avance sans recopie
+        source = &endpoint->messages[endpoint->read_index];
+        endpoint->read_index = (endpoint->read_index + 1U) % IPC_ENDPOINT_CAPACITY;
+    } else {
+        // Les messages plus récents avancent d'une case pour combler le trou
+        for (; position + 1U < endpoint->count; position++) {
+            endpoint->messages[(endpoint->read_index + position) % IPC_ENDPOINT_CAPACITY] =
+                endpoint->messages[(endpoint->read_index + position + 1U) % IPC_ENDPOINT_CAPACITY];
+        }
+        endpoint->write_index = (endpoint->write_index + IPC_ENDPOINT_CAPACITY - 1U) % IPC_ENDPOINT_CAPACITY;
+        source = &endpoint->messages[endpoint->write_index];
+    }
     source->sender_pid = -1;
     source->type = 0U;
     source->size = 0U;
     source->request_id = 0U;
     for (i = 0U; i < OS_IPC_MAX_DATA; i++) source->data[i] = 0U;
-    endpoint->read_index = (endpoint->read_index + 1U) % IPC_ENDPOINT_CAPACITY;
     endpoint->count--;
     return 0;
 }
+
+const os_ipc_message_t* ipc_endpoint_last(const ipc_endpoint_t* endpoint) {
+    if (!endpoint || endpoint->count == 0U) return NULL;
+    return &endpoint->messages[(endpoint->write_index + IPC_ENDPOINT_CAPACITY - 1U) % IPC_ENDPOINT_CAPACITY];
+}
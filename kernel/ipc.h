@@ -21,5 +21,15 @@ void ipc_endpoint_init(ipc_endpoint_t* endpoint);
 int ipc_endpoint_send(ipc_endpoint_t* endpoint, int32_t sender_pid,
                       const os_ipc_payload_t* payload);
 int ipc_endpoint_receive(ipc_endpoint_t* endpoint, os_ipc_message_t* out);
+/* Filtre NULL ou sans drapeau : tout message passe. */
+int ipc_filter_accepts(const os_ipc_filter_t* filter, int32_t sender_pid, uint32_t type,
+                       uint32_t request_id);
+int ipc_filter_matches(const os_ipc_filter_t* filter, const os_ipc_message_t* message);
+/* Retire le plus ancien message qui passe le filtre ; les suivants se
+ * resserrent dans l'ordre d'arrivée. */
+int ipc_endpoint_receive_matching(ipc_endpoint_t* endpoint, const os_ipc_filter_t* filter,
+                                  os_ipc_message_t* out);
+/* Dernier message déposé, NULL si l'endpoint est vide. */
+const os_ipc_message_t* ipc_endpoint_last(const ipc_endpoint_t* endpoint);
 
 #endif
@@ -20,8 +20,14 @@
 #include "llm/gpt2_tokenizer.h"
 #include "keyboard.h"
 #include "service_registry.h"
+#include "shm.h"
 #include "vga_console.h"
 #include "ne2k.h"
+#include "smp.h"
+#include "deferred.h"
+#include "trace.h"
+#include "perf.h"
+#include "profile.h"
 #include "net_socket.h"
 #include "tls_trust_anchor.h"
 #include "ecdsa_p256.h"
@@ -35,6 +41,12 @@ void outb(unsigned short port, unsigned char data);
 void print_string_serial(const char* str);
 void print_string(const char* str);
 
+/* Frames mises à zéro par tour de la boucle d'inactivité noyau. */
+#define KERNEL_IDLE_ZERO_BATCH 8U
+/* Enregistrements de trace (et échantillons de profil) vidés sur le port
+ * série par tour d'inactivité. */
+#define KERNEL_IDLE_TRACE_BATCH 8U
+
 #define KERNEL_LLM_FRAME_CAPACITY NE2K_ETHERNET_MAX_FRAME
 #define KERNEL_LLM_TLS_RECORD_CAPACITY 8192U
 #define KERNEL_LLM_TLS_HELLO_CAPACITY 512U
@@ -56,7 +68,10 @@ typedef struct {
 #define KERNEL_LLM_DHCP_RETRY_BASE_TICKS 100U
 #define KERNEL_LLM_DHCP_RETRY_MAX_TICKS 10000U
 #define KERNEL_LLM_DHCP_RETRY_LIMIT 5U
+/* Passage de maintenance tant qu'un bail est suivi : deux par délai de relance. */
+#define KERNEL_LLM_DHCP_MAINTENANCE_TICKS (KERNEL_LLM_DHCP_RETRY_BASE_TICKS / 2U)
 static kernel_llm_dhcp_maintenance_t boot_llm_dhcp_maintenance;
+static deferred_work_t boot_llm_dhcp_work;
 /* Espaces de travail noyau fixes : aucun buffer du chemin DHCP→LLM n’est alloué. */
 static net_arp_cache_t boot_llm_arp_cache;
 static uint8_t boot_llm_dhcp_tx[KERNEL_LLM_FRAME_CAPACITY];
@@ -113,8 +128,14 @@ static uint8_t boot_ne2k_present;
 static void kernel_llm_clear_bytes(uint8_t* buffer, uint32_t length);
 static int kernel_llm_rdrand_supported(void);
 static int kernel_llm_close_internal(uint8_t preserve_provider);
+static void kernel_llm_dhcp_work(deferred_work_t* work, uint32_t now);
 int kernel_llm_close(void);
-void ne2k_irq_handler(void) { ne2k_irq_service(); }
+void ne2k_irq_handler(void) {
+    perf_span_t span;
+    perf_begin(&span);
+    ne2k_irq_service();
+    perf_end(OS_PERF_SLOT_IRQ(3), &span);
+}
 
 static void ne2k_boot_probe(void) {
     net_dhcp_lease_clear(&boot_llm_lease);
@@ -131,6 +152,7 @@ static void ne2k_boot_probe(void) {
     boot_llm_http_streaming = 0U;
     boot_llm_application_recovery.pending = 0U;
     boot_llm_dhcp_maintenance.armed = 0U;
+    deferred_work_init(&boot_llm_dhcp_work, kernel_llm_dhcp_work);
     boot_llm_dhcp_maintenance.retries_used = 0U;
     boot_llm_dhcp_maintenance.retry_limit = KERNEL_LLM_DHCP_RETRY_LIMIT;
     boot_llm_dhcp_maintenance.next_retry_tick = 0U;
@@ -298,6 +320,7 @@ int kernel_llm_acquire_start(const os_llm_acquire_start_request_t* request) {
     boot_llm_dhcp_maintenance.retries_used = 0U;
     boot_llm_dhcp_maintenance.retry_limit = KERNEL_LLM_DHCP_RETRY_LIMIT;
     boot_llm_dhcp_maintenance.next_retry_tick = 0U;
+    deferred_work_schedule(&boot_llm_dhcp_work, timer_get_ticks(), KERNEL_LLM_DHCP_MAINTENANCE_TICKS);
     kernel_llm_copy_hostname(request->hostname);
     return 0;
 }
@@ -342,6 +365,16 @@ int kernel_llm_dhcp_maintenance(uint32_t now) {
     return -2;
 }
 
+/* Travail différé : la maintenance quitte le chemin de chaque syscall et ne
+ * se réarme que tant qu'un bail ou une relance reste à suivre. */
+static void kernel_llm_dhcp_work(deferred_work_t* work, uint32_t now) {
+    (void)kernel_llm_dhcp_maintenance(now);
+    if (!boot_llm_dhcp_maintenance.armed || !boot_ne2k_present) return;
+    if (!boot_llm_lease.valid &&
+        boot_llm_dhcp_maintenance.retries_used >= boot_llm_dhcp_maintenance.retry_limit) return;
+    deferred_work_schedule(work, now, KERNEL_LLM_DHCP_MAINTENANCE_TICKS);
+}
+
 static int kernel_llm_text_field_is_valid(const char* field, uint16_t capacity) {
     uint16_t index;
     if (!field || capacity == 0U || field[0] == '\0') return 0;
@@ -951,6 +984,17 @@ void print_hex_serial(uint32_t n) {
     }
 }
 
+// Fonction pour afficher un uint32_t en décimal sur le port série
+void print_dec_serial(uint32_t n) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + n % 10U);
+        n /= 10U;
+    } while (n != 0U);
+    while (count > 0) write_serial(digits[--count]);
+}
+
 // Fonction pour afficher sur les deux sorties
 void print_string(const char* str) {
     print_string_vga(str, 0x1F);
@@ -1207,6 +1251,7 @@ void kmain(uint32_t multiboot_magic, uint32_t multiboot_addr) {
     print_string("Initialisation du systeme de taches...\n");
     tasking_init();
     service_registry_init();
+    shm_init();
 
     // NOUVEAU: Initialisation des appels système
     print_string("Initialisation des appels systeme...\n");
@@ -1267,6 +1312,11 @@ void kmain(uint32_t multiboot_magic, uint32_t multiboot_addr) {
 
     print_string("\n=== AI-OS v6.0 - Force le premier changement de contexte ===\n");
     print_string("Declencher immediatement le planificateur...\n");
+
+    /* Les AP démarrent en dernier : jusqu'ici le BSP est seul dans le noyau.
+     * Le timer étalonne leur LAPIC ; ils volent le shell s'ils sont libres. */
+    asm volatile("sti");
+    smp_init();
     
     // Forcer le premier changement de contexte vers le shell utilisateur
     extern volatile int g_reschedule_needed;
@@ -1275,9 +1325,30 @@ void kmain(uint32_t multiboot_magic, uint32_t multiboot_addr) {
     // Activer les interruptions pour que le timer puisse déclencher le scheduler
     asm volatile("sti");
 
-    // Boucle d'inactivité du kernel. Le scheduler fera le travail.
+    // Boucle d'inactivité du kernel. Le scheduler fera le travail ; le temps
+    // libre remplit la réserve de frames pré-zéroées et vide trace et profil
+    // sur le port série, puis le CPU dort sans tick jusqu'à la prochaine
+    // échéance ou au réveil d'une tâche Ring 3.
+    task_enter_idle();
     while(1) {
-        asm volatile("hlt");
+        uint32_t refilled;
+        uint32_t drained = 0U;
+        asm volatile("cli");
+        smp_kernel_enter();
+        refilled = pmm_zero_pool_refill(KERNEL_IDLE_ZERO_BATCH);
+        if (refilled == 0U) {
+            // Vidage série du profil et de la trace, IRQ ouvertes comme pour le travail différé
+            asm volatile("sti");
+            drained = profile_drain_serial(KERNEL_IDLE_TRACE_BATCH);
+            drained += trace_drain_serial(KERNEL_IDLE_TRACE_BATCH);
+            asm volatile("cli");
+        }
+        smp_kernel_leave();
+        if (refilled == 0U && drained == 0U) {
+            timer_idle_wait();
+        } else {
+            asm volatile("sti");
+        }
     }
 }
 
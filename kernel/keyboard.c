@@ -1,6 +1,11 @@
 #include "keyboard.h"
 #include "kernel.h"
 #include "vga_console.h"
+#include "smp.h"
+#include "timer.h"
+#include "task/task.h"
+#include "trace.h"
+#include "perf.h"
 #include <stdint.h>
 
 // Fonctions externes pour les ports I/O et autres
@@ -70,13 +75,6 @@ void kbd_put_char(char c) {
     if (next != kbd_tail) {
         kbd_buf[kbd_head] = c;
         kbd_head = next;
-        
-        // Debug limité
-        if (debug_interrupt_count + debug_polling_count <= 5) {
-            print_string_serial("KBD_PUT: '");
-            write_serial(c);
-            print_string_serial("'\n");
-        }
     }
 }
 
@@ -196,14 +194,7 @@ void keyboard_poll_check() {
                 return;
             }
             
-            // Debug polling réduit pour éviter le bruit
-            if ((debug_interrupt_count == 0 && debug_polling_count <= 3)) {
-                print_string_serial("POLL: scancode=0x");
-                char hex[] = "0123456789ABCDEF";
-                write_serial(hex[(scancode >> 4) & 0xF]);
-                write_serial(hex[scancode & 0xF]);
-                print_string_serial(" (mode console)\n");
-            }
+            TRACE(TRACE_LEVEL_VERBOSE, OS_TRACE_KBD_SCANCODE, scancode, 1, debug_polling_count);
             
             // Gérer press/release pour maintenir correctement l'état SHIFT en mode polling
             if (scancode & 0x80) {
@@ -225,30 +216,15 @@ void keyboard_poll_check() {
     }
 }
 
-// Handler d'interruption optimisé
-void keyboard_interrupt_handler() {
+static void keyboard_irq_service(void) {
     debug_interrupt_count++;
     
-    // Debug interruptions
-    if (debug_interrupt_count <= 3) {
-        print_string_serial("KBD_IRQ: #");
-        write_serial('0' + (debug_interrupt_count % 10));
-        print_string_serial("\n");
-    }
-    
     uint8_t status = inb(0x64);
     if (!(status & 0x01)) return; // Pas de données
     
     uint8_t scancode = inb(0x60);
     
-    // Debug scancode
-    if (debug_interrupt_count <= 5) {
-        print_string_serial("IRQ: scancode=0x");
-        char hex[] = "0123456789ABCDEF";
-        write_serial(hex[(scancode >> 4) & 0xF]);
-        write_serial(hex[scancode & 0xF]);
-        print_string_serial("\n");
-    }
+    TRACE(TRACE_LEVEL_VERBOSE, OS_TRACE_KBD_SCANCODE, scancode, 0, debug_interrupt_count);
     
     // Filtrer les codes de contrôle
     if (scancode == 0xFA || scancode == 0xFE || scancode == 0xAA) {
@@ -268,10 +244,21 @@ void keyboard_interrupt_handler() {
         char c = map_scancode(scancode);
         if (c != 0) {
             kbd_put_char(c);
+            // La tâche endormie dans keyboard_getc() n'attend pas la fin de son tick
+            task_t* waiter = find_task_waiting_for_input();
+            if (waiter) task_set_state(waiter, TASK_READY);
         }
     }
 }
 
+// Handler d'interruption optimisé
+void keyboard_interrupt_handler() {
+    perf_span_t span;
+    perf_begin(&span);
+    keyboard_irq_service();
+    perf_end(OS_PERF_SLOT_IRQ(1), &span);
+}
+
 // Initialisation clavier hybride optimisée pour QEMU
 void keyboard_init() {
     print_string_serial("=== KEYBOARD HYBRID INIT (FIXED) ===\n");
@@ -421,13 +408,6 @@ char keyboard_getc(void) {
     
     getc_calls++;
     
-    // Debug limité
-    if (getc_calls <= 3) {
-        print_string_serial("GETC: start (call #");
-        write_serial('0' + (getc_calls % 10));
-        print_string_serial(")\n");
-    }
-    
     // Réactiver les interruptions
     asm volatile("sti");
     
@@ -437,17 +417,22 @@ char keyboard_getc(void) {
             // Filtrer: uniquement ASCII imprimable + contrôle utiles
             if ((c >= 32 && c <= 126) || c == '\n' || c == '\r' || c == '\t' || c == '\b') {
                 consecutive_empty_returns = 0; // Reset compteur
-                if (getc_calls <= 3) {
-                    print_string_serial("GETC: got valid '");
-                    write_serial(c);
-                    print_string_serial("' from buffer\n");
-                }
+                TRACE(TRACE_LEVEL_VERBOSE, OS_TRACE_GETC, (uint8_t)c, 0, getc_calls);
                 return c;
             } else {
                 continue;
             }
         }
         
+        /* Attente : la tâche dort un tick au plus (IRQ1 la réveille plus tôt),
+         * la tâche d'inactivité se contente de rendre le verrou noyau. */
+        if (current_task != smp_cpu()->idle_task) {
+            timer_block_until(TASK_WAITING_FOR_INPUT, timer_get_ticks() + 1U, NULL);
+        } else {
+            smp_kernel_relax();
+            if (task_has_other_ready_user()) task_yield();
+        }
+
         // 2. Polling de secours (actif même avec interruptions)
         keyboard_poll_check();
         
@@ -455,11 +440,7 @@ char keyboard_getc(void) {
         if (kbd_get_char_nonblock(&c)) {
             if ((c >= 32 && c <= 126) || c == '\n' || c == '\r' || c == '\t' || c == '\b') {
                 consecutive_empty_returns = 0; // Reset compteur
-                if (getc_calls <= 3) {
-                    print_string_serial("GETC: got valid '");
-                    write_serial(c);
-                    print_string_serial("' from polling\n");
-                }
+                TRACE(TRACE_LEVEL_VERBOSE, OS_TRACE_GETC, (uint8_t)c, 1, getc_calls);
                 return c;
             } else {
                 continue;
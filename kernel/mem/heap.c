@@ -3,31 +3,186 @@
 #include <stdint.h>
 
 /*
- * Allocation par plages physiques contigues. Chaque allocation est arrondie a
- * la page; le moteur GPT-2 peut ainsi reserver ses activations sans dependre
- * d'une bibliotheque d'execution hote. Les allocations restent non liberables
- * par taille inconnue dans cette premiere version du noyau.
+ * Tas noyau a classes de taille. Les petites allocations (16 o a ~2 Ko) sont
+ * servies par des slabs d'une page portant leur en-tete en tete de page : un
+ * objet slab n'est donc jamais aligne sur la page. Au-dela, l'allocation prend
+ * un bloc PMM contigu (aligne) dont le PMM retient lui-meme la taille
+ * (pmm_alloc_block), sans limite sur le nombre de blocs vivants.
+ *
+ * Le noyau reste fait de pools statiques et les tables de pages passent
+ * directement par le PMM : aucun chemin ne fait encore appel a kmalloc/kfree.
  */
 
+#ifndef NULL
+#define NULL ((void*)0)
+#endif
+
+#define HEAP_SLAB_MAGIC 0x534C4142u /* "SLAB" */
+#define HEAP_SLAB_HEADER_SIZE 32u    /* Garde les objets alignés sur 16 octets */
+
+typedef struct heap_slab {
+    uint32_t magic;
+    struct heap_slab* next;
+    struct heap_slab* prev;
+    void* free_list;
+    uint16_t class_index;
+    uint16_t in_use;
+} heap_slab_t;
+
+typedef struct {
+    uint32_t object_size;
+    uint32_t objects_per_slab;
+    heap_slab_t* partial;   // Slabs ayant encore au moins un objet libre
+    uint32_t slab_pages;
+    uint32_t objects_in_use;
+} heap_cache_t;
+
+/* La dernière classe loge exactement deux objets derrière l'en-tête. */
+static heap_cache_t heap_caches[OS_HEAP_CLASS_COUNT] = {
+    {16, 0, NULL, 0, 0}, {32, 0, NULL, 0, 0}, {64, 0, NULL, 0, 0}, {128, 0, NULL, 0, 0},
+    {256, 0, NULL, 0, 0}, {512, 0, NULL, 0, 0}, {1024, 0, NULL, 0, 0},
+    {(PAGE_SIZE - HEAP_SLAB_HEADER_SIZE) / 2, 0, NULL, 0, 0},
+};
+static uint32_t heap_large_allocs = 0;
+static uint32_t heap_large_pages = 0;
+
 void init_heap() {
-    // No-op, the PMM is initialized before the VMM/heap.
+    // Le PMM est initialisé avant le tas; seules les capacités de slab sont calculées.
+    for (uint32_t i = 0; i < OS_HEAP_CLASS_COUNT; i++) {
+        heap_caches[i].objects_per_slab =
+            (PAGE_SIZE - HEAP_SLAB_HEADER_SIZE) / heap_caches[i].object_size;
+    }
+}
+
+static int heap_class_for(size_t size) {
+    for (uint32_t i = 0; i < OS_HEAP_CLASS_COUNT; i++) {
+        if (size <= heap_caches[i].object_size) return (int)i;
+    }
+    return -1;
+}
+
+static void heap_partial_push(heap_cache_t* cache, heap_slab_t* slab) {
+    slab->prev = NULL;
+    slab->next = cache->partial;
+    if (cache->partial) cache->partial->prev = slab;
+    cache->partial = slab;
+}
+
+static void heap_partial_remove(heap_cache_t* cache, heap_slab_t* slab) {
+    if (slab->prev) slab->prev->next = slab->next;
+    else cache->partial = slab->next;
+    if (slab->next) slab->next->prev = slab->prev;
+    slab->next = NULL;
+    slab->prev = NULL;
+}
+
+static heap_slab_t* heap_slab_create(uint32_t class_index) {
+    heap_cache_t* cache = &heap_caches[class_index];
+    heap_slab_t* slab = (heap_slab_t*)pmm_alloc_page();
+    if (!slab) return NULL;
+
+    slab->magic = HEAP_SLAB_MAGIC;
+    slab->class_index = (uint16_t)class_index;
+    slab->in_use = 0;
+    slab->free_list = NULL;
+
+    // Chaîne les objets en ordre croissant d'adresse
+    uint8_t* base = (uint8_t*)slab + HEAP_SLAB_HEADER_SIZE;
+    for (uint32_t i = cache->objects_per_slab; i > 0; i--) {
+        void** object = (void**)(base + (i - 1) * cache->object_size);
+        *object = slab->free_list;
+        slab->free_list = object;
+    }
+    cache->slab_pages++;
+    heap_partial_push(cache, slab);
+    return slab;
+}
+
+static void* heap_large_alloc(size_t size) {
+    uint32_t pages = (uint32_t)((size + PAGE_SIZE - 1) / PAGE_SIZE);
+    void* ptr = pmm_alloc_block(pages);
+    if (!ptr) return NULL;
+    heap_large_allocs++;
+    heap_large_pages += pages;
+    return ptr;
 }
 
 void* kmalloc(size_t size) {
     if (size == 0) return NULL;
-    uint32_t pages = (uint32_t)((size + PAGE_SIZE - 1) / PAGE_SIZE);
-    return pmm_alloc_pages(pages);
+    int class_index = heap_class_for(size);
+    if (class_index < 0) return heap_large_alloc(size);
+
+    heap_cache_t* cache = &heap_caches[class_index];
+    if (cache->objects_per_slab == 0) init_heap();
+
+    heap_slab_t* slab = cache->partial;
+    if (!slab && !(slab = heap_slab_create((uint32_t)class_index))) return NULL;
+
+    void** object = (void**)slab->free_list;
+    slab->free_list = *object;
+    slab->in_use++;
+    cache->objects_in_use++;
+    if (!slab->free_list) heap_partial_remove(cache, slab);
+    return object;
 }
 
+// Les allocations alignées passent toujours par le chemin pages entières.
 void* kmalloc_aligned(size_t size) {
-    return kmalloc(size);
+    if (size == 0) return NULL;
+    return heap_large_alloc(size);
 }
 
 void kfree(void* ptr) {
-    /*
-     * A size-aware free API is required to return a multi-page allocation.
-     * Keep this compatibility entry point as a no-op for now; GPT-2 buffers
-     * are intentionally retained for the lifetime of the boot session.
-     */
-    (void)ptr;
+    if (!ptr) return;
+    uint32_t address = (uint32_t)ptr;
+
+    if ((address & (PAGE_SIZE - 1)) == 0) {
+        uint32_t pages = pmm_free_block(ptr);   // 0 : pointeur inconnu, ignoré
+        if (pages) {
+            heap_large_allocs--;
+            heap_large_pages -= pages;
+        }
+        return;
+    }
+
+    heap_slab_t* slab = (heap_slab_t*)(address & ~(PAGE_SIZE - 1));
+    if (slab->magic != HEAP_SLAB_MAGIC || slab->class_index >= OS_HEAP_CLASS_COUNT) return;
+    heap_cache_t* cache = &heap_caches[slab->class_index];
+    uint32_t offset = address - (uint32_t)slab;
+    if (offset < HEAP_SLAB_HEADER_SIZE ||
+        (offset - HEAP_SLAB_HEADER_SIZE) % cache->object_size != 0 ||
+        slab->in_use == 0) {
+        return;
+    }
+
+    int was_full = (slab->free_list == NULL);
+    *(void**)ptr = slab->free_list;
+    slab->free_list = ptr;
+    slab->in_use--;
+    cache->objects_in_use--;
+
+    if (slab->in_use == 0 && cache->slab_pages > 1) {
+        // Garde un slab vide par classe pour éviter les allers-retours PMM
+        if (!was_full) heap_partial_remove(cache, slab);
+        slab->magic = 0;
+        cache->slab_pages--;
+        pmm_free_page(slab);
+    } else if (was_full) {
+        heap_partial_push(cache, slab);
+    }
+}
+
+void heap_fill_meminfo(os_meminfo_t* info) {
+    if (!info) return;
+    info->heap_large_allocs = heap_large_allocs;
+    info->heap_large_pages = heap_large_pages;
+    for (uint32_t i = 0; i < OS_HEAP_CLASS_COUNT; i++) {
+        heap_cache_t* cache = &heap_caches[i];
+        uint32_t capacity = cache->slab_pages *
+            ((PAGE_SIZE - HEAP_SLAB_HEADER_SIZE) / cache->object_size);
+        info->heap_caches[i].object_size = cache->object_size;
+        info->heap_caches[i].slab_pages = cache->slab_pages;
+        info->heap_caches[i].objects_in_use = cache->objects_in_use;
+        info->heap_caches[i].objects_free = capacity - cache->objects_in_use;
+    }
 }
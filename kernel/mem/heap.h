@@ -3,6 +3,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "os_syscalls.h"
 
 void* kmalloc(size_t size);
 void* kmalloc_aligned(size_t size);
@@ -10,4 +11,7 @@ void kfree(void* ptr);
 
 void init_heap();
 
+/* Complète les compteurs heap_* d'un instantané SYS_MEMINFO. */
+void heap_fill_meminfo(os_meminfo_t* info);
+
 #endif
@@ -8,10 +8,46 @@
 // Symbol from linker script
 extern uint32_t end;
 
+// Allocateur "buddy" binaire : une liste de blocs libres par ordre (2^ordre pages).
+// Le bitmap reste la source de vérité page par page (double free, pmm_test_page),
+// les métadonnées buddy sont hors bande, juste après lui.
+// Deux zones indépendantes : directe (identité noyau) et haute (au-delà de
+// PMM_DIRECT_MAP_LIMIT). Un bloc ne chevauche jamais la frontière.
+#define PMM_MAX_ORDER 20
+#define PMM_ORDER_NONE 0xFF
+#define PMM_LINK_NONE 0xFFFFFFFF
+#define PMM_ZONE_DIRECT 0
+#define PMM_ZONE_HIGH 1
+#define PMM_ZONE_COUNT 2
+// buddy_prev du premier frame d'un bloc alloué par pmm_alloc_block (hors de toute liste)
+#define PMM_BLOCK_TAG 0xB10CB10Cu
+
 // Variables globales pour le gestionnaire de mémoire physique
 static uint32_t* memory_map = 0;
 static uint32_t total_pages = 0;
 static uint32_t used_pages = 0;
+static uint32_t direct_pages = 0;   // Première frame de la zone haute
+
+static uint8_t* buddy_order = 0;   // Ordre du bloc libre qui commence à cette page, sinon PMM_ORDER_NONE
+static uint32_t* buddy_next = 0;
+static uint32_t* buddy_prev = 0;
+static uint32_t buddy_free_head[PMM_ZONE_COUNT][PMM_MAX_ORDER + 1];
+static uint32_t buddy_free_mask[PMM_ZONE_COUNT]; // Bit k = liste de l'ordre k non vide
+static uint32_t buddy_free_count[PMM_ZONE_COUNT][PMM_MAX_ORDER + 1]; // Histogramme des blocs libres
+static uint8_t* page_extra_refs = 0; // Propriétaires en plus du premier (frames partagées)
+
+// Réserve de frames directes déjà mises à zéro, remplie quand le CPU est inactif.
+// Ces frames sont marquées dans le bitmap mais comptées comme libres.
+#ifndef PMM_ZERO_POOL_CAPACITY
+#define PMM_ZERO_POOL_CAPACITY 128U
+#endif
+static uint32_t zero_pool[PMM_ZERO_POOL_CAPACITY];
+static uint32_t zero_pool_count = 0;
+
+// Échecs d'allocation par ordre demandé (KV cache, tables...), pour SYS_MEMSTATS.
+static uint32_t alloc_failures = 0;
+static uint32_t alloc_failures_by_order[PMM_MAX_ORDER + 1];
+static uint32_t last_failed_pages = 0;
 
 // Fonctions utilitaires pour manipuler le bitmap
 void pmm_set_page(uint32_t page_num) {
@@ -51,10 +87,90 @@ uint32_t pmm_find_free_page() {
     return 0xFFFFFFFF; // No free page found
 }
 
+// --- Listes de blocs libres ---
+
+static uint32_t buddy_zone(uint32_t page) {
+    return page >= direct_pages ? PMM_ZONE_HIGH : PMM_ZONE_DIRECT;
+}
+
+static void buddy_push(uint32_t page, uint32_t order) {
+    uint32_t zone = buddy_zone(page);
+    uint32_t head = buddy_free_head[zone][order];
+    buddy_order[page] = (uint8_t)order;
+    buddy_prev[page] = PMM_LINK_NONE;
+    buddy_next[page] = head;
+    if (head != PMM_LINK_NONE) buddy_prev[head] = page;
+    buddy_free_head[zone][order] = page;
+    buddy_free_mask[zone] |= (1u << order);
+    buddy_free_count[zone][order]++;
+}
+
+static void buddy_remove(uint32_t page) {
+    uint32_t zone = buddy_zone(page);
+    uint32_t order = buddy_order[page];
+    uint32_t prev = buddy_prev[page];
+    uint32_t next = buddy_next[page];
+
+    if (prev != PMM_LINK_NONE) buddy_next[prev] = next;
+    else buddy_free_head[zone][order] = next;
+    if (next != PMM_LINK_NONE) buddy_prev[next] = prev;
+
+    if (buddy_free_head[zone][order] == PMM_LINK_NONE) buddy_free_mask[zone] &= ~(1u << order);
+    buddy_free_count[zone][order]--;
+    buddy_order[page] = PMM_ORDER_NONE;
+}
+
+// Rend un bloc aligné de 2^order pages et le fusionne avec ses buddies libres.
+static void buddy_release_block(uint32_t page, uint32_t order) {
+    while (order < PMM_MAX_ORDER) {
+        uint32_t buddy = page ^ (1u << order);
+        if (buddy >= total_pages || buddy_order[buddy] != order ||
+            buddy_zone(buddy) != buddy_zone(page)) {
+            break;
+        }
+        buddy_remove(buddy);
+        if (buddy < page) page = buddy;
+        order++;
+    }
+    buddy_push(page, order);
+}
+
+// Découpe une plage quelconque en blocs alignés maximaux, sans franchir la frontière de zone.
+static void buddy_release_range(uint32_t page, uint32_t count) {
+    if (page < direct_pages && count > direct_pages - page) {
+        uint32_t low_count = direct_pages - page;
+        buddy_release_range(page, low_count);
+        page = direct_pages;
+        count -= low_count;
+    }
+    while (count > 0) {
+        uint32_t order = 0;
+        while (order < PMM_MAX_ORDER &&
+               !(page & (1u << order)) &&
+               (2u << order) <= count) {
+            order++;
+        }
+        buddy_release_block(page, order);
+        page += 1u << order;
+        count -= 1u << order;
+    }
+}
+
+static uint32_t buddy_order_for(uint32_t page_count) {
+    uint32_t order = 0;
+    while ((1u << order) < page_count) order++;
+    return order;
+}
+
 // Initialise le gestionnaire de mémoire physique
 void pmm_init(uint32_t memory_size, uint32_t multiboot_addr) {
     total_pages = memory_size / PAGE_SIZE;
     used_pages = 0;
+    zero_pool_count = 0;
+    alloc_failures = 0;
+    last_failed_pages = 0;
+    direct_pages = PMM_DIRECT_MAP_LIMIT / PAGE_SIZE;
+    if (direct_pages > total_pages) direct_pages = total_pages;
     
     multiboot_info_t* mbi = (multiboot_info_t*)multiboot_addr;
 
@@ -69,29 +185,48 @@ void pmm_init(uint32_t memory_size, uint32_t multiboot_addr) {
         }
     }
 
-    // Place le bitmap juste après
+    // Place le bitmap juste après, suivi des métadonnées buddy
     memory_map = (uint32_t*)((highest_addr + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1));
+    uint32_t bitmap_size_dwords = (total_pages + 31) / 32;
+    buddy_order = (uint8_t*)(memory_map + bitmap_size_dwords);
+    buddy_next = (uint32_t*)(((uint32_t)buddy_order + total_pages + 3) & ~3u);
+    buddy_prev = buddy_next + total_pages;
+    page_extra_refs = (uint8_t*)(buddy_prev + total_pages);
 
     // Initialise le bitmap à zéro
-    uint32_t bitmap_size_bytes = ((total_pages + 7) / 8);
-    for (uint32_t i = 0; i < (bitmap_size_bytes + 3) / 4; i++) {
+    for (uint32_t i = 0; i < bitmap_size_dwords; i++) {
         memory_map[i] = 0;
     }
+    for (uint32_t i = 0; i < total_pages; i++) {
+        buddy_order[i] = PMM_ORDER_NONE;
+        page_extra_refs[i] = 0;
+    }
+    for (uint32_t zone = 0; zone < PMM_ZONE_COUNT; zone++) {
+        for (uint32_t i = 0; i <= PMM_MAX_ORDER; i++) {
+            buddy_free_head[zone][i] = PMM_LINK_NONE;
+            buddy_free_count[zone][i] = 0;
+        }
+        buddy_free_mask[zone] = 0;
+    }
+    for (uint32_t i = 0; i <= PMM_MAX_ORDER; i++) alloc_failures_by_order[i] = 0;
     
-    // Marque les pages utilisées par le noyau, les modules et le bitmap
-    uint32_t reserved_until = ((uint32_t)memory_map + bitmap_size_bytes);
+    // Marque les pages utilisées par le noyau, les modules et les métadonnées
+    uint32_t reserved_until = (uint32_t)(page_extra_refs + total_pages);
 #ifdef KERNEL_TEST
-    uint32_t reserved_pages = 1;
+    // En test, la page physique N correspond à &end + N * PAGE_SIZE
+    uint32_t reserved_pages = (reserved_until - (uint32_t)memory_map + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (reserved_pages == 0) reserved_pages = 1;
 #else
     uint32_t reserved_pages = (reserved_until + PAGE_SIZE - 1) / PAGE_SIZE;
 #endif
+    if (reserved_pages > total_pages) reserved_pages = total_pages;
     
     for (uint32_t i = 0; i < reserved_pages; i++) {
-        if (i < total_pages) {
-            pmm_set_page(i);
-        }
+        pmm_set_page(i);
     }
     used_pages = reserved_pages;
+
+    buddy_release_range(reserved_pages, total_pages - reserved_pages);
 }
 
 
@@ -100,26 +235,123 @@ void* pmm_alloc_page() {
     return pmm_alloc_pages(1);
 }
 
+static void* buddy_alloc_in_zone(uint32_t zone, uint32_t page_count) {
+    uint32_t order = buddy_order_for(page_count);
+    if (order > PMM_MAX_ORDER) return NULL;
+
+    uint32_t available = buddy_free_mask[zone] & ~((1u << order) - 1);
+    if (!available) return NULL;
+
+    uint32_t block_order = (uint32_t)__builtin_ctz(available);
+    uint32_t first = buddy_free_head[zone][block_order];
+    buddy_remove(first);
+
+    while (block_order > order) {
+        block_order--;
+        buddy_push(first + (1u << block_order), block_order);
+    }
+    if ((1u << order) > page_count) {
+        buddy_release_range(first + page_count, (1u << order) - page_count);
+    }
+
+    for (uint32_t i = 0; i < page_count; i++) pmm_set_page(first + i);
+    used_pages += page_count;
+    return (void*)(first * PAGE_SIZE);
+}
+
+// Dernier recours quand le buddy est vide : une frame de la réserve reste une frame valide.
+static void* pmm_zero_pool_pop(uint32_t page_count) {
+    if (page_count != 1 || zero_pool_count == 0) return NULL;
+    return (void*)(zero_pool[--zero_pool_count] * PAGE_SIZE);
+}
+
+static void* pmm_note_failure(void* pages, uint32_t page_count) {
+    if (!pages) {
+        uint32_t order = buddy_order_for(page_count);
+        alloc_failures++;
+        alloc_failures_by_order[order > PMM_MAX_ORDER ? PMM_MAX_ORDER : order]++;
+        last_failed_pages = page_count;
+    }
+    return pages;
+}
+
 // Alloue une plage physique contigue pour les buffers volumineux (modele, KV cache, activations).
+// Prend le plus petit bloc libre d'ordre suffisant, le découpe, puis rend la queue inutilisée.
+// Toujours dans la zone directe : le noyau déréférence ces adresses telles quelles.
 void* pmm_alloc_pages(uint32_t page_count) {
-    if (page_count == 0 || page_count > total_pages) return NULL;
-
-    uint32_t consecutive = 0;
-    uint32_t first = 0;
-    for (uint32_t page_num = 0; page_num < total_pages; page_num++) {
-        if (!pmm_test_page(page_num)) {
-            if (consecutive == 0) first = page_num;
-            consecutive++;
-            if (consecutive == page_count) {
-                for (uint32_t i = 0; i < page_count; i++) pmm_set_page(first + i);
-                used_pages += page_count;
-                return (void*)(first * PAGE_SIZE);
-            }
-        } else {
-            consecutive = 0;
-        }
+    if (page_count == 0) return NULL;
+    if (page_count > total_pages) return pmm_note_failure(NULL, page_count);
+    void* pages = buddy_alloc_in_zone(PMM_ZONE_DIRECT, page_count);
+    return pmm_note_failure(pages ? pages : pmm_zero_pool_pop(page_count), page_count);
+}
+
+// Les liens buddy du premier frame sont inutilisés tant que le bloc est alloué :
+// ils gardent l'étiquette et la taille, que pmm_free_block relit.
+void* pmm_alloc_block(uint32_t page_count) {
+    void* pages = pmm_alloc_pages(page_count);
+    if (pages) {
+        buddy_prev[(uint32_t)pages / PAGE_SIZE] = PMM_BLOCK_TAG;
+        buddy_next[(uint32_t)pages / PAGE_SIZE] = page_count;
+    }
+    return pages;
+}
+
+uint32_t pmm_free_block(void* first) {
+    uint32_t page_num = (uint32_t)first / PAGE_SIZE;
+    uint32_t page_count;
+    if (((uint32_t)first & (PAGE_SIZE - 1)) != 0 || page_num >= total_pages ||
+        !pmm_test_page(page_num) || buddy_prev[page_num] != PMM_BLOCK_TAG) {
+        return 0;
+    }
+    page_count = buddy_next[page_num];
+    pmm_free_pages(first, page_count);
+    return page_count;
+}
+
+void* pmm_alloc_high_page() {
+    return pmm_alloc_high_pages(1);
+}
+
+void* pmm_alloc_high_pages(uint32_t page_count) {
+    if (page_count == 0) return NULL;
+    if (page_count > total_pages) return pmm_note_failure(NULL, page_count);
+    void* pages = buddy_alloc_in_zone(PMM_ZONE_HIGH, page_count);
+    if (!pages) pages = buddy_alloc_in_zone(PMM_ZONE_DIRECT, page_count);
+    return pmm_note_failure(pages ? pages : pmm_zero_pool_pop(page_count), page_count);
+}
+
+static void pmm_zero_frame(uint32_t page_num) {
+#ifdef KERNEL_TEST
+    uint32_t* words = (uint32_t*)((uint8_t*)&end + page_num * PAGE_SIZE);
+#else
+    uint32_t* words = (uint32_t*)(page_num * PAGE_SIZE);
+#endif
+    for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); i++) words[i] = 0;
+}
+
+// Frame zéro sans attente si la réserve en a une, sinon mise à zéro immédiate.
+void* pmm_alloc_zeroed_page() {
+    void* page = pmm_zero_pool_pop(1);
+    if (page) return page;
+    page = buddy_alloc_in_zone(PMM_ZONE_DIRECT, 1);
+    if (page) pmm_zero_frame((uint32_t)page / PAGE_SIZE);
+    return pmm_note_failure(page, 1);
+}
+
+uint32_t pmm_zero_pool_refill(uint32_t budget) {
+    uint32_t added = 0;
+    while (added < budget && zero_pool_count < PMM_ZERO_POOL_CAPACITY) {
+        void* page = buddy_alloc_in_zone(PMM_ZONE_DIRECT, 1);
+        if (!page) break;
+        pmm_zero_frame((uint32_t)page / PAGE_SIZE);
+        zero_pool[zero_pool_count++] = (uint32_t)page / PAGE_SIZE;
+        added++;
     }
-    return NULL;
+    return added;
+}
+
+uint32_t pmm_zero_pool_count() {
+    return zero_pool_count;
 }
 
 // Libère une page de mémoire physique
@@ -127,18 +359,56 @@ void pmm_free_page(void* page) {
     pmm_free_pages(page, 1);
 }
 
+// Seules les pages marquées utilisées sont rendues : un double free est ignoré.
 void pmm_free_pages(void* page, uint32_t page_count) {
     if (page == NULL || page_count == 0) return;
 
     uint32_t page_num = (uint32_t)page / PAGE_SIZE;
     if (page_num >= total_pages || page_count > total_pages - page_num) return;
 
+    uint32_t run_start = 0;
+    uint32_t run_len = 0;
     for (uint32_t i = 0; i < page_count; i++) {
-        if (pmm_test_page(page_num + i)) {
-            pmm_clear_page(page_num + i);
+        uint32_t p = page_num + i;
+        if (pmm_test_page(p)) {
+            pmm_clear_page(p);
+            page_extra_refs[p] = 0;
+            buddy_prev[p] = PMM_LINK_NONE;   // Efface une étiquette de bloc
             if (used_pages > 0) used_pages--;
+            if (run_len == 0) run_start = p;
+            run_len++;
+        } else if (run_len > 0) {
+            buddy_release_range(run_start, run_len);
+            run_len = 0;
         }
     }
+    if (run_len > 0) buddy_release_range(run_start, run_len);
+}
+
+// Partage de frames (texte ELF, copy-on-write) : une frame n'est rendue au
+// buddy qu'au départ de son dernier propriétaire.
+int pmm_page_ref(void* page) {
+    uint32_t page_num = (uint32_t)page / PAGE_SIZE;
+    if (!pmm_page_ref_count(page) || page_extra_refs[page_num] == 0xFF) return -1;
+    page_extra_refs[page_num]++;
+    return 0;
+}
+
+int pmm_page_unref(void* page) {
+    uint32_t page_num = (uint32_t)page / PAGE_SIZE;
+    if (!pmm_page_ref_count(page)) return 0;
+    if (page_extra_refs[page_num] > 0) {
+        page_extra_refs[page_num]--;
+        return 0;
+    }
+    pmm_free_pages(page, 1);
+    return 1;
+}
+
+uint32_t pmm_page_ref_count(void* page) {
+    uint32_t page_num = (uint32_t)page / PAGE_SIZE;
+    if (page_num >= total_pages || !pmm_test_page(page_num)) return 0;
+    return 1U + page_extra_refs[page_num];
 }
 
 // Fonctions d'information
@@ -147,9 +417,39 @@ uint32_t pmm_get_total_pages() {
 }
 
 uint32_t pmm_get_used_pages() {
-    return used_pages;
+    return used_pages - zero_pool_count;
 }
 
 uint32_t pmm_get_free_pages() {
-    return total_pages - used_pages;
+    return total_pages - used_pages + zero_pool_count;
+}
+
+uint32_t pmm_get_direct_pages() {
+    return direct_pages;
+}
+
+// Histogramme et plus grand bloc : lus dans les compteurs des listes buddy.
+void pmm_fill_memstats(os_memstats_t* out) {
+    uint32_t largest = zero_pool_count ? 1U : 0U;
+    out->total_pages = total_pages;
+    out->free_pages = pmm_get_free_pages();
+    out->direct_pages = direct_pages;
+    out->zero_pool_pages = zero_pool_count;
+    for (uint32_t zone = 0; zone < PMM_ZONE_COUNT; zone++) {
+        if (buddy_free_mask[zone]) {
+            uint32_t run = 1U << (31U - (uint32_t)__builtin_clz(buddy_free_mask[zone]));
+            if (run > largest) largest = run;
+        }
+    }
+    out->largest_free_run = largest;
+    for (uint32_t order = 0; order < OS_MEM_ORDER_COUNT; order++) {
+        uint32_t blocks = 0;
+        if (order <= PMM_MAX_ORDER) {
+            for (uint32_t zone = 0; zone < PMM_ZONE_COUNT; zone++) blocks += buddy_free_count[zone][order];
+        }
+        out->free_blocks[order] = blocks;
+        out->alloc_failures_by_order[order] = order <= PMM_MAX_ORDER ? alloc_failures_by_order[order] : 0;
+    }
+    out->alloc_failures = alloc_failures;
+    out->last_failed_pages = last_failed_pages;
 }
@@ -2,18 +2,46 @@
 #define PMM_H
 
 #include <stdint.h>
+#include "os_syscalls.h"
 
 #define PAGE_SIZE 4096
 
+/* Au-delà, les frames ne sont pas dans l'identité noyau : elles ne servent
+ * qu'aux pages utilisateur ou via la fenêtre vmm_kmap(). */
+#ifndef PMM_DIRECT_MAP_LIMIT
+#define PMM_DIRECT_MAP_LIMIT (1024U * 1024U * 1024U)
+#endif
+
 // Fonctions publiques du Physical Memory Manager
 void pmm_init(uint32_t memory_size, uint32_t multiboot_addr);
 void* pmm_alloc_page();
 void* pmm_alloc_pages(uint32_t page_count);
+/* Frames hautes d'abord (repli sur la zone directe) : jamais déréférencées par le noyau. */
+void* pmm_alloc_high_page();
+void* pmm_alloc_high_pages(uint32_t page_count);
+/* Frame directe garantie à zéro, prise dans la réserve pré-zéroée si possible. */
+void* pmm_alloc_zeroed_page();
+/* Met à zéro jusqu'à budget frames pour la réserve ; à appeler interruptions
+ * masquées depuis l'inactivité. Renvoie le nombre de frames ajoutées. */
+uint32_t pmm_zero_pool_refill(uint32_t budget);
+uint32_t pmm_zero_pool_count();
+/* Bloc direct dont le PMM retient la taille : pmm_free_block le rend entier et
+ * renvoie son nombre de pages, 0 si first ne vient pas de pmm_alloc_block. */
+void* pmm_alloc_block(uint32_t page_count);
+uint32_t pmm_free_block(void* first);
 void pmm_free_page(void* page);
 void pmm_free_pages(void* page, uint32_t page_count);
+/* Frames partagées : ref ajoute un propriétaire (-1 si libre ou saturée),
+ * unref en retire un et renvoie 1 quand la frame est effectivement libérée. */
+int pmm_page_ref(void* page);
+int pmm_page_unref(void* page);
+uint32_t pmm_page_ref_count(void* page);   // 0 si la frame est libre
 uint32_t pmm_get_total_pages();
 uint32_t pmm_get_used_pages();
 uint32_t pmm_get_free_pages();
+uint32_t pmm_get_direct_pages();   // Frames sous PMM_DIRECT_MAP_LIMIT
+/* Partie PMM d'un instantané SYS_MEMSTATS (les tâches sont remplies par task.c). */
+void pmm_fill_memstats(os_memstats_t* out);
 
 // Fonctions utilitaires internes
 void pmm_set_page(uint32_t page_num);
@@ -1,19 +1,18 @@
 #include "string.h"
+#include "os_mem.h"
 
+/* Les primitives sont partagées avec l'espace utilisateur (include/os_mem.h) :
+ * répartition par taille entre boucle d'octets, rep movsd/stosd et SSE2. */
 void* memset(void* bufptr, int value, size_t size) {
-    unsigned char* buf = (unsigned char*) bufptr;
-    for (size_t i = 0; i < size; i++) {
-        buf[i] = (unsigned char) value;
-    }
-    return bufptr;
+    return os_memset(bufptr, value, (uint32_t)size);
 }
 
 void* memcpy(void* dstptr, const void* srcptr, size_t size) {
-	unsigned char* dst = (unsigned char*) dstptr;
-	const unsigned char* src = (const unsigned char*) srcptr;
-	for (size_t i = 0; i < size; i++)
-		dst[i] = src[i];
-	return dstptr;
+    return os_memcpy(dstptr, srcptr, (uint32_t)size);
+}
+
+int memcmp(const void* lhs, const void* rhs, size_t size) {
+    return os_memcmp(lhs, rhs, (uint32_t)size);
 }
 
 int strcmp(const char *s1, const char *s2) {
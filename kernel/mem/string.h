@@ -5,6 +5,7 @@
 
 void* memset(void* bufptr, int value, size_t size);
 void* memcpy(void* dstptr, const void* srcptr, size_t size);
+int memcmp(const void* lhs, const void* rhs, size_t size);
 int strcmp(const char *s1, const char *s2);
 
 #endif
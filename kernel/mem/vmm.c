@@ -8,15 +8,68 @@ extern void print_string_serial(const char* str);
 
 // Variables globales pour la gestion de la mémoire virtuelle
 vmm_directory_t *kernel_directory = 0;
-vmm_directory_t *current_directory = 0;
 
 /*
  * Le premier moteur GPT-2 local charge ses poids comme module Multiboot.
  * Le noyau reste en mode 32 bits : le plafond identite est donc borne a 1 Gio
- * pour garder un chemin simple et verifiable avant le portage PAE/x86_64.
+ * (zone directe du PMM). Les frames au-dela servent aux pages utilisateur ou
+ * sont vues a la demande par la fenetre noyau vmm_kmap().
  */
-#define VMM_IDENTITY_LIMIT (1024U * 1024U * 1024U)
+#define VMM_IDENTITY_LIMIT PMM_DIRECT_MAP_LIMIT
 
+/* Fenetre noyau de 64 Mio au-dessus de l'espace utilisateur ; ses tables sont
+ * creees a l'init et partagees par pointeur avec tous les repertoires. */
+#define VMM_KWINDOW_BASE 0xC0000000U
+#define VMM_KWINDOW_PAGES 16384U
+static uint32_t vmm_kwindow_used[VMM_KWINDOW_PAGES / 32U];
+
+#define VMM_LARGE_PAGE_SIZE (PAGE_SIZE * ENTRIES_PER_TABLE)
+#define VMM_CPUID_EDX_PSE (1U << 3)
+#define VMM_CR4_PSE (1U << 4)
+#define VMM_CR0_WP (1U << 16)
+
+static int vmm_pse_active = 0;
+
+static int vmm_cpu_has_pse(void) {
+    uint32_t eax, ebx, ecx, edx;
+    __asm__ volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1U), "c"(0U));
+    (void)eax;
+    (void)ebx;
+    (void)ecx;
+    return (edx & VMM_CPUID_EDX_PSE) != 0U;
+}
+
+static void vmm_enable_pse(void) {
+    uint32_t cr4;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= VMM_CR4_PSE;
+    __asm__ volatile("mov %0, %%cr4" : : "r"(cr4) : "memory");
+}
+
+/* Sans WP, le noyau écrirait à travers une page utilisateur en lecture seule
+ * et corromprait une frame partagée au lieu de déclencher la copie. */
+static void vmm_enable_write_protect(void) {
+    uint32_t cr0;
+    __asm__ volatile("mov %%cr0, %0" : "=r"(cr0));
+    cr0 |= VMM_CR0_WP;
+    __asm__ volatile("mov %0, %%cr0" : : "r"(cr0) : "memory");
+}
+
+int vmm_pse_enabled(void) {
+    return vmm_pse_active;
+}
+
+/* Reconstruit en 4 Kio l'identité d'une PDE PSE, pour y insérer des pages fines. */
+static void vmm_fill_from_large_pde(page_table_t* table, uint32_t pde) {
+    uint32_t first_frame = (pde & ~(VMM_LARGE_PAGE_SIZE - 1U)) / PAGE_SIZE;
+    memset(table, 0, sizeof(page_table_t));
+    for (uint32_t i = 0; i < ENTRIES_PER_TABLE; i++) {
+        table->pages[i].present = 1;
+        table->pages[i].rw = (pde & PAGE_WRITE) ? 1 : 0;
+        table->pages[i].user = 0;
+        table->pages[i].frame = first_frame + i;
+    }
+}
 
 // Initialise le gestionnaire de mémoire virtuelle
 void vmm_init() {
@@ -51,7 +104,23 @@ void vmm_init() {
     if (total_frames < limit_frames) limit_frames = total_frames;
     uint32_t table_count = (limit_frames + ENTRIES_PER_TABLE - 1) / ENTRIES_PER_TABLE;
 
+    /*
+     * Avec PSE, chaque tranche complète de 4 Mio (noyau, initrd, poids GPT-2)
+     * est une seule PDE : pas de table de pages et une entrée TLB par tranche.
+     * Seule une tranche partielle en fin de RAM garde une table 4 Kio.
+     */
+    vmm_pse_active = vmm_cpu_has_pse();
+    if (vmm_pse_active) {
+        vmm_enable_pse();
+        print_string_serial("VMM: identite en pages PSE de 4 Mio\n");
+    }
+
     for (uint32_t table_index = 0; table_index < table_count; table_index++) {
+        if (vmm_pse_active && (table_index + 1U) * ENTRIES_PER_TABLE <= limit_frames) {
+            kernel_directory->physical_dir->tablesPhysical[table_index] =
+                (table_index * VMM_LARGE_PAGE_SIZE) | PAGE_LARGE | PAGE_WRITE | PAGE_PRESENT;
+            continue;
+        }
         page_table_t* pt = (page_table_t*)pmm_alloc_page();
         if (!pt) return; // Erreur critique
         memset(pt, 0, sizeof(page_table_t));
@@ -69,9 +138,20 @@ void vmm_init() {
         kernel_directory->physical_dir->tablesPhysical[table_index] = (uint32_t)pt | 3;
     }
 
+    uint32_t window_first_table = (VMM_KWINDOW_BASE / PAGE_SIZE) / ENTRIES_PER_TABLE;
+    for (uint32_t i = 0; i < VMM_KWINDOW_PAGES / ENTRIES_PER_TABLE; i++) {
+        page_table_t* pt = (page_table_t*)pmm_alloc_page();
+        if (!pt) return; // Erreur critique
+        memset(pt, 0, sizeof(page_table_t));
+        kernel_directory->tables[window_first_table + i] = pt;
+        kernel_directory->physical_dir->tablesPhysical[window_first_table + i] = (uint32_t)pt | 3;
+    }
+    memset(vmm_kwindow_used, 0, sizeof(vmm_kwindow_used));
+
     // Charger le nouveau répertoire de pages et activer
     load_page_directory(kernel_directory->physical_addr);
     enable_paging();
+    vmm_enable_write_protect();
 
     current_directory = kernel_directory;
 
@@ -91,10 +171,21 @@ page_t *vmm_get_page(uint32_t address, int make, vmm_directory_t *dir) {
 
     if (dir->tables[table_idx]) {
         return &dir->tables[table_idx]->pages[address % 1024];
+    } else if (dir->physical_dir->tablesPhysical[table_idx] & PAGE_LARGE) {
+        // Une page de 4 Mio n'a pas d'entrée 4 Kio : on ne la découpe que sur demande.
+        if (!make) return 0;
+        page_table_t* split = (page_table_t*)pmm_alloc_page();
+        if (!split) return 0;
+        vmm_fill_from_large_pde(split, dir->physical_dir->tablesPhysical[table_idx]);
+        dir->tables[table_idx] = split;
+        dir->physical_dir->tablesPhysical[table_idx] = (uint32_t)split | 0x7;
+        if (dir == current_directory) {
+            asm volatile ("invlpg (%0)" :: "r" (table_idx * VMM_LARGE_PAGE_SIZE) : "memory");
+        }
+        return &dir->tables[table_idx]->pages[address % 1024];
     } else if (make) {
-        page_table_t* new_table = (page_table_t*)pmm_alloc_page();
+        page_table_t* new_table = (page_table_t*)pmm_alloc_zeroed_page();
         if (!new_table) return 0;
-        memset(new_table, 0, sizeof(page_table_t));
         
         dir->tables[table_idx] = new_table;
         dir->physical_dir->tablesPhysical[table_idx] = (uint32_t)new_table | 0x7; // P, RW, US
@@ -111,16 +202,27 @@ static uint8_t vmm_table_is_private(const vmm_directory_t* dir, uint32_t table_i
 
 static void vmm_table_mark_private(vmm_directory_t* dir, uint32_t table_index) {
     dir->private_table_mask[table_index / 32U] |= (uint32_t)1U << (table_index % 32U);
+    dir->table_pages++;
 }
 
 static int vmm_ensure_private_user_table(vmm_directory_t *dir, uint32_t table_index) {
     page_table_t* private_table;
     if (!dir || table_index >= ENTRIES_PER_TABLE) return -1;
     if (vmm_table_is_private(dir, table_index)) return 0;
-    private_table = (page_table_t*)pmm_alloc_page();
-    if (!private_table) return -2;
-    if (dir->tables[table_index]) memcpy(private_table, dir->tables[table_index], sizeof(page_table_t));
-    else memset(private_table, 0, sizeof(page_table_t));
+    if (dir->tables[table_index]) {
+        private_table = (page_table_t*)pmm_alloc_page();
+        if (!private_table) return -2;
+        memcpy(private_table, dir->tables[table_index], sizeof(page_table_t));
+    } else if (dir->physical_dir->tablesPhysical[table_index] & PAGE_LARGE) {
+        // Tranche PSE partagée : la copie privée reprend l'identité en 4 Kio.
+        private_table = (page_table_t*)pmm_alloc_page();
+        if (!private_table) return -2;
+        vmm_fill_from_large_pde(private_table, dir->physical_dir->tablesPhysical[table_index]);
+    } else {
+        // Cas courant d'une tâche neuve : table vide prise dans la réserve pré-zéroée.
+        private_table = (page_table_t*)pmm_alloc_zeroed_page();
+        if (!private_table) return -2;
+    }
     dir->tables[table_index] = private_table;
     dir->physical_dir->tablesPhysical[table_index] = (uint32_t)private_table | 0x7U;
     vmm_table_mark_private(dir, table_index);
@@ -135,14 +237,36 @@ int vmm_map_page_in_directory(vmm_directory_t *dir, void *physaddr, void *virtua
     if ((flags & PAGE_USER) && dir != kernel_directory && vmm_ensure_private_user_table(dir, table_index) != 0) return -2;
     page = vmm_get_page((uint32_t)virtualaddr, 1, dir);
     if (!page) return -3;
+    if (dir != kernel_directory) {
+        if (page->present && page->user) dir->resident_pages--;
+        if ((flags & (PAGE_PRESENT | PAGE_USER)) == (PAGE_PRESENT | PAGE_USER)) dir->resident_pages++;
+    }
     page->present = (flags & PAGE_PRESENT) ? 1 : 0;
     page->rw = (flags & PAGE_WRITE) ? 1 : 0;
     page->user = (flags & PAGE_USER) ? 1 : 0;
+    page->cow = (flags & PAGE_COW) ? 1 : 0;
+    page->borrowed = (flags & PAGE_BORROWED) ? 1 : 0;
     page->frame = (uint32_t)physaddr / PAGE_SIZE;
     asm volatile ("invlpg (%0)" :: "r" (virtualaddr) : "memory");
     return 0;
 }
 
+int vmm_unmap_page_in_directory(vmm_directory_t *dir, void *virtualaddr) {
+    page_t *page;
+    void *frame;
+    uint32_t borrowed;
+    if (!dir || dir == kernel_directory || !virtualaddr) return -1;
+    page = vmm_get_page((uint32_t)virtualaddr, 0, dir);
+    if (!page || !page->present || !page->user) return -1;
+    frame = (void*)(page->frame * PAGE_SIZE);
+    borrowed = page->borrowed;
+    *(uint32_t*)page = 0U;
+    dir->resident_pages--;
+    if (dir == current_directory) asm volatile ("invlpg (%0)" :: "r" (virtualaddr) : "memory");
+    if (!borrowed) (void)pmm_page_unref(frame);
+    return 0;
+}
+
 int vmm_destroy_user_directory(vmm_directory_t *dir) {
     uint32_t table_index, page_index;
     if (!dir || dir == kernel_directory || dir == current_directory) return -1;
@@ -152,9 +276,146 @@ int vmm_destroy_user_directory(vmm_directory_t *dir) {
         if (!vmm_table_is_private(dir, table_index) || !table) continue;
         for (page_index = 0U; page_index < ENTRIES_PER_TABLE; page_index++) {
             page_t* page = &table->pages[page_index];
-            if (page->present && page->user) pmm_free_page((void*)(page->frame * PAGE_SIZE));
+            // Frames empruntées à l'initrd : réservées au PMM, jamais libérées
+            if (page->present && page->user && !page->borrowed) (void)pmm_page_unref((void*)(page->frame * PAGE_SIZE));
         }
         pmm_free_page(table);
     }
     return 0;
 }
+
+int vmm_add_area(vmm_directory_t *dir, uint32_t start, uint32_t end, uint32_t flags) {
+    if (!dir || dir == kernel_directory || dir->area_count >= VMM_AREA_CAPACITY) return -1;
+    if (start >= end || end > VMM_KWINDOW_BASE || ((start | end) & (PAGE_SIZE - 1U)) != 0U) return -1;
+    dir->areas[dir->area_count].start = start;
+    dir->areas[dir->area_count].end = end;
+    dir->areas[dir->area_count].flags = flags;
+    dir->area_count++;
+    return 0;
+}
+
+static const vmm_area_t* vmm_find_area(const vmm_directory_t *dir, uint32_t address) {
+    for (uint32_t i = 0U; i < dir->area_count; i++) {
+        if (address >= dir->areas[i].start && address < dir->areas[i].end) return &dir->areas[i];
+    }
+    return 0;
+}
+
+// Premier accès à une page d'une zone : frame prise dans la réserve pré-zéroée.
+static int vmm_fault_in_area(vmm_directory_t *dir, uint32_t address, uint32_t error_code) {
+    const vmm_area_t* area = vmm_find_area(dir, address);
+    void* frame;
+
+    if (!area) return -1;
+    if (area->flags & VMM_AREA_GUARD) {
+        print_string_serial("VMM: acces a la zone de garde de pile\n");
+        return -3;
+    }
+    if ((error_code & PAGE_FAULT_WRITE) && !(area->flags & PAGE_WRITE)) return -1;
+
+    frame = pmm_alloc_zeroed_page();
+    if (!frame) return -2;
+    if (vmm_map_page_in_directory(dir, frame, (void*)(address & ~(PAGE_SIZE - 1U)),
+                                  PAGE_PRESENT | PAGE_USER | (area->flags & PAGE_WRITE)) != 0) {
+        pmm_free_page(frame);
+        return -2;
+    }
+    return 0;
+}
+
+int vmm_handle_page_fault(uint32_t address, uint32_t error_code) {
+    uint32_t page_addr = address & ~(PAGE_SIZE - 1U);
+    page_t* page;
+    void* shared;
+    void* copy;
+    void* window;
+
+    if (!current_directory || current_directory == kernel_directory || address >= VMM_KWINDOW_BASE) return -1;
+    if (!(error_code & PAGE_FAULT_PRESENT)) return vmm_fault_in_area(current_directory, address, error_code);
+    if (!(error_code & PAGE_FAULT_WRITE)) return -1;
+    page = vmm_get_page(address, 0, current_directory);
+    if (!page || !page->present || !page->user || !page->cow) return -1;
+
+    shared = (void*)(page->frame * PAGE_SIZE);
+    if (pmm_page_ref_count(shared) <= 1U) {
+        // Dernier propriétaire : la frame devient privée sans copie.
+        page->rw = 1;
+        page->cow = 0;
+        asm volatile ("invlpg (%0)" :: "r" (page_addr) : "memory");
+        return 0;
+    }
+
+    copy = pmm_alloc_high_page();
+    if (!copy) return -2;
+    window = vmm_kmap((uint32_t)copy, 1U);
+    if (!window) {
+        pmm_free_page(copy);
+        return -2;
+    }
+    memcpy(window, (const void*)page_addr, PAGE_SIZE);
+    (void)vmm_kunmap(window, 1U);
+
+    page->frame = (uint32_t)copy / PAGE_SIZE;
+    page->rw = 1;
+    page->cow = 0;
+    asm volatile ("invlpg (%0)" :: "r" (page_addr) : "memory");
+    (void)pmm_page_unref(shared);
+    return 0;
+}
+
+static int vmm_kwindow_slot_used(uint32_t slot) {
+    return (vmm_kwindow_used[slot / 32U] >> (slot % 32U)) & 1U;
+}
+
+static void vmm_kwindow_set_slot(uint32_t slot, int used) {
+    if (used) vmm_kwindow_used[slot / 32U] |= 1U << (slot % 32U);
+    else vmm_kwindow_used[slot / 32U] &= ~(1U << (slot % 32U));
+}
+
+void* vmm_kmap(uint32_t physaddr, uint32_t page_count) {
+    uint32_t first = 0U, run = 0U;
+    if (!kernel_directory || page_count == 0U || page_count > VMM_KWINDOW_PAGES ||
+        (physaddr & (PAGE_SIZE - 1U)) != 0U) {
+        return 0;
+    }
+    for (uint32_t slot = 0U; slot < VMM_KWINDOW_PAGES; slot++) {
+        if (vmm_kwindow_slot_used(slot)) {
+            run = 0U;
+            continue;
+        }
+        if (run == 0U) first = slot;
+        if (++run < page_count) continue;
+
+        for (uint32_t i = 0U; i < page_count; i++) {
+            uint32_t virt = VMM_KWINDOW_BASE + (first + i) * PAGE_SIZE;
+            page_t* page = vmm_get_page(virt, 0, kernel_directory);
+            if (!page) return 0;
+            page->present = 1;
+            page->rw = 1;
+            page->user = 0;
+            page->frame = physaddr / PAGE_SIZE + i;
+            vmm_kwindow_set_slot(first + i, 1);
+            asm volatile ("invlpg (%0)" :: "r" (virt) : "memory");
+        }
+        return (void*)(VMM_KWINDOW_BASE + first * PAGE_SIZE);
+    }
+    return 0;
+}
+
+int vmm_kunmap(void* virtualaddr, uint32_t page_count) {
+    uint32_t virt = (uint32_t)virtualaddr;
+    uint32_t first;
+    if (virt < VMM_KWINDOW_BASE || (virt & (PAGE_SIZE - 1U)) != 0U) return -1;
+    first = (virt - VMM_KWINDOW_BASE) / PAGE_SIZE;
+    if (first >= VMM_KWINDOW_PAGES || page_count > VMM_KWINDOW_PAGES - first) return -1;
+    for (uint32_t i = 0U; i < page_count; i++) {
+        page_t* page = vmm_get_page(virt + i * PAGE_SIZE, 0, kernel_directory);
+        if (page) {
+            page->present = 0;
+            page->frame = 0;
+        }
+        vmm_kwindow_set_slot(first + i, 0);
+        asm volatile ("invlpg (%0)" :: "r" (virt + i * PAGE_SIZE) : "memory");
+    }
+    return 0;
+}
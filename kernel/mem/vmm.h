@@ -7,6 +7,14 @@
 #define PAGE_PRESENT    0x01
 #define PAGE_WRITE      0x02
 #define PAGE_USER       0x04
+#define PAGE_LARGE      0x80    // PDE PSE : page de 4 Mio, sans table
+#define PAGE_COW        0x200   // Bit logiciel : frame partagée, copiée à la première écriture
+#define PAGE_BORROWED   0x400   // Bit logiciel : frame hors PMM (initrd), jamais rendue
+
+// Code d'erreur #PF
+#define PAGE_FAULT_PRESENT 0x01
+#define PAGE_FAULT_WRITE   0x02
+#define PAGE_FAULT_USER    0x04
 
 // Taille d'une page et nombre d'entrées par table
 #define PAGE_SIZE       4096
@@ -19,7 +27,10 @@ typedef struct {
     uint32_t user       : 1;
     uint32_t accessed   : 1;
     uint32_t dirty      : 1;
-    uint32_t unused     : 7;
+    uint32_t unused     : 4;
+    uint32_t cow        : 1;    // PAGE_COW
+    uint32_t borrowed   : 1;    // PAGE_BORROWED
+    uint32_t avail      : 1;
     uint32_t frame      : 20;
 } page_t;
 
@@ -33,8 +44,17 @@ typedef struct {
     uint32_t tablesPhysical[ENTRIES_PER_TABLE];
 } page_directory_t;
 
-// Structure pour la gestion d'un répertoire de pages par le noyau
+// Zone virtuelle peuplée à la demande (bss, pile) : pages mises à zéro au premier accès.
+#define VMM_AREA_CAPACITY 8U
+#define VMM_AREA_GUARD   0x100   // Zone de garde : tout accès est une faute réelle
 typedef struct {
+    uint32_t start;
+    uint32_t end;       // Exclu
+    uint32_t flags;     // PAGE_WRITE et/ou VMM_AREA_GUARD
+} vmm_area_t;
+
+// Structure pour la gestion d'un répertoire de pages par le noyau
+typedef struct vmm_directory {
     page_table_t** tables;
     page_directory_t* physical_dir;
     uint32_t physical_addr;
@@ -42,20 +62,49 @@ typedef struct {
     uint8_t static_storage;
     /* Bitmap des tables clonées pour un espace utilisateur ; les tables noyau restent partagées. */
     uint32_t private_table_mask[ENTRIES_PER_TABLE / 32U];
+    vmm_area_t areas[VMM_AREA_CAPACITY];
+    uint32_t area_count;
+    /* Empreinte tenue à jour au mapping : frames utilisateur présentes, tables privées. */
+    uint32_t resident_pages;
+    uint32_t table_pages;
 } vmm_directory_t;
 
 // Fonctions publiques
 void vmm_init();
 void vmm_switch_page_directory(uint32_t physical_addr);
+/* Vrai si l'identité noyau est mappée en pages PSE de 4 Mio. */
+int vmm_pse_enabled(void);
 page_t *vmm_get_page(uint32_t address, int make, vmm_directory_t *dir);
 /* Retourne 0 après mapping ; négatif si une table privée ne peut pas être obtenue. */
 int vmm_map_page_in_directory(vmm_directory_t *dir, void *physaddr, void *virtualaddr, uint32_t flags);
-/* Libère uniquement un répertoire utilisateur inactif et ses pages marquées utilisateur. */
+/* Retire une page utilisateur : la frame perd la référence du mapping (sauf
+ * PAGE_BORROWED, qui n'en porte pas).
+ * 0 si une page était présente, -1 sinon. Pas de shootdown : seul le TLB du
+ * CPU courant est invalidé ; smp_tlb_shootdown() avant de rendre les frames
+ * d'un espace qui tourne peut-être ailleurs. */
+int vmm_unmap_page_in_directory(vmm_directory_t *dir, void *virtualaddr);
+/* Déclare une zone peuplée à la demande (bornes alignées sur la page) ; -1 si invalide ou table pleine. */
+int vmm_add_area(vmm_directory_t *dir, uint32_t start, uint32_t end, uint32_t flags);
+/* Résout un #PF de l'espace courant : page d'une zone à la demande ou écriture
+ * copy-on-write. 0 si l'accès peut être rejoué ; négatif si la faute est réelle. */
+int vmm_handle_page_fault(uint32_t address, uint32_t error_code);
+/* Libère uniquement un répertoire utilisateur inactif ; les pages utilisateur
+ * partagées ne perdent qu'une référence. */
 int vmm_destroy_user_directory(vmm_directory_t *dir);
+/* Fenêtre noyau : rend visible une plage physique (ex. frames hautes) à une adresse
+ * supérieure à 0xC0000000 ; NULL si la fenêtre est pleine ou l'adresse non alignée. */
+void* vmm_kmap(uint32_t physaddr, uint32_t page_count);
+int vmm_kunmap(void* virtualaddr, uint32_t page_count);
 
 // Variables globales
 extern vmm_directory_t *kernel_directory;
+#ifdef KERNEL_TEST
 extern vmm_directory_t *current_directory;
+#else
+// Répertoire chargé dans CR3 sur le CPU courant
+#include "kernel/smp.h"
+#define current_directory (smp_cpu()->directory)
+#endif
 
 // Fonctions assembleur
 extern void load_page_directory(uint32_t physical_addr);
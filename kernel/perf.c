@@ -0,0 +1,43 @@
+#include "perf.h"
+#include "mem/string.h"
+
+static os_perf_stat_t perf_table[OS_PERF_SLOT_COUNT];
+
+#if CONFIG_PERF
+void perf_begin(perf_span_t* span) {
+    span->task = current_task;
+    span->off_cpu = span->task ? span->task->perf_off_cpu : 0U;
+    span->start = perf_rdtsc();
+}
+
+void perf_end(uint32_t slot, const perf_span_t* span) {
+    uint64_t cycles = perf_rdtsc() - span->start;
+    uint32_t flags;
+    if (slot >= OS_PERF_SLOT_COUNT) return;
+    // Élue à nouveau après un schedule() : l'attente n'est pas du coût
+    if (span->task) cycles -= span->task->perf_off_cpu - span->off_cpu;
+    __asm__ volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    perf_stat_add(&perf_table[slot], cycles);
+    if (flags & 0x200U) __asm__ volatile("sti");
+}
+#endif
+
+uint32_t perf_read(uint32_t first, os_perf_stat_t* out, uint32_t count) {
+    uint32_t copied = 0U;
+    uint32_t flags;
+    while (copied < count && first + copied < OS_PERF_SLOT_COUNT) {
+        // Case par case : une IRQ ne laisse pas de copie à moitié à jour
+        __asm__ volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+        out[copied] = perf_table[first + copied];
+        if (flags & 0x200U) __asm__ volatile("sti");
+        copied++;
+    }
+    return copied;
+}
+
+void perf_reset(void) {
+    uint32_t flags;
+    __asm__ volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    memset(perf_table, 0, sizeof(perf_table));
+    if (flags & 0x200U) __asm__ volatile("sti");
+}
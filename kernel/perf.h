@@ -0,0 +1,72 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include "os_perf.h"
+#include "task/task.h"
+
+/* Profil en cycles des syscalls, IRQ et de schedule() (SYS_PERF_READ).
+ * Une mesure retire le temps où sa tâche était hors CPU : un syscall
+ * bloquant compte son coût, pas son attente. La table est globale et mise
+ * à jour sous le verrou noyau, interruptions masquées.
+ *
+ * CONFIG_PERF=0 retire toutes les mesures à la compilation. */
+#ifndef CONFIG_PERF
+#define CONFIG_PERF 1
+#endif
+
+typedef struct {
+    uint64_t start;
+    uint64_t off_cpu;       // task->perf_off_cpu au début de la mesure
+    task_t* task;
+} perf_span_t;
+
+static inline uint64_t perf_rdtsc(void) {
+    uint32_t low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+static inline uint32_t perf_hist_bucket(uint64_t cycles) {
+    uint32_t high = (uint32_t)(cycles >> 32);
+    uint32_t low = (uint32_t)cycles;
+    uint32_t bucket;
+    if (high != 0U) bucket = 63U - (uint32_t)__builtin_clz(high);
+    else if (low != 0U) bucket = 31U - (uint32_t)__builtin_clz(low);
+    else bucket = 0U;
+    return bucket < OS_PERF_HIST_BUCKETS ? bucket : OS_PERF_HIST_BUCKETS - 1U;
+}
+
+static inline void perf_stat_add(os_perf_stat_t* stat, uint64_t cycles) {
+    if (stat->count == 0U || cycles < stat->min) stat->min = cycles;
+    if (stat->count == 0U || cycles > stat->max) stat->max = cycles;
+    stat->count++;
+    stat->total += cycles;
+    stat->hist[perf_hist_bucket(cycles)]++;
+}
+
+#if CONFIG_PERF
+void perf_begin(perf_span_t* span);
+void perf_end(uint32_t slot, const perf_span_t* span);
+
+/* Bascule de contexte (task_schedule) : le temps entre les deux appels est
+ * hors CPU pour la tâche. */
+static inline void perf_switch_out(task_t* task) {
+    task->perf_switch_tsc = perf_rdtsc();
+}
+
+static inline void perf_switch_in(task_t* task) {
+    if (task->perf_switch_tsc != 0U) task->perf_off_cpu += perf_rdtsc() - task->perf_switch_tsc;
+}
+#else
+static inline void perf_begin(perf_span_t* span) { (void)span; }
+static inline void perf_end(uint32_t slot, const perf_span_t* span) { (void)slot; (void)span; }
+static inline void perf_switch_out(task_t* task) { (void)task; }
+static inline void perf_switch_in(task_t* task) { (void)task; }
+#endif
+
+/* Copie count cases à partir de first ; renvoie le nombre copié. */
+uint32_t perf_read(uint32_t first, os_perf_stat_t* out, uint32_t count);
+void perf_reset(void);
+
+#endif
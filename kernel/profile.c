@@ -0,0 +1,174 @@
+#include "profile.h"
+#include "smp.h"
+#include "timer.h"
+#include "mem/vmm.h"
+
+extern void print_string_serial(const char* str);
+extern void print_hex_serial(uint32_t n);
+extern void print_dec_serial(uint32_t n);
+extern void write_serial(char c);
+
+volatile uint32_t profile_active = 0U;
+
+static profile_ring_t profile_rings[SMP_MAX_CPUS];
+
+/* Noms des tâches échantillonnées, émis à l'arrêt : le script retrouve
+ * l'ELF de l'initrd d'un PID même après sa sortie. */
+typedef struct {
+    int32_t pid;
+    char name[16];
+} profile_task_name_t;
+
+static profile_task_name_t profile_names[PROFILE_TASK_NAMES];
+static uint32_t profile_name_count = 0U;
+static uint32_t profile_emitted = 0U;   // Échantillons vidés depuis le démarrage
+
+static void profile_note_task(const task_t* task) {
+    profile_task_name_t* entry;
+    uint32_t i;
+    for (i = 0U; i < profile_name_count; i++) {
+        if (profile_names[i].pid == task->id) return;
+    }
+    if (profile_name_count == PROFILE_TASK_NAMES) return;
+    entry = &profile_names[profile_name_count++];
+    entry->pid = task->id;
+    for (i = 0U; i + 1U < sizeof(entry->name) && task->name[i]; i++) entry->name[i] = task->name[i];
+    entry->name[i] = '\0';
+}
+
+/* Cadre [ebp] = EBP appelant, [ebp + 4] = retour, lisible dans [low, high).
+ * En Ring 3 (dir), les deux mots doivent être sur une page utilisateur. */
+static int profile_frame_ok(uint32_t ebp, uint32_t low, uint32_t high, vmm_directory_t* dir) {
+    page_t* page;
+    if (ebp < low || high < 8U || ebp > high - 8U || (ebp & 3U) != 0U) return 0;
+    if (!dir) return 1;
+    if ((ebp & (PAGE_SIZE - 1U)) > PAGE_SIZE - 8U) return 0;
+    page = vmm_get_page(ebp, 0, dir);
+    return page && page->present && page->user;
+}
+
+static uint32_t profile_walk(uint32_t* pc, uint32_t depth, uint32_t ebp, uint32_t low, uint32_t high,
+                             vmm_directory_t* dir) {
+    while (depth < PROFILE_DEPTH && profile_frame_ok(ebp, low, high, dir)) {
+        const uint32_t* frame = (const uint32_t*)ebp;
+        if (frame[1] == 0U) break;
+        pc[depth++] = frame[1];
+        // L'appelant est plus haut sur la pile : un cadre qui redescend clôt la chaîne
+        if (frame[0] <= ebp) break;
+        ebp = frame[0];
+    }
+    return depth;
+}
+
+void profile_sample(const cpu_state_t* cpu) {
+    cpu_t* self = smp_cpu();
+    task_t* task = current_task;
+    profile_ring_t* ring = &profile_rings[self->index];
+    profile_sample_t* sample = profile_ring_reserve(ring);
+    uint32_t depth = 1U;
+    if (!sample) return;
+    sample->pid = task ? task->id : -1;
+    sample->cpu = (uint8_t)self->index;
+    sample->user = (uint8_t)((cpu->cs & 3U) == 3U);
+    sample->pc[0] = cpu->eip;
+    if (sample->user && task && task->vmm_dir) {
+        depth = profile_walk(sample->pc, depth, cpu->ebp, cpu->useresp, 0xC0000000U, task->vmm_dir);
+    } else if (CONFIG_PROFILE_FRAMES) {
+        // Interruption en Ring 0 : ESP interrompu juste au-dessus d'EFLAGS
+        uint32_t low = (uint32_t)&cpu->useresp;
+        uint32_t high = (low | (PAGE_SIZE - 1U)) + 1U;
+        // Pile noyau statique d'une tâche Ring 3 (4 Kio), sinon la page d'ESP
+        if (task && task->kernel_stack_p > low && task->kernel_stack_p - low <= 4096U) {
+            high = task->kernel_stack_p;
+        }
+        depth = profile_walk(sample->pc, depth, cpu->ebp, low, high, 0);
+    }
+    sample->depth = (uint8_t)depth;
+    if (task) profile_note_task(task);
+    profile_ring_publish(ring);
+}
+
+int profile_start(uint32_t multiplier) {
+    uint32_t cpu;
+    if (multiplier == 0U || multiplier > OS_PROFILE_MAX_MULTIPLIER) return -1;
+    // Une session relancée repart de zéro : les restes sont vidés d'abord
+    if (profile_active) (void)profile_stop();
+    for (cpu = 0U; cpu < SMP_MAX_CPUS; cpu++) {
+        profile_rings[cpu].drained = profile_rings[cpu].head;
+        profile_rings[cpu].dropped = 0U;
+    }
+    profile_name_count = 0U;
+    profile_emitted = 0U;
+    print_string_serial("PROF-START ");
+    print_dec_serial(TIMER_FREQUENCY * multiplier);
+    write_serial('\n');
+    timer_set_irq0_multiplier(multiplier);
+    profile_active = 1U;
+    return 0;
+}
+
+static void profile_print_sample(const profile_sample_t* sample) {
+    uint32_t i;
+    print_string_serial("PROF ");
+    print_dec_serial(sample->cpu);
+    write_serial(' ');
+    if (sample->pid < 0) write_serial('-');
+    else print_dec_serial((uint32_t)sample->pid);
+    print_string_serial(sample->user ? " u" : " k");
+    for (i = 0U; i < sample->depth && i < PROFILE_DEPTH; i++) {
+        write_serial(' ');
+        print_hex_serial(sample->pc[i]);
+    }
+    write_serial('\n');
+}
+
+/* L'échantillon est copié et son slot rendu avant l'impression, IRQ
+ * masquées : le vidage d'inactivité, préemptible, et celui de l'arrêt ne
+ * l'impriment jamais deux fois. */
+uint32_t profile_drain_serial(uint32_t budget) {
+    profile_sample_t sample;
+    uint32_t printed = 0U;
+    uint32_t cpu, flags;
+    int claimed;
+    for (cpu = 0U; cpu < SMP_MAX_CPUS && printed < budget; cpu++) {
+        profile_ring_t* ring = &profile_rings[cpu];
+        while (printed < budget) {
+            claimed = 0;
+            __asm__ volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+            if (ring->drained != ring->head) {
+                sample = ring->samples[ring->drained & PROFILE_RING_MASK];
+                ring->drained++;
+                profile_emitted++;
+                claimed = 1;
+            }
+            if (flags & 0x200U) __asm__ volatile("sti");
+            if (!claimed) break;
+            profile_print_sample(&sample);
+            printed++;
+        }
+    }
+    return printed;
+}
+
+int profile_stop(void) {
+    uint32_t dropped = 0U;
+    uint32_t cpu, i;
+    if (!profile_active) return -1;
+    profile_active = 0U;
+    timer_set_irq0_multiplier(1U);
+    (void)profile_drain_serial(0xFFFFFFFFU);
+    for (cpu = 0U; cpu < SMP_MAX_CPUS; cpu++) dropped += profile_rings[cpu].dropped;
+    for (i = 0U; i < profile_name_count; i++) {
+        print_string_serial("PROF-TASK ");
+        print_dec_serial((uint32_t)profile_names[i].pid);
+        write_serial(' ');
+        print_string_serial(profile_names[i].name);
+        write_serial('\n');
+    }
+    print_string_serial("PROF-END ");
+    print_dec_serial(profile_emitted);
+    write_serial(' ');
+    print_dec_serial(dropped);
+    write_serial('\n');
+    return (int)profile_emitted;
+}
@@ -0,0 +1,68 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "task/task.h"
+
+/* Profilage par échantillonnage (SYS_PROFILE) : à chaque IRQ0 (BSP) ou
+ * timer LAPIC (AP), le CPU note l'EIP interrompu, la tâche courante et les
+ * adresses de retour lisibles le long de la chaîne EBP. Les échantillons
+ * vont dans l'anneau du CPU, vidé sur le port série par la boucle
+ * d'inactivité du BSP et à l'arrêt de la session ; scripts/profile_symbolize.py
+ * les symbolise. Anneau plein : l'échantillon est perdu et compté.
+ *
+ * La pile noyau n'est remontée qu'avec CONFIG_PROFILE_FRAMES (make
+ * PROFILE_FRAMES=1, qui garde le pointeur de cadre) ; les programmes Ring 3,
+ * compilés sans optimisation, l'ont toujours. */
+#ifndef CONFIG_PROFILE_FRAMES
+#define CONFIG_PROFILE_FRAMES 0
+#endif
+
+#define PROFILE_DEPTH 6U             // EIP interrompu + 5 appelants
+#define PROFILE_RING_SAMPLES 1024U   // Puissance de deux
+#define PROFILE_RING_MASK (PROFILE_RING_SAMPLES - 1U)
+#define PROFILE_TASK_NAMES 32U
+
+typedef struct {
+    int32_t pid;            // -1 hors tâche
+    uint8_t cpu;
+    uint8_t user;           // 1 : EIP Ring 3
+    uint8_t depth;          // Entrées valides de pc
+    uint8_t reserved;
+    uint32_t pc[PROFILE_DEPTH];
+} profile_sample_t;
+
+typedef struct {
+    volatile uint32_t head;       // Écrit par le CPU propriétaire (IRQ)
+    volatile uint32_t drained;    // Écrit par le vidage série
+    uint32_t dropped;
+    profile_sample_t samples[PROFILE_RING_SAMPLES];
+} profile_ring_t;
+
+extern volatile uint32_t profile_active;
+
+/* IRQ timer, verrou noyau tenu. */
+void profile_sample(const cpu_state_t* cpu);
+/* multiplier : IRQ0 par tick pendant la session (1 à OS_PROFILE_MAX_MULTIPLIER). */
+int profile_start(uint32_t multiplier);
+/* Arrête la session et vide tout ; renvoie le nombre d'échantillons. */
+int profile_stop(void);
+/* Écrit au plus budget échantillons sur le port série ; renvoie leur nombre. */
+uint32_t profile_drain_serial(uint32_t budget);
+
+/* Slot du prochain échantillon, NULL (et compté perdu) si l'anneau est
+ * plein ; l'appelant le remplit puis le publie. */
+static inline profile_sample_t* profile_ring_reserve(profile_ring_t* ring) {
+    if (ring->head - ring->drained >= PROFILE_RING_SAMPLES) {
+        ring->dropped++;
+        return 0;
+    }
+    return &ring->samples[ring->head & PROFILE_RING_MASK];
+}
+
+static inline void profile_ring_publish(profile_ring_t* ring) {
+    __asm__ volatile("" : : : "memory");
+    ring->head++;
+}
+
+#endif
@@ -0,0 +1,224 @@
+#include "shm.h"
+#include "service_registry.h"
+#include "kernel/mem/pmm.h"
+#include "kernel/smp.h"
+
+static shm_region_t shm_regions[SHM_REGION_CAPACITY];
+
+static void shm_copy_name(char* destination, const char* source) {
+    uint32_t i;
+    if (!source) source = "";
+    for (i = 0U; i < OS_SERVICE_NAME_MAX; i++) {
+        destination[i] = source[i];
+        if (source[i] == '\0') {
+            for (i++; i < OS_SERVICE_NAME_MAX; i++) destination[i] = '\0';
+            return;
+        }
+    }
+}
+
+static shm_region_t* shm_lookup(uint32_t id) {
+    if (id == 0U || id > SHM_REGION_CAPACITY || shm_regions[id - 1U].owner_pid == 0) return 0;
+    return &shm_regions[id - 1U];
+}
+
+/* Un service transféré ou retiré gèle la région : plus de droit ni de
+ * mapping neufs. Une région anonyme n'en accorde jamais. */
+static int shm_owner_holds_service(const shm_region_t* region) {
+    if (region->name[0] == '\0') return 0;
+    return service_registry_lookup(region->name) == region->owner_pid;
+}
+
+static shm_grant_t* shm_find_grant(shm_region_t* region, int32_t pid) {
+    uint32_t i;
+    for (i = 0U; i < SHM_GRANT_CAPACITY; i++) {
+        if (region->grants[i].pid == pid) return &region->grants[i];
+    }
+    return 0;
+}
+
+static void shm_unmap_from(const shm_region_t* region, uint32_t id, vmm_directory_t* dir) {
+    uint8_t* base = (uint8_t*)os_shm_address(id);
+    uint32_t i;
+    for (i = 0U; i < region->page_count; i++) (void)vmm_unmap_page_in_directory(dir, base + i * PAGE_SIZE);
+    // La région garde sa référence : aucune frame n'est rendue avant la fin du shootdown
+    smp_tlb_shootdown(dir);
+}
+
+/* Chaque page mappée prend sa propre référence : la frame survit à la
+ * région tant qu'un espace la voit encore. */
+static int shm_map_into(const shm_region_t* region, uint32_t id, vmm_directory_t* dir, int writable) {
+    uint8_t* base = (uint8_t*)os_shm_address(id);
+    uint32_t flags = PAGE_PRESENT | PAGE_USER | (writable ? PAGE_WRITE : 0U);
+    uint32_t i;
+    for (i = 0U; i < region->page_count; i++) {
+        if (pmm_page_ref(region->frames[i]) != 0) break;
+        if (vmm_map_page_in_directory(dir, region->frames[i], base + i * PAGE_SIZE, flags) != 0) {
+            (void)pmm_page_unref(region->frames[i]);
+            break;
+        }
+    }
+    if (i == region->page_count) return 0;
+    while (i > 0U) {
+        i--;
+        (void)vmm_unmap_page_in_directory(dir, base + i * PAGE_SIZE);
+    }
+    return OS_SHM_NO_MEMORY;
+}
+
+static void shm_destroy(shm_region_t* region, uint32_t id) {
+    uint32_t i;
+    for (i = 0U; i < SHM_GRANT_CAPACITY; i++) {
+        if (region->grants[i].mapped) shm_unmap_from(region, id, region->grants[i].mapped);
+        region->grants[i].pid = 0;
+        region->grants[i].rights = 0U;
+        region->grants[i].mapped = 0;
+    }
+    if (region->owner_dir) shm_unmap_from(region, id, region->owner_dir);
+    for (i = 0U; i < region->page_count; i++) {
+        (void)pmm_page_unref(region->frames[i]);
+        region->frames[i] = 0;
+    }
+    region->owner_pid = 0;
+    region->owner_dir = 0;
+    region->name[0] = '\0';
+    region->page_count = 0U;
+}
+
+void shm_init(void) {
+    uint32_t i, j;
+    for (i = 0U; i < SHM_REGION_CAPACITY; i++) {
+        shm_regions[i].owner_pid = 0;
+        shm_regions[i].owner_dir = 0;
+        shm_regions[i].name[0] = '\0';
+        shm_regions[i].page_count = 0U;
+        for (j = 0U; j < OS_SHM_REGION_MAX_PAGES; j++) shm_regions[i].frames[j] = 0;
+        for (j = 0U; j < SHM_GRANT_CAPACITY; j++) {
+            shm_regions[i].grants[j].pid = 0;
+            shm_regions[i].grants[j].rights = 0U;
+            shm_regions[i].grants[j].mapped = 0;
+        }
+    }
+}
+
+int shm_create(const char* name, int32_t owner_pid, vmm_directory_t* owner_dir, uint32_t page_count) {
+    shm_region_t* region = 0;
+    uint32_t i;
+    uint32_t id = 0U;
+    int named = name && name[0] != '\0';
+    if ((named && !service_registry_name_valid(name)) || owner_pid <= 0 || !owner_dir ||
+        page_count == 0U || page_count > OS_SHM_REGION_MAX_PAGES) return OS_SHM_BAD_ARGUMENT;
+    if (named && service_registry_lookup(name) != owner_pid) return OS_SERVICE_NOT_OWNER;
+    for (i = 0U; i < SHM_REGION_CAPACITY; i++) {
+        if (shm_regions[i].owner_pid == 0) {
+            region = &shm_regions[i];
+            id = i + 1U;
+            break;
+        }
+    }
+    if (!region) return OS_SHM_FULL;
+    for (i = 0U; i < page_count; i++) {
+        region->frames[i] = pmm_alloc_zeroed_page();
+        if (!region->frames[i]) break;
+    }
+    region->owner_pid = owner_pid;
+    region->page_count = i;
+    shm_copy_name(region->name, name);
+    if (i != page_count || shm_map_into(region, id, owner_dir, 1) != 0) {
+        shm_destroy(region, id);
+        return OS_SHM_NO_MEMORY;
+    }
+    region->owner_dir = owner_dir;
+    return (int)id;
+}
+
+int shm_grant(uint32_t id, int32_t owner_pid, int32_t grantee_pid, uint32_t rights) {
+    shm_region_t* region = shm_lookup(id);
+    shm_grant_t* grant;
+    if (!region || grantee_pid <= 0 || grantee_pid == owner_pid || rights == 0U ||
+        (rights & ~SERVICE_BACKEND_RIGHT_ALL) != 0U) return OS_SHM_BAD_ARGUMENT;
+    if (region->owner_pid != owner_pid || !shm_owner_holds_service(region)) return OS_SERVICE_NOT_OWNER;
+    grant = shm_find_grant(region, grantee_pid);
+    if (!grant) grant = shm_find_grant(region, 0);
+    if (!grant) return OS_SHM_FULL;
+    if (grant->pid == grantee_pid && grant->rights != rights && grant->mapped) {
+        vmm_directory_t* dir = grant->mapped;
+        shm_unmap_from(region, id, dir);
+        grant->mapped = 0;
+        if (shm_map_into(region, id, dir, (rights & SERVICE_BACKEND_RIGHT_MUTATE) != 0U) == 0) {
+            grant->mapped = dir;
+        }
+    }
+    grant->pid = grantee_pid;
+    grant->rights = rights;
+    return 0;
+}
+
+int shm_revoke(uint32_t id, int32_t owner_pid, int32_t grantee_pid) {
+    shm_region_t* region = shm_lookup(id);
+    shm_grant_t* grant;
+    if (!region || grantee_pid <= 0) return OS_SHM_BAD_ARGUMENT;
+    if (region->owner_pid != owner_pid) return OS_SERVICE_NOT_OWNER;
+    grant = shm_find_grant(region, grantee_pid);
+    if (!grant) return OS_SERVICE_NOT_FOUND;
+    if (grant->mapped) shm_unmap_from(region, id, grant->mapped);
+    grant->pid = 0;
+    grant->rights = 0U;
+    grant->mapped = 0;
+    return 0;
+}
+
+int shm_map(uint32_t id, int32_t pid, vmm_directory_t* dir) {
+    shm_region_t* region = shm_lookup(id);
+    shm_grant_t* grant;
+    int rc;
+    if (!region || pid <= 0 || !dir) return OS_SHM_BAD_ARGUMENT;
+    if (region->owner_pid == pid) return 0;
+    grant = shm_find_grant(region, pid);
+    if (!grant || !shm_owner_holds_service(region)) return OS_SHM_DENIED;
+    if (grant->mapped) return 0;
+    rc = shm_map_into(region, id, dir, (grant->rights & SERVICE_BACKEND_RIGHT_MUTATE) != 0U);
+    if (rc == 0) grant->mapped = dir;
+    return rc;
+}
+
+int shm_release(uint32_t id, int32_t pid) {
+    shm_region_t* region = shm_lookup(id);
+    shm_grant_t* grant;
+    if (!region || pid <= 0) return OS_SHM_BAD_ARGUMENT;
+    if (region->owner_pid == pid) {
+        shm_destroy(region, id);
+        return 0;
+    }
+    grant = shm_find_grant(region, pid);
+    if (!grant) return OS_SHM_DENIED;
+    if (grant->mapped) shm_unmap_from(region, id, grant->mapped);
+    grant->pid = 0;
+    grant->rights = 0U;
+    grant->mapped = 0;
+    return 0;
+}
+
+void shm_remove_pid(int32_t pid) {
+    uint32_t i;
+    if (pid <= 0) return;
+    for (i = 0U; i < SHM_REGION_CAPACITY; i++) {
+        if (shm_regions[i].owner_pid == 0) continue;
+        (void)shm_release(i + 1U, pid);
+    }
+}
+
+void* shm_writable_page(uint32_t id, int32_t pid, uint32_t index) {
+    shm_region_t* region = shm_lookup(id);
+    shm_grant_t* grant;
+    if (!region || pid <= 0 || index >= region->page_count) return 0;
+    if (region->owner_pid != pid) {
+        grant = shm_find_grant(region, pid);
+        if (!grant || !grant->mapped || (grant->rights & SERVICE_BACKEND_RIGHT_MUTATE) == 0U) return 0;
+    }
+    return region->frames[index];
+}
+
+const shm_region_t* shm_region(uint32_t id) {
+    return shm_lookup(id);
+}
@@ -0,0 +1,50 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include <stdint.h>
+#include "os_syscalls.h"
+#include "kernel/mem/vmm.h"
+
+/* Régions de mémoire partagée entre tâches. Une région appartient au
+ * détenteur d'un service (service_registry) : ses droits suivent le modèle
+ * des capacités backend, lecture seule (SERVICE_BACKEND_RIGHT_READ) ou
+ * lecture-écriture (en plus SERVICE_BACKEND_RIGHT_MUTATE). Les frames gardent
+ * une référence pour la région et une par mapping ; la fenêtre virtuelle est
+ * fixe par identifiant (os_shm_address). Sans nom, la région est anonyme :
+ * privée à son créateur, sans contrôle de service. */
+#define SHM_REGION_CAPACITY OS_SHM_REGION_CAPACITY
+#define SHM_GRANT_CAPACITY 4U
+
+typedef struct {
+    int32_t pid;               // 0 : libre
+    uint32_t rights;
+    vmm_directory_t* mapped;   // Espace où la région est mappée, NULL sinon
+} shm_grant_t;
+
+typedef struct {
+    int32_t owner_pid;         // 0 : région libre
+    vmm_directory_t* owner_dir;
+    char name[OS_SERVICE_NAME_MAX];
+    uint32_t page_count;
+    void* frames[OS_SHM_REGION_MAX_PAGES];
+    shm_grant_t grants[SHM_GRANT_CAPACITY];
+} shm_region_t;
+
+void shm_init(void);
+/* Crée et mappe chez le propriétaire ; renvoie l'identifiant (> 0). */
+int shm_create(const char* name, int32_t owner_pid, vmm_directory_t* owner_dir, uint32_t page_count);
+/* Ajoute ou modifie un droit ; une baisse vers la lecture seule remappe. */
+int shm_grant(uint32_t id, int32_t owner_pid, int32_t grantee_pid, uint32_t rights);
+int shm_revoke(uint32_t id, int32_t owner_pid, int32_t grantee_pid);
+/* Mappe chez le propriétaire ou un bénéficiaire ; idempotent. */
+int shm_map(uint32_t id, int32_t pid, vmm_directory_t* dir);
+int shm_release(uint32_t id, int32_t pid);
+/* Sortie d'une tâche, avant la destruction de son espace : détruit ses
+ * régions et oublie ses droits. */
+void shm_remove_pid(int32_t pid);
+/* Frame (identité noyau) de la page index si pid écrit dans la région :
+ * créateur ou bénéficiaire mappé avec SERVICE_BACKEND_RIGHT_MUTATE. */
+void* shm_writable_page(uint32_t id, int32_t pid, uint32_t index);
+const shm_region_t* shm_region(uint32_t id);
+
+#endif
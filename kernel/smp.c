@@ -0,0 +1,502 @@
+#include "smp.h"
+#include "gdt.h"
+#include "idt.h"
+#include "timer.h"
+#include "task/task.h"
+#include "mem/vmm.h"
+#include "mem/string.h"
+
+// Fonctions externes
+extern void print_string_serial(const char* str);
+extern void print_hex_serial(uint32_t n);
+extern void outb(unsigned short port, unsigned char data);
+extern void idt_load(struct idt_ptr* idtp);
+extern struct idt_ptr idtp;
+
+// Trampoline (boot/ap_trampoline.s), recopié en mémoire basse
+extern uint8_t ap_trampoline_start[];
+extern uint8_t ap_trampoline_params[];
+extern uint8_t ap_trampoline_end[];
+#define AP_TRAMPOLINE_BASE 0x8000U
+
+// Registres du LAPIC (décalages MMIO)
+#define LAPIC_ID          0x020U
+#define LAPIC_TPR         0x080U
+#define LAPIC_EOI         0x0B0U
+#define LAPIC_SVR         0x0F0U
+#define LAPIC_ICR_LOW     0x300U
+#define LAPIC_ICR_HIGH    0x310U
+#define LAPIC_LVT_TIMER   0x320U
+#define LAPIC_TIMER_INIT  0x380U
+#define LAPIC_TIMER_CUR   0x390U
+#define LAPIC_TIMER_DIV   0x3E0U
+
+#define LAPIC_SVR_ENABLE      0x100U
+#define LAPIC_ICR_INIT        0x00000500U
+#define LAPIC_ICR_STARTUP     0x00000600U
+#define LAPIC_ICR_PENDING     0x00001000U
+#define LAPIC_ICR_ASSERT      0x00004000U
+#define LAPIC_ICR_LEVEL       0x00008000U
+#define LAPIC_LVT_MASKED      0x00010000U
+#define LAPIC_TIMER_PERIODIC  0x00020000U
+#define LAPIC_TIMER_DIV_16    0x3U
+
+#define SMP_CPUID_EDX_APIC (1U << 9)
+#define SMP_AP_STACK_SIZE 8192U
+#define SMP_AP_BOOT_TICKS 20U        // 200 ms à 100 Hz par AP
+#define SMP_CALIBRATE_TICKS 5U
+// Tables firmware sous 1 Mio : déjà en identité ; au-delà, vues par vmm_kmap()
+#define SMP_LOW_MEMORY_LIMIT 0x100000U
+
+/* Paramètres du trampoline : même ordre que le bloc de boot/ap_trampoline.s. */
+typedef struct {
+    struct {
+        uint16_t limit;
+        uint32_t base;
+    } __attribute__((packed)) gdt;
+    uint16_t pad;
+    uint32_t cr0;
+    uint32_t cr3;
+    uint32_t cr4;
+    uint32_t stack;
+    uint32_t entry;
+    uint32_t index;
+} __attribute__((packed)) ap_trampoline_params_t;
+
+cpu_t smp_cpus[SMP_MAX_CPUS];
+volatile uint32_t smp_online_cpus = 1U;
+
+static volatile uint32_t smp_kernel_lock_owner = 0U;   // 0 libre, sinon index CPU + 1
+static volatile uint32_t* smp_lapic = 0;
+static uint32_t smp_lapic_phys = 0U;
+static uint32_t smp_lapic_ids[SMP_MAX_CPUS];
+static uint32_t smp_lapic_found = 0U;
+static uint32_t smp_lapic_timer_count = 0U;            // Décompte LAPIC par tick PIT
+static uint32_t smp_lapic_oneshot_count[SMP_MAX_CPUS];  // Décompte initial du coup armé
+static uint8_t smp_ap_stacks[SMP_MAX_CPUS][SMP_AP_STACK_SIZE] __attribute__((aligned(16)));
+
+// ---------------------------------------------------------------------------
+// Verrou global du noyau
+// ---------------------------------------------------------------------------
+
+// Shootdown reçu pendant l'attente du verrou, ou IPI : le CR3 courant est rechargé
+static void smp_tlb_flush_pending(cpu_t* cpu) {
+    uint32_t cr3;
+    if (!cpu->tlb_flush_pending) return;
+    __asm__ volatile("mov %%cr3, %0; mov %0, %%cr3" : "=r"(cr3) : : "memory");
+    cpu->tlb_flush_pending = 0U;
+}
+
+void smp_kernel_enter(void) {
+    cpu_t* cpu = smp_cpu();
+    uint32_t me = cpu->index + 1U;
+    if (smp_kernel_lock_owner == me) {
+        cpu->kernel_lock_depth++;
+        return;
+    }
+    cpu->lock_waiting = 1U;
+    while (__sync_val_compare_and_swap(&smp_kernel_lock_owner, 0U, me) != 0U) {
+        __asm__ volatile("pause");
+    }
+    cpu->lock_waiting = 0U;
+    cpu->kernel_lock_depth = 1U;
+    smp_tlb_flush_pending(cpu);
+}
+
+void smp_kernel_leave(void) {
+    cpu_t* cpu = smp_cpu();
+    if (smp_kernel_lock_owner != cpu->index + 1U) return;
+    if (--cpu->kernel_lock_depth == 0U) __sync_lock_release(&smp_kernel_lock_owner);
+}
+
+void smp_kernel_release_all(void) {
+    cpu_t* cpu = smp_cpu();
+    if (smp_kernel_lock_owner != cpu->index + 1U) return;
+    cpu->kernel_lock_depth = 0U;
+    __sync_lock_release(&smp_kernel_lock_owner);
+}
+
+void smp_kernel_relax(void) {
+    cpu_t* cpu = smp_cpu();
+    uint32_t depth;
+    if (smp_kernel_lock_owner != cpu->index + 1U) return;
+    depth = cpu->kernel_lock_depth;
+    smp_kernel_release_all();
+    __asm__ volatile("pause");
+    smp_kernel_enter();
+    cpu->kernel_lock_depth = depth;
+}
+
+// ---------------------------------------------------------------------------
+// LAPIC
+// ---------------------------------------------------------------------------
+
+static inline uint32_t lapic_read(uint32_t reg) {
+    return smp_lapic[reg / 4U];
+}
+
+static inline void lapic_write(uint32_t reg, uint32_t value) {
+    smp_lapic[reg / 4U] = value;
+    (void)smp_lapic[LAPIC_ID / 4U];   // Relecture : écriture postée achevée
+}
+
+void smp_lapic_eoi(void) {
+    if (smp_lapic) lapic_write(LAPIC_EOI, 0U);
+}
+
+static void smp_lapic_enable(void) {
+    lapic_write(LAPIC_TPR, 0U);
+    lapic_write(LAPIC_SVR, LAPIC_SVR_ENABLE | SMP_SPURIOUS_VECTOR);
+}
+
+static void smp_lapic_ipi(uint32_t apic_id, uint32_t command) {
+    lapic_write(LAPIC_ICR_HIGH, apic_id << 24);
+    lapic_write(LAPIC_ICR_LOW, command);
+    while (lapic_read(LAPIC_ICR_LOW) & LAPIC_ICR_PENDING) __asm__ volatile("pause");
+}
+
+// Environ 1 µs par écriture sur le port POST
+static void smp_udelay(uint32_t us) {
+    while (us-- > 0U) outb(0x80, 0);
+}
+
+/* Étalonne le timer LAPIC (même horloge de bus sur tous les CPU) contre IRQ0. */
+static void smp_lapic_calibrate(void) {
+    uint32_t start;
+    lapic_write(LAPIC_TIMER_DIV, LAPIC_TIMER_DIV_16);
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED | SMP_LAPIC_TIMER_VECTOR);
+    start = timer_get_ticks();
+    while (timer_get_ticks() == start) __asm__ volatile("hlt");
+    lapic_write(LAPIC_TIMER_INIT, 0xFFFFFFFFU);
+    timer_wait(SMP_CALIBRATE_TICKS);
+    smp_lapic_timer_count = (0xFFFFFFFFU - lapic_read(LAPIC_TIMER_CUR)) / SMP_CALIBRATE_TICKS;
+    lapic_write(LAPIC_TIMER_INIT, 0U);
+    if (smp_lapic_timer_count == 0U) smp_lapic_timer_count = 1U;
+}
+
+// Timer périodique au rythme d'IRQ0 : quantum des tâches Ring 3 des AP
+void smp_lapic_timer_start(void) {
+    lapic_write(LAPIC_TIMER_DIV, LAPIC_TIMER_DIV_16);
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_TIMER_PERIODIC | SMP_LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INIT, smp_lapic_timer_count);
+}
+
+int smp_lapic_timer_stop(void) {
+    if (!smp_lapic) return 0;
+    lapic_write(LAPIC_LVT_TIMER, LAPIC_LVT_MASKED | SMP_LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INIT, 0U);
+    return 1;
+}
+
+uint32_t smp_lapic_oneshot(uint32_t ticks) {
+    uint32_t index = smp_cpu()->index;
+    if (!smp_lapic || ticks == 0U) return 0U;
+    if (ticks > 0xFFFFFFFFU / smp_lapic_timer_count) ticks = 0xFFFFFFFFU / smp_lapic_timer_count;
+    smp_lapic_oneshot_count[index] = ticks * smp_lapic_timer_count;
+    lapic_write(LAPIC_TIMER_DIV, LAPIC_TIMER_DIV_16);
+    lapic_write(LAPIC_LVT_TIMER, SMP_LAPIC_TIMER_VECTOR);
+    lapic_write(LAPIC_TIMER_INIT, smp_lapic_oneshot_count[index]);
+    return ticks;
+}
+
+uint32_t smp_lapic_oneshot_stop(void) {
+    uint32_t index = smp_cpu()->index;
+    uint32_t remaining;
+    if (!smp_lapic) return 0U;
+    // Décompte à 0 une fois le coup tiré : tout l'intervalle est écoulé
+    remaining = lapic_read(LAPIC_TIMER_CUR);
+    smp_lapic_timer_stop();
+    return (smp_lapic_oneshot_count[index] - remaining) / smp_lapic_timer_count;
+}
+
+void smp_send_reschedule(cpu_t* cpu) {
+    if (!smp_lapic || !cpu->online) return;
+    smp_lapic_ipi(cpu->lapic_id, LAPIC_ICR_ASSERT | SMP_RESCHEDULE_VECTOR);
+}
+
+void smp_tlb_shootdown(struct vmm_directory* dir) {
+    cpu_t* self = smp_cpu();
+    uint32_t i;
+    if (!smp_lapic || !dir) return;
+    for (i = 0U; i < SMP_MAX_CPUS; i++) {
+        cpu_t* cpu = &smp_cpus[i];
+        if (cpu == self || !cpu->online || cpu->directory != dir) continue;
+        cpu->tlb_flush_pending = 1U;
+        __sync_synchronize();
+        smp_lapic_ipi(cpu->lapic_id, LAPIC_ICR_ASSERT | SMP_TLB_SHOOTDOWN_VECTOR);
+    }
+    for (i = 0U; i < SMP_MAX_CPUS; i++) {
+        cpu_t* cpu = &smp_cpus[i];
+        if (cpu == self) continue;
+        while (cpu->tlb_flush_pending && !cpu->lock_waiting) __asm__ volatile("pause");
+    }
+}
+
+// Sans verrou noyau : l'émetteur le tient pendant son attente
+void smp_tlb_shootdown_handler(void) {
+    smp_tlb_flush_pending(smp_cpu());
+    smp_lapic_eoi();
+}
+
+// ---------------------------------------------------------------------------
+// Découverte : ACPI MADT, sinon table MP Intel
+// ---------------------------------------------------------------------------
+
+static uint32_t smp_page_span(uint32_t phys, uint32_t length) {
+    return ((phys & (PAGE_SIZE - 1U)) + length + PAGE_SIZE - 1U) / PAGE_SIZE;
+}
+
+static const uint8_t* smp_map(uint32_t phys, uint32_t length) {
+    uint8_t* base;
+    if (phys < SMP_LOW_MEMORY_LIMIT && length <= SMP_LOW_MEMORY_LIMIT - phys) {
+        return (const uint8_t*)phys;
+    }
+    base = (uint8_t*)vmm_kmap(phys & ~(PAGE_SIZE - 1U), smp_page_span(phys, length));
+    return base ? base + (phys & (PAGE_SIZE - 1U)) : 0;
+}
+
+static void smp_unmap(const uint8_t* view, uint32_t phys, uint32_t length) {
+    if (!view || (phys < SMP_LOW_MEMORY_LIMIT && length <= SMP_LOW_MEMORY_LIMIT - phys)) return;
+    (void)vmm_kunmap((void*)((uint32_t)view & ~(PAGE_SIZE - 1U)), smp_page_span(phys, length));
+}
+
+static int smp_checksum_ok(const uint8_t* data, uint32_t length) {
+    uint8_t sum = 0U;
+    for (uint32_t i = 0U; i < length; i++) sum = (uint8_t)(sum + data[i]);
+    return sum == 0U;
+}
+
+static uint32_t smp_read32(const uint8_t* data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+// Structures flottantes alignées sur 16 octets, en mémoire basse
+static const uint8_t* smp_scan(uint32_t start, uint32_t length, const char* signature,
+                               uint32_t checksum_length) {
+    for (uint32_t addr = start; addr + checksum_length <= start + length; addr += 16U) {
+        const uint8_t* candidate = (const uint8_t*)addr;
+        if (memcmp(candidate, signature, 4U) == 0 && smp_checksum_ok(candidate, checksum_length)) {
+            return candidate;
+        }
+    }
+    return 0;
+}
+
+static uint32_t smp_ebda_base(void) {
+    uint32_t bda_ebda = 0x40EU;       // Segment de l'EBDA dans la BDA
+    uint32_t ebda;
+    __asm__("" : "+r"(bda_ebda));      // Adresse < 4 Kio : masque -Warray-bounds
+    ebda = (uint32_t)(*(volatile const uint16_t*)bda_ebda) << 4;
+    return ebda >= 0x80000U && ebda < 0xA0000U ? ebda : 0U;
+}
+
+static void smp_add_lapic(uint32_t apic_id) {
+    for (uint32_t i = 0U; i < smp_lapic_found; i++) {
+        if (smp_lapic_ids[i] == apic_id) return;
+    }
+    if (smp_lapic_found < SMP_MAX_CPUS) smp_lapic_ids[smp_lapic_found++] = apic_id;
+}
+
+static int smp_parse_madt(const uint8_t* madt, uint32_t length) {
+    uint32_t offset = 44U;
+    if (length < offset) return 0;
+    smp_lapic_phys = smp_read32(madt + 36);
+    while (offset + 2U <= length) {
+        uint8_t type = madt[offset];
+        uint8_t entry_length = madt[offset + 1U];
+        if (entry_length < 2U || offset + entry_length > length) break;
+        // Type 0 : LAPIC d'un processeur (bit 0 des drapeaux : activé)
+        if (type == 0U && entry_length >= 8U && (smp_read32(madt + offset + 4U) & 1U)) {
+            smp_add_lapic(madt[offset + 3U]);
+        }
+        // Type 5 : adresse LAPIC 64 bits (on garde les 32 bits bas)
+        if (type == 5U && entry_length >= 12U) smp_lapic_phys = smp_read32(madt + offset + 4U);
+        offset += entry_length;
+    }
+    return smp_lapic_found > 0U;
+}
+
+static int smp_discover_acpi(void) {
+    const uint8_t* rsdp = 0;
+    const uint8_t* rsdt;
+    uint32_t ebda = smp_ebda_base();
+    uint32_t rsdt_phys, rsdt_length, entries;
+    int found = 0;
+
+    if (ebda) rsdp = smp_scan(ebda, 1024U, "RSD PTR ", 20U);
+    if (!rsdp) rsdp = smp_scan(0xE0000U, 0x20000U, "RSD PTR ", 20U);
+    if (!rsdp || memcmp(rsdp + 4, "PTR ", 4U) != 0) return 0;
+
+    rsdt_phys = smp_read32(rsdp + 16);
+    rsdt = smp_map(rsdt_phys, 36U);
+    if (!rsdt) return 0;
+    rsdt_length = memcmp(rsdt, "RSDT", 4U) == 0 ? smp_read32(rsdt + 4) : 0U;
+    smp_unmap(rsdt, rsdt_phys, 36U);
+    if (rsdt_length < 36U) return 0;
+
+    rsdt = smp_map(rsdt_phys, rsdt_length);
+    if (!rsdt) return 0;
+    entries = smp_checksum_ok(rsdt, rsdt_length) ? (rsdt_length - 36U) / 4U : 0U;
+    for (uint32_t i = 0U; i < entries && !found; i++) {
+        uint32_t table_phys = smp_read32(rsdt + 36U + i * 4U);
+        const uint8_t* table = smp_map(table_phys, 36U);
+        uint32_t table_length;
+        if (!table) continue;
+        table_length = memcmp(table, "APIC", 4U) == 0 ? smp_read32(table + 4) : 0U;
+        smp_unmap(table, table_phys, 36U);
+        if (table_length < 44U) continue;
+        table = smp_map(table_phys, table_length);
+        if (!table) continue;
+        if (smp_checksum_ok(table, table_length)) found = smp_parse_madt(table, table_length);
+        smp_unmap(table, table_phys, table_length);
+    }
+    smp_unmap(rsdt, rsdt_phys, rsdt_length);
+    return found;
+}
+
+static int smp_discover_mp(void) {
+    const uint8_t* floating = 0;
+    const uint8_t* config;
+    uint32_t ebda = smp_ebda_base();
+    uint32_t config_phys, config_length, offset, count;
+
+    if (ebda) floating = smp_scan(ebda, 1024U, "_MP_", 16U);
+    if (!floating) floating = smp_scan(0x9FC00U, 1024U, "_MP_", 16U);
+    if (!floating) floating = smp_scan(0xF0000U, 0x10000U, "_MP_", 16U);
+    if (!floating) return 0;
+    // Configurations par défaut (pointeur nul) : non gérées, on reste mono-CPU
+    config_phys = smp_read32(floating + 4);
+    if (!config_phys) return 0;
+
+    config = smp_map(config_phys, 44U);
+    if (!config) return 0;
+    config_length = memcmp(config, "PCMP", 4U) == 0 ? (uint32_t)config[4] | ((uint32_t)config[5] << 8) : 0U;
+    smp_unmap(config, config_phys, 44U);
+    if (config_length < 44U) return 0;
+
+    config = smp_map(config_phys, config_length);
+    if (!config) return 0;
+    if (smp_checksum_ok(config, config_length)) {
+        smp_lapic_phys = smp_read32(config + 36);
+        count = (uint32_t)config[34] | ((uint32_t)config[35] << 8);
+        offset = 44U;
+        for (uint32_t i = 0U; i < count && offset < config_length; i++) {
+            // Type 0 : processeur, 20 octets ; les autres entrées de base font 8 octets
+            if (config[offset] == 0U) {
+                if (offset + 20U <= config_length && (config[offset + 3U] & 1U)) {
+                    smp_add_lapic(config[offset + 1U]);
+                }
+                offset += 20U;
+            } else if (config[offset] <= 4U) {
+                offset += 8U;
+            } else {
+                break;
+            }
+        }
+    }
+    smp_unmap(config, config_phys, config_length);
+    return smp_lapic_found > 0U;
+}
+
+static int smp_cpu_has_apic(void) {
+    uint32_t eax = 1U, ebx, ecx = 0U, edx;
+    __asm__ volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return (edx & SMP_CPUID_EDX_APIC) != 0U;
+}
+
+// ---------------------------------------------------------------------------
+// Démarrage des AP
+// ---------------------------------------------------------------------------
+
+void smp_ap_main(uint32_t index) {
+    cpu_t* cpu = &smp_cpus[index];
+
+    gdt_init_cpu(index);
+    idt_load(&idtp);
+    __asm__ volatile("fninit");
+    smp_lapic_enable();
+
+    smp_kernel_enter();
+    cpu->directory = kernel_directory;
+    if (!task_create_idle(index)) {
+        print_string_serial("SMP: slot de tache indisponible pour l'AP\n");
+        smp_kernel_leave();
+        for (;;) __asm__ volatile("cli; hlt");
+    }
+    smp_lapic_timer_start();
+    cpu->online = 1U;
+    smp_online_cpus++;
+    smp_kernel_leave();
+
+    // Inactivité sans tick : l'IPI de replanification ou le vol réveille l'AP
+    for (;;) timer_idle_wait();
+}
+
+static int smp_start_ap(uint32_t index, uint32_t apic_id) {
+    ap_trampoline_params_t* params = (ap_trampoline_params_t*)(AP_TRAMPOLINE_BASE +
+        (uint32_t)(ap_trampoline_params - ap_trampoline_start));
+    cpu_t* cpu = &smp_cpus[index];
+    uint32_t value, start;
+
+    cpu->lapic_id = apic_id;
+    cpu->online = 0U;
+    __asm__ volatile("sgdt %0" : "=m"(params->gdt));
+    __asm__ volatile("mov %%cr0, %0" : "=r"(value));
+    params->cr0 = value;
+    params->cr3 = kernel_directory->physical_addr;
+    __asm__ volatile("mov %%cr4, %0" : "=r"(value));
+    params->cr4 = value;
+    params->stack = (uint32_t)&smp_ap_stacks[index][SMP_AP_STACK_SIZE];
+    params->entry = (uint32_t)smp_ap_main;
+    params->index = index;
+
+    // INIT, 10 ms, puis deux SIPI (vecteur = page du trampoline)
+    smp_lapic_ipi(apic_id, LAPIC_ICR_INIT | LAPIC_ICR_ASSERT | LAPIC_ICR_LEVEL);
+    timer_wait(2U);
+    for (uint32_t attempt = 0U; attempt < 2U; attempt++) {
+        smp_lapic_ipi(apic_id, LAPIC_ICR_STARTUP | (AP_TRAMPOLINE_BASE >> 12));
+        smp_udelay(200U);
+    }
+
+    start = timer_get_ticks();
+    while (!cpu->online && timer_get_ticks() - start < SMP_AP_BOOT_TICKS) __asm__ volatile("hlt");
+    return cpu->online != 0U;
+}
+
+void smp_init(void) {
+    uint32_t bsp_id, index = 1U;
+
+    if (!smp_cpu_has_apic() || (!smp_discover_acpi() && !smp_discover_mp())) {
+        print_string_serial("SMP: aucun LAPIC decrit, mono-processeur\n");
+        return;
+    }
+    // Fenêtre noyau partagée : le même mapping sert à tous les CPU (chaque LAPIC
+    // répond à la même adresse). La plage est non cacheable via les MTRR du firmware.
+    smp_lapic = (volatile uint32_t*)vmm_kmap(smp_lapic_phys & ~(PAGE_SIZE - 1U), 1U);
+    if (!smp_lapic) {
+        print_string_serial("SMP: LAPIC non mappable\n");
+        return;
+    }
+    smp_lapic_enable();
+    bsp_id = lapic_read(LAPIC_ID) >> 24;
+    smp_cpus[0].lapic_id = bsp_id;
+    smp_lapic_calibrate();
+
+    memcpy((void*)AP_TRAMPOLINE_BASE, ap_trampoline_start,
+           (uint32_t)(ap_trampoline_end - ap_trampoline_start));
+    for (uint32_t i = 0U; i < smp_lapic_found && index < SMP_MAX_CPUS; i++) {
+        if (smp_lapic_ids[i] == bsp_id) continue;
+        // Un AP muet pourrait encore lire les paramètres : on n'en démarre pas d'autre
+        if (!smp_start_ap(index, smp_lapic_ids[i])) {
+            print_string_serial("SMP: AP sans reponse, LAPIC ");
+            print_hex_serial(smp_lapic_ids[i]);
+            print_string_serial("\n");
+            break;
+        }
+        index++;
+    }
+    print_string_serial("SMP: CPU en ligne: ");
+    print_hex_serial(smp_online_cpus);
+    print_string_serial("\n");
+}
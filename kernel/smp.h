@@ -0,0 +1,79 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include <stdint.h>
+#include "kernel/task/runq.h"
+
+/* Multiprocesseur : découverte des LAPIC (ACPI MADT, sinon table MP Intel),
+ * démarrage des AP par INIT-SIPI-SIPI et état propre à chaque CPU.
+ * Le descripteur GDT 0x30 de chaque CPU a pour base son cpu_t : %gs:0 donne
+ * le bloc courant sans lire le LAPIC. */
+#define SMP_MAX_CPUS 8U
+#define SMP_PERCPU_SELECTOR 0x30
+#define SMP_LAPIC_TIMER_VECTOR 0x40
+#define SMP_RESCHEDULE_VECTOR 0x41
+#define SMP_TLB_SHOOTDOWN_VECTOR 0x42
+#define SMP_SPURIOUS_VECTOR 0xFF
+
+struct task;
+struct vmm_directory;
+
+typedef struct cpu {
+    struct cpu* self;                  // Doit rester en tête : lu par smp_cpu()
+    uint32_t index;                    // 0 = BSP
+    uint32_t lapic_id;
+    volatile uint32_t online;
+    struct task* task;                 // current_task (kernel/task/task.h)
+    struct vmm_directory* directory;   // current_directory (kernel/mem/vmm.h)
+    struct task* idle_task;            // Élue quand la file locale est vide
+    struct task* deferred_reap;        // Tâche terminée à libérer hors de sa pile
+    runq_t runq;
+    uint32_t last_preempt_tick;
+    uint32_t kernel_lock_depth;
+    uint32_t idle_timer;               // Sommeil sans tick en cours (timer.c)
+    volatile uint32_t lock_waiting;    // Attend le verrou noyau, interruptions possiblement coupées
+    volatile uint32_t tlb_flush_pending; // CR3 à recharger (smp_tlb_shootdown)
+} cpu_t;
+
+extern cpu_t smp_cpus[SMP_MAX_CPUS];
+extern volatile uint32_t smp_online_cpus;
+
+static inline cpu_t* smp_cpu(void) {
+    cpu_t* cpu;
+    __asm__ volatile("movl %%gs:0, %0" : "=r"(cpu));
+    return cpu;
+}
+
+/* BSP, interruptions actives et timer PIT programmé : démarre les AP trouvés. */
+void smp_init(void);
+/* Point d'entrée C d'un AP, appelé par le trampoline sur sa pile de démarrage. */
+void smp_ap_main(uint32_t index);
+void smp_lapic_eoi(void);
+/* Timer LAPIC du CPU courant. start : périodique au rythme d'IRQ0 ; stop
+ * renvoie 0 sans LAPIC. oneshot arme un coup dans `ticks` ticks (borné,
+ * valeur retenue renvoyée, 0 sans LAPIC) ; oneshot_stop l'arrête et renvoie
+ * les ticks entiers écoulés depuis l'armement. */
+void smp_lapic_timer_start(void);
+int smp_lapic_timer_stop(void);
+uint32_t smp_lapic_oneshot(uint32_t ticks);
+uint32_t smp_lapic_oneshot_stop(void);
+/* IPI de replanification : tire un CPU endormi sans tick de son hlt. */
+void smp_send_reschedule(cpu_t* cpu);
+/* Invalide le TLB de tout autre CPU dont `dir` est l'espace chargé et
+ * attend qu'il l'ait fait, avant que l'appelant rende les frames démappées.
+ * Un CPU bloqué sur le verrou noyau (tenu par l'appelant) recharge CR3 en
+ * le prenant, sans retour en Ring 3 entre les deux. */
+void smp_tlb_shootdown(struct vmm_directory* dir);
+void smp_tlb_shootdown_handler(void);
+
+/* Verrou global du noyau, récursif par CPU : pris à chaque entrée (stubs
+ * d'interruption et de syscall), rendu au retour. Il reste au CPU pendant
+ * switch_to() ; seule la profondeur change avec la tâche élue. */
+void smp_kernel_enter(void);
+void smp_kernel_leave(void);
+void smp_kernel_release_all(void);
+/* Point de respiration d'une attente longue dans le noyau : rend le verrou
+ * le temps d'une pause, puis le reprend à la même profondeur. */
+void smp_kernel_relax(void);
+
+#endif
@@ -9,20 +9,37 @@
 #include "../mem/string.h"
 #include "../mem/vmm.h"
 #include "../mem/pmm.h"
+#include "../mem/heap.h"
 #include "../timer.h"
 #include "../llm/gpt2_infer.h"
 #include "../llm/gpt2_gguf_infer.h"
 #include "../llm/gpt2_model.h"
 #include "../llm/gpt2_tokenizer.h"
 #include "../service_registry.h"
+#include "../shm.h"
+#include "../deferred.h"
+#include "../trace.h"
+#include "../perf.h"
+#include "../profile.h"
+#include "../smp.h"
 #include "../fs/fat16.h"
 #include "../fs/fat32.h"
 #include "../net_socket.h"
+#include "os_batch.h"
 /* Completions locales : BPE, top-k basse temperature, arret newline/EOT/repetition. */
 #define GPT2_BAREMETAL_GENERATION_STEPS 12U
+/* Frames mises à zéro par SYS_YIELD quand aucune autre tâche n'est prête. */
+#define SYSCALL_ZERO_POOL_BATCH 4U
+/* Moteur GPT-2 déjà utilisé par une autre tâche vivante. */
+#define SYSCALL_GPT2_BUSY (-7)
+
+/* Cadre local d'une entrée SYS_BATCH (sélecteur de code nul) : les envois
+ * groupés ne cèdent pas le CPU un par un. */
+#define SYSCALL_BATCH_FRAME(cpu) ((cpu)->cs == 0U)
+static void syscall_dispatch(cpu_state_t* cpu);
+static int syscall_user_range(const void* pointer, uint32_t length, int write);
 
 // Externs VMM
-extern vmm_directory_t* current_directory;
 extern void vmm_switch_page_directory(uint32_t phys_addr);
 
 // Fonctions externes
@@ -37,7 +54,6 @@ extern int kernel_llm_poll_sse(os_llm_text_result_t* result);
 extern int kernel_llm_reset_for_request(void);
 extern int kernel_llm_close(void);
 extern int kernel_llm_configure_openai(const os_llm_openai_credential_request_t* request);
-extern int kernel_llm_dhcp_maintenance(uint32_t now);
 extern void print_char(char c, int x, int y, char color);
 extern void write_serial(char c);
 
@@ -54,7 +70,7 @@ static void service_notify_change(const char* name, int32_t old_owner_pid,
         task_t* watcher = get_task_by_id(watchers[i]);
         if (!watcher || watcher->type != TASK_TYPE_USER || watcher->state == TASK_TERMINATED) continue;
         /* Best effort non bloquant : une boîte pleine ne retarde jamais un changement de registre. */
-        (void)ipc_endpoint_send(&watcher->ipc_endpoint, 0, &payload);
+        (void)task_ipc_deliver(watcher, 0, &payload);
     }
 }
 
@@ -69,29 +85,84 @@ static void service_notify_purge_pid(int32_t pid) {
     }
 }
 
+/* Termine la tâche courante et planifie la suivante ; ne retourne pas.
+ * Partagé par SYS_EXIT et par les fautes utilisateur non résolues. */
+void syscall_exit_current(cpu_state_t* cpu, int exit_code, uint32_t reason) {
+    service_notify_purge_pid(current_task->id);
+    service_registry_backend_remove_pid(current_task->id);
+    (void)service_registry_remove_watcher_pid(current_task->id);
+    task_report_parent_exit(current_task, exit_code, reason);
+    task_wake_waiter(current_task);
+    task_reparent_children(current_task);
+    task_set_state(current_task, TASK_TERMINATED);
+    TRACE(TRACE_LEVEL_EVENT, OS_TRACE_TASK_EXIT, current_task->id, exit_code, reason);
+    schedule(cpu);
+}
+
 // ==============================================================================
 // GESTIONNAIRE D'APPELS SYSTÈME
 // ==============================================================================
 
 void syscall_handler(cpu_state_t* cpu) {
+    uint32_t number = cpu->eax;   // EAX devient le résultat
+    perf_span_t span;
+    perf_begin(&span);
+
+    /* Tuée par un autre CPU pendant qu'elle tournait ici : son CPU la quitte
+     * au lieu de servir l'appel. */
+    if (current_task->state == TASK_TERMINATED) schedule(cpu);
+
     // Réactive les interruptions pour permettre au clavier de fonctionner
     asm volatile("sti");
 
-    /* Maintenance réseau différée : aucune E/S DHCP n’est réalisée dans IRQ0. */
-    (void)kernel_llm_dhcp_maintenance(timer_get_ticks());
+    /* Un syscall abandonné (tâche tuée en cours d'appel) n'a pas vidé l'arène. */
+    task_scratch_reset(current_task);
+
+    /* Travail différé échu (maintenance DHCP) : un seul mot lu sinon. */
+    if (deferred_work_pending) (void)deferred_work_run(timer_get_ticks());
+
+    syscall_dispatch(cpu);
+
+    // Tuée depuis un autre CPU pendant l'appel : elle ne revient pas en Ring 3
+    if (current_task->state == TASK_TERMINATED) schedule(cpu);
+
+    // Les temporaires du syscall ne survivent pas au retour en Ring 3
+    task_scratch_reset(current_task);
+    if (number < MAX_SYSCALLS) perf_end(OS_PERF_SLOT_SYSCALL(number), &span);
+}
+
+/* Entrée SYSENTER (boot/isr_stubs.s) : EBP désigne le cadre du stub
+ * utilisateur (os_vsyscall_frame_t). Le cadre noyau devient celui d'un
+ * INT 0x80 fait à la sortie du stub : EIP = retour, ESP au-dessus du cadre.
+ * Renvoie 1 si SYSEXIT suffit (le stub restaure ECX et EDX), 0 pour IRET
+ * quand l'appel a rendu ECX/EDX (réponse courte IPC). */
+int syscall_sysenter_handler(cpu_state_t* cpu) {
+    const os_vsyscall_frame_t* stub = (const os_vsyscall_frame_t*)cpu->ebp;
+    uint32_t ecx = cpu->ecx;
+    uint32_t edx = cpu->edx;
+    uint32_t resume;
+    // Un cadre illisible est une faute du programme, comme en page fault
+    if (!syscall_user_range(stub, sizeof(*stub), 0)) {
+        syscall_exit_current(cpu, OS_TASK_EXIT_KILLED, OS_TASK_EVENT_KILLED);
+        return 0;
+    }
+    resume = stub->resume;
+    cpu->eip = stub->ret;
+    cpu->useresp = (uint32_t)(stub + 1);
+    cpu->ebp = stub->ebp;
+    syscall_handler(cpu);
+    if (cpu->ecx != ecx || cpu->edx != edx) return 0;
+    cpu->ecx = (uint32_t)&stub->ebp;
+    cpu->edx = resume;
+    return 1;
+}
 
-    // Le numéro de syscall est dans le registre EAX
+/* Le numéro de syscall est dans EAX, le résultat y revient. SYS_BATCH
+ * repasse ici avec un cadre local par entrée. */
+static void syscall_dispatch(cpu_state_t* cpu) {
     switch (cpu->eax) {
         case SYS_EXIT:
-            service_notify_purge_pid(current_task->id);
-            service_registry_backend_remove_pid(current_task->id);
-            (void)service_registry_remove_watcher_pid(current_task->id);
-            task_report_parent_exit(current_task, (int)cpu->ebx, OS_TASK_EVENT_EXITED);
-            task_wake_waiter(current_task);
-            task_reparent_children(current_task);
-            current_task->state = TASK_TERMINATED;
-            print_string_serial("[EXIT] task terminated, scheduling...\n");
-            schedule(cpu);
+            syscall_exit_current(cpu, (int)cpu->ebx, OS_TASK_EVENT_EXITED);
             break;
         
         case SYS_PUTC:
@@ -108,15 +179,9 @@ void syscall_handler(cpu_state_t* cpu) {
                 asm volatile("sti");
                 
                 // Lecture clavier (ASCII)
+                // Lecture tracée par keyboard_getc (OS_TRACE_GETC)
                 char c = keyboard_getc();
                 cpu->eax = c;
-                
-                // Log uniquement si caractère non nul pour éviter le bruit
-                if (c != 0) {
-                    print_string_serial("SYS_GETC: caractère retourné: '");
-                    write_serial(c);
-                    print_string_serial("'\n");
-                }
             }
             break;
             
@@ -138,9 +203,10 @@ void syscall_handler(cpu_state_t* cpu) {
             break;
             
         case SYS_YIELD:
-            /* Cooperative switch from the int 0x80 user frame (safe).
-             * Nested int 0x30 / IRQ0 is not used: that frame has no SS/ESP. */
+            /* schedule() revient à la réélection de la tâche ; eax est déjà posé. */
             cpu->eax = 0;
+            /* Personne d'autre à servir : le temps rendu remplit la réserve de frames zéro. */
+            if (!task_has_other_ready_user()) (void)pmm_zero_pool_refill(SYSCALL_ZERO_POOL_BATCH);
             schedule(cpu);
             break;
             
@@ -150,21 +216,19 @@ void syscall_handler(cpu_state_t* cpu) {
             break;
             
         case SYS_EXEC:
-            print_string_serial("[EXEC] starting child\n");
             {
                 int rc = sys_exec((const char*)cpu->ebx, (char**)cpu->ecx);
                 cpu->eax = (uint32_t)rc;
+                TRACE(TRACE_LEVEL_EVENT, OS_TRACE_EXEC, rc, 0, 0);
                 if (rc >= 0) {
-                    print_string_serial("[EXEC] waiting for child\n");
-                    current_task->state = TASK_WAITING;
+                    task_set_state(current_task, TASK_WAITING);
                     schedule(cpu);
                 }
             }
             break;
         case SYS_SPAWN:
-            print_string_serial("[SPAWN] starting child\n");
             cpu->eax = sys_spawn((const char*)cpu->ebx, (char**)cpu->ecx);
-            print_string_serial("[SPAWN] child created\n");
+            TRACE(TRACE_LEVEL_EVENT, OS_TRACE_SPAWN, cpu->eax, 0, 0);
             if ((int)cpu->eax >= 0) {
                 schedule(cpu);
             }
@@ -187,9 +251,26 @@ void syscall_handler(cpu_state_t* cpu) {
         case SYS_TICKS:
             cpu->eax = sys_ticks();
             break;
+        /* Un message déjà en boîte écourte le sommeil comme un message reçu :
+         * aucun réveil n'est perdu entre SYS_IPC_RECV et SYS_SLEEP. */
+        case SYS_SLEEP:
+            if (cpu->ebx == 0U) {
+                schedule(cpu);
+            } else if (current_task->ipc_endpoint.count == 0U) {
+                timer_block_until(TASK_SLEEPING, timer_get_ticks() + timer_ms_to_ticks(cpu->ebx), NULL);
+            }
+            cpu->eax = timer_get_ticks();
+            break;
+        case SYS_SLEEP_UNTIL:
+            if (current_task->ipc_endpoint.count == 0U) timer_block_until(TASK_SLEEPING, cpu->ebx, NULL);
+            cpu->eax = timer_get_ticks();
+            break;
         case SYS_MEMINFO:
             cpu->eax = (uint32_t)sys_meminfo((os_meminfo_t*)cpu->ebx);
             break;
+        case SYS_MEMSTATS:
+            cpu->eax = (uint32_t)sys_memstats((os_memstats_t*)cpu->ebx);
+            break;
         case SYS_TASK_METRICS:
             cpu->eax = (uint32_t)sys_task_metrics((int)cpu->ebx, (os_task_metrics_t*)cpu->ecx);
             break;
@@ -431,14 +512,67 @@ void syscall_handler(cpu_state_t* cpu) {
         case SYS_IPC_SEND:
             cpu->eax = (uint32_t)sys_ipc_send((int)cpu->ebx,
                                                (const os_ipc_payload_t*)cpu->ecx);
-            /* Le shell dort ensuite dans SYS_GETS (Ring 0) et ne peut pas être
-             * préempté par IRQ0. Un handoff coopératif livre donc sans délai un
-             * message à une autre tâche utilisateur déjà prête. */
-            if ((int)cpu->eax == 0 && task_has_other_ready_user()) schedule(cpu);
+            /* Handoff coopératif : le destinataire prêt traite le message sans
+             * attendre la fin du quantum de l'émetteur. */
+            if ((int)cpu->eax == 0 && !SYSCALL_BATCH_FRAME(cpu) && task_has_other_ready_user()) schedule(cpu);
             break;
         case SYS_IPC_RECV:
             cpu->eax = (uint32_t)sys_ipc_receive((os_ipc_message_t*)cpu->ebx);
             break;
+        case SYS_IPC_RECV_WAIT:
+            cpu->eax = (uint32_t)sys_ipc_receive_wait((os_ipc_message_t*)cpu->ebx,
+                                                      (const os_ipc_filter_t*)cpu->ecx, cpu->edx);
+            break;
+        case SYS_IPC_CALL:
+            cpu->eax = (uint32_t)sys_ipc_call((int)cpu->ebx, (const os_ipc_payload_t*)cpu->ecx,
+                                              (os_ipc_message_t*)cpu->edx, cpu->esi, cpu);
+            break;
+        case SYS_IPC_REPLY_WAIT:
+            cpu->eax = (uint32_t)sys_ipc_reply_wait((int)cpu->ebx, (const os_ipc_payload_t*)cpu->ecx,
+                                                    (os_ipc_message_t*)cpu->edx, cpu->esi, cpu);
+            break;
+        case SYS_SHM_CREATE:
+            cpu->eax = (uint32_t)sys_shm_create((const char*)cpu->ebx, cpu->ecx);
+            break;
+        case SYS_SHM_GRANT:
+            cpu->eax = (uint32_t)sys_shm_grant(cpu->ebx, (int)cpu->ecx, cpu->edx);
+            break;
+        case SYS_SHM_REVOKE:
+            cpu->eax = (uint32_t)sys_shm_revoke(cpu->ebx, (int)cpu->ecx);
+            break;
+        case SYS_SHM_MAP:
+            cpu->eax = (uint32_t)sys_shm_map(cpu->ebx);
+            break;
+        case SYS_SHM_RELEASE:
+            cpu->eax = (uint32_t)sys_shm_release(cpu->ebx);
+            break;
+        case SYS_DOORBELL_WAIT:
+            cpu->eax = (uint32_t)sys_doorbell_wait(cpu->ebx);
+            break;
+        case SYS_DOORBELL_RING:
+            cpu->eax = (uint32_t)sys_doorbell_ring((int)cpu->ebx);
+            break;
+        case SYS_EVENT_RING:
+            cpu->eax = (uint32_t)sys_event_ring(cpu->ebx);
+            break;
+        case SYS_BATCH:
+            cpu->eax = (uint32_t)sys_batch(cpu->ebx);
+            // Handoff coopératif de SYS_IPC_SEND, une fois pour tout le lot
+            if ((int)cpu->eax > 0 && task_has_other_ready_user()) schedule(cpu);
+            break;
+        case SYS_TRACE_READ:
+            cpu->eax = (uint32_t)sys_trace_read((os_trace_record_t*)cpu->ebx, cpu->ecx);
+            break;
+        case SYS_PERF_READ:
+            cpu->eax = (uint32_t)sys_perf_read(cpu->ebx, (os_perf_stat_t*)cpu->ecx, cpu->edx);
+            break;
+        case SYS_PERF_RESET:
+            perf_reset();
+            cpu->eax = 0;
+            break;
+        case SYS_PROFILE:
+            cpu->eax = (uint32_t)(cpu->ebx != 0U ? profile_start(cpu->ebx) : profile_stop());
+            break;
         case SYS_SERVICE_REGISTER:
             cpu->eax = (uint32_t)sys_service_register((const char*)cpu->ebx);
             break;
@@ -556,7 +690,8 @@ void syscall_handler(cpu_state_t* cpu) {
     }
 }
 
-int sys_ipc_send(int target_pid, const os_ipc_payload_t* payload) {
+/* Cible Ring 3 vivante ; un service publié sature avant la capacité brute. */
+static int sys_ipc_target(int target_pid, const os_ipc_payload_t* payload, task_t** out) {
     task_t* target;
     if (!current_task || !payload || payload->size > OS_IPC_MAX_DATA) {
         return OS_IPC_BAD_MESSAGE;
@@ -569,7 +704,15 @@ int sys_ipc_send(int target_pid, const os_ipc_payload_t* payload) {
         target->ipc_endpoint.count >= IPC_SERVICE_ENDPOINT_CAPACITY) {
         return OS_IPC_SERVICE_FULL;
     }
-    return ipc_endpoint_send(&target->ipc_endpoint, current_task->id, payload);
+    *out = target;
+    return 0;
+}
+
+int sys_ipc_send(int target_pid, const os_ipc_payload_t* payload) {
+    task_t* target;
+    int rc = sys_ipc_target(target_pid, payload, &target);
+    if (rc != 0) return rc;
+    return task_ipc_deliver(target, current_task->id, payload);
 }
 
 int sys_ipc_receive(os_ipc_message_t* out) {
@@ -579,6 +722,70 @@ int sys_ipc_receive(os_ipc_message_t* out) {
     return ipc_endpoint_receive(&current_task->ipc_endpoint, out);
 }
 
+/* Attente commune, filtre déjà posé. Avec frame, un message court arrive dans
+ * les registres de l'appelant (task_ipc_deliver) ; le premier blocage cède le
+ * CPU à handoff. */
+static int sys_ipc_wait(os_ipc_message_t* out, uint32_t timeout_ms, cpu_state_t* frame,
+                        task_t* handoff) {
+    task_t* task = current_task;
+    uint32_t deadline = timer_get_ticks() + timer_ms_to_ticks(timeout_ms);
+    int rc;
+    for (;;) {
+        rc = ipc_endpoint_receive_matching(&task->ipc_endpoint, &task->ipc_wait_filter, out);
+        if (rc != OS_IPC_EMPTY || timeout_ms == 0U) return rc;
+        if (timeout_ms != OS_IPC_WAIT_FOREVER && (int32_t)(deadline - timer_get_ticks()) <= 0) {
+            return OS_IPC_EMPTY;
+        }
+        task->ipc_frame = frame;
+        if (timeout_ms == OS_IPC_WAIT_FOREVER) task_block(TASK_WAITING_FOR_IPC, handoff);
+        else timer_block_until(TASK_WAITING_FOR_IPC, deadline, handoff);
+        if (frame && !task->ipc_frame) return (int)frame->eax;
+        task->ipc_frame = NULL;
+        handoff = NULL;
+    }
+}
+
+/* Le filtre est copié dans la tâche : task_ipc_deliver() le compare à chaque
+ * dépôt pour décider du réveil. */
+int sys_ipc_receive_wait(os_ipc_message_t* out, const os_ipc_filter_t* filter, uint32_t timeout_ms) {
+    task_t* task = current_task;
+    if (!task || task->type != TASK_TYPE_USER || !out) return OS_IPC_BAD_MESSAGE;
+    if (filter) task->ipc_wait_filter = *filter;
+    else task->ipc_wait_filter.match = 0U;
+    return sys_ipc_wait(out, timeout_ms, NULL, NULL);
+}
+
+int sys_ipc_call(int target_pid, const os_ipc_payload_t* request, os_ipc_message_t* out,
+                 uint32_t timeout_ms, cpu_state_t* frame) {
+    task_t* task = current_task;
+    task_t* target;
+    int rc;
+    if (!task || task->type != TASK_TYPE_USER || !out) return OS_IPC_BAD_MESSAGE;
+    rc = sys_ipc_target(target_pid, request, &target);
+    if (rc != 0) return rc;
+    // Filtre posé avant l'envoi : le service peut répondre avant notre blocage
+    task->ipc_wait_filter.match = OS_IPC_MATCH_SENDER | OS_IPC_MATCH_REQUEST;
+    task->ipc_wait_filter.sender_pid = target_pid;
+    task->ipc_wait_filter.request_id = request->request_id;
+    rc = task_ipc_deliver(target, task->id, request);
+    if (rc != 0) return rc;
+    return sys_ipc_wait(out, timeout_ms, frame, target);
+}
+
+/* Un client parti ou saturé perd sa réponse ; le serveur attend la suite. */
+int sys_ipc_reply_wait(int client_pid, const os_ipc_payload_t* reply, os_ipc_message_t* out,
+                       uint32_t timeout_ms, cpu_state_t* frame) {
+    task_t* task = current_task;
+    task_t* client = NULL;
+    if (!task || task->type != TASK_TYPE_USER || !out) return OS_IPC_BAD_MESSAGE;
+    task->ipc_wait_filter.match = 0U;
+    if (client_pid > 0 && sys_ipc_target(client_pid, reply, &client) == 0 &&
+        task_ipc_deliver(client, task->id, reply) != 0) {
+        client = NULL;
+    }
+    return sys_ipc_wait(out, timeout_ms, frame, client);
+}
+
 int sys_task_supervision_notify(uint32_t enabled) {
     if (!current_task || current_task->type != TASK_TYPE_USER) return OS_TASK_NOT_FOUND;
     return task_set_supervision_notify(current_task->id, enabled);
@@ -685,8 +892,17 @@ static int syscall_user_range(const void* pointer, uint32_t length, int write) {
     if (start >= 0xc0000000U || end >= 0xc0000000U) return 0;
     for (address = start & ~(PAGE_SIZE - 1U); ; address += PAGE_SIZE) {
         page = vmm_get_page(address, 0, current_task->vmm_dir);
+        // Page jamais touchée d'une zone (pile, bss) : on la peuple comme le ferait le #PF.
+        if ((!page || !page->present) && current_task->vmm_dir == current_directory &&
+            vmm_handle_page_fault(address, PAGE_FAULT_USER | (write ? PAGE_FAULT_WRITE : 0U)) == 0) {
+            page = vmm_get_page(address, 0, current_task->vmm_dir);
+        }
+        // Tampon d'écriture sur une page partagée : copie privée avant que le noyau y écrive.
+        if (write && page && page->present && page->cow && current_task->vmm_dir == current_directory) {
+            (void)vmm_handle_page_fault(address, PAGE_FAULT_PRESENT | PAGE_FAULT_WRITE | PAGE_FAULT_USER);
+        }
         if (!page || !page->present || !page->user || (write && !page->rw)) return 0;
-        if (address > end - (end % PAGE_SIZE)) break;
+        if (address >= end - (end % PAGE_SIZE)) break;
         if (address > 0xffffffffU - PAGE_SIZE) return 0;
     }
     return 1;
@@ -756,6 +972,177 @@ int sys_socket_close(int socket_id) {
     return net_socket_close(socket_id);
 }
 
+int sys_shm_create(const char* name, uint32_t page_count) {
+    if (!current_task || current_task->type != TASK_TYPE_USER) return OS_SHM_BAD_ARGUMENT;
+    return shm_create(name, current_task->id, current_task->vmm_dir, page_count);
+}
+
+int sys_shm_grant(uint32_t id, int target_pid, uint32_t rights) {
+    task_t* target;
+    if (!current_task || current_task->type != TASK_TYPE_USER) return OS_SHM_BAD_ARGUMENT;
+    target = get_task_by_id(target_pid);
+    if (!target || target->type != TASK_TYPE_USER || target->state == TASK_TERMINATED) return OS_SERVICE_BAD_GRANTEE;
+    return shm_grant(id, current_task->id, target_pid, rights);
+}
+
+int sys_shm_revoke(uint32_t id, int target_pid) {
+    if (!current_task || current_task->type != TASK_TYPE_USER) return OS_SHM_BAD_ARGUMENT;
+    return shm_revoke(id, current_task->id, target_pid);
+}
+
+int sys_shm_map(uint32_t id) {
+    int rc;
+    if (!current_task || current_task->type != TASK_TYPE_USER) return OS_SHM_BAD_ARGUMENT;
+    rc = shm_map(id, current_task->id, current_task->vmm_dir);
+    return rc == 0 ? (int)(uint32_t)os_shm_address(id) : rc;
+}
+
+int sys_shm_release(uint32_t id) {
+    if (!current_task || current_task->type != TASK_TYPE_USER) return OS_SHM_BAD_ARGUMENT;
+    return shm_release(id, current_task->id);
+}
+
+/* La sonnette est un booléen : plusieurs sonneries avant l'attente n'en
+ * font qu'une, l'anneau dit combien d'enregistrements attendent. */
+int sys_doorbell_wait(uint32_t timeout_ms) {
+    task_t* task = current_task;
+    if (!task || task->type != TASK_TYPE_USER) return OS_IPC_BAD_TARGET;
+    if (task->doorbell == 0U && task->ipc_endpoint.count == 0U && timeout_ms != 0U) {
+        if (timeout_ms == OS_IPC_WAIT_FOREVER) task_block(TASK_SLEEPING, NULL);
+        else timer_block_until(TASK_SLEEPING, timer_get_ticks() + timer_ms_to_ticks(timeout_ms), NULL);
+    }
+    if (task->doorbell == 0U) return 0;
+    task->doorbell = 0U;
+    return 1;
+}
+
+int sys_doorbell_ring(int target_pid) {
+    task_t* target = get_task_by_id(target_pid);
+    if (!current_task || current_task->type != TASK_TYPE_USER) return OS_IPC_BAD_TARGET;
+    if (!target || target->type != TASK_TYPE_USER || target->state == TASK_TERMINATED) {
+        return OS_IPC_BAD_TARGET;
+    }
+    task_doorbell_ring(target);
+    return 0;
+}
+
+int sys_event_ring(uint32_t id) {
+    if (!current_task || current_task->type != TASK_TYPE_USER) return OS_SHM_BAD_ARGUMENT;
+    return task_set_event_ring(current_task, id);
+}
+
+/* Opérations groupables : fichiers, listes et IPC qui ne bloquent pas et
+ * n'utilisent pas leur cadre (SYS_IPC_CALL, attentes, exec exclus). */
+static int syscall_batchable(uint32_t op) {
+    switch (op) {
+        case SYS_LISTDIR: case SYS_READFILE: case SYS_MKDIR: case SYS_UNLINK:
+        case SYS_WRITEFILE: case SYS_STAT: case SYS_RENAME: case SYS_COPY: case SYS_APPEND:
+        case SYS_IPC_SEND: case SYS_IPC_RECV: case SYS_SERVICE_LOOKUP: case SYS_SERVICE_STATUS:
+        case SYS_VFS_BACKEND_READ: case SYS_VFS_BACKEND_WRITE:
+        case SYS_VFS_INITRD_READ: case SYS_VFS_OVERLAY_READ:
+        case SYS_VFS_OVERLAY_UNLINK: case SYS_VFS_OVERLAY_RENAME:
+        case SYS_VFS_INITRD_STAT: case SYS_VFS_OVERLAY_STAT:
+        case SYS_VFS_INITRD_LISTDIR: case SYS_VFS_OVERLAY_LISTDIR:
+        case SYS_VFS_INITRD_LISTDIR_PAGE: case SYS_VFS_OVERLAY_LISTDIR_PAGE:
+        case SYS_VFS_OVERLAY_MKDIR: case SYS_VFS_OVERLAY_RMDIR:
+        case SYS_VFS_FAT16_CREATE: case SYS_VFS_FAT16_UNLINK: case SYS_VFS_FAT16_RENAME:
+        case SYS_FAT16_READ: case SYS_FAT16_LIST: case SYS_FAT16_LIST_PAGE:
+        case SYS_FAT32_READ: case SYS_FAT32_LIST: case SYS_FAT32_LIST_PAGE:
+        case SYS_DOORBELL_RING:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Géométrie lue une fois et bornée par la moitié de région. Une opération
+ * du lot (lecture de fichier) peut écrire dans les en-têtes : le masque et
+ * les compteurs vivent dans des locales, seuls head et tail sont recopiés. */
+static os_ring_t* syscall_batch_ring(uint8_t* base, uint32_t bytes, uint32_t slot_size, uint32_t* out_mask) {
+    os_ring_t* ring = (os_ring_t*)base;
+    uint32_t mask = ring->slot_mask;
+    if (ring->slot_size != slot_size || mask >= bytes / slot_size || (mask & (mask + 1U)) != 0U ||
+        OS_RING_HEADER_SIZE + (mask + 1U) * slot_size > bytes) return NULL;
+    *out_mask = mask;
+    return ring;
+}
+
+/* Au plus le contenu de tous les anneaux : la fusion reste bornée. */
+int sys_trace_read(os_trace_record_t* out, uint32_t capacity) {
+    if (capacity > SMP_MAX_CPUS * TRACE_RING_RECORDS) capacity = SMP_MAX_CPUS * TRACE_RING_RECORDS;
+    if (capacity == 0U || !syscall_user_range(out, capacity * sizeof(*out), 1)) return -1;
+    return (int)trace_snapshot(out, capacity);
+}
+
+int sys_perf_read(uint32_t first, os_perf_stat_t* out, uint32_t capacity) {
+    if (capacity > OS_PERF_SLOT_COUNT) capacity = OS_PERF_SLOT_COUNT;
+    if (capacity == 0U || !syscall_user_range(out, capacity * sizeof(*out), 1)) return -1;
+    return (int)perf_read(first, out, capacity);
+}
+
+int sys_batch(uint32_t id) {
+    const shm_region_t* region = shm_region(id);
+    union {
+        os_batch_sqe_t sqe;
+        uint8_t raw[OS_BATCH_SQE_SLOT - 4U];
+    } entry;
+    os_batch_cqe_t cqe;
+    cpu_state_t frame;
+    os_ring_t* sq;
+    os_ring_t* cq;
+    uint8_t* base;
+    uint8_t* slot;
+    uint32_t half;
+    uint32_t sq_mask = 0U, sq_head, sq_tail;
+    uint32_t cq_mask = 0U, cq_head, cq_tail;
+    uint32_t size;
+    uint32_t mark;
+    int done = 0;
+    if (!current_task || current_task->type != TASK_TYPE_USER || !region ||
+        region->owner_pid != current_task->id || region->name[0] != '\0') return OS_BATCH_BAD_RING;
+    base = (uint8_t*)os_shm_address(id);
+    half = region->page_count * PAGE_SIZE / 2U;
+    sq = syscall_batch_ring(base, half, OS_BATCH_SQE_SLOT, &sq_mask);
+    cq = syscall_batch_ring(base + half, half, OS_BATCH_CQE_SLOT, &cq_mask);
+    if (!sq || !cq) return OS_BATCH_BAD_RING;
+    sq_head = sq->head;
+    sq_tail = sq->tail;
+    cq_head = cq->head;
+    cq_tail = cq->tail;
+    // Une file pleine au plus par appel, quels que soient les compteurs écrits en Ring 3
+    if (sq_head - sq_tail > sq_mask + 1U) sq_head = sq_tail + sq_mask + 1U;
+    while (sq_tail != sq_head && cq_head - cq_tail <= cq_mask) {
+        slot = (uint8_t*)sq + os_ring_slot_offset(sq_tail, sq_mask, OS_BATCH_SQE_SLOT);
+        size = *(const uint32_t*)slot;
+        if (size > sizeof(entry.raw)) size = sizeof(entry.raw);
+        memcpy(entry.raw, slot + 4U, size);
+        sq->tail = ++sq_tail;
+        cqe.user_data = entry.sqe.user_data;
+        if (size != sizeof(os_batch_sqe_t) || !syscall_batchable(entry.sqe.op)) {
+            cqe.result = OS_BATCH_BAD_OP;
+        } else {
+            memset(&frame, 0, sizeof(frame));
+            frame.eax = entry.sqe.op;
+            frame.ebx = entry.sqe.args[0];
+            frame.ecx = entry.sqe.args[1];
+            frame.edx = entry.sqe.args[2];
+            frame.esi = entry.sqe.args[3];
+            mark = task_scratch_mark();
+            syscall_dispatch(&frame);
+            task_scratch_rewind(mark);
+            cqe.result = (int32_t)frame.eax;
+        }
+        slot = (uint8_t*)cq + os_ring_slot_offset(cq_head, cq_mask, OS_BATCH_CQE_SLOT);
+        *(uint32_t*)slot = sizeof(cqe);
+        memcpy(slot + 4U, &cqe, sizeof(cqe));
+        os_ring_barrier();
+        cq->head = ++cq_head;
+        done++;
+        if (current_task->state == TASK_TERMINATED) break;
+    }
+    return done;
+}
+
 int sys_service_register(const char* name) {
     int owner_pid;
     int rc;
@@ -1044,6 +1431,24 @@ static uint32_t gguf_session_token_count;
 static uint32_t gguf_session_prompt_tokens;
 static uint32_t gguf_session_rng;
 static uint8_t gguf_session_active;
+/* Poids, espaces de travail et cache KV n'ont qu'un utilisateur à la fois :
+ * le calcul d'un jeton tourne ainsi hors verrou noyau, préemptible. */
+static int gpt2_engine_owner;   // PID propriétaire, 0 si libre
+
+static int gpt2_engine_acquire(void) {
+    task_t* owner;
+    if (gpt2_engine_owner != 0 && gpt2_engine_owner != current_task->id) {
+        owner = get_task_by_id(gpt2_engine_owner);
+        // Un propriétaire tué en plein calcul n'a pas rendu le moteur
+        if (owner && owner->state != TASK_TERMINATED) return SYSCALL_GPT2_BUSY;
+    }
+    gpt2_engine_owner = current_task->id;
+    return 0;
+}
+
+static void gpt2_engine_release(void) {
+    gpt2_engine_owner = 0;
+}
 
 static int sys_gpt2_gguf_session_step(char* out, uint32_t max) {
     const char* piece;
@@ -1059,6 +1464,9 @@ static int sys_gpt2_gguf_session_step(char* out, uint32_t max) {
         return 0;
     }
     generated_count = gguf_session_token_count - gguf_session_prompt_tokens;
+    /* Les poids sont lus en flux sur le volume FAT16 (ATA PIO, sans verrou
+     * propre) au fil du calcul : le verrou noyau reste tenu pour tout le
+     * jeton. La session rend la main entre deux jetons, un par appel. */
     rc = gpt2_gguf_generate_next_sampled(gguf_session_tokens, gguf_session_token_count,
                                          generated_count, &next_token, &gguf_session_rng);
     if (rc != 0) return -30 + rc;
@@ -1134,12 +1542,20 @@ static int sys_gpt2_generate_impl(const char* prompt, char* out, uint32_t max,
         const char* piece;
         int saw_newline = 0;
         uint32_t generated_count = token_count - prompt_tokens;
-        if (use_gguf)
+        uint32_t lock_depth;
+        // Point sûr entre deux jetons, puis calcul préemptible hors verrou
+        task_yield_point();
+        if (use_gguf) {
+            // Lecture FAT16/ATA pendant le calcul : verrou noyau tenu (voir la session)
             rc = gpt2_gguf_generate_next_sampled(tokens, token_count, generated_count,
                                                   &next_token, &rng_state);
-        else
+        } else {
+            // Modèle entièrement en mémoire : seul le calcul quitte le verrou
+            lock_depth = task_preempt_enable();
             rc = gpt2_generate_next_sampled(tokens, token_count, generated_count,
                                             &next_token, &rng_state);
+            task_preempt_disable(lock_depth);
+        }
         if (rc != 0) return -30 + rc;
         if (next_token == gpt2_tokenizer_eot()) break;
         if (next_token == prev_generated) break;
@@ -1162,15 +1578,27 @@ static int sys_gpt2_generate_impl(const char* prompt, char* out, uint32_t max,
 }
 
 int sys_gpt2_generate(const char* prompt, char* out, uint32_t max) {
-    return sys_gpt2_generate_impl(prompt, out, max, 0U);
+    int rc = gpt2_engine_acquire();
+    if (rc != 0) return rc;
+    rc = sys_gpt2_generate_impl(prompt, out, max, 0U);
+    gpt2_engine_release();
+    return rc;
 }
 
 int sys_gpt2_gguf_generate(const char* prompt, char* out, uint32_t max) {
-    return sys_gpt2_generate_impl(prompt, out, max, 1U);
+    int rc = gpt2_engine_acquire();
+    if (rc != 0) return rc;
+    rc = sys_gpt2_generate_impl(prompt, out, max, 1U);
+    gpt2_engine_release();
+    return rc;
 }
 
 int sys_gpt2_gguf_continue(char* out, uint32_t max) {
-    return sys_gpt2_gguf_session_step(out, max);
+    int rc = gpt2_engine_acquire();
+    if (rc != 0) return rc;
+    rc = sys_gpt2_gguf_session_step(out, max);
+    gpt2_engine_release();
+    return rc;
 }
 
 // Cette fonction est maintenant obsolète pour l'entrée clavier
@@ -1208,12 +1636,16 @@ int sys_exec(const char* path, char* argv[]) {
         const char* src = 0;
         if (argv_list[1]) src = argv_list[1];
         else if (argv_list[0]) src = argv_list[0];
-        if (src) {
-            char kbuf[256];
+        char* kbuf = src ? (char*)task_scratch_alloc(256U) : NULL;
+        if (src && !kbuf) {
+            // Arène épuisée : l'enfant ne démarre pas sans son argument.
+            remove_task(new_task);
+            return -1;
+        }
+        if (kbuf) {
             int n = 0;
             while (n < 255 && src[n] != '\0') { kbuf[n] = src[n]; n++; }
             kbuf[n] = '\0';
-            extern vmm_directory_t* current_directory;
             vmm_directory_t* old_dir = current_directory;
             vmm_switch_page_directory(new_task->vmm_dir->physical_addr);
             current_directory = new_task->vmm_dir;
@@ -1249,9 +1681,14 @@ int sys_spawn(const char* path, char* argv[]) {
         const char* src = 0;
         if (argv_list[1]) src = argv_list[1];
         else if (argv_list[0]) src = argv_list[0];
-        if (src) {
-            // Copier jusqu'a 255 octets
-            char kbuf[256];
+        // Copier jusqu'a 255 octets dans l'arene du syscall
+        char* kbuf = src ? (char*)task_scratch_alloc(256U) : NULL;
+        if (src && !kbuf) {
+            // Arène épuisée : l'enfant ne démarre pas sans son argument.
+            remove_task(new_task);
+            return -1;
+        }
+        if (kbuf) {
             int n = 0;
             while (n < 255 && src[n] != '\0') { kbuf[n] = src[n]; n++; }
             kbuf[n] = '\0';
@@ -1307,9 +1744,7 @@ void sys_gets(char* buffer, uint32_t size) {
             // Caractère imprimable - l'afficher sur l'écran
             buffer[i++] = c;
             print_char(c, -1, -1, 0x0F);
-            print_string_serial("SYS_GETS: caractère ajouté: '");
-            write_serial(c);
-            print_string_serial("'\n");
+            TRACE(TRACE_LEVEL_VERBOSE, OS_TRACE_GETS_CHAR, (uint8_t)c, i, 0);
         }
     }
     
@@ -1404,6 +1839,14 @@ int sys_meminfo(os_meminfo_t* info) {
     info->total_pages = pmm_get_total_pages();
     info->used_pages = pmm_get_used_pages();
     info->free_pages = pmm_get_free_pages();
+    heap_fill_meminfo(info);
+    return 0;
+}
+
+int sys_memstats(os_memstats_t* out) {
+    if (!out) return -1;
+    pmm_fill_memstats(out);
+    task_fill_memstats(out);
     return 0;
 }
 
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include "../task/task.h"
 #include "os_syscalls.h"
+#include "os_trace.h"
+#include "os_perf.h"
 
 typedef struct {
     uint32_t eax, ebx, ecx, edx, esi, edi;
@@ -11,6 +13,9 @@ typedef struct {
 
 void syscall_init();
 void syscall_handler(cpu_state_t* cpu);
+/* Entrée SYSENTER ; renvoie 1 pour un retour SYSEXIT, 0 pour IRET. */
+int syscall_sysenter_handler(cpu_state_t* cpu);
+void syscall_exit_current(cpu_state_t* cpu, int exit_code, uint32_t reason);
 
 void sys_exit(uint32_t exit_code);
 void sys_putc(char c);
@@ -29,6 +34,7 @@ int sys_ps(os_proc_t* out, int max_n);
 int sys_kill(int pid);
 uint32_t sys_ticks(void);
 int sys_meminfo(os_meminfo_t* info);
+int sys_memstats(os_memstats_t* out);
 int sys_task_metrics(int pid, os_task_metrics_t* out);
 int sys_task_set_priority(int pid, uint32_t priority);
 int sys_task_wait(int pid);
@@ -95,6 +101,23 @@ int sys_gpt2_gguf_generate(const char* prompt, char* out, uint32_t max);
 int sys_gpt2_gguf_continue(char* out, uint32_t max);
 int sys_ipc_send(int target_pid, const os_ipc_payload_t* payload);
 int sys_ipc_receive(os_ipc_message_t* out);
+int sys_ipc_receive_wait(os_ipc_message_t* out, const os_ipc_filter_t* filter, uint32_t timeout_ms);
+int sys_ipc_call(int target_pid, const os_ipc_payload_t* request, os_ipc_message_t* out,
+                 uint32_t timeout_ms, cpu_state_t* frame);
+int sys_ipc_reply_wait(int client_pid, const os_ipc_payload_t* reply, os_ipc_message_t* out,
+                       uint32_t timeout_ms, cpu_state_t* frame);
+int sys_shm_create(const char* name, uint32_t page_count);
+int sys_shm_grant(uint32_t id, int target_pid, uint32_t rights);
+int sys_shm_revoke(uint32_t id, int target_pid);
+int sys_shm_map(uint32_t id);
+int sys_shm_release(uint32_t id);
+int sys_doorbell_wait(uint32_t timeout_ms);
+int sys_doorbell_ring(int target_pid);
+int sys_event_ring(uint32_t id);
+/* Vide la file de soumission de la région anonyme id (os_batch.h). */
+int sys_batch(uint32_t id);
+int sys_trace_read(os_trace_record_t* out, uint32_t capacity);
+int sys_perf_read(uint32_t first, os_perf_stat_t* out, uint32_t capacity);
 int sys_service_register(const char* name);
 int sys_service_lookup(const char* name);
 int sys_service_unregister(const char* name);
@@ -0,0 +1,85 @@
+#include "runq.h"
+#include "task.h"
+#include <stddef.h>
+
+static uint32_t runq_level(const task_t* task) {
+    uint32_t priority = task->priority;
+    if (priority < OS_TASK_PRIORITY_LOW) priority = OS_TASK_PRIORITY_LOW;
+    if (priority > OS_TASK_PRIORITY_HIGH) priority = OS_TASK_PRIORITY_HIGH;
+    priority -= OS_TASK_PRIORITY_LOW;
+    return task->type == TASK_TYPE_USER ? RUNQ_PRIORITY_LEVELS + priority : priority;
+}
+
+void runq_init(runq_t* rq) {
+    for (uint32_t level = 0U; level < RUNQ_LEVEL_COUNT; level++) {
+        rq->head[level] = NULL;
+        rq->tail[level] = NULL;
+    }
+    rq->mask = 0U;
+    rq->user_count = 0U;
+}
+
+void runq_enqueue(runq_t* rq, task_t* task) {
+    uint32_t level;
+    if (!rq || !task || task->run_queue) return;
+    level = runq_level(task);
+    task->run_level = level;
+    task->run_next = NULL;
+    task->run_prev = rq->tail[level];
+    if (rq->tail[level]) rq->tail[level]->run_next = task;
+    else rq->head[level] = task;
+    rq->tail[level] = task;
+    task->run_queue = rq;
+    rq->mask |= 1U << level;
+    if (level >= RUNQ_PRIORITY_LEVELS) rq->user_count++;
+}
+
+void runq_enqueue_front(runq_t* rq, task_t* task) {
+    uint32_t level;
+    if (!rq || !task || task->run_queue) return;
+    level = runq_level(task);
+    task->run_level = level;
+    task->run_prev = NULL;
+    task->run_next = rq->head[level];
+    if (rq->head[level]) rq->head[level]->run_prev = task;
+    else rq->tail[level] = task;
+    rq->head[level] = task;
+    task->run_queue = rq;
+    rq->mask |= 1U << level;
+    if (level >= RUNQ_PRIORITY_LEVELS) rq->user_count++;
+}
+
+void runq_remove(task_t* task) {
+    runq_t* rq;
+    uint32_t level;
+    if (!task || !task->run_queue) return;
+    rq = task->run_queue;
+    // Niveau mémorisé : la priorité a pu changer depuis la mise en file.
+    level = task->run_level;
+    if (task->run_prev) task->run_prev->run_next = task->run_next;
+    else rq->head[level] = task->run_next;
+    if (task->run_next) task->run_next->run_prev = task->run_prev;
+    else rq->tail[level] = task->run_prev;
+    if (!rq->head[level]) rq->mask &= ~(1U << level);
+    if (level >= RUNQ_PRIORITY_LEVELS) rq->user_count--;
+    task->run_next = NULL;
+    task->run_prev = NULL;
+    task->run_queue = NULL;
+}
+
+task_t* runq_pop_next(runq_t* rq) {
+    task_t* task;
+    if (!rq->mask) return NULL;
+    task = rq->head[31U - (uint32_t)__builtin_clz(rq->mask)];
+    runq_remove(task);
+    return task;
+}
+
+task_t* runq_pop_user(runq_t* rq) {
+    if (!runq_has_user(rq)) return NULL;
+    return runq_pop_next(rq);
+}
+
+int runq_has_user(const runq_t* rq) {
+    return (rq->mask >> RUNQ_PRIORITY_LEVELS) != 0U;
+}
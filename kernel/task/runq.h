@@ -0,0 +1,37 @@
+#ifndef RUNQ_H
+#define RUNQ_H
+
+#include <stdint.h>
+#include "os_syscalls.h"
+
+/* Files prêtes : une FIFO par classe (noyau, utilisateur) et par priorité
+ * OS_TASK_PRIORITY_*. Le niveau utilisateur le plus bas passe devant le
+ * niveau noyau le plus haut ; un bit par file non vide donne le choix en O(1).
+ * Chaque CPU possède son runq_t (kernel/smp.h). */
+#define RUNQ_PRIORITY_LEVELS OS_TASK_PRIORITY_HIGH
+#define RUNQ_LEVEL_COUNT (2U * RUNQ_PRIORITY_LEVELS)
+
+struct task;
+
+typedef struct runq {
+    struct task* head[RUNQ_LEVEL_COUNT];
+    struct task* tail[RUNQ_LEVEL_COUNT];
+    uint32_t mask;         // Bit n = file n non vide
+    uint32_t user_count;   // Tâches Ring 3 en file : charge vue par le vol de travail
+} runq_t;
+
+void runq_init(runq_t* rq);
+/* En queue de sa file ; sans effet si la tâche est déjà dans une file. */
+void runq_enqueue(runq_t* rq, struct task* task);
+/* En tête de sa file : une tâche réveillée par un message passe avant ses
+ * pairs de même niveau, sans doubler un niveau plus prioritaire. */
+void runq_enqueue_front(runq_t* rq, struct task* task);
+/* Retire la tâche de la file qui la contient ; sans effet hors file. */
+void runq_remove(struct task* task);
+/* Retire et renvoie la tête de la file la plus prioritaire, NULL si tout est vide. */
+struct task* runq_pop_next(runq_t* rq);
+/* Vol de travail : retire la tâche Ring 3 la plus prioritaire, NULL s'il n'y en a pas. */
+struct task* runq_pop_user(runq_t* rq);
+int runq_has_user(const runq_t* rq);
+
+#endif
@@ -1,4 +1,5 @@
 #include "task.h"
+#include "runq.h"
 #include "kernel/mem/pmm.h"
 #include "kernel/mem/vmm.h"
 #include <stddef.h>
@@ -9,19 +10,28 @@
 #include "fs/initrd.h"
 #include "kernel/gdt.h"
 #include "kernel/timer.h"
+#include "kernel/smp.h"
+#include "kernel/shm.h"
+#include "kernel/trace.h"
+#include "kernel/perf.h"
+#include "os_ring.h"
 
-// Variables globales
-task_t* current_task = NULL;
+// Variables globales (la tâche courante est propre à chaque CPU : smp.h)
 task_t* task_queue = NULL;
 int next_task_id = 0;
 volatile int g_reschedule_needed = 0;
-/* Tâche détachée à libérer lors d’un passage ultérieur, hors de sa pile et de son VMM. */
-static task_t* deferred_reap_task = NULL;
 
 #define TASK_STATIC_KERNEL_STACK_SIZE 4096U
+#define TASK_STATIC_SCRATCH_SIZE 2048U
+#define TASK_STATIC_FPU_SIZE 512U
 static task_t task_static_pool[OS_TASK_GLOBAL_CAPACITY];
 static uint8_t task_static_used[OS_TASK_GLOBAL_CAPACITY];
 static uint8_t task_static_kernel_stacks[OS_TASK_GLOBAL_CAPACITY][TASK_STATIC_KERNEL_STACK_SIZE] __attribute__((aligned(16)));
+/* Arène de travail par slot : les temporaires volumineux quittent la pile noyau de 4 Ko. */
+static uint8_t task_static_scratch[OS_TASK_GLOBAL_CAPACITY][TASK_STATIC_SCRATCH_SIZE] __attribute__((aligned(16)));
+/* État x87/SSE sauvé à chaque bascule : un syscall préempté en plein calcul
+ * flottant (GPT-2) retrouve ses registres XMM. */
+static uint8_t task_static_fpu[OS_TASK_GLOBAL_CAPACITY][TASK_STATIC_FPU_SIZE] __attribute__((aligned(16)));
 static vmm_directory_t task_static_vmm_pool[OS_TASK_GLOBAL_CAPACITY];
 static uint8_t task_static_vmm_used[OS_TASK_GLOBAL_CAPACITY];
 static page_table_t* task_static_vmm_tables[OS_TASK_GLOBAL_CAPACITY][ENTRIES_PER_TABLE];
@@ -42,7 +52,9 @@ static vmm_directory_t* task_static_vmm_acquire(void) {
         dir->physical_addr = (uint32_t)dir->physical_dir;
         dir->static_storage = 1U;
         for (table_index = 0U; table_index < ENTRIES_PER_TABLE; table_index++) {
-            if (kernel_directory->tables[table_index]) {
+            /* Les PDE PSE du noyau n'ont pas de table : seule l'entrée matérielle est partagée. */
+            if (kernel_directory->tables[table_index] ||
+                (kernel_directory->physical_dir->tablesPhysical[table_index] & PAGE_LARGE)) {
                 dir->tables[table_index] = kernel_directory->tables[table_index];
                 dir->physical_dir->tablesPhysical[table_index] = kernel_directory->physical_dir->tablesPhysical[table_index];
             }
@@ -68,6 +80,13 @@ static task_t* task_static_acquire(void) {
         if (!task_static_used[index]) {
             task_static_used[index] = 1U;
             memset(&task_static_pool[index], 0, sizeof(task_t));
+            os_arena_init(&task_static_pool[index].scratch, task_static_scratch[index],
+                          TASK_STATIC_SCRATCH_SIZE);
+            // Image FXSAVE d'un fninit : FCW 0x037F, MXCSR 0x1F80 (exceptions masquées)
+            memset(task_static_fpu[index], 0, TASK_STATIC_FPU_SIZE);
+            *(uint16_t*)&task_static_fpu[index][0] = 0x037FU;
+            *(uint32_t*)&task_static_fpu[index][24] = 0x1F80U;
+            task_static_pool[index].fpu_state = task_static_fpu[index];
             return &task_static_pool[index];
         }
     }
@@ -95,7 +114,7 @@ static uint32_t task_static_kernel_stack_top(const task_t* task) {
 
 // Externes
 extern vmm_directory_t* kernel_directory;
-extern vmm_directory_t* current_directory;
+extern void task_first_return(void);
 extern void print_string_serial(const char* str);
 
 // Prototypes
@@ -105,9 +124,13 @@ void setup_initial_user_context(task_t* task, uint32_t entry_point, uint32_t sta
 
 
 void tasking_init() {
-    deferred_reap_task = NULL;
+    uint32_t i;
     memset(task_static_used, 0, sizeof(task_static_used));
     memset(task_static_vmm_used, 0, sizeof(task_static_vmm_used));
+    for (i = 0U; i < SMP_MAX_CPUS; i++) {
+        runq_init(&smp_cpus[i].runq);
+        smp_cpus[i].deferred_reap = NULL;
+    }
     current_task = task_static_acquire();
     if (!current_task) return;
     current_task->id = next_task_id++;
@@ -155,11 +178,51 @@ void tasking_init() {
     current_task->name[6] = '\0';
     current_task->next = current_task;
     current_task->prev = current_task;
+    current_task->cpu = 0U;
     task_queue = current_task;
+    // Le BSP reçoit des tâches dès qu'il a la sienne ; les AP suivent dans smp_init().
+    smp_cpus[0].online = 1U;
     print_string_serial("Tache kernel creee.\n");
 }
 
+void* task_scratch_alloc(uint32_t size) {
+    if (!current_task) return NULL;
+    return os_arena_alloc(&current_task->scratch, size);
+}
+
+uint32_t task_scratch_mark(void) {
+    return current_task ? os_arena_mark(&current_task->scratch) : 0U;
+}
+
+void task_scratch_rewind(uint32_t mark) {
+    if (current_task) os_arena_rewind(&current_task->scratch, mark);
+}
+
+void task_scratch_reset(task_t* task) {
+    if (task) os_arena_reset(&task->scratch);
+}
+
+/* Placement initial d'une tâche Ring 3 : CPU en ligne le moins chargé. */
+static uint32_t task_pick_cpu(void) {
+    uint32_t best = smp_cpu()->index;
+    uint32_t best_load = 0xFFFFFFFFU;
+    for (uint32_t i = 0U; i < SMP_MAX_CPUS; i++) {
+        cpu_t* cpu = &smp_cpus[i];
+        uint32_t load;
+        if (!cpu->online) continue;
+        load = cpu->runq.user_count;
+        if (cpu->task && cpu->task->type == TASK_TYPE_USER) load++;
+        if (load < best_load) {
+            best = i;
+            best_load = load;
+        }
+    }
+    return best;
+}
+
 void add_task_to_queue(task_t* task) {
+    // Les tâches noyau (inactivité) restent sur le CPU fixé par leur créateur
+    if (task->type == TASK_TYPE_USER) task->cpu = task_pick_cpu();
     if (!task_queue) {
         task_queue = task;
         task->next = task;
@@ -170,10 +233,158 @@ void add_task_to_queue(task_t* task) {
         task_queue->prev->next = task;
         task_queue->prev = task;
     }
+    if (task->state == TASK_READY) task_set_state(task, TASK_READY);
+}
+
+/* Un CPU inactif dort sans tick : la tâche prête lui est signalée par IPI,
+ * sur son CPU d'affinité ou, pour une tâche Ring 3, sur un CPU libre qui
+ * viendra la voler. */
+static void task_kick_idle_cpu(cpu_t* target, const task_t* task) {
+    cpu_t* self = smp_cpu();
+    if (target != self && target->task == target->idle_task) {
+        smp_send_reschedule(target);
+        return;
+    }
+    if (task->type != TASK_TYPE_USER) return;
+    for (uint32_t i = 0U; i < SMP_MAX_CPUS; i++) {
+        cpu_t* cpu = &smp_cpus[i];
+        if (cpu == self || cpu == target || !cpu->online || cpu->task != cpu->idle_task) continue;
+        smp_send_reschedule(cpu);
+        return;
+    }
+}
+
+static void task_change_state(task_t* task, task_state_t state, int front) {
+    cpu_t* target;
+    task->state = state;
+    if (state != TASK_SLEEPING && state != TASK_WAITING_FOR_INPUT && state != TASK_WAITING_FOR_IPC) {
+        timer_sleep_cancel(task);
+    }
+    if (state != TASK_READY) {
+        runq_remove(task);
+        return;
+    }
+    // Réveil sur le CPU d'affinité ; un CPU inactif viendra la voler au besoin
+    target = &smp_cpus[task->cpu % SMP_MAX_CPUS];
+    if (front) runq_enqueue_front(&target->runq, task);
+    else runq_enqueue(&target->runq, task);
+    task_kick_idle_cpu(target, task);
+}
+
+void task_set_state(task_t* task, task_state_t state) {
+    if (!task) return;
+    task_change_state(task, state, 0);
+}
+
+/* La réponse attendue passe devant : l'émetteur qui cède l'élit aussitôt. */
+static void task_ipc_wake(task_t* target) {
+    cpu_t* self = smp_cpu();
+    cpu_t* home = &smp_cpus[target->cpu % SMP_MAX_CPUS];
+    if (target->type == TASK_TYPE_USER && home != self && home->task != home->idle_task) {
+        target->cpu = self->index;
+    }
+    task_change_state(target, TASK_READY, 1);
+}
+
+void task_doorbell_ring(task_t* task) {
+    if (!task || task->state == TASK_TERMINATED) return;
+    task->doorbell = 1U;
+    if (task->state == TASK_SLEEPING) task_ipc_wake(task);
+}
+
+int task_set_event_ring(task_t* task, uint32_t region_id) {
+    const shm_region_t* region = shm_region(region_id);
+    os_ring_t* ring;
+    if (!task) return OS_SHM_BAD_ARGUMENT;
+    task->event_ring = 0U;
+    if (region_id == 0U) return 0;
+    ring = (os_ring_t*)shm_writable_page(region_id, task->id, 0U);
+    if (!ring || !region) return OS_SHM_DENIED;
+    if (!os_ring_init(ring, region->page_count * PAGE_SIZE, OS_RING_EVENT_SLOT_SIZE)) {
+        return OS_SHM_BAD_ARGUMENT;
+    }
+    task->event_ring = region_id;
+    task->event_ring_mask = ring->slot_mask;
+    task->event_ring_head = 0U;
+    return 0;
+}
+
+/* Géométrie et head viennent de la tâche : l'en-tête partagé est
+ * inscriptible en Ring 3, un slot n'est écrit qu'à travers le masque. Région
+ * perdue : OS_IPC_BAD_TARGET, l'appelant revient à la boîte aux lettres. */
+static int task_event_ring_push(task_t* target, const os_ipc_payload_t* payload) {
+    os_ring_t* ring = (os_ring_t*)shm_writable_page(target->event_ring, target->id, 0U);
+    uint32_t head = target->event_ring_head;
+    uint32_t offset;
+    uint8_t* slot;
+    if (!ring) {
+        target->event_ring = 0U;
+        return OS_IPC_BAD_TARGET;
+    }
+    if (head - ring->tail > target->event_ring_mask) return OS_IPC_FULL;
+    offset = os_ring_slot_offset(head, target->event_ring_mask, OS_RING_EVENT_SLOT_SIZE);
+    slot = (uint8_t*)shm_writable_page(target->event_ring, target->id, offset / PAGE_SIZE);
+    if (!slot) return OS_IPC_BAD_TARGET;
+    slot += offset % PAGE_SIZE;
+    *(uint32_t*)slot = sizeof(*payload);
+    memcpy(slot + 4U, payload, sizeof(*payload));
+    os_ring_barrier();
+    target->event_ring_head = head + 1U;
+    ring->head = target->event_ring_head;
+    if (os_ring_needs_doorbell(ring) || target->state == TASK_SLEEPING) task_doorbell_ring(target);
+    return 0;
+}
+
+/* Registres du cadre syscall bloqué, relus par os_ipc_short_unpack(). */
+static void task_ipc_deliver_short(task_t* target, int32_t sender_pid,
+                                   const os_ipc_payload_t* payload) {
+    cpu_state_t* frame = target->ipc_frame;
+    uint8_t words[OS_IPC_SHORT_MAX] = {0};
+    for (uint32_t i = 0U; i < payload->size; i++) words[i] = payload->data[i];
+    frame->eax = (uint32_t)OS_IPC_SHORT | payload->size;
+    frame->ebx = (uint32_t)sender_pid;
+    frame->ecx = payload->type;
+    frame->edx = payload->request_id;
+    frame->esi = os_ipc_decode_u32(words);
+    frame->edi = os_ipc_decode_u32(words + 4);
+    target->ipc_frame = NULL;
+}
+
+int task_ipc_deliver(task_t* target, int32_t sender_pid, const os_ipc_payload_t* payload) {
+    int waiting;
+    int rc;
+    if (!target) return OS_IPC_BAD_TARGET;
+    if (!payload || payload->size > OS_IPC_MAX_DATA) return OS_IPC_BAD_MESSAGE;
+    if (sender_pid == 0 && target->event_ring != 0U) {
+        rc = task_event_ring_push(target, payload);
+        if (rc != OS_IPC_BAD_TARGET) return rc;
+    }
+    waiting = target->state == TASK_WAITING_FOR_IPC &&
+              ipc_filter_accepts(&target->ipc_wait_filter, sender_pid, payload->type,
+                                 payload->request_id);
+    // Le filtre a déjà écarté tout message en boîte : l'ordre est préservé
+    if (waiting && target->ipc_frame && payload->size <= OS_IPC_SHORT_MAX) {
+        task_ipc_deliver_short(target, sender_pid, payload);
+        task_ipc_wake(target);
+        return 0;
+    }
+    rc = ipc_endpoint_send(&target->ipc_endpoint, sender_pid, payload);
+    if (rc != 0) return rc;
+    if (target->state == TASK_SLEEPING) task_set_state(target, TASK_READY);
+    else if (waiting) task_ipc_wake(target);
+    return 0;
+}
+
+void task_block(task_state_t state, task_t* handoff) {
+    task_t* task = current_task;
+    uint32_t flags;
+    if (!task || task == smp_cpu()->idle_task) return;
+    asm volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    task_set_state(task, state);
+    schedule_handoff(handoff);
+    if (flags & 0x200U) asm volatile("sti");
 }
 
-// Déclaration de la fonction assembleur pour le changement de contexte
-extern void jump_to_task(cpu_state_t* next_state);
 static void unlink_task(task_t* task);
 
 static int task_destroy_user_vmm(vmm_directory_t* dir) {
@@ -185,22 +396,36 @@ static int task_destroy_user_vmm(vmm_directory_t* dir) {
 
 static void task_release_detached(task_t* task) {
     if (!task || task->type != TASK_TYPE_USER || !task->kernel_stack_p) return;
+    // Les régions partagées quittent l'espace avant sa destruction
+    shm_remove_pid(task->id);
     if (task_destroy_user_vmm(task->vmm_dir) != 0) return;
     task->vmm_dir = NULL;
     task->kernel_stack_p = 0U;
     task_static_release(task);
 }
 
+/* Tâche détachée libérée au passage suivant du même CPU, hors de sa pile et de son VMM. */
 static void task_reap_deferred(void) {
-    task_t* task = deferred_reap_task;
-    deferred_reap_task = NULL;
+    cpu_t* self = smp_cpu();
+    task_t* task = self->deferred_reap;
+    self->deferred_reap = NULL;
+    task_release_detached(task);
+}
+
+/* Une tâche en cours sur un autre CPU est seulement marquée : ce CPU la retire
+ * à son prochain tick, sans qu'on libère la pile sur laquelle il s'exécute. */
+static void task_terminate(task_t* task) {
+    int running_elsewhere = task->state == TASK_RUNNING && task != current_task;
+    task_set_state(task, TASK_TERMINATED);
+    if (running_elsewhere) return;
+    unlink_task(task);
     task_release_detached(task);
 }
 
 void remove_task(task_t* task) {
     task_t* cursor;
     int found = 0;
-    if (!task || task == current_task || !task_queue) return;
+    if (!task || task->state == TASK_RUNNING || !task_queue) return;
     cursor = task_queue;
     do {
         if (cursor == task) { found = 1; break; }
@@ -213,117 +438,198 @@ void remove_task(task_t* task) {
 
 static void unlink_task(task_t* task) {
     if (!task_queue || !task) return;
+    runq_remove(task);
+    timer_sleep_cancel(task);
     if (task->next == task) {
         // Single element in queue
         task_queue = NULL;
-        current_task = NULL;
         return;
     }
     task->prev->next = task->next;
     task->next->prev = task->prev;
     if (task_queue == task) task_queue = task->next;
-    if (current_task == task) current_task = task->next;
 }
 
-void schedule(cpu_state_t* cpu) {
-    uint32_t now = timer_get_ticks();
-    asm volatile("cli"); // Désactiver les interruptions pour la planification
+/* Vol de travail : un CPU sans tâche Ring 3 locale prend la plus prioritaire
+ * du CPU le plus chargé. Les tâches noyau (inactivité) ne migrent jamais. */
+static task_t* task_steal_user(cpu_t* self) {
+    cpu_t* victim = NULL;
+    for (uint32_t i = 0U; i < SMP_MAX_CPUS; i++) {
+        cpu_t* cpu = &smp_cpus[i];
+        if (cpu == self || !cpu->online || cpu->runq.user_count == 0U) continue;
+        if (!victim || cpu->runq.user_count > victim->runq.user_count) victim = cpu;
+    }
+    return victim ? runq_pop_user(&victim->runq) : NULL;
+}
+
+/* Premier passage : le cadre initial (cpu_state) est recopié au sommet de la
+ * pile noyau, sous lui le cadre de switch_to() qui « revient » dans
+ * task_first_return, lequel dépile ce cadre comme un retour d'interruption. */
+static void task_build_first_frame(task_t* task) {
+    uint32_t* sp = (uint32_t*)task->kernel_stack_p;
+    sp -= sizeof(cpu_state_t) / sizeof(uint32_t);
+    memcpy(sp, &task->cpu_state, sizeof(cpu_state_t));
+    *--sp = (uint32_t)task_first_return;
+    *--sp = 0U; // ebp
+    *--sp = 0U; // ebx
+    *--sp = 0U; // esi
+    *--sp = 0U; // edi
+    task->kernel_esp = (uint32_t)sp;
+    task->kernel_lock_depth = 1U; // Comme un stub d'entrée : rendu par task_first_return
+}
+
+void task_switch_finish(void) {
+    task_t* task = current_task;
+    // Le verrou noyau suit le CPU ; la profondeur suit la tâche réélue
+    smp_cpu()->kernel_lock_depth = task->kernel_lock_depth;
+    asm volatile("fxrstor (%0)" : : "r"(task->fpu_state) : "memory");
+    perf_switch_in(task);
     task_reap_deferred();
-    if (!current_task) {
+}
+
+static void task_schedule(task_t* handoff) {
+    cpu_t* self = smp_cpu();
+    task_t* prev = current_task;
+    task_t* next = NULL;
+    uint32_t now;
+    uint32_t flags;
+    // Désactiver les interruptions pour la planification ; IF de l'appelant rendu au retour
+    asm volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    if (!prev) {
         asm volatile("sti");
         return;
     }
+    // Un CPU qui quitte son sommeil sans tick reprend d'abord son timer
+    timer_idle_resume();
+    now = timer_get_ticks();
 
-    // Si la tache courante est terminee, ne pas sauver l'etat; retirer de la file
-    if (current_task->state != TASK_TERMINATED) {
-        // Sauvegarder l'état de la tâche actuelle
-        if (now >= current_task->last_scheduled_ticks) current_task->run_ticks += now - current_task->last_scheduled_ticks;
-        memcpy(&current_task->cpu_state, cpu, sizeof(cpu_state_t));
+    // Si la tache courante est terminee, elle ne sera plus reprise : retrait de la file
+    if (prev->state != TASK_TERMINATED) {
+        if (now >= prev->last_scheduled_ticks) prev->run_ticks += now - prev->last_scheduled_ticks;
     } else {
-        task_t* terminated_task = current_task;
-        print_string_serial("[SCHED] removing terminated task\n");
-        unlink_task(terminated_task);
-        deferred_reap_task = terminated_task;
-        if (!task_queue) {
-            asm volatile("sti");
-            while(1) asm volatile("hlt");
-        }
+        TRACE(TRACE_LEVEL_EVENT, OS_TRACE_TASK_REAP, prev->id, 0, 0);
+        unlink_task(prev);
+        self->deferred_reap = prev;
+    }
+
+    // Si la tâche tournait, elle repasse en queue de sa file prête
+    if (prev->state == TASK_RUNNING) {
+        task_set_state(prev, TASK_READY);
+    }
+
+    /* Préférer une tâche Ring 3 prête, puis la priorité la plus haute ; la
+     * FIFO de chaque niveau conserve le round-robin à priorité égale. Sans
+     * tâche Ring 3 locale, le CPU en vole une avant de retomber sur sa tâche
+     * d'inactivité, qui reste READY dans sa file après le premier saut. Un
+     * handoff prêt passe avant tout : il reprend le temps de l'appelant. */
+    if (handoff && handoff != prev && handoff->state == TASK_READY &&
+        handoff->type == TASK_TYPE_USER) {
+        next = handoff;
+    }
+    if (!next && !runq_has_user(&self->runq)) next = task_steal_user(self);
+    if (!next) next = runq_pop_next(&self->runq);
+    if (!next) {
+        // Plus rien d'exécutable ici : seule une tâche terminée sans repli y mène
+        smp_kernel_release_all();
+        asm volatile("sti");
+        while(1) asm volatile("hlt");
     }
-
-    // Si la tâche tournait, elle est maintenant prête à être replanifiée plus tard
-    if (current_task->state == TASK_RUNNING) {
-        current_task->state = TASK_READY;
+    task_set_state(next, TASK_RUNNING);
+    next->cpu = self->index;
+    next->last_scheduled_ticks = now;
+    if (next == prev) {
+        if (flags & 0x200U) asm volatile("sti");
+        return;
     }
+    current_task = next;
 
-    /* Préférer une tâche Ring 3 prête. Parmi les candidates de même classe,
-     * la priorité la plus haute gagne ; le parcours circulaire conserve le
-     * round-robin lorsque la priorité est égale. La tâche noyau reste READY
-     * après le premier saut vers le shell et ne doit pas recevoir un ancien
-     * cadre utilisateur. */
-    {
-        task_t* start = current_task ? current_task : task_queue;
-        task_t* t = start;
-        task_t* next_task = start;
-        uint32_t best_priority = 0U;
-        int found_user = 0;
-
-        do {
-            t = t->next;
-            if (t->state == TASK_READY && t->type == TASK_TYPE_USER &&
-                (!found_user || t->priority > best_priority)) {
-                next_task = t;
-                best_priority = t->priority;
-                found_user = 1;
-            }
-        } while (t != start);
+    next->switch_count++;
+    TRACE(TRACE_LEVEL_HOT, OS_TRACE_SCHED_SWITCH, prev->id, next->id, next->switch_count);
 
-        if (start->state == TASK_READY && start->type == TASK_TYPE_USER &&
-            (!found_user || start->priority > best_priority)) {
-            next_task = start;
-            found_user = 1;
-        }
+    // Mettre à jour le TSS de ce CPU avec la pile noyau de la nouvelle tâche
+    if (next->type == TASK_TYPE_USER) {
+        tss_set_stack(0x10, next->kernel_stack_p);
+    }
 
-        if (!found_user) {
-            t = start;
-            do {
-                t = t->next;
-                if (t->state == TASK_READY) {
-                    next_task = t;
-                    break;
-                }
-            } while (t != start);
-        }
+    // Changer de répertoire de pages si nécessaire
+    if (current_directory != next->vmm_dir) {
+        vmm_switch_page_directory(next->vmm_dir->physical_addr);
+        current_directory = next->vmm_dir;
+    }
 
-        current_task = next_task;
+    if (!next->kernel_esp) task_build_first_frame(next);
+    prev->kernel_lock_depth = self->kernel_lock_depth;
+    if (prev->state != TASK_TERMINATED) {
+        asm volatile("fxsave (%0)" : : "r"(prev->fpu_state) : "memory");
     }
 
-    print_string_serial("[SCHED] switching to task ");
-    write_serial('0' + (current_task->id % 10));
-    print_string_serial("\n");
-    current_task->state = TASK_RUNNING;
-    current_task->last_scheduled_ticks = now;
-    current_task->switch_count++;
+    /* La pile de prev reste intacte jusqu'à sa réélection. Une tâche terminée
+     * n'y revient jamais : task_switch_finish() la libère depuis la pile de next. */
+    perf_switch_out(prev);
+    switch_to(&prev->kernel_esp, next->kernel_esp);
+    task_switch_finish();
+    if (flags & 0x200U) asm volatile("sti");
+}
 
-    // Mettre à jour le TSS avec la pile noyau de la nouvelle tâche
-    if (current_task->type == TASK_TYPE_USER) {
-        tss_set_stack(0x10, current_task->kernel_stack_p);
-    }
+void schedule(cpu_state_t* cpu) {
+    perf_span_t span;
+    (void)cpu;
+    perf_begin(&span);
+    task_schedule(NULL);
+    perf_end(OS_PERF_SLOT_SCHEDULE, &span);
+}
 
-    // Changer de répertoire de pages si nécessaire
-    if (current_directory != current_task->vmm_dir) {
-        vmm_switch_page_directory(current_task->vmm_dir->physical_addr);
-        current_directory = current_task->vmm_dir;
+void schedule_handoff(task_t* next) {
+    perf_span_t span;
+    perf_begin(&span);
+    task_schedule(next);
+    perf_end(OS_PERF_SLOT_SCHEDULE, &span);
+}
+
+void task_yield(void) {
+    schedule(NULL);
+}
+
+void task_yield_point(void) {
+    if (!current_task || !task_has_other_ready_user()) return;
+    if (!timer_preempt_due()) return;
+    task_yield();
+}
+
+uint32_t task_preempt_enable(void) {
+    task_t* task = current_task;
+    uint32_t depth = 0U;
+    uint32_t flags;
+    if (!task) return 0U;
+    asm volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    // Seule la section la plus externe rend le verrou
+    if (task->kernel_preemptible++ == 0U) {
+        depth = smp_cpu()->kernel_lock_depth;
+        smp_kernel_release_all();
     }
+    if (flags & 0x200U) asm volatile("sti");
+    return depth;
+}
 
-    // Sauter à la nouvelle tâche. Ne retourne jamais.
-    jump_to_task(&current_task->cpu_state);
+void task_preempt_disable(uint32_t lock_depth) {
+    task_t* task = current_task;
+    uint32_t flags;
+    if (!task || task->kernel_preemptible == 0U) return;
+    // Interruptions coupées : le timer ne doit pas préempter un verrou à moitié repris
+    asm volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    if (--task->kernel_preemptible == 0U && lock_depth != 0U) {
+        // La tâche a pu changer de CPU pendant la section
+        smp_kernel_enter();
+        smp_cpu()->kernel_lock_depth = lock_depth;
+    }
+    if (flags & 0x200U) asm volatile("sti");
 }
 
 void task_exit() {
     if (!current_task) return;
 
-    current_task->state = TASK_TERMINATED;
-    print_string_serial("[TASK_EXIT] terminating, scheduling now\n");
+    task_set_state(current_task, TASK_TERMINATED);
+    TRACE(TRACE_LEVEL_EVENT, OS_TRACE_TASK_EXIT, current_task->id, 0, 0);
 
     // Utiliser l'appel système pour quitter proprement
     // Cela déclenchera le scheduler sans sauvegarder l'état de cette tâche
@@ -333,40 +639,18 @@ void task_exit() {
     while(1) { asm volatile("hlt"); }
 }
 
-task_t* create_task_from_initrd_file(const char* filename) {
-    uint8_t* file_data;
+static task_t* task_create_from_initrd_path(const char* filename) {
+    elf_image_t* image;
     const char* name_src;
-    char alt[256];
 
     if (task_can_create_global() != 0) {
         print_string_serial("ERREUR: Capacite globale de taches atteinte\n");
         return NULL;
     }
-    file_data = (uint8_t*)initrd_read_file(filename);
+    // Résolution (initrd puis bin/) et analyse ELF mises en cache par chemin
+    image = elf_image_get(filename);
+    if (!image) return NULL;
     name_src = filename;
-    if (!file_data && filename && filename[0] && filename[0] != '/') {
-        int slash = 0;
-        int i = 0;
-        while (filename[i]) {
-            if (filename[i] == '/') slash = 1;
-            i++;
-        }
-        if (!slash) {
-            alt[0] = 'b'; alt[1] = 'i'; alt[2] = 'n'; alt[3] = '/';
-            i = 0;
-            while (filename[i] && i < 250) {
-                alt[4 + i] = filename[i];
-                i++;
-            }
-            alt[4 + i] = '\0';
-            file_data = (uint8_t*)initrd_read_file(alt);
-            if (file_data) name_src = alt;
-        }
-    }
-    if (!file_data) {
-        print_string_serial("ERREUR: Fichier non trouve dans l'initrd\n");
-        return NULL;
-    }
 
     vmm_directory_t* vmm_dir = create_user_vmm_directory();
     if (!vmm_dir) {
@@ -377,23 +661,13 @@ task_t* create_task_from_initrd_file(const char* filename) {
     uint32_t entry_point = 0;
     uint32_t user_stack_top = 0;
 
-    // --- Critical section for new task's address space ---
-    vmm_directory_t* old_dir = current_directory;
-    vmm_switch_page_directory(vmm_dir->physical_addr);
-    current_directory = vmm_dir;
-
-    // Load the executable into the new address space
-    entry_point = elf_load(file_data, vmm_dir);
+    // Le chargeur remplit les frames par la fenêtre noyau : pas de bascule de CR3
+    entry_point = elf_image_map(image, vmm_dir);
     if (entry_point != 0) {
         // Allocate the user stack in the new address space
         user_stack_top = allocate_user_stack(vmm_dir);
     }
 
-    // Restore the kernel's address space
-    vmm_switch_page_directory(old_dir->physical_addr);
-    current_directory = old_dir;
-    // --- End of critical section ---
-
     if (entry_point == 0 || user_stack_top == 0) {
         print_string_serial("ERREUR: Chargement ELF ou allocation de pile a echoue\n");
         (void)task_destroy_user_vmm(vmm_dir);
@@ -467,10 +741,18 @@ task_t* create_task_from_initrd_file(const char* filename) {
     setup_initial_user_context(new_task, entry_point, user_stack_top);
     add_task_to_queue(new_task);
 
-    print_string_serial("Tache utilisateur creee avec succes\n");
+    TRACE(TRACE_LEVEL_EVENT, OS_TRACE_TASK_CREATE, new_task->id, entry_point, user_stack_top);
     return new_task;
 }
 
+/* Le chemin alternatif "bin/<nom>" vit dans l'arène de l'appelant le temps du chargement. */
+task_t* create_task_from_initrd_file(const char* filename) {
+    uint32_t mark = task_scratch_mark();
+    task_t* task = task_create_from_initrd_path(filename);
+    task_scratch_rewind(mark);
+    return task;
+}
+
 void setup_initial_user_context(task_t* task, uint32_t entry_point, uint32_t stack_top) {
     memset(&task->cpu_state, 0, sizeof(cpu_state_t));
     
@@ -495,48 +777,40 @@ void setup_initial_user_context(task_t* task, uint32_t entry_point, uint32_t sta
     task->cpu_state.fs = 0x23;
     task->cpu_state.gs = 0x23;
     task->cpu_state.ss = 0x23;  // Stack segment utilisateur (Ring 3)
-    
-    print_string_serial("User context setup complete. EIP=0x");
-    print_hex_serial(task->cpu_state.eip);
-    print_string_serial(", ESP=0x");
-    print_hex_serial(task->cpu_state.useresp);
-    print_string_serial("\n");
 }
 
 vmm_directory_t* create_user_vmm_directory() {
     vmm_directory_t* dir;
-    print_string_serial("create_user_vmm_directory: static pool\n");
     dir = task_static_vmm_acquire();
     if (!dir) print_string_serial("create_user_vmm_directory: static pool exhausted\n");
     return dir;
 }
 
 #define USER_STACK_TOP 0xB0000000
-#define USER_STACK_PAGES 16
-#define USER_STACK_SIZE (USER_STACK_PAGES * PAGE_SIZE)
+/* La pile est peuplée page par page au premier accès, jusqu'à la limite de
+ * croissance ; la zone de garde en dessous transforme un débordement en faute. */
+#ifndef USER_STACK_LIMIT_PAGES
+#define USER_STACK_LIMIT_PAGES 64U
+#endif
+#ifndef USER_STACK_GUARD_PAGES
+#define USER_STACK_GUARD_PAGES 4U
+#endif
+#define USER_STACK_SIZE (USER_STACK_LIMIT_PAGES * PAGE_SIZE)
 #define USER_STACK_BOTTOM (USER_STACK_TOP - USER_STACK_SIZE)
+#define USER_STACK_GUARD_BOTTOM (USER_STACK_BOTTOM - USER_STACK_GUARD_PAGES * PAGE_SIZE)
 
 uint32_t allocate_user_stack(vmm_directory_t* vmm_dir) {
-    print_string_serial("Allocating user stack...\n");
-    for (uint32_t addr = USER_STACK_BOTTOM; addr < USER_STACK_TOP; addr += PAGE_SIZE) {
-        void* stack_phys_page = pmm_alloc_page();
-        if (!stack_phys_page) {
-            print_string_serial("ERROR: Could not allocate physical page for user stack\n");
-            // In a real scenario, we should free previously allocated pages
-            return 0;
-        }
-        if (vmm_map_page_in_directory(vmm_dir, stack_phys_page, (void*)addr, PAGE_PRESENT | PAGE_WRITE | PAGE_USER) != 0) {
-            pmm_free_page(stack_phys_page);
-            return 0;
-        }
+    if (USER_STACK_GUARD_PAGES > 0U &&
+        vmm_add_area(vmm_dir, USER_STACK_GUARD_BOTTOM, USER_STACK_BOTTOM, VMM_AREA_GUARD) != 0) {
+        print_string_serial("ERROR: Could not reserve user stack guard\n");
+        return 0;
+    }
+    if (vmm_add_area(vmm_dir, USER_STACK_BOTTOM, USER_STACK_TOP, PAGE_WRITE) != 0) {
+        print_string_serial("ERROR: Could not reserve user stack area\n");
+        return 0;
     }
 
-    print_string_serial("User stack allocated at 0x");
-    print_hex_serial(USER_STACK_BOTTOM);
-    print_string_serial(" - 0x");
-    print_hex_serial(USER_STACK_TOP);
-    print_string_serial("\n");
-
+    TRACE(TRACE_LEVEL_VERBOSE, OS_TRACE_USER_STACK, USER_STACK_BOTTOM, USER_STACK_TOP, 0);
     return USER_STACK_TOP;
 }
 
@@ -567,17 +841,54 @@ task_t* get_task_by_id(int id) {
     return NULL;
 }
 
+// La tâche courante n'est jamais en file : toute tâche Ring 3 en file est une autre.
 int task_has_other_ready_user(void) {
-    task_t* t;
     if (!task_queue || !current_task) return 0;
-    t = current_task->next;
-    while (t && t != current_task) {
-        if (t->type == TASK_TYPE_USER && t->state == TASK_READY) return 1;
-        t = t->next;
+    return runq_has_user(&smp_cpu()->runq);
+}
+
+int task_work_available(void) {
+    cpu_t* self = smp_cpu();
+    if (runq_has_user(&self->runq)) return 1;
+    for (uint32_t i = 0U; i < SMP_MAX_CPUS; i++) {
+        cpu_t* cpu = &smp_cpus[i];
+        if (cpu != self && cpu->online && cpu->runq.user_count != 0U) return 1;
     }
     return 0;
 }
 
+void task_enter_idle(void) {
+    smp_cpu()->idle_task = current_task;
+}
+
+task_t* task_create_idle(uint32_t cpu_index) {
+    // task_static_acquire() rend un slot à zéro : seuls les champs non nuls sont posés
+    task_t* task = task_static_acquire();
+    if (!task) return NULL;
+    task->id = next_task_id++;
+    task->state = TASK_RUNNING;
+    task->type = TASK_TYPE_KERNEL;
+    task->priority = OS_TASK_PRIORITY_LOW;
+    task->vmm_dir = kernel_directory;
+    task->parent_pid = -1;
+    task->created_ticks = timer_get_ticks();
+    task->last_scheduled_ticks = task->created_ticks;
+    task->switch_count = 1U;
+    task->last_child_pid = -1;
+    task->child_exit_history_generation = 1U;
+    task->supervision_notify_mask = OS_TASK_SUPERVISION_NOTIFY_ALL;
+    task->supervision_priority_child_pid = -1;
+    ipc_endpoint_init(&task->ipc_endpoint);
+    memcpy(task->name, "idle", 4U);
+    task->name[4] = (char)('0' + cpu_index % 10U);
+    task->name[5] = '\0';
+    task->cpu = cpu_index;
+    add_task_to_queue(task);
+    current_task = task;
+    smp_cpu()->idle_task = task;
+    return task;
+}
+
 int get_task_count(void) {
     int n = 0;
     task_t* t;
@@ -638,7 +949,7 @@ int task_wait_for_child(int requester_pid, int child_pid) {
         return OS_TASK_CONTROL_DENIED;
     }
     child->waiter_pid = requester_pid;
-    parent->state = TASK_WAITING;
+    task_set_state(parent, TASK_WAITING);
     return 0;
 }
 
@@ -659,7 +970,7 @@ int task_wait_for_any_child(int requester_pid) {
         t = t->next;
     } while (t && t != task_queue);
     if (!found) return OS_TASK_NO_DIRECT_CHILD;
-    parent->state = TASK_WAITING;
+    task_set_state(parent, TASK_WAITING);
     return 0;
 }
 
@@ -673,9 +984,7 @@ int task_kill(int requester_pid, int pid) {
     task_report_parent_exit(t, OS_TASK_EXIT_KILLED, OS_TASK_EVENT_KILLED);
     task_wake_waiter(t);
     task_reparent_children(t);
-    t->state = TASK_TERMINATED;
-    unlink_task(t);
-    task_release_detached(t);
+    task_terminate(t);
     return 0;
 }
 
@@ -698,9 +1007,7 @@ int task_kill_direct_children(int requester_pid) {
         task_report_parent_exit(child, OS_TASK_EXIT_KILLED, OS_TASK_EVENT_KILLED);
         task_wake_waiter(child);
         task_reparent_children(child);
-        child->state = TASK_TERMINATED;
-        unlink_task(child);
-        task_release_detached(child);
+        task_terminate(child);
     }
     return (int)count;
 }
@@ -758,7 +1065,7 @@ static void task_notify_supervision_event(task_t* parent,
     parent->supervision_notify_budget_used++;
     parent->supervision_delivery_attempted++;
     /* Best effort : une boîte pleine ne retarde jamais une transition de supervision. */
-    if (ipc_endpoint_send(&parent->ipc_endpoint, 0, &payload) == 0) {
+    if (task_ipc_deliver(parent, 0, &payload) == 0) {
         parent->supervision_delivery_delivered++;
     } else {
         parent->supervision_delivery_dropped++;
@@ -801,7 +1108,7 @@ int task_suspend_child(int requester_pid, int child_pid) {
         return OS_TASK_CONTROL_DENIED;
     }
     if (child->state != TASK_READY) return OS_TASK_BAD_STATE;
-    child->state = TASK_SUSPENDED;
+    task_set_state(child, TASK_SUSPENDED);
     task_record_supervision_event(parent, OS_TASK_SUPERVISION_SUSPEND, child_pid, 0, 0U);
     return 0;
 }
@@ -814,7 +1121,7 @@ int task_resume_child(int requester_pid, int child_pid) {
         return OS_TASK_CONTROL_DENIED;
     }
     if (child->state != TASK_SUSPENDED) return OS_TASK_BAD_STATE;
-    child->state = TASK_READY;
+    task_set_state(child, TASK_READY);
     task_record_supervision_event(parent, OS_TASK_SUPERVISION_RESUME, child_pid, 0, 0U);
     return 0;
 }
@@ -824,7 +1131,7 @@ void task_wake_waiter(task_t* child) {
     if (!child || child->waiter_pid <= 0) return;
     parent = get_task_by_id(child->waiter_pid);
     if (parent && parent->state == TASK_WAITING) {
-        parent->state = TASK_READY;
+        task_set_state(parent, TASK_READY);
     }
     child->waiter_pid = 0;
 }
@@ -865,7 +1172,7 @@ void task_report_parent_exit(task_t* child, int exit_code, uint32_t reason) {
     }
     if (os_task_make_event(&payload, child->id, reason) != 0) return;
     /* Best effort : la terminaison ne dépend jamais d’une boîte IPC disponible. */
-    (void)ipc_endpoint_send(&parent->ipc_endpoint, 0, &payload);
+    (void)task_ipc_deliver(parent, 0, &payload);
 }
 
 static int32_t map_task_state(task_state_t s) {
@@ -1143,7 +1450,7 @@ int task_replay_supervision_event(int requester_pid, uint32_t sequence) {
     if (rc != 0) return rc;
     if (os_task_make_supervision_event(&payload, &event) != 0) return OS_IPC_BAD_MESSAGE;
     parent->supervision_delivery_attempted++;
-    rc = ipc_endpoint_send(&parent->ipc_endpoint, 0, &payload);
+    rc = task_ipc_deliver(parent, 0, &payload);
     if (rc == 0) {
         parent->supervision_delivery_delivered++;
         return 0;
@@ -1282,6 +1589,34 @@ int task_fill_ps(os_proc_t* out, int max_n) {
     return count;
 }
 
+/* Compteurs du répertoire de chaque tâche : pas de parcours des tables. */
+void task_fill_memstats(os_memstats_t* out) {
+    task_t* t;
+    out->task_count = 0U;
+    if (!task_queue) return;
+    t = task_queue;
+    do {
+        os_task_mem_t* entry;
+        int i;
+        if (out->task_count >= OS_TASK_GLOBAL_CAPACITY) break;
+        entry = &out->tasks[out->task_count++];
+        entry->pid = t->id;
+        entry->resident_pages = 0U;
+        entry->table_pages = 0U;
+        if (t->vmm_dir && t->vmm_dir != kernel_directory) {
+            entry->resident_pages = t->vmm_dir->resident_pages;
+            entry->table_pages = t->vmm_dir->table_pages;
+        }
+        i = 0;
+        while (t->name[i] && i < OS_PROC_NAME_MAX - 1) {
+            entry->name[i] = t->name[i];
+            i++;
+        }
+        entry->name[i] = '\0';
+        t = t->next;
+    } while (t && t != task_queue);
+}
+
 int task_fill_metrics(int pid, os_task_metrics_t* out) {
     task_t* t;
     uint32_t now;
@@ -1329,6 +1664,12 @@ int task_set_priority(int requester_pid, int pid, uint32_t priority) {
         return OS_TASK_CONTROL_DENIED;
     }
     t->priority = priority;
+    // Une tâche prête change de file tout de suite
+    if (t->run_queue) {
+        runq_t* rq = t->run_queue;
+        runq_remove(t);
+        runq_enqueue(rq, t);
+    }
     return 0;
 }
 
@@ -4,7 +4,9 @@
 #include <stdint.h>
 #include "kernel/mem/vmm.h" // Inclure pour vmm_directory_t
 #include "os_syscalls.h"
+#include "os_arena.h"
 #include "../ipc.h"
+#include "../timer_wheel.h"
 
 // États possibles d'une tâche
 typedef enum {
@@ -12,6 +14,8 @@ typedef enum {
     TASK_READY,
     TASK_WAITING,
     TASK_WAITING_FOR_INPUT,
+    TASK_SLEEPING,             // SYS_SLEEP, SYS_DOORBELL_WAIT : échéance, message IPC ou sonnette
+    TASK_WAITING_FOR_IPC,      // SYS_IPC_RECV_WAIT : message filtré ou échéance
     TASK_SUSPENDED,
     TASK_TERMINATED
 } task_state_t;
@@ -44,6 +48,10 @@ typedef struct task {
     uint32_t priority;          // Politique CPU locale : 1 (bas) à 3 (haut)
     vmm_directory_t* vmm_dir;  // Répertoire de pages de la tâche
     uint32_t kernel_stack_p;   // Pointeur vers le sommet de la pile noyau
+    uint32_t kernel_esp;       // ESP sauvé par switch_to(), 0 avant la première élection
+    uint32_t kernel_lock_depth; // Profondeur du verrou noyau à la bascule
+    uint32_t kernel_preemptible; // Sections task_preempt_enable() ouvertes
+    uint8_t* fpu_state;        // Zone FXSAVE (512 octets, alignée sur 16)
     char name[32];
     int parent_pid;            // Créateur direct, -1 pour la tâche racine
     int waiter_pid;            // Parent TASK_WAITING (SYS_EXEC), 0 sinon
@@ -51,6 +59,8 @@ typedef struct task {
     uint32_t last_scheduled_ticks;
     uint32_t run_ticks;        // Temps cumulé approximatif en tâche courante
     uint32_t switch_count;     // Nombre de sélections par l’ordonnanceur
+    uint64_t perf_switch_tsc;  // TSC de la dernière sortie du CPU (perf.h)
+    uint64_t perf_off_cpu;     // Cycles cumulés hors CPU, retirés des mesures perf
     int last_child_pid;         // Dernier enfant direct terminé observé par ce parent
     int last_child_exit_code;   // Code SYS_EXIT ou OS_TASK_EXIT_KILLED
     uint32_t last_child_exit_reason;
@@ -77,12 +87,31 @@ typedef struct task {
     uint32_t supervision_notify_budget_limit;
     uint32_t supervision_notify_budget_used;
     ipc_endpoint_t ipc_endpoint; // Boîte aux lettres IPC propre à la tâche
+    os_arena_t scratch;          // Temporaires noyau, remis à zéro en sortie de syscall
+    timer_event_t sleep_timer;   // Échéance d'une attente bornée (timer.c)
+    os_ipc_filter_t ipc_wait_filter; // Messages qui réveillent TASK_WAITING_FOR_IPC
+    cpu_state_t* ipc_frame;      // Cadre syscall d'un appel bloqué : message court en registres
+    uint32_t doorbell;           // Sonnette levée par SYS_DOORBELL_RING, consommée par SYS_DOORBELL_WAIT
+    uint32_t event_ring;         // Région shm des messages noyau (SYS_EVENT_RING), 0 : boîte aux lettres
+    uint32_t event_ring_mask;
+    uint32_t event_ring_head;    // Copie noyau de head, l'en-tête partagé étant inscriptible
     struct task* next;         // Pour la liste chaînée de tâches
     struct task* prev;         // Liste doublement chaînée
+    struct task* run_next;     // File prête (runq.c), seulement si TASK_READY
+    struct task* run_prev;
+    uint32_t run_level;
+    struct runq* run_queue;    // File qui contient la tâche, NULL hors file
+    uint32_t cpu;              // CPU d'affinité : file de réveil, changée par le vol
 } task_t;
 
 // Variables globales
+#ifdef KERNEL_TEST
 extern task_t* current_task;
+#else
+// Tâche en cours sur le CPU courant
+#include "kernel/smp.h"
+#define current_task (smp_cpu()->task)
+#endif
 extern task_t* task_queue;
 extern int next_task_id;
 extern volatile int g_reschedule_needed;
@@ -92,10 +121,51 @@ void tasking_init();
 task_t* create_task(void (*entry_point)());
 task_t* create_task_from_initrd_file(const char* filename);
 task_t* load_elf_task(uint8_t* elf_data, uint32_t size);
+/* Élit la tâche suivante et bascule sur sa pile noyau. Revient quand la
+ * tâche courante est réélue (jamais si elle est TASK_TERMINATED). Le cadre
+ * d'entrée cpu reste sur la pile noyau de l'appelant. */
 void schedule(cpu_state_t* cpu);
-void jump_to_task(cpu_state_t* state);
+/* Comme schedule(), mais élit next s'il est prêt, sans passer par les files :
+ * la tâche courante bloquée donne son CPU à son correspondant IPC. */
+void schedule_handoff(task_t* next);
+/* Sauve les registres préservés et ESP dans *prev_esp puis reprend next_esp. */
+void switch_to(uint32_t* prev_esp, uint32_t next_esp);
+void task_switch_finish(void);
 void task_exit();
-void task_yield();
+/* Cède le CPU depuis le noyau ; la tâche reste prête. */
+void task_yield(void);
+/* Point sûr d'un syscall long : cède le CPU si le quantum est épuisé et
+ * qu'une autre tâche Ring 3 attend. Verrou noyau tenu. */
+void task_yield_point(void);
+/* Section noyau préemptible : le verrou noyau est rendu et le timer peut
+ * élire une autre tâche au milieu. Réservée au code qui ne touche que l'état
+ * de la tâche ou un état dont elle est seule propriétaire. Renvoie la
+ * profondeur du verrou à rendre à task_preempt_disable(). */
+uint32_t task_preempt_enable(void);
+void task_preempt_disable(uint32_t lock_depth);
+/* Seul point de changement d'état : une tâche est dans les files prêtes
+ * si et seulement si elle est TASK_READY. Quitter une attente désarme son
+ * échéance ; un CPU inactif est réveillé par IPI pour la tâche prête. */
+void task_set_state(task_t* task, task_state_t state);
+/* Dépose un message dans l'endpoint de target. Le dépôt interrompt un
+ * sommeil ; un destinataire bloqué dont le filtre accepte le message repasse
+ * prêt en tête de sa file, sur le CPU de l'émetteur si le sien est occupé.
+ * Un message court pour un appel bloqué (ipc_frame) va dans ses registres. */
+int task_ipc_deliver(task_t* target, int32_t sender_pid, const os_ipc_payload_t* payload);
+/* Avec un anneau d'événements, les messages noyau (émetteur 0) y sont
+ * écrits ; le consommateur endormi (consumer_waiting) est sonné. */
+int task_set_event_ring(task_t* task, uint32_t region_id);
+/* Lève la sonnette et réveille un sommeil, comme un message accepté. */
+void task_doorbell_ring(task_t* task);
+/* Bloque la tâche courante sans échéance jusqu'à son retour à TASK_READY ;
+ * handoff, s'il est prêt, est élu à sa place (NULL : élection ordinaire). */
+void task_block(task_state_t state, task_t* handoff);
+
+// Arène de travail de la tâche courante (tampon statique, pas de free individuel)
+void* task_scratch_alloc(uint32_t size);
+uint32_t task_scratch_mark(void);
+void task_scratch_rewind(uint32_t mark);
+void task_scratch_reset(task_t* task);
 
 // Fonctions utilitaires
 task_t* get_task_by_id(int id);
@@ -103,8 +173,15 @@ void remove_task(task_t* task);
 void add_task_to_queue(task_t* task);
 int get_task_count();
 task_t* find_task_waiting_for_input(void);
-/* Vrai lorsqu’une autre tâche Ring 3 prête peut recevoir un quantum IRQ0. */
+/* Vrai lorsqu’une autre tâche Ring 3 prête peut recevoir un quantum sur ce CPU. */
 int task_has_other_ready_user(void);
+/* Vrai si une tâche Ring 3 attend dans la file locale ou peut y être volée. */
+int task_work_available(void);
+/* La tâche courante devient la tâche d'inactivité du CPU : un tick la quitte
+ * dès que task_work_available(). */
+void task_enter_idle(void);
+/* Crée la tâche d'inactivité courante d'un AP (son contexte de démarrage). */
+task_t* task_create_idle(uint32_t cpu_index);
 int task_kill(int requester_pid, int pid);
 void task_reparent_children(task_t* departing);
 uint32_t task_count_direct_children(int pid);
@@ -115,6 +192,7 @@ int task_wait_for_any_child(int requester_pid);
 int task_fill_direct_children(int requester_pid, os_task_children_t* out);
 int task_fill_ps(os_proc_t* out, int max_n);
 int task_fill_metrics(int pid, os_task_metrics_t* out);
+void task_fill_memstats(os_memstats_t* out);
 int task_fill_capacity(os_task_capacity_t* out);
 int task_set_priority(int requester_pid, int pid, uint32_t priority);
 int task_set_name(int requester_pid, int pid, const char* name);
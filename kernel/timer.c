@@ -1,5 +1,11 @@
 #include "timer.h"
+#include "timer_wheel.h"
 #include "task/task.h"
+#include "smp.h"
+#include "deferred.h"
+#include "perf.h"
+#include "profile.h"
+#include <stddef.h>
 
 // Fonctions externes
 extern void outb(unsigned short port, unsigned char data);
@@ -12,15 +18,51 @@ uint32_t timer_ticks = 0;
 uint32_t software_timer_counter = 0;
 int timer_mode = 0; // 0 = logiciel, 1 = matériel
 
-/* La préemption IRQ0 est limitée aux retours Ring 3 : un cadre noyau issu d’un
- * syscall ne possède pas l’ESP/SS utilisateur requis par jump_to_task(). */
+/* Échéances des tâches (sommeils, attentes bornées) : une seule roue, avancée
+ * par le BSP, seul à compter le temps. Verrou noyau tenu. */
+static timer_wheel_t timer_wheel;
+static uint32_t timer_frequency = TIMER_FREQUENCY;
+static uint32_t timer_pit_divisor = PIT_BASE_FREQUENCY / TIMER_FREQUENCY;
+/* Session de profilage : le PIT tire timer_irq0_substeps IRQ0 par tick ;
+ * seule la dernière compte le temps. Voulu par n'importe quel CPU, appliqué
+ * par le BSP. */
+static uint32_t timer_irq0_substeps = 1U;
+static uint32_t timer_irq0_substep = 0U;
+static volatile uint32_t timer_irq0_substeps_wanted = 1U;
+
+/* Sommeil sans tick d'un CPU inactif. Le BSP ne s'y met que si tous les CPU
+ * sont inactifs : il arrête le PIT et programme un coup du timer LAPIC (à
+ * défaut, un coup du PIT, borné à 65535 périodes) sur la prochaine échéance
+ * de la roue, puis compte au réveil le temps dormi. Un AP coupe son timer
+ * LAPIC et attend l'IPI de replanification. */
+#define TIMER_IDLE_NONE 0U
+#define TIMER_IDLE_LAPIC 1U
+#define TIMER_IDLE_PIT 2U
+#define TIMER_IDLE_STOPPED 3U
+#define TIMER_IDLE_MAX_TICKS 100U   // Au moins un réveil par seconde
+static uint32_t timer_idle_ticks = 0U;   // Ticks programmés par le BSP
+
+/* La préemption matérielle vise les cadres Ring 3 et les sections noyau
+ * déclarées préemptibles (task_preempt_enable) ; le reste du noyau ne cède
+ * qu'à ses points sûrs. Le dernier instant de préemption est propre à chaque
+ * CPU (cpu_t). */
 #define TIMER_PREEMPT_QUANTUM 20U
-static uint32_t timer_last_preempt_tick;
 
 static int timer_user_frame(const cpu_state_t* cpu) {
     return cpu && (cpu->cs & 3U) == 3U && (cpu->ss & 3U) == 3U;
 }
 
+static int timer_preemptible(const cpu_state_t* cpu, const task_t* task) {
+    return timer_user_frame(cpu) || task->kernel_preemptible != 0U;
+}
+
+int timer_preempt_due(void) {
+    cpu_t* self = smp_cpu();
+    if (timer_ticks - self->last_preempt_tick < TIMER_PREEMPT_QUANTUM) return 0;
+    self->last_preempt_tick = timer_ticks;
+    return 1;
+}
+
 // Timer logiciel de secours
 void software_timer_tick() {
     software_timer_counter++;
@@ -42,45 +84,239 @@ void software_timer_tick() {
     }
 }
 
-// Handler appelé par l'ISR du timer matériel
-void timer_handler(cpu_state_t* cpu) {
-    extern volatile int g_reschedule_needed;
-    timer_ticks++;
-    
-    // Debug périodique pour tracer l'activité du timer
-    if (timer_ticks % 100 == 0) {
-        print_string_serial("TIMER_ALIVE: tick=");
-        if (timer_ticks < 10000) {
-            int thousands = timer_ticks / 1000;
-            int hundreds = (timer_ticks / 100) % 10;
-            if (thousands > 0) write_serial('0' + thousands);
-            write_serial('0' + hundreds);
-            write_serial('0');
-            write_serial('0');
-        } else {
-            write_serial('9');
-            write_serial('9');
-            write_serial('+');
-        }
-        print_string_serial("\n");
+static void timer_advance(uint32_t ticks) {
+    timer_ticks += ticks;
+    timer_wheel_advance(&timer_wheel, timer_ticks);
+}
+
+static void timer_pit_periodic(void) {
+    uint32_t divisor = timer_pit_divisor / timer_irq0_substeps;
+    // 0x36 : canal 0, LSB/MSB, mode 3 (onde carrée)
+    outb(PIT_COMMAND, 0x36);
+    outb(PIT_CHANNEL_0, (uint8_t)(divisor & 0xFF));
+    outb(PIT_CHANNEL_0, (uint8_t)((divisor >> 8) & 0xFF));
+}
+
+static int timer_pic_irq0_pending(void) {
+    outb(0x20, 0x0A);   // OCW3 : lecture de l'IRR
+    return (inb(0x20) & 0x01U) != 0U;
+}
+
+static int timer_other_cpus_idle(const cpu_t* self) {
+    for (uint32_t i = 0U; i < SMP_MAX_CPUS; i++) {
+        const cpu_t* cpu = &smp_cpus[i];
+        if (cpu != self && cpu->online && cpu->task != cpu->idle_task) return 0;
     }
-    
+    return 1;
+}
+
+static void timer_idle_arm(cpu_t* self) {
+    uint32_t ticks, count;
+    if (self->index != 0U) {
+        if (smp_lapic_timer_stop()) self->idle_timer = TIMER_IDLE_STOPPED;
+        return;
+    }
+    // Un AP actif lit l'horloge : elle doit avancer ; le profilage l'échantillonne
+    if (!timer_other_cpus_idle(self) || timer_irq0_substeps != 1U) return;
+    ticks = timer_wheel_next_delta(&timer_wheel);
+    if (ticks > TIMER_IDLE_MAX_TICKS) ticks = TIMER_IDLE_MAX_TICKS;
+    if (ticks < 2U) return;
+    // Mode 0 sans décompte : canal 0 arrêté, sortie basse, plus aucun front
+    outb(PIT_COMMAND, PIT_CHANNEL_0_SELECT | PIT_ACCESS_LOHI | PIT_MODE_ONESHOT);
+    timer_idle_ticks = smp_lapic_oneshot(ticks);
+    if (timer_idle_ticks != 0U) {
+        self->idle_timer = TIMER_IDLE_LAPIC;
+        return;
+    }
+    if (ticks > 0xFFFFU / timer_pit_divisor) ticks = 0xFFFFU / timer_pit_divisor;
+    // Un front déjà en attente serait pris pour la fin du coup
+    if (ticks < 2U || timer_pic_irq0_pending()) {
+        timer_pit_periodic();
+        return;
+    }
+    count = ticks * timer_pit_divisor;
+    outb(PIT_CHANNEL_0, (uint8_t)(count & 0xFF));
+    outb(PIT_CHANNEL_0, (uint8_t)((count >> 8) & 0xFF));
+    timer_idle_ticks = ticks;
+    self->idle_timer = TIMER_IDLE_PIT;
+}
+
+/* from_irq0 : appelé par IRQ0, fin du coup PIT ou, en mode LAPIC, front
+ * arrivé avant l'arrêt du PIT (un tick non compté). */
+static void timer_idle_account(cpu_t* self, int from_irq0) {
+    uint32_t elapsed;
+    if (self->idle_timer == TIMER_IDLE_NONE) return;
+    if (self->idle_timer == TIMER_IDLE_STOPPED) {
+        self->idle_timer = TIMER_IDLE_NONE;
+        smp_lapic_timer_start();
+        // Le BSP endormi doit reprendre l'horloge que cet AP va lire
+        if (smp_cpus[0].idle_timer != TIMER_IDLE_NONE) smp_send_reschedule(&smp_cpus[0]);
+        return;
+    }
+    if (self->idle_timer == TIMER_IDLE_LAPIC) {
+        elapsed = smp_lapic_oneshot_stop() + (from_irq0 ? 1U : 0U);
+    } else if (from_irq0) {
+        elapsed = timer_idle_ticks;
+    } else {
+        uint32_t status, remaining, count;
+        outb(PIT_COMMAND, PIT_READBACK_CHANNEL_0);
+        status = inb(PIT_CHANNEL_0);
+        remaining = inb(PIT_CHANNEL_0);
+        remaining |= (uint32_t)inb(PIT_CHANNEL_0) << 8;
+        // Coup déjà tiré : l'IRQ0 en attente le comptera
+        if (status & PIT_STATUS_OUT) return;
+        count = timer_idle_ticks * timer_pit_divisor;
+        elapsed = remaining < count ? (count - remaining) / timer_pit_divisor : 0U;
+    }
+    self->idle_timer = TIMER_IDLE_NONE;
+    timer_pit_periodic();
+    timer_advance(elapsed);
+}
+
+void timer_idle_resume(void) {
+    timer_idle_account(smp_cpu(), 0);
+}
+
+void timer_idle_wait(void) {
+    asm volatile("cli");
+    smp_kernel_enter();
+    // Travail différé échu : servi ici quand aucune tâche n'entre en syscall
+    if (deferred_work_pending) {
+        asm volatile("sti");
+        (void)deferred_work_run(timer_ticks);
+        asm volatile("cli");
+    }
+    if (!task_work_available() && !g_reschedule_needed) timer_idle_arm(smp_cpu());
+    smp_kernel_leave();
+    asm volatile("sti; hlt");
+    asm volatile("cli");
+    smp_kernel_enter();
+    timer_idle_resume();
+    // Réveil par une IRQ (clavier, échéance) : la tâche prête passe sans attendre le tick
+    if (task_work_available()) task_yield();
+    smp_kernel_leave();
+    asm volatile("sti");
+}
+
+static void timer_sleep_fire(timer_event_t* event) {
+    task_t* task = (task_t*)((uint8_t*)event - offsetof(task_t, sleep_timer));
+    if (task->state == TASK_SLEEPING || task->state == TASK_WAITING_FOR_INPUT ||
+        task->state == TASK_WAITING_FOR_IPC) {
+        task_set_state(task, TASK_READY);
+    }
+}
+
+void timer_block_until(task_state_t state, uint32_t deadline, task_t* handoff) {
+    task_t* task = current_task;
+    uint32_t flags;
+    if (!task || task == smp_cpu()->idle_task) return;
+    if ((int32_t)(deadline - timer_ticks) <= 0) return;
+    asm volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    task->sleep_timer.fire = timer_sleep_fire;
+    timer_wheel_arm(&timer_wheel, &task->sleep_timer, deadline);
+    task_set_state(task, state);
+    schedule_handoff(handoff);
+    if (flags & 0x200U) asm volatile("sti");
+}
+
+void timer_arm(timer_event_t* event, uint32_t expires) {
+    uint32_t flags;
+    asm volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    timer_wheel_arm(&timer_wheel, event, expires);
+    if (flags & 0x200U) asm volatile("sti");
+}
+
+void timer_sleep_cancel(task_t* task) {
+    timer_wheel_cancel(&timer_wheel, &task->sleep_timer);
+}
+
+uint32_t timer_ms_to_ticks(uint32_t ms) {
+    uint32_t ms_per_tick = 1000U / timer_frequency;
+    if (ms_per_tick == 0U) ms_per_tick = 1U;
+    return ms / ms_per_tick + (ms % ms_per_tick != 0U ? 1U : 0U);
+}
+
+static void timer_tick(cpu_state_t* cpu) {
+    cpu_t* self = smp_cpu();
+    if (self->idle_timer != TIMER_IDLE_NONE) timer_idle_account(self, 1);
+    else timer_advance(1U);
+
     // Changement explicite existant (lancement du shell / yield coopératif).
     if (g_reschedule_needed) {
         g_reschedule_needed = 0;
         schedule(cpu);
+        return;
+    }
+
+    timer_yield_handler(cpu);
+}
+
+// Handler appelé par l'ISR du timer matériel (BSP)
+void timer_handler(cpu_state_t* cpu) {
+    perf_span_t span;
+    perf_begin(&span);
+    if (profile_active) profile_sample(cpu);
+    if (++timer_irq0_substep >= timer_irq0_substeps) {
+        timer_irq0_substep = 0U;
+        if (timer_irq0_substeps != timer_irq0_substeps_wanted) {
+            timer_irq0_substeps = timer_irq0_substeps_wanted;
+            timer_pit_periodic();
+        }
+        timer_tick(cpu);
+    }
+    perf_end(OS_PERF_SLOT_IRQ(0), &span);
+}
+
+void timer_set_irq0_multiplier(uint32_t multiplier) {
+    if (multiplier == 0U || multiplier > timer_pit_divisor) multiplier = 1U;
+    timer_irq0_substeps_wanted = multiplier;
+}
+
+/* Décision de planification du CPU courant, commune à IRQ0 (BSP), au timer
+ * LAPIC (AP) et à INT 0x30 ; ne compte pas de tick. */
+void timer_yield_handler(cpu_state_t* cpu) {
+    cpu_t* self = smp_cpu();
+    task_t* task = current_task;
+    if (!task) return;
+
+    // Tuée depuis un autre CPU pendant qu'elle tournait ici : on la quitte
+    if (timer_preemptible(cpu, task) && task->state == TASK_TERMINATED) {
+        schedule(cpu);
     }
 
-    /* Préemption matérielle : uniquement entre deux cadres utilisateur valides.
-     * Le garde Ring 3 évite le basculement depuis un syscall ou une IRQ noyau. */
-    if (timer_user_frame(cpu) && current_task && current_task->type == TASK_TYPE_USER &&
-        task_has_other_ready_user() &&
-        timer_ticks - timer_last_preempt_tick >= TIMER_PREEMPT_QUANTUM) {
-        timer_last_preempt_tick = timer_ticks;
+    // Inactif : élire (ou voler) une tâche Ring 3 dès qu'il y en a une
+    if (task == self->idle_task) {
+        if (task_work_available()) schedule(cpu);
+        return;
+    }
+
+    /* Préemption matérielle : cadre utilisateur, ou syscall dans une section
+     * préemptible. schedule() revient quand la tâche est réélue. */
+    if (timer_preemptible(cpu, task) && task->type == TASK_TYPE_USER &&
+        task_has_other_ready_user() && timer_preempt_due()) {
         schedule(cpu);
     }
 }
 
+/* Handler du timer LAPIC : quantum des AP, coup de réveil du BSP endormi. Le
+ * temps global reste compté par IRQ0 sur le BSP. */
+void lapic_timer_handler(cpu_state_t* cpu) {
+    perf_span_t span;
+    perf_begin(&span);
+    if (profile_active) profile_sample(cpu);
+    smp_lapic_eoi();
+    timer_yield_handler(cpu);
+    perf_end(OS_PERF_SLOT_LAPIC_TIMER, &span);
+}
+
+void reschedule_ipi_handler(cpu_state_t* cpu) {
+    perf_span_t span;
+    perf_begin(&span);
+    smp_lapic_eoi();
+    timer_yield_handler(cpu);
+    perf_end(OS_PERF_SLOT_RESCHED_IPI, &span);
+}
+
 // Fonction unifiée pour obtenir les ticks (marche avec les deux modes)
 uint32_t timer_get_ticks() {
     return timer_ticks;
@@ -97,18 +333,12 @@ void timer_update() {
 // Initialise le timer matériel (PIT) pour le scheduling préemptif
 void timer_init(uint32_t frequency) {
     timer_mode = 1; // Mode matériel
-    timer_last_preempt_tick = 0U;
 
     // Le PIT (Programmable Interval Timer) utilise une fréquence de base de 1.193182 MHz
-    uint32_t divisor = 1193182 / frequency;
-
-    // Envoie l'octet de commande pour le canal 0
-    // 0x36 = 00110110b -> Canal 0, LSB/MSB, Mode 2 (rate generator)
-    outb(0x43, 0x36);
-
-    // Envoie le diviseur
-    outb(0x40, (uint8_t)(divisor & 0xFF));
-    outb(0x40, (uint8_t)((divisor >> 8) & 0xFF));
+    timer_frequency = frequency;
+    timer_pit_divisor = PIT_BASE_FREQUENCY / frequency;
+    timer_pit_periodic();
+    timer_wheel_init(&timer_wheel, timer_ticks);
 }
 
 // Attend un certain nombre de ticks
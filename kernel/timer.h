@@ -16,6 +16,10 @@
 #define PIT_CHANNEL_0_SELECT    0x00
 #define PIT_ACCESS_LOHI         0x30
 #define PIT_MODE_SQUARE_WAVE    0x06
+#define PIT_MODE_ONESHOT        0x00    // Mode 0 : interruption au terme du décompte
+#define PIT_READBACK_CHANNEL_0  0xC2    // Relit état et décompte du canal 0
+#define PIT_STATUS_OUT          0x80
+#define PIT_BASE_FREQUENCY      1193182U
 
 // Variables globales
 extern uint32_t timer_ticks;
@@ -26,6 +30,31 @@ extern int timer_mode;
 // Fonctions publiques
 void timer_init(uint32_t frequency);
 void timer_handler(cpu_state_t* cpu);
+void timer_yield_handler(cpu_state_t* cpu);
+void lapic_timer_handler(cpu_state_t* cpu);
+void reschedule_ipi_handler(cpu_state_t* cpu);
+/* Boucle d'inactivité : sans tâche à élire, le CPU dort sans tick jusqu'à la
+ * prochaine échéance de la roue (BSP) ou jusqu'à un IPI (AP). */
+void timer_idle_wait(void);
+/* IRQ0 par tick du PIT (profilage, profile.h) ; 1 rend la cadence normale.
+ * Appliqué par le BSP à son prochain tick ; le sommeil sans tick du BSP est
+ * suspendu tant que la cadence est multipliée. */
+void timer_set_irq0_multiplier(uint32_t multiplier);
+/* Rend au CPU son tick périodique et compte le temps dormi ; sans effet hors
+ * sommeil sans tick. */
+void timer_idle_resume(void);
+/* Bloque la tâche courante dans state jusqu'au tick deadline ou à un réveil
+ * explicite (task_set_state) ; revient à sa réélection. Sans effet pour une
+ * échéance passée ou une tâche d'inactivité. handoff : voir task_block(). */
+void timer_block_until(task_state_t state, uint32_t deadline, task_t* handoff);
+/* Arme un événement sur la roue commune ; son rappel tourne dans IRQ0. */
+void timer_arm(timer_event_t* event, uint32_t expires);
+/* Désarme l'échéance de la tâche (réveil anticipé, terminaison). */
+void timer_sleep_cancel(task_t* task);
+/* Durée en ticks arrondie au tick supérieur. */
+uint32_t timer_ms_to_ticks(uint32_t ms);
+/* Vrai (et quantum réarmé) si la tâche courante a épuisé son quantum sur ce CPU. */
+int timer_preempt_due(void);
 uint32_t timer_get_ticks();
 void timer_wait(uint32_t ticks);
 void timer_update();
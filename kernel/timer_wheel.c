@@ -0,0 +1,135 @@
+#include "timer_wheel.h"
+#include <stddef.h>
+
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1U)
+
+void timer_wheel_init(timer_wheel_t* wheel, uint32_t now) {
+    for (uint32_t level = 0U; level < TIMER_WHEEL_LEVELS; level++) {
+        for (uint32_t slot = 0U; slot < TIMER_WHEEL_SLOTS; slot++) wheel->slots[level][slot] = NULL;
+        wheel->occupied[level] = 0U;
+    }
+    wheel->now = now;
+    wheel->count = 0U;
+}
+
+void timer_event_init(timer_event_t* event, timer_event_fn fire) {
+    event->next = NULL;
+    event->pprev = NULL;
+    event->expires = 0U;
+    event->fire = fire;
+    event->level = 0U;
+    event->slot = 0U;
+}
+
+/* Niveau le plus bas dont un tour couvre l'écart : l'échéance y tombe dans
+ * une case que la roue n'a pas encore dépassée. */
+static void timer_wheel_link(timer_wheel_t* wheel, timer_event_t* event) {
+    uint32_t delta = event->expires - wheel->now;
+    uint32_t level = 0U;
+    uint32_t slot;
+    if (delta > TIMER_WHEEL_MAX_DELTA) {
+        event->expires = wheel->now + TIMER_WHEEL_MAX_DELTA;
+        delta = TIMER_WHEEL_MAX_DELTA;
+    }
+    while (level + 1U < TIMER_WHEEL_LEVELS &&
+           delta >= (1U << ((level + 1U) * TIMER_WHEEL_SLOT_BITS))) {
+        level++;
+    }
+    slot = (event->expires >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+    event->level = (uint8_t)level;
+    event->slot = (uint8_t)slot;
+    event->next = wheel->slots[level][slot];
+    if (event->next) event->next->pprev = &event->next;
+    wheel->slots[level][slot] = event;
+    event->pprev = &wheel->slots[level][slot];
+    wheel->occupied[level] |= 1ULL << slot;
+    wheel->count++;
+}
+
+static void timer_wheel_unlink(timer_wheel_t* wheel, timer_event_t* event) {
+    *event->pprev = event->next;
+    if (event->next) event->next->pprev = event->pprev;
+    if (!wheel->slots[event->level][event->slot]) {
+        wheel->occupied[event->level] &= ~(1ULL << event->slot);
+    }
+    event->next = NULL;
+    event->pprev = NULL;
+    wheel->count--;
+}
+
+void timer_wheel_arm(timer_wheel_t* wheel, timer_event_t* event, uint32_t expires) {
+    if (timer_event_pending(event)) timer_wheel_unlink(wheel, event);
+    // La case du tick courant est déjà traitée
+    if ((int32_t)(expires - wheel->now) <= 0) expires = wheel->now + 1U;
+    event->expires = expires;
+    timer_wheel_link(wheel, event);
+}
+
+void timer_wheel_cancel(timer_wheel_t* wheel, timer_event_t* event) {
+    if (timer_event_pending(event)) timer_wheel_unlink(wheel, event);
+}
+
+/* Une case de niveau supérieur se vide vers les niveaux inférieurs quand la
+ * roue du dessous repasse par zéro. */
+static void timer_wheel_cascade(timer_wheel_t* wheel, uint32_t level, uint32_t slot) {
+    timer_event_t* event = wheel->slots[level][slot];
+    wheel->slots[level][slot] = NULL;
+    wheel->occupied[level] &= ~(1ULL << slot);
+    while (event) {
+        timer_event_t* next = event->next;
+        event->pprev = NULL;
+        wheel->count--;
+        timer_wheel_link(wheel, event);
+        event = next;
+    }
+}
+
+uint32_t timer_wheel_advance(timer_wheel_t* wheel, uint32_t now) {
+    uint32_t fired = 0U;
+    while ((int32_t)(now - wheel->now) > 0) {
+        uint32_t index;
+        timer_event_t* event;
+        // Roue vide : rien à descendre ni à déclencher, on saute l'intervalle
+        if (wheel->count == 0U) {
+            wheel->now = now;
+            break;
+        }
+        wheel->now++;
+        index = wheel->now & TIMER_WHEEL_SLOT_MASK;
+        if (index == 0U) {
+            for (uint32_t level = 1U; level < TIMER_WHEEL_LEVELS; level++) {
+                uint32_t slot = (wheel->now >> (level * TIMER_WHEEL_SLOT_BITS)) & TIMER_WHEEL_SLOT_MASK;
+                timer_wheel_cascade(wheel, level, slot);
+                if (slot != 0U) break;
+            }
+        }
+        // Le rappel peut réarmer : l'événement est hors roue avant l'appel
+        while ((event = wheel->slots[0][index]) != NULL) {
+            timer_wheel_unlink(wheel, event);
+            event->fire(event);
+            fired++;
+        }
+    }
+    return fired;
+}
+
+uint32_t timer_wheel_next_delta(const timer_wheel_t* wheel) {
+    uint32_t best = TIMER_WHEEL_NONE;
+    if (wheel->count == 0U) return TIMER_WHEEL_NONE;
+    for (uint32_t level = 0U; level < TIMER_WHEEL_LEVELS; level++) {
+        uint32_t shift = level * TIMER_WHEEL_SLOT_BITS;
+        uint32_t base = wheel->now >> shift;
+        uint32_t start = (base + 1U) & TIMER_WHEEL_SLOT_MASK;
+        uint64_t mask = wheel->occupied[level];
+        uint32_t distance;
+        uint32_t delta;
+        if (!mask) continue;
+        // Bit k après rotation = case start + k : première case non vide devant la roue
+        mask = (mask >> start) | (mask << ((TIMER_WHEEL_SLOTS - start) & TIMER_WHEEL_SLOT_MASK));
+        distance = (uint32_t)__builtin_ctzll(mask) + 1U;
+        // Niveau 0 : échéance exacte ; au-dessus : instant de la descente
+        delta = ((base + distance) << shift) - wheel->now;
+        if (delta < best) best = delta;
+    }
+    return best;
+}
@@ -0,0 +1,52 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+/* Roue hiérarchique d'échéances en ticks : quatre niveaux de 64 cases, le
+ * niveau n couvrant 64^(n+1) ticks. Armer et annuler sont en O(1) ; une
+ * échéance descend d'un niveau quand la roue inférieure fait un tour. Au-delà
+ * de 64^4 ticks, l'échéance est ramenée à la borne. Les événements sont
+ * intrusifs (aucune allocation) et leur rappel s'exécute dans advance(). */
+#define TIMER_WHEEL_LEVELS 4U
+#define TIMER_WHEEL_SLOT_BITS 6U
+#define TIMER_WHEEL_SLOTS (1U << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_MAX_DELTA ((1U << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1U)
+#define TIMER_WHEEL_NONE 0xFFFFFFFFU
+
+struct timer_event;
+typedef void (*timer_event_fn)(struct timer_event* event);
+
+typedef struct timer_event {
+    struct timer_event* next;
+    struct timer_event** pprev;   // Lien qui pointe sur l'événement, NULL hors roue
+    uint32_t expires;             // Tick d'échéance
+    timer_event_fn fire;
+    uint8_t level;                // Case occupée, pour tenir le bitmap à l'annulation
+    uint8_t slot;
+} timer_event_t;
+
+typedef struct {
+    timer_event_t* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    uint64_t occupied[TIMER_WHEEL_LEVELS];   // Bit n = case n non vide
+    uint32_t now;                            // Dernier tick traité
+    uint32_t count;
+} timer_wheel_t;
+
+void timer_wheel_init(timer_wheel_t* wheel, uint32_t now);
+void timer_event_init(timer_event_t* event, timer_event_fn fire);
+/* (Ré)arme l'événement ; une échéance déjà passée part au tick suivant. */
+void timer_wheel_arm(timer_wheel_t* wheel, timer_event_t* event, uint32_t expires);
+/* Sans effet sur un événement désarmé ou déjà déclenché. */
+void timer_wheel_cancel(timer_wheel_t* wheel, timer_event_t* event);
+/* Traite chaque tick jusqu'à now inclus ; renvoie le nombre de rappels. */
+uint32_t timer_wheel_advance(timer_wheel_t* wheel, uint32_t now);
+/* Ticks jusqu'au prochain rappel ou à la prochaine descente de niveau (borne
+ * sûre pour un réveil sans tick), TIMER_WHEEL_NONE si la roue est vide. */
+uint32_t timer_wheel_next_delta(const timer_wheel_t* wheel);
+
+static inline int timer_event_pending(const timer_event_t* event) {
+    return event->pprev != 0;
+}
+
+#endif
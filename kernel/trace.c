@@ -0,0 +1,109 @@
+#include "trace.h"
+#include "smp.h"
+#include "task/task.h"
+
+extern void print_string_serial(const char* str);
+extern void print_hex_serial(uint32_t n);
+extern void print_dec_serial(uint32_t n);
+extern void write_serial(char c);
+
+static trace_ring_t trace_rings[SMP_MAX_CPUS];
+
+static inline uint64_t trace_rdtsc(void) {
+    uint32_t low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+void trace_emit(uint32_t event, uint32_t a0, uint32_t a1, uint32_t a2) {
+    uint32_t flags;
+    cpu_t* self;
+    // Pas de verrou : seul ce CPU écrit son anneau, une IRQ ne doit pas s'intercaler
+    __asm__ volatile("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+    self = smp_cpu();
+    trace_ring_write(&trace_rings[self->index], trace_rdtsc(), event, self->index,
+                     current_task ? current_task->id : -1, a0, a1, a2);
+    if (flags & 0x200U) __asm__ volatile("sti");
+}
+
+/* Recule cursor jusqu'au prochain enregistrement lisible plus ancien. */
+static int trace_load_older(const trace_ring_t* ring, uint32_t* cursor, uint32_t oldest,
+                            os_trace_record_t* out) {
+    while (*cursor != oldest) {
+        (*cursor)--;
+        if (trace_ring_read(ring, *cursor, out)) return 1;
+    }
+    return 0;
+}
+
+uint32_t trace_snapshot(os_trace_record_t* out, uint32_t max) {
+    uint32_t cursor[SMP_MAX_CPUS];
+    uint32_t oldest[SMP_MAX_CPUS];
+    os_trace_record_t candidate[SMP_MAX_CPUS];
+    uint8_t loaded[SMP_MAX_CPUS];
+    uint32_t count = 0U;
+    uint32_t cpu, i;
+    if (!out || max == 0U) return 0U;
+    for (cpu = 0U; cpu < SMP_MAX_CPUS; cpu++) {
+        cursor[cpu] = trace_rings[cpu].head;
+        oldest[cpu] = cursor[cpu] - (cursor[cpu] > TRACE_RING_RECORDS ? TRACE_RING_RECORDS : cursor[cpu]);
+        loaded[cpu] = (uint8_t)trace_load_older(&trace_rings[cpu], &cursor[cpu], oldest[cpu], &candidate[cpu]);
+    }
+    // Fusion depuis la fin : le plus récent de tous les CPU remplit out à rebours
+    while (count < max) {
+        uint32_t best = SMP_MAX_CPUS;
+        for (cpu = 0U; cpu < SMP_MAX_CPUS; cpu++) {
+            if (loaded[cpu] && (best == SMP_MAX_CPUS || candidate[cpu].tsc > candidate[best].tsc)) best = cpu;
+        }
+        if (best == SMP_MAX_CPUS) break;
+        out[max - 1U - count] = candidate[best];
+        count++;
+        loaded[best] = (uint8_t)trace_load_older(&trace_rings[best], &cursor[best], oldest[best], &candidate[best]);
+    }
+    for (i = 0U; i < count; i++) out[i] = out[max - count + i];
+    return count;
+}
+
+static void trace_print_record(const os_trace_record_t* record) {
+    uint32_t i;
+    print_string_serial("[TRACE cpu");
+    print_dec_serial(record->cpu);
+    write_serial(' ');
+    print_hex_serial((uint32_t)(record->tsc >> 32));
+    print_hex_serial((uint32_t)record->tsc);
+    print_string_serial(" pid ");
+    if (record->pid < 0) write_serial('-');
+    else print_dec_serial((uint32_t)record->pid);
+    print_string_serial("] ");
+    print_string_serial(os_trace_event_name(record->event));
+    for (i = 0U; i < 3U; i++) {
+        write_serial(' ');
+        print_hex_serial(record->args[i]);
+    }
+    write_serial('\n');
+}
+
+uint32_t trace_drain_serial(uint32_t budget) {
+    os_trace_record_t record;
+    uint32_t printed = 0U;
+    uint32_t cpu;
+    for (cpu = 0U; cpu < SMP_MAX_CPUS && printed < budget; cpu++) {
+        trace_ring_t* ring = &trace_rings[cpu];
+        uint32_t head = ring->head;
+        if (head - ring->drained > TRACE_RING_RECORDS) {
+            print_string_serial("[TRACE cpu");
+            print_dec_serial(cpu);
+            print_string_serial("] perdus ");
+            print_dec_serial(head - ring->drained - TRACE_RING_RECORDS);
+            write_serial('\n');
+            ring->drained = head - TRACE_RING_RECORDS;
+        }
+        while (printed < budget && ring->drained != head) {
+            // Écrasé entre-temps : rattrapé au passage suivant par le test ci-dessus
+            if (trace_ring_read(ring, ring->drained, &record)) trace_print_record(&record);
+            ring->drained++;
+            printed++;
+        }
+    }
+    return printed;
+}
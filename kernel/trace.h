@@ -0,0 +1,92 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "os_trace.h"
+
+/* Trace en mémoire : un anneau par CPU, écrit sans verrou par son seul CPU
+ * (interruptions masquées le temps d'un enregistrement), lu par n'importe
+ * qui. Plein, il écrase les plus anciens : seq dit au lecteur si le slot
+ * contient encore l'index attendu. Le vidage série se fait plus tard, hors
+ * chemin chaud (boucle d'inactivité du BSP) ou à la demande (SYS_TRACE_READ).
+ *
+ * Niveaux fixés à la compilation (CONFIG_TRACE_LEVEL) : un TRACE() d'un
+ * niveau supérieur disparaît, arguments compris. */
+#define TRACE_LEVEL_OFF 0
+#define TRACE_LEVEL_EVENT 1     // Cycle de vie : création, exec, sortie
+#define TRACE_LEVEL_HOT 2       // Chemins chauds : bascules, chargement ELF
+#define TRACE_LEVEL_VERBOSE 3   // Par caractère, par scancode
+
+#ifndef CONFIG_TRACE_LEVEL
+#define CONFIG_TRACE_LEVEL TRACE_LEVEL_HOT
+#endif
+
+#define TRACE_RING_RECORDS 128U   // Puissance de deux
+#define TRACE_RING_MASK (TRACE_RING_RECORDS - 1U)
+
+typedef struct {
+    volatile uint32_t head;       // Prochain index écrit
+    uint32_t drained;             // Curseur du vidage série
+    os_trace_record_t records[TRACE_RING_RECORDS];
+} trace_ring_t;
+
+#define TRACE(level, event, a0, a1, a2)                                            \
+    do {                                                                           \
+        if ((level) <= CONFIG_TRACE_LEVEL)                                         \
+            trace_emit((event), (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2));   \
+    } while (0)
+
+/* Enregistrement sur l'anneau du CPU courant. */
+void trace_emit(uint32_t event, uint32_t a0, uint32_t a1, uint32_t a2);
+/* Copie les max derniers enregistrements de tous les CPU, du plus ancien au
+ * plus récent (TSC) ; non destructif. */
+uint32_t trace_snapshot(os_trace_record_t* out, uint32_t max);
+/* Écrit au plus budget enregistrements non encore vidés sur le port série ;
+ * renvoie leur nombre. Un seul appelant (BSP inactif). */
+uint32_t trace_drain_serial(uint32_t budget);
+
+/* L'appelant tient le CPU : l'écriture n'est pas interrompue. */
+static inline void trace_ring_write(trace_ring_t* ring, uint64_t tsc, uint32_t event, uint32_t cpu,
+                                    int32_t pid, uint32_t a0, uint32_t a1, uint32_t a2) {
+    uint32_t index = ring->head;
+    volatile os_trace_record_t* record = &ring->records[index & TRACE_RING_MASK];
+    record->seq = 0U;
+    __asm__ volatile("" : : : "memory");
+    record->tsc = tsc;
+    record->event = (uint16_t)event;
+    record->cpu = (uint8_t)cpu;
+    record->reserved = 0U;
+    record->pid = pid;
+    record->args[0] = a0;
+    record->args[1] = a1;
+    record->args[2] = a2;
+    __asm__ volatile("" : : : "memory");
+    record->seq = index + 1U;
+    ring->head = index + 1U;
+}
+
+/* 1 si l'enregistrement index est encore dans l'anneau et a été copié entier. */
+static inline int trace_ring_read(const trace_ring_t* ring, uint32_t index, os_trace_record_t* out) {
+    const volatile os_trace_record_t* record = &ring->records[index & TRACE_RING_MASK];
+    if (record->seq != index + 1U) return 0;
+    __asm__ volatile("" : : : "memory");
+    out->tsc = record->tsc;
+    out->event = record->event;
+    out->cpu = record->cpu;
+    out->reserved = 0U;
+    out->pid = record->pid;
+    out->args[0] = record->args[0];
+    out->args[1] = record->args[1];
+    out->args[2] = record->args[2];
+    out->seq = index + 1U;
+    __asm__ volatile("" : : : "memory");
+    return record->seq == index + 1U;
+}
+
+/* Premier index encore lisible. */
+static inline uint32_t trace_ring_oldest(const trace_ring_t* ring) {
+    uint32_t head = ring->head;
+    return head > TRACE_RING_RECORDS ? head - TRACE_RING_RECORDS : 0U;
+}
+
+#endif
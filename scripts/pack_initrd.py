@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Empaquette l'initrd AI-OS (archive TAR ustar) en alignant les ELF.
+
+Le module Multiboot est chargé aligné sur la page. Pour que ``elf_load()``
+mappe le texte des exécutables directement sur l'initrd, les données de
+chaque ELF doivent commencer sur une frontière de 4 Kio dans l'archive.
+Le script intercale avant eux des en-têtes de répertoire sans données
+(512 octets chacun, ignorés par ``initrd_init``) ; le contenu extrait reste
+celui de ``tar -C <dir> -cf <image> .``.
+"""
+import argparse
+import os
+import sys
+import tarfile
+
+BLOCK = 512
+PAGE = 4096
+ELF_MAGIC = b"\x7fELF"
+
+
+def is_elf(path):
+    with open(path, "rb") as handle:
+        return handle.read(4) == ELF_MAGIC
+
+
+def padding_headers(offset):
+    """Nombre d'en-têtes de 512 octets pour que les données suivant
+    l'en-tête placé à offset tombent sur une page."""
+    return ((PAGE - (offset + BLOCK) % PAGE) % PAGE) // BLOCK
+
+
+def walk(root):
+    """Chemins relatifs triés, répertoires avant leur contenu (comme tar)."""
+    yield "."
+    for current, dirs, files in os.walk(root):
+        dirs.sort()
+        rel = os.path.relpath(current, root)
+        for name in sorted(dirs):
+            yield os.path.join(".", rel, name) if rel != "." else "./" + name
+        for name in sorted(files):
+            yield os.path.join(".", rel, name) if rel != "." else "./" + name
+
+
+def pack(root, image):
+    aligned = 0
+    with tarfile.open(image, "w", format=tarfile.USTAR_FORMAT) as archive:
+        for arcname in walk(root):
+            path = os.path.join(root, arcname)
+            info = archive.gettarinfo(path, arcname)
+            if info.isfile() and is_elf(path):
+                parent = archive.gettarinfo(os.path.dirname(path), os.path.dirname(arcname))
+                for _ in range(padding_headers(archive.offset)):
+                    archive.addfile(parent)
+                aligned += 1
+            if info.isfile():
+                with open(path, "rb") as handle:
+                    archive.addfile(info, handle)
+            else:
+                archive.addfile(info)
+    return aligned
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("root", help="répertoire à empaqueter")
+    parser.add_argument("image", help="archive TAR produite")
+    args = parser.parse_args(argv)
+    if not os.path.isdir(args.root):
+        print("%s: répertoire introuvable" % args.root, file=sys.stderr)
+        return 1
+    aligned = pack(args.root, args.image)
+    print("[mkinitrd] %d ELF alignés sur la page" % aligned)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
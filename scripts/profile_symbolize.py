@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""Symbolise une session du profileur AI-OS (``profile start`` / ``profile stop``).
+
+Le noyau écrit ses échantillons sur le port série :
+
+    PROF-START <hz>
+    PROF <cpu> <pid|-> <k|u> <eip> [<retour> ...]
+    PROF-TASK <pid> <nom>
+    PROF-END <échantillons> <perdus>
+
+Les adresses noyau sont résolues dans ``build/ai_os.bin``, celles de Ring 3
+dans l'ELF de l'initrd qui porte le nom de la tâche. Le script imprime un
+profil plat (temps propre par fonction) et peut écrire les piles repliées
+attendues par flamegraph.pl.
+"""
+import argparse
+import bisect
+import os
+import struct
+import sys
+from collections import Counter
+
+STT_NOTYPE = 0
+STT_FUNC = 2
+SHT_SYMTAB = 2
+
+
+class Symbols(object):
+    """Table triée (adresse, nom) ; l'adresse prend le symbole qui la précède."""
+
+    def __init__(self, entries, image):
+        entries = sorted(entries)
+        self.addresses = [address for address, _ in entries]
+        self.names = [name for _, name in entries]
+        self.image = image
+
+    def lookup(self, address):
+        index = bisect.bisect_right(self.addresses, address) - 1
+        if index < 0:
+            return "0x%08x" % address
+        return self.names[index]
+
+    @classmethod
+    def from_elf(cls, path):
+        with open(path, "rb") as handle:
+            data = handle.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1:
+            raise ValueError("%s: ELF32 attendu" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        sections = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize)
+                    for i in range(shnum)]
+        entries = []
+        for section in sections:
+            if section[1] != SHT_SYMTAB:
+                continue
+            strtab = sections[section[6]]
+            offset, size, entsize = section[4], section[5], section[9] or 16
+            for pos in range(offset, offset + size, entsize):
+                name, value, _, info, _, shndx = struct.unpack_from("<IIIBBH", data, pos)
+                kind = info & 0xF
+                # shndx 0 : symbole indéfini ; les étiquettes asm sont STT_NOTYPE
+                if shndx == 0 or value == 0 or kind not in (STT_FUNC, STT_NOTYPE):
+                    continue
+                start = strtab[4] + name
+                end = data.index(b"\0", start)
+                label = data[start:end].decode("ascii", "replace")
+                if label and not label.startswith("."):
+                    entries.append((value, label))
+        return cls(entries, os.path.basename(path))
+
+
+def parse_log(text):
+    """Dernière session du journal : (hz, échantillons, noms, fin).
+
+    Un échantillon est (cpu, pid, user, [pc...]) ; pid vaut None hors tâche.
+    Les lignes PROF qui suivent PROF-END appartiennent encore à la session
+    (vidage d'inactivité interrompu par l'arrêt)."""
+    hz = None
+    samples = []
+    names = {}
+    end = None
+    for line in text.splitlines():
+        fields = line.strip().split()
+        if not fields:
+            continue
+        tag = fields[0]
+        if tag == "PROF-START" and len(fields) >= 2:
+            hz = int(fields[1])
+            samples, names, end = [], {}, None
+        elif tag == "PROF" and len(fields) >= 5 and hz is not None:
+            pid = None if fields[2] == "-" else int(fields[2])
+            samples.append((int(fields[1]), pid, fields[3] == "u",
+                            [int(value, 16) for value in fields[4:]]))
+        elif tag == "PROF-TASK" and len(fields) >= 3 and hz is not None:
+            names[int(fields[1])] = " ".join(fields[2:])
+        elif tag == "PROF-END" and len(fields) >= 3 and hz is not None:
+            end = (int(fields[1]), int(fields[2]))
+    return hz, samples, names, end
+
+
+class Resolver(object):
+    """Choisit la table de symboles d'un échantillon (noyau ou ELF de tâche)."""
+
+    def __init__(self, kernel, initrd_dir, names):
+        self.kernel = kernel
+        self.initrd_dir = initrd_dir
+        self.names = names
+        self.user = {}
+
+    def user_symbols(self, pid):
+        name = self.names.get(pid)
+        if name not in self.user:
+            symbols = None
+            path = os.path.join(self.initrd_dir, name) if self.initrd_dir and name else None
+            if path and os.path.isfile(path):
+                try:
+                    symbols = Symbols.from_elf(path)
+                except (OSError, ValueError, struct.error):
+                    symbols = None
+            self.user[name] = symbols
+        return self.user[name]
+
+    def frames(self, sample):
+        """Noms des cadres, de la feuille (EIP) vers les appelants."""
+        _, pid, user, pcs = sample
+        symbols = self.user_symbols(pid) if user else self.kernel
+        image = symbols.image if symbols else (self.names.get(pid, "?") if user else "noyau")
+        result = []
+        for depth, pc in enumerate(pcs):
+            # Une adresse de retour désigne l'instruction après l'appel
+            address = pc if depth == 0 else pc - 1
+            name = symbols.lookup(address) if symbols else "0x%08x" % address
+            result.append("%s [%s]" % (name, image))
+        return result
+
+    def task(self, sample):
+        pid = sample[1]
+        if pid is None:
+            return "-"
+        return "%s/%d" % (self.names.get(pid, "?"), pid)
+
+
+def flat_profile(samples, resolver):
+    return Counter(resolver.frames(sample)[0] for sample in samples)
+
+
+def folded_stacks(samples, resolver):
+    stacks = Counter()
+    for sample in samples:
+        frames = [resolver.task(sample)] + list(reversed(resolver.frames(sample)))
+        stacks[";".join(frame.replace(";", ":") for frame in frames)] += 1
+    return stacks
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", help="journal série contenant la session")
+    parser.add_argument("--kernel", default="build/ai_os.bin")
+    parser.add_argument("--initrd-dir", default="initrd_content/bin",
+                        help="répertoire des ELF Ring 3 (nom de tâche = nom de fichier)")
+    parser.add_argument("--folded", help="écrit les piles repliées (flamegraph.pl)")
+    parser.add_argument("--top", type=int, default=30)
+    args = parser.parse_args(argv)
+
+    with open(args.log, "r", errors="replace") as handle:
+        hz, samples, names, end = parse_log(handle.read())
+    if hz is None:
+        print("aucune session PROF-START dans %s" % args.log, file=sys.stderr)
+        return 1
+    kernel = Symbols.from_elf(args.kernel) if os.path.isfile(args.kernel) else None
+    resolver = Resolver(kernel, args.initrd_dir, names)
+
+    total = len(samples)
+    print("Profil : %d échantillons à %d Hz" % (total, hz))
+    if end is None:
+        print("attention : PROF-END absent, session tronquée")
+    elif end[1]:
+        print("attention : %d échantillons perdus (anneau plein, baisser la cadence)" % end[1])
+    for frame, count in flat_profile(samples, resolver).most_common(args.top):
+        print("%6.2f%% %7d  %s" % (100.0 * count / total, count, frame))
+    if args.folded:
+        with open(args.folded, "w") as handle:
+            for stack, count in sorted(folded_stacks(samples, resolver).items()):
+                handle.write("%s %d\n" % (stack, count))
+        print("piles repliées : %s" % args.folded)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
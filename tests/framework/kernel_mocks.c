@@ -1480,6 +1480,14 @@ int sys_meminfo(os_meminfo_t* info) {
     info->total_pages = 32768;
     info->used_pages = 100;
     info->free_pages = 32668;
+    info->heap_large_allocs = 0;
+    info->heap_large_pages = 0;
+    for (uint32_t i = 0; i < OS_HEAP_CLASS_COUNT; i++) {
+        info->heap_caches[i].object_size = 16U << i;
+        info->heap_caches[i].slab_pages = 0;
+        info->heap_caches[i].objects_in_use = 0;
+        info->heap_caches[i].objects_free = 0;
+    }
     return 0;
 }
 
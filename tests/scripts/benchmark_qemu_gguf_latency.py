@@ -27,6 +27,9 @@ GENERATION_TIMEOUT = float(os.environ.get("GGUF_GENERATION_TIMEOUT", "600"))
 KEY_DELAY = float(os.environ.get("KEY_DELAY", "0.65"))
 MAX_SPREAD_RATIO = float(os.environ.get("GGUF_BENCH_MAX_SPREAD_RATIO", "0"))
 REPORT = os.environ.get("GGUF_BENCH_REPORT", os.path.join(LOG_DIR, "gguf-qemu-latency.json"))
+# Multiplicateur IRQ0 du profileur pendant les deux générations (0 : désactivé)
+PROFILE = int(os.environ.get("GGUF_BENCH_PROFILE", "0"))
+INITRD_BIN = os.environ.get("INITRD_BIN", os.path.join(ROOT, "initrd_content", "bin"))
 
 
 def read_text(path):
@@ -91,6 +94,18 @@ def summarize(values):
     }
 
 
+def write_profile(log, index):
+    """Profil plat et piles repliées de la session, à côté du journal série."""
+    flat = os.path.join(LOG_DIR, "gguf-qemu-profile-%02d.txt" % index)
+    folded = os.path.join(LOG_DIR, "gguf-qemu-profile-%02d.folded" % index)
+    with open(flat, "w") as out:
+        subprocess.check_call([
+            sys.executable, os.path.join(ROOT, "scripts", "profile_symbolize.py"),
+            "--kernel", KERNEL, "--initrd-dir", INITRD_BIN, "--folded", folded, log,
+        ], stdout=out)
+    return os.path.relpath(flat, ROOT)
+
+
 def run_once(index):
     log = os.path.join(LOG_DIR, "gguf-qemu-latency-%02d.log" % index)
     err_path = os.path.join(LOG_DIR, "gguf-qemu-latency-%02d.err" % index)
@@ -117,6 +132,10 @@ def run_once(index):
             start = len(read_text(log))
             send(client, "ai-model use gpt2.gguf")
             wait_for(proc, log, "Profil GPT-2 GGUF selectionne", BOOT_TIMEOUT, start)
+            if PROFILE:
+                start = len(read_text(log))
+                send(client, "profile start %d" % PROFILE)
+                wait_for(proc, log, "PROF-START", BOOT_TIMEOUT, start)
             start = len(read_text(log))
             first_started = time.monotonic()
             send(client, "ai bonjour")
@@ -133,12 +152,18 @@ def run_once(index):
             if "session indisponible" in segment:
                 raise RuntimeError("GGUF continuation rejected: %s" % segment[-1000:])
             continued_elapsed = time.monotonic() - continued_started
-            return {
+            result = {
                 "run": index,
                 "first_token_seconds": first_elapsed,
                 "continuation_seconds": continued_elapsed,
                 "log": os.path.relpath(log, ROOT),
             }
+            if PROFILE:
+                start = len(read_text(log))
+                send(client, "profile stop")
+                wait_for(proc, log, "PROF-END", GENERATION_TIMEOUT, start)
+                result["profile"] = write_profile(log, index)
+            return result
     finally:
         if client is not None:
             client.close()
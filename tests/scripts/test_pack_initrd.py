@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""Contrat de l'empaqueteur d'initrd : ELF alignés sur la page, contenu intact."""
+import importlib.util
+import os
+import tarfile
+import tempfile
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+TARGET = os.path.join(ROOT, "scripts", "pack_initrd.py")
+spec = importlib.util.spec_from_file_location("pack_initrd", TARGET)
+module = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(module)
+
+
+def write(path, data):
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "wb") as handle:
+        handle.write(data)
+
+
+def main():
+    if module.padding_headers(0) != 7 or module.padding_headers(3584) != 0:
+        raise RuntimeError("calcul du bourrage incorrect")
+    with tempfile.TemporaryDirectory() as tmp:
+        root = os.path.join(tmp, "root")
+        image = os.path.join(tmp, "initrd.tar")
+        write(os.path.join(root, "a.txt"), b"x" * 700)
+        write(os.path.join(root, "bin", "shell"), b"\x7fELF" + b"s" * 5000)
+        write(os.path.join(root, "bin", "spin"), b"\x7fELF" + b"p" * 100)
+        write(os.path.join(root, "models", "m.bin"), b"m" * 10)
+        if module.pack(root, image) != 2:
+            raise RuntimeError("ELF non comptés")
+
+        files = {}
+        with tarfile.open(image) as archive:
+            for member in archive.getmembers():
+                if member.isfile():
+                    files[member.name] = (member.offset_data, archive.extractfile(member).read())
+        if sorted(files) != ["./a.txt", "./bin/shell", "./bin/spin", "./models/m.bin"]:
+            raise RuntimeError("fichiers inattendus: %r" % sorted(files))
+        for name in ("./bin/shell", "./bin/spin"):
+            if files[name][0] % 4096 != 0:
+                raise RuntimeError("%s non aligné (%d)" % (name, files[name][0]))
+        if files["./a.txt"][1] != b"x" * 700 or files["./bin/shell"][1][:4] != b"\x7fELF":
+            raise RuntimeError("contenu altéré")
+    print("Initrd packing check passed")
+
+
+if __name__ == "__main__":
+    main()
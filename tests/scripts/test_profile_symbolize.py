@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Contrat de symbolisation du profileur, sans QEMU ni ELF."""
+import importlib.util
+import os
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+TARGET = os.path.join(ROOT, "scripts", "profile_symbolize.py")
+spec = importlib.util.spec_from_file_location("profile_symbolize", TARGET)
+module = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(module)
+
+LOG = """\
+PROF-START 100
+PROF 0 3 k 0x00101000
+PROF-END 1 0
+bruit du noyau
+PROF-START 400
+PROF 0 7 k 0x00102010 0x00101008
+PROF 1 7 k 0x00102020
+PROF 0 - k 0x00100004
+PROF 1 9 u 0x40000010
+PROF-TASK 7 shell
+PROF-TASK 9 mystere
+PROF-END 3 2
+PROF 0 7 k 0x00102000
+"""
+
+
+def main():
+    hz, samples, names, end = module.parse_log(LOG)
+    if hz != 400:
+        raise RuntimeError("la derniere session doit l'emporter")
+    if len(samples) != 5:
+        raise RuntimeError("echantillons apres PROF-END perdus")
+    if names != {7: "shell", 9: "mystere"} or end != (3, 2):
+        raise RuntimeError("noms ou bilan de session incorrects")
+    if samples[2][1] is not None or samples[3][2] is not True:
+        raise RuntimeError("PID hors tache ou anneau Ring 3 mal lus")
+
+    kernel = module.Symbols([(0x100000, "_start"), (0x101000, "syscall_handler"),
+                             (0x102000, "gpt2_matmul")], "ai_os.bin")
+    if kernel.lookup(0x0FFFFF) != "0x000fffff" or kernel.lookup(0x101FFF) != "syscall_handler":
+        raise RuntimeError("recherche de symbole incorrecte")
+    resolver = module.Resolver(kernel, None, names)
+    flat = module.flat_profile(samples, resolver)
+    if flat["gpt2_matmul [ai_os.bin]"] != 3:
+        raise RuntimeError("profil plat incorrect")
+    # Sans ELF pour la tache, l'adresse brute reste lisible
+    if flat["0x40000010 [mystere]"] != 1:
+        raise RuntimeError("repli sans ELF incorrect")
+    folded = module.folded_stacks(samples, resolver)
+    stack = "shell/7;syscall_handler [ai_os.bin];gpt2_matmul [ai_os.bin]"
+    if folded[stack] != 1:
+        raise RuntimeError("pile repliee incorrecte: %r" % dict(folded))
+    if folded["-;_start [ai_os.bin]"] != 1:
+        raise RuntimeError("echantillon hors tache mal replie")
+    print("Profile symbolization check passed")
+
+
+if __name__ == "__main__":
+    main()
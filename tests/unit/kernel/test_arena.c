@@ -0,0 +1,72 @@
+#include "../../framework/unity.h"
+#include "../../../include/os_arena.h"
+
+static uint8_t arena_buffer[256] __attribute__((aligned(16)));
+
+static void test_arena_allocations_are_aligned_and_distinct(void) {
+    os_arena_t arena;
+    uint8_t* first;
+    uint8_t* second;
+    os_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    first = (uint8_t*)os_arena_alloc(&arena, 3U);
+    second = (uint8_t*)os_arena_alloc(&arena, 20U);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL(0, (uint32_t)first % OS_ARENA_ALIGN);
+    TEST_ASSERT_EQUAL(0, (uint32_t)second % OS_ARENA_ALIGN);
+    TEST_ASSERT_EQUAL(OS_ARENA_ALIGN, (uint32_t)(second - first));
+    TEST_ASSERT_EQUAL(48, arena.used);
+}
+
+static void test_arena_is_bounded_and_reset_reuses_space(void) {
+    os_arena_t arena;
+    void* first;
+    os_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    first = os_arena_alloc(&arena, 200U);
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NULL(os_arena_alloc(&arena, 64U));
+    TEST_ASSERT_NULL(os_arena_alloc(&arena, 0U));
+    TEST_ASSERT_NULL(os_arena_alloc(&arena, 0xFFFFFFFFU));
+    os_arena_reset(&arena);
+    TEST_ASSERT_EQUAL(0, arena.used);
+    TEST_ASSERT_EQUAL(208, arena.peak);
+    TEST_ASSERT_EQUAL(first, os_arena_alloc(&arena, 1U));
+}
+
+static void test_arena_rewind_releases_lifo_suffix(void) {
+    os_arena_t arena;
+    uint32_t mark;
+    void* kept;
+    os_arena_init(&arena, arena_buffer, sizeof(arena_buffer));
+    kept = os_arena_alloc(&arena, 16U);
+    mark = os_arena_mark(&arena);
+    TEST_ASSERT_NOT_NULL(os_arena_alloc(&arena, 64U));
+    os_arena_rewind(&arena, mark);
+    TEST_ASSERT_EQUAL(16, arena.used);
+    TEST_ASSERT_EQUAL((uint8_t*)kept + 16, os_arena_alloc(&arena, 8U));
+    /* Un repère plus haut que le niveau courant est ignoré. */
+    os_arena_rewind(&arena, 240U);
+    TEST_ASSERT_EQUAL(32, arena.used);
+}
+
+static void test_arena_realigns_unaligned_buffer(void) {
+    os_arena_t arena;
+    uint8_t* block;
+    os_arena_init(&arena, arena_buffer + 3, 64U);
+    TEST_ASSERT_EQUAL(51, arena.capacity);
+    block = (uint8_t*)os_arena_alloc(&arena, 1U);
+    TEST_ASSERT_EQUAL(arena_buffer + 16, block);
+    os_arena_init(&arena, arena_buffer + 3, 8U);
+    TEST_ASSERT_NULL(os_arena_alloc(&arena, 1U));
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_arena_allocations_are_aligned_and_distinct);
+    RUN_TEST(test_arena_is_bounded_and_reset_reuses_space);
+    RUN_TEST(test_arena_rewind_releases_lifo_suffix);
+    RUN_TEST(test_arena_realigns_unaligned_buffer);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
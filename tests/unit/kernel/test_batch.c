@@ -0,0 +1,59 @@
+#include "../../framework/unity.h"
+#include "../../../include/os_batch.h"
+
+static uint8_t batch_region[2U * 4096U] __attribute__((aligned(4096)));
+
+static void test_batch_splits_region_into_two_rings(void) {
+    os_batch_t batch;
+    TEST_ASSERT_EQUAL(0, os_batch_init(&batch, batch_region, sizeof(batch_region)));
+    TEST_ASSERT_EQUAL((uint32_t)batch_region, (uint32_t)batch.sq);
+    TEST_ASSERT_EQUAL((uint32_t)batch_region + 4096U, (uint32_t)batch.cq);
+    // (4096 - 128) / 32 = 124 -> 64 soumissions ; / 16 = 248 -> 128 complétions
+    TEST_ASSERT_EQUAL(63, batch.sq->slot_mask);
+    TEST_ASSERT_EQUAL(127, batch.cq->slot_mask);
+    TEST_ASSERT_EQUAL(OS_BATCH_BAD_RING, os_batch_init(&batch, batch_region, 128U));
+    TEST_ASSERT_EQUAL(OS_BATCH_BAD_RING, os_batch_init(&batch, NULL, sizeof(batch_region)));
+}
+
+static void test_batch_round_trip_keeps_user_data(void) {
+    os_batch_t batch;
+    os_batch_sqe_t sqe;
+    os_batch_cqe_t cqe;
+    uint32_t i;
+    TEST_ASSERT_EQUAL(0, os_batch_init(&batch, batch_region, sizeof(batch_region)));
+    for (i = 0U; i < 3U; i++) {
+        TEST_ASSERT_EQUAL(0, os_batch_push(&batch, SYS_LISTDIR, 100U + i, i, 2U, 3U, 4U));
+    }
+    // Côté noyau : une soumission consommée, une complétion publiée
+    while (os_ring_pop(batch.sq, &sqe, sizeof(sqe)) == (int)sizeof(sqe)) {
+        TEST_ASSERT_EQUAL(SYS_LISTDIR, sqe.op);
+        TEST_ASSERT_EQUAL(4, sqe.args[3]);
+        cqe.user_data = sqe.user_data;
+        cqe.result = (int32_t)sqe.args[0] - 1;
+        TEST_ASSERT_EQUAL(0, os_ring_push(batch.cq, &cqe, sizeof(cqe)));
+    }
+    for (i = 0U; i < 3U; i++) {
+        TEST_ASSERT_EQUAL(0, os_batch_reap(&batch, &cqe));
+        TEST_ASSERT_EQUAL(100U + i, cqe.user_data);
+        TEST_ASSERT_EQUAL((int)i - 1, cqe.result);
+    }
+    TEST_ASSERT_EQUAL(OS_RING_EMPTY, os_batch_reap(&batch, &cqe));
+}
+
+static void test_batch_submission_queue_is_bounded(void) {
+    os_batch_t batch;
+    uint32_t i;
+    TEST_ASSERT_EQUAL(0, os_batch_init(&batch, batch_region, sizeof(batch_region)));
+    for (i = 0U; i < 64U; i++) TEST_ASSERT_EQUAL(0, os_batch_push(&batch, SYS_STAT, i, 0U, 0U, 0U, 0U));
+    TEST_ASSERT_EQUAL(OS_RING_FULL, os_batch_push(&batch, SYS_STAT, i, 0U, 0U, 0U, 0U));
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_batch_splits_region_into_two_rings);
+    RUN_TEST(test_batch_round_trip_keeps_user_data);
+    RUN_TEST(test_batch_submission_queue_is_bounded);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include "../../framework/unity.h"
+#include "../../../kernel/deferred.h"
+#include "../../../kernel/timer_wheel.h"
+
+/* La roue de timer.c est remplacée par une roue locale : advance() joue IRQ0. */
+static timer_wheel_t wheel;
+
+void timer_arm(timer_event_t* event, uint32_t expires) {
+    timer_wheel_arm(&wheel, event, expires);
+}
+
+typedef struct {
+    deferred_work_t work;
+    uint32_t runs;
+    uint32_t last_now;
+    uint32_t period;
+} deferred_probe_t;
+
+static deferred_probe_t first;
+static deferred_probe_t second;
+
+static void probe_run(deferred_work_t* work, uint32_t now) {
+    deferred_probe_t* probe = (deferred_probe_t*)work;
+    probe->runs++;
+    probe->last_now = now;
+    if (probe->period != 0U) deferred_work_schedule(work, now, probe->period);
+}
+
+static void probes_init(void) {
+    timer_wheel_init(&wheel, 0U);
+    deferred_work_init(&first.work, probe_run);
+    deferred_work_init(&second.work, probe_run);
+    first.runs = second.runs = 0U;
+    first.period = second.period = 0U;
+}
+
+static void test_deferred_expiry_only_raises_flag(void) {
+    probes_init();
+    deferred_work_schedule(&first.work, 0U, 5U);
+    TEST_ASSERT_EQUAL(0, timer_wheel_advance(&wheel, 4U));
+    TEST_ASSERT_EQUAL(0, deferred_work_pending);
+    TEST_ASSERT_EQUAL(1, timer_wheel_advance(&wheel, 5U));
+    // Rien n'a tourné dans le contexte de l'échéance
+    TEST_ASSERT_EQUAL(1, deferred_work_pending);
+    TEST_ASSERT_EQUAL(0, first.runs);
+    TEST_ASSERT_EQUAL(1, deferred_work_run(7U));
+    TEST_ASSERT_EQUAL(1, first.runs);
+    TEST_ASSERT_EQUAL(7, first.last_now);
+    TEST_ASSERT_EQUAL(0, deferred_work_pending);
+    TEST_ASSERT_EQUAL(0, deferred_work_run(8U));
+}
+
+static void test_deferred_runs_only_expired_work(void) {
+    probes_init();
+    deferred_work_schedule(&first.work, 0U, 2U);
+    deferred_work_schedule(&second.work, 0U, 50U);
+    (void)timer_wheel_advance(&wheel, 10U);
+    TEST_ASSERT_EQUAL(1, deferred_work_run(10U));
+    TEST_ASSERT_EQUAL(1, first.runs);
+    TEST_ASSERT_EQUAL(0, second.runs);
+    // Un délai nul part au tick suivant
+    deferred_work_schedule(&first.work, 10U, 0U);
+    (void)timer_wheel_advance(&wheel, 11U);
+    TEST_ASSERT_EQUAL(1, deferred_work_run(11U));
+    TEST_ASSERT_EQUAL(2, first.runs);
+}
+
+static void test_deferred_periodic_work_rearms_from_run(void) {
+    probes_init();
+    first.period = 10U;
+    deferred_work_schedule(&first.work, 0U, 10U);
+    (void)timer_wheel_advance(&wheel, 10U);
+    TEST_ASSERT_EQUAL(1, deferred_work_run(10U));
+    // Service tardif : la période repart de l'exécution, sans rattrapage
+    (void)timer_wheel_advance(&wheel, 35U);
+    TEST_ASSERT_EQUAL(1, deferred_work_run(35U));
+    TEST_ASSERT_EQUAL(2, first.runs);
+    TEST_ASSERT_EQUAL(0, timer_wheel_advance(&wheel, 44U));
+    TEST_ASSERT_EQUAL(1, timer_wheel_advance(&wheel, 45U));
+    TEST_ASSERT_EQUAL(1, deferred_work_run(45U));
+    TEST_ASSERT_EQUAL(3, first.runs);
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_deferred_expiry_only_raises_flag);
+    RUN_TEST(test_deferred_runs_only_expired_work);
+    RUN_TEST(test_deferred_periodic_work_rearms_from_run);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
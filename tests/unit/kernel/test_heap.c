@@ -0,0 +1,200 @@
+/* test_heap.c - Tests unitaires du tas noyau à classes de taille */
+
+#include <stdio.h>
+#include "../../framework/unity.h"
+#include "../../framework/test_kernel.h"
+
+// PMM simulé : un pool de pages hôte alignées, adressable directement
+#define TEST_HEAP_POOL_PAGES 256
+static uint8_t test_heap_pool[TEST_HEAP_POOL_PAGES * 4096] __attribute__((aligned(4096)));
+static uint8_t test_heap_page_used[TEST_HEAP_POOL_PAGES];
+static uint32_t test_heap_block_pages[TEST_HEAP_POOL_PAGES];  // Taille retenue par pmm_alloc_block
+static uint32_t test_heap_pages_in_use = 0;
+
+void* pmm_alloc_pages(uint32_t page_count) {
+    for (uint32_t first = 0; first + page_count <= TEST_HEAP_POOL_PAGES; first++) {
+        uint32_t i;
+        for (i = 0; i < page_count && !test_heap_page_used[first + i]; i++) {}
+        if (i != page_count) continue;
+        for (i = 0; i < page_count; i++) test_heap_page_used[first + i] = 1;
+        test_heap_pages_in_use += page_count;
+        return test_heap_pool + first * 4096;
+    }
+    return NULL;
+}
+
+void* pmm_alloc_page(void) {
+    return pmm_alloc_pages(1);
+}
+
+void pmm_free_pages(void* page, uint32_t page_count) {
+    uint32_t first = (uint32_t)((uint8_t*)page - test_heap_pool) / 4096;
+    for (uint32_t i = 0; i < page_count; i++) {
+        if (test_heap_page_used[first + i]) {
+            test_heap_page_used[first + i] = 0;
+            test_heap_pages_in_use--;
+        }
+    }
+}
+
+void pmm_free_page(void* page) {
+    pmm_free_pages(page, 1);
+}
+
+void* pmm_alloc_block(uint32_t page_count) {
+    uint8_t* pages = (uint8_t*)pmm_alloc_pages(page_count);
+    if (pages) test_heap_block_pages[(pages - test_heap_pool) / 4096] = page_count;
+    return pages;
+}
+
+uint32_t pmm_free_block(void* first) {
+    uint32_t index = (uint32_t)((uint8_t*)first - test_heap_pool) / 4096;
+    uint32_t page_count = test_heap_block_pages[index];
+    if (!test_heap_page_used[index] || page_count == 0) return 0;
+    test_heap_block_pages[index] = 0;
+    pmm_free_pages(first, page_count);
+    return page_count;
+}
+
+#include "../../../kernel/mem/heap.c"
+
+static void heap_test_reset(void) {
+    for (uint32_t i = 0; i < TEST_HEAP_POOL_PAGES; i++) {
+        test_heap_page_used[i] = 0;
+        test_heap_block_pages[i] = 0;
+    }
+    test_heap_pages_in_use = 0;
+    for (uint32_t i = 0; i < OS_HEAP_CLASS_COUNT; i++) {
+        heap_caches[i].partial = NULL;
+        heap_caches[i].slab_pages = 0;
+        heap_caches[i].objects_in_use = 0;
+    }
+    heap_large_allocs = 0;
+    heap_large_pages = 0;
+    init_heap();
+}
+
+void setUp(void) {
+    test_kernel_init();
+    heap_test_reset();
+}
+
+void tearDown(void) {
+    test_kernel_cleanup();
+}
+
+void test_heap_small_allocations_share_a_page(void) {
+    setUp();
+    void* a = kmalloc(24);
+    void* b = kmalloc(24);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_EQUAL(a, b);
+    TEST_ASSERT_EQUAL(0, (uint32_t)a % 16);
+    TEST_ASSERT_EQUAL((uint32_t)a & ~0xFFFu, (uint32_t)b & ~0xFFFu);
+    TEST_ASSERT_EQUAL(1, test_heap_pages_in_use);
+    kfree(a);
+    kfree(b);
+}
+
+void test_heap_kfree_recycles_objects(void) {
+    setUp();
+    void* first = kmalloc(100);
+    TEST_ASSERT_NOT_NULL(first);
+    kfree(first);
+    void* again = kmalloc(100);
+    TEST_ASSERT_EQUAL(first, again);
+    kfree(again);
+}
+
+void test_heap_steady_footprint_under_churn(void) {
+    setUp();
+    void* objects[200];
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 200; i++) {
+            objects[i] = kmalloc((size_t)(16 + (i * 37) % 2000));
+            TEST_ASSERT_NOT_NULL(objects[i]);
+        }
+        for (int i = 0; i < 200; i++) kfree(objects[i]);
+    }
+    // Au plus un slab vide conservé par classe
+    TEST_ASSERT(test_heap_pages_in_use <= OS_HEAP_CLASS_COUNT);
+}
+
+void test_heap_large_allocation_returns_pages(void) {
+    setUp();
+    void* big = kmalloc(3 * 4096 + 1);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ASSERT_PAGE_ALIGNED((uint32_t)big);
+    TEST_ASSERT_EQUAL(4, test_heap_pages_in_use);
+    kfree(big);
+    TEST_ASSERT_EQUAL(0, test_heap_pages_in_use);
+    // Un second kfree est ignoré
+    kfree(big);
+    TEST_ASSERT_EQUAL(0, test_heap_pages_in_use);
+}
+
+void test_heap_large_allocations_are_unbounded(void) {
+    setUp();
+    void* blocks[128];
+    for (int i = 0; i < 128; i++) {
+        blocks[i] = kmalloc_aligned(4096);
+        TEST_ASSERT_NOT_NULL(blocks[i]);
+    }
+    TEST_ASSERT_EQUAL(128, test_heap_pages_in_use);
+    for (int i = 0; i < 128; i++) kfree(blocks[i]);
+    TEST_ASSERT_EQUAL(0, test_heap_pages_in_use);
+}
+
+void test_heap_meminfo_counters(void) {
+    setUp();
+    os_meminfo_t info;
+    void* a = kmalloc(16);
+    void* b = kmalloc(1000);
+    void* c = kmalloc(8192);
+
+    heap_fill_meminfo(&info);
+    TEST_ASSERT_EQUAL(16, info.heap_caches[0].object_size);
+    TEST_ASSERT_EQUAL(1, info.heap_caches[0].objects_in_use);
+    TEST_ASSERT_EQUAL(1, info.heap_caches[0].slab_pages);
+    TEST_ASSERT_EQUAL((4096 - 32) / 16 - 1, info.heap_caches[0].objects_free);
+    TEST_ASSERT_EQUAL(1, info.heap_caches[6].objects_in_use);
+    TEST_ASSERT_EQUAL(1, info.heap_large_allocs);
+    TEST_ASSERT_EQUAL(2, info.heap_large_pages);
+
+    kfree(a);
+    kfree(b);
+    kfree(c);
+    heap_fill_meminfo(&info);
+    TEST_ASSERT_EQUAL(0, info.heap_caches[0].objects_in_use);
+    TEST_ASSERT_EQUAL(0, info.heap_large_allocs);
+}
+
+void test_heap_rejects_foreign_pointers(void) {
+    setUp();
+    void* a = kmalloc(64);
+    TEST_ASSERT_NOT_NULL(a);
+    kfree((uint8_t*)a + 1); // Pas un début d'objet
+    kfree(NULL);
+    os_meminfo_t info;
+    heap_fill_meminfo(&info);
+    TEST_ASSERT_EQUAL(1, info.heap_caches[2].objects_in_use);
+    kfree(a);
+}
+
+int main(void) {
+    unity_init();
+
+    RUN_TEST(test_heap_small_allocations_share_a_page);
+    RUN_TEST(test_heap_kfree_recycles_objects);
+    RUN_TEST(test_heap_steady_footprint_under_churn);
+    RUN_TEST(test_heap_large_allocation_returns_pages);
+    RUN_TEST(test_heap_large_allocations_are_unbounded);
+    RUN_TEST(test_heap_meminfo_counters);
+    RUN_TEST(test_heap_rejects_foreign_pointers);
+
+    unity_print_results();
+    unity_cleanup();
+
+    return (unity_stats.tests_failed == 0) ? 0 : 1;
+}
@@ -59,6 +59,10 @@ static void test_messages_preserve_fifo_order(void) {
     TEST_ASSERT_EQUAL(10, message.sender_pid);
     TEST_ASSERT_EQUAL(1, message.type);
     TEST_ASSERT_EQUAL('u', message.data[0]);
+    // La tête part sans recopie : seul read_index avance
+    TEST_ASSERT_EQUAL(1, endpoint.read_index);
+    TEST_ASSERT_EQUAL(2, endpoint.write_index);
+    TEST_ASSERT_EQUAL(11, endpoint.messages[1].sender_pid);
     TEST_ASSERT_EQUAL(0, ipc_endpoint_receive(&endpoint, &message));
     TEST_ASSERT_EQUAL(11, message.sender_pid);
     TEST_ASSERT_EQUAL(2, message.type);
@@ -88,6 +92,75 @@ static void test_invalid_payload_is_rejected(void) {
     TEST_ASSERT_EQUAL(OS_IPC_BAD_MESSAGE, ipc_endpoint_send(0, 1, &payload));
 }
 
+static void test_matching_receive_keeps_other_messages_in_order(void) {
+    os_ipc_payload_t payload;
+    os_ipc_filter_t filter;
+    os_ipc_message_t message;
+    ipc_endpoint_init(&endpoint);
+    // Anneau décalé : le trou à combler franchit la fin du tableau
+    payload = make_payload(9U, "x");
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_send(&endpoint, 5, &payload));
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_receive(&endpoint, &message));
+    for (uint32_t i = 1U; i <= 4U; i++) {
+        payload = make_payload(i, "m");
+        payload.request_id = 100U + i;
+        TEST_ASSERT_EQUAL(0, ipc_endpoint_send(&endpoint, (int32_t)i, &payload));
+    }
+    filter.match = OS_IPC_MATCH_SENDER | OS_IPC_MATCH_REQUEST;
+    filter.sender_pid = 2;
+    filter.request_id = 102U;
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_receive_matching(&endpoint, &filter, &message));
+    TEST_ASSERT_EQUAL(2, message.sender_pid);
+    TEST_ASSERT_EQUAL(OS_IPC_EMPTY, ipc_endpoint_receive_matching(&endpoint, &filter, &message));
+    TEST_ASSERT_EQUAL(3, endpoint.count);
+    TEST_ASSERT_EQUAL(4, ipc_endpoint_last(&endpoint)->sender_pid);
+    // La place libérée accepte un nouveau message, en fin de file
+    payload = make_payload(5U, "m");
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_send(&endpoint, 5, &payload));
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_receive(&endpoint, &message));
+    TEST_ASSERT_EQUAL(1, message.sender_pid);
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_receive(&endpoint, &message));
+    TEST_ASSERT_EQUAL(3, message.sender_pid);
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_receive(&endpoint, &message));
+    TEST_ASSERT_EQUAL(4, message.sender_pid);
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_receive(&endpoint, &message));
+    TEST_ASSERT_EQUAL(5, message.sender_pid);
+    TEST_ASSERT_NULL(ipc_endpoint_last(&endpoint));
+}
+
+static void test_filter_distinguishes_kernel_sender(void) {
+    os_ipc_payload_t payload = make_payload(3U, "k");
+    os_ipc_filter_t filter;
+    os_ipc_message_t message;
+    ipc_endpoint_init(&endpoint);
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_send(&endpoint, 0, &payload));
+    filter.match = OS_IPC_MATCH_TYPE;
+    filter.sender_pid = 7;
+    filter.type = 3U;
+    TEST_ASSERT_TRUE(ipc_filter_matches(&filter, ipc_endpoint_last(&endpoint)));
+    filter.match |= OS_IPC_MATCH_SENDER;
+    TEST_ASSERT_FALSE(ipc_filter_matches(&filter, ipc_endpoint_last(&endpoint)));
+    filter.sender_pid = 0;
+    TEST_ASSERT_EQUAL(0, ipc_endpoint_receive_matching(&endpoint, &filter, &message));
+    TEST_ASSERT_EQUAL(0, message.sender_pid);
+}
+
+static void test_short_unpack_rebuilds_register_message(void) {
+    os_ipc_message_t message;
+    message.sender_pid = -1;
+    TEST_ASSERT_EQUAL(OS_IPC_EMPTY, os_ipc_short_unpack(OS_IPC_EMPTY, 1U, 2U, 3U, 4U, 5U, &message));
+    TEST_ASSERT_EQUAL(0, os_ipc_short_unpack(0, 1U, 2U, 3U, 4U, 5U, &message));
+    TEST_ASSERT_EQUAL(-1, message.sender_pid);
+    TEST_ASSERT_EQUAL(0, os_ipc_short_unpack(OS_IPC_SHORT | 6, 9U, 0x474E4950U, 77U,
+                                             0x64636261U, 0x00006665U, &message));
+    TEST_ASSERT_EQUAL(9, message.sender_pid);
+    TEST_ASSERT_EQUAL(0x474E4950U, message.type);
+    TEST_ASSERT_EQUAL(77, message.request_id);
+    TEST_ASSERT_EQUAL(6, message.size);
+    TEST_ASSERT_EQUAL('a', message.data[0]);
+    TEST_ASSERT_EQUAL('f', message.data[5]);
+}
+
 int main(void) {
     unity_init();
     RUN_TEST(test_endpoint_is_empty_after_init);
@@ -96,6 +169,9 @@ int main(void) {
     RUN_TEST(test_messages_preserve_fifo_order);
     RUN_TEST(test_full_endpoint_keeps_existing_messages);
     RUN_TEST(test_invalid_payload_is_rejected);
+    RUN_TEST(test_matching_receive_keeps_other_messages_in_order);
+    RUN_TEST(test_filter_distinguishes_kernel_sender);
+    RUN_TEST(test_short_unpack_rebuilds_register_message);
     unity_print_results();
     unity_cleanup();
     return unity_stats.tests_failed == 0 ? 0 : 1;
@@ -154,6 +154,26 @@ static void test_snapshot_rejects_small_buffer(void) {
     TEST_ASSERT_EQUAL(99, sz);
 }
 
+static void test_generation_tracks_mutations(void) {
+    char buf[8];
+    uint32_t gen;
+
+    setUp();
+    gen = overlay_generation();
+    TEST_ASSERT_TRUE(overlay_read("bin/spin", buf, sizeof(buf)) < 0);
+    TEST_ASSERT_TRUE(overlay_unlink("absent") < 0);
+    TEST_ASSERT_EQUAL(gen, overlay_generation());
+    TEST_ASSERT_EQUAL(1, overlay_write("spin", "x", 1));
+    TEST_ASSERT_EQUAL(gen + 1U, overlay_generation());
+    TEST_ASSERT_EQUAL(0, overlay_unlink("spin"));
+    TEST_ASSERT_EQUAL(gen + 2U, overlay_generation());
+    // Un chemin dans l'overlay masque celui de l'initrd
+    TEST_ASSERT_EQUAL(0, overlay_mkdir("tools"));
+    TEST_ASSERT_EQUAL(1, overlay_write("tools/run", "y", 1));
+    TEST_ASSERT_EQUAL(OV_OK, overlay_stat("tools/run", 0));
+    TEST_ASSERT_EQUAL(gen + 4U, overlay_generation());
+}
+
 int main(void) {
     unity_init();
     RUN_TEST(test_snapshot_empty_roundtrip);
@@ -164,6 +184,7 @@ int main(void) {
     RUN_TEST(test_restore_v1_snapshot_compatibility);
     RUN_TEST(test_snapshot_v2_accepts_extended_file);
     RUN_TEST(test_snapshot_rejects_small_buffer);
+    RUN_TEST(test_generation_tracks_mutations);
     unity_print_results();
     unity_cleanup();
     return (unity_stats.tests_failed == 0) ? 0 : 1;
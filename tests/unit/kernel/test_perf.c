@@ -0,0 +1,55 @@
+#include "../../framework/unity.h"
+#include "../../../kernel/perf.h"
+
+static void test_perf_hist_bucket_is_log2(void) {
+    TEST_ASSERT_EQUAL(0, perf_hist_bucket(0U));
+    TEST_ASSERT_EQUAL(0, perf_hist_bucket(1U));
+    TEST_ASSERT_EQUAL(1, perf_hist_bucket(2U));
+    TEST_ASSERT_EQUAL(1, perf_hist_bucket(3U));
+    TEST_ASSERT_EQUAL(10, perf_hist_bucket(1024U));
+    TEST_ASSERT_EQUAL(10, perf_hist_bucket(2047U));
+    TEST_ASSERT_EQUAL(31, perf_hist_bucket(0x80000000ULL));
+    // Au-delà de 2^32 cycles : dernière case
+    TEST_ASSERT_EQUAL(OS_PERF_HIST_BUCKETS - 1U, perf_hist_bucket(0x500000000ULL));
+}
+
+static void test_perf_stat_add_tracks_min_max_total(void) {
+    os_perf_stat_t stat = {0};
+    perf_stat_add(&stat, 300U);
+    TEST_ASSERT_EQUAL(1, stat.count);
+    TEST_ASSERT_TRUE(stat.min == 300U && stat.max == 300U);
+    perf_stat_add(&stat, 100U);
+    perf_stat_add(&stat, 5000U);
+    TEST_ASSERT_EQUAL(3, stat.count);
+    TEST_ASSERT_TRUE(stat.min == 100U);
+    TEST_ASSERT_TRUE(stat.max == 5000U);
+    TEST_ASSERT_TRUE(stat.total == 5400U);
+    TEST_ASSERT_EQUAL(1, stat.hist[6]);    // 100
+    TEST_ASSERT_EQUAL(1, stat.hist[8]);    // 300
+    TEST_ASSERT_EQUAL(1, stat.hist[12]);   // 5000
+}
+
+static void test_perf_stat_empty_slot_takes_first_sample_as_min(void) {
+    os_perf_stat_t stat = {0};
+    // Case remise à zéro : min = 0 ne doit pas rester le minimum
+    perf_stat_add(&stat, 42U);
+    TEST_ASSERT_TRUE(stat.min == 42U);
+}
+
+static void test_perf_slots_follow_syscall_table(void) {
+    TEST_ASSERT_EQUAL(SYS_PERF_READ, OS_PERF_SLOT_SYSCALL(SYS_PERF_READ));
+    TEST_ASSERT_EQUAL(MAX_SYSCALLS, OS_PERF_SLOT_IRQ(0));
+    TEST_ASSERT_EQUAL(OS_PERF_SLOT_IRQ(OS_PERF_IRQ_LINES), OS_PERF_SLOT_LAPIC_TIMER);
+    TEST_ASSERT_EQUAL(OS_PERF_SLOT_SCHEDULE + 1U, OS_PERF_SLOT_COUNT);
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_perf_hist_bucket_is_log2);
+    RUN_TEST(test_perf_stat_add_tracks_min_max_total);
+    RUN_TEST(test_perf_stat_empty_slot_takes_first_sample_as_min);
+    RUN_TEST(test_perf_slots_follow_syscall_table);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
@@ -4,6 +4,9 @@
 #include "../../framework/unity.h"
 #include "../../framework/test_kernel.h"
 
+// Zone directe réduite pour exercer la zone haute avec un petit pool
+#define PMM_DIRECT_MAP_LIMIT (8U * 1024U * 1024U)
+
 // Include du module à tester
 #include "../../../kernel/mem/pmm.h"
 
@@ -321,6 +324,216 @@ void test_pmm_batch_allocation_performance(void) {
     test_benchmark_print_results(&bench);
 }
 
+// Compare la latence d'allocation sur un pool neuf et sur un pool fragmenté
+// en damier : avec le buddy, le coût ne dépend plus de la position des trous.
+void test_pmm_fragmented_allocation_latency(void) {
+    const uint32_t iterations = 1000;
+    init_pmm_for_test(2 * 1024 * 1024);
+
+    test_benchmark_t fresh;
+    test_benchmark_start(&fresh, "PMM Alloc/Free (pool neuf)");
+    fresh.num_calls = iterations;
+    for (uint32_t i = 0; i < iterations; i++) {
+        void* phys = pmm_alloc_pages(1);
+        TEST_ASSERT_NOT_NULL(phys);
+        pmm_free_pages(phys, 1);
+    }
+    test_benchmark_end(&fresh);
+    test_benchmark_print_results(&fresh);
+
+    // Fragmente : toutes les pages allouées puis une sur deux libérée
+    uint32_t initial_free = pmm_get_free_pages();
+    static void* held[512];
+    uint32_t count = 0;
+    void* phys;
+    while (count < 512 && (phys = pmm_alloc_pages(1)) != NULL) {
+        held[count++] = phys;
+    }
+    TEST_ASSERT_EQUAL(0, pmm_get_free_pages());
+    for (uint32_t i = 0; i < count; i += 2) {
+        pmm_free_pages(held[i], 1);
+    }
+    uint32_t fragmented_free = pmm_get_free_pages();
+
+    test_benchmark_t fragmented;
+    test_benchmark_start(&fragmented, "PMM Alloc/Free (pool fragmente)");
+    fragmented.num_calls = iterations;
+    for (uint32_t i = 0; i < iterations; i++) {
+        phys = pmm_alloc_pages(1);
+        TEST_ASSERT_NOT_NULL(phys);
+        pmm_free_pages(phys, 1);
+    }
+    test_benchmark_end(&fragmented);
+    test_benchmark_print_results(&fragmented);
+    TEST_ASSERT_EQUAL(fragmented_free, pmm_get_free_pages());
+
+    // Aucune paire de pages contigues n'existe tant que le damier est en place
+    TEST_ASSERT_NULL(pmm_alloc_pages(2));
+
+    // Les blocs libérés fusionnent : le pool redevient contigu
+    for (uint32_t i = 1; i < count; i += 2) {
+        pmm_free_pages(held[i], 1);
+    }
+    TEST_ASSERT_EQUAL(initial_free, pmm_get_free_pages());
+    phys = pmm_alloc_pages(256);
+    TEST_ASSERT_NOT_NULL(phys);
+    pmm_free_pages(phys, 256);
+}
+
+// === TESTS DE ZONES ===
+
+void test_pmm_high_zone_allocation(void) {
+    // 12 Mo : 8 Mo de zone directe, 4 Mo de frames hautes
+    init_pmm_for_test(12 * 1024 * 1024);
+    uint32_t direct_limit = pmm_get_direct_pages() * PAGE_SIZE;
+    TEST_ASSERT_EQUAL(PMM_DIRECT_MAP_LIMIT, direct_limit);
+
+    void* high = pmm_alloc_high_pages(4);
+    TEST_ASSERT_NOT_NULL(high);
+    TEST_ASSERT((uint32_t)high >= direct_limit);
+
+    // Les allocations noyau restent dans l'identité
+    void* direct = pmm_alloc_pages(4);
+    TEST_ASSERT_NOT_NULL(direct);
+    TEST_ASSERT((uint32_t)direct + 4 * PAGE_SIZE <= direct_limit);
+
+    // Zone haute épuisée : repli sur la zone directe
+    uint32_t high_taken = 0;
+    void* fallback;
+    while ((fallback = pmm_alloc_high_page()) != NULL && (uint32_t)fallback >= direct_limit) {
+        high_taken++;
+    }
+    TEST_ASSERT_NOT_NULL(fallback);
+    TEST_ASSERT_EQUAL(pmm_get_total_pages() - pmm_get_direct_pages() - 4, high_taken);
+
+    // Les frames hautes libérées refusionnent sans jamais rejoindre la zone directe
+    for (uint32_t page = pmm_get_direct_pages(); page < pmm_get_total_pages(); page++) {
+        uint32_t addr = page * PAGE_SIZE;
+        if (addr < (uint32_t)high || addr >= (uint32_t)high + 4 * PAGE_SIZE) {
+            pmm_free_pages((void*)addr, 1);
+        }
+    }
+    pmm_free_pages(high, 4);
+    void* whole_high = pmm_alloc_high_pages(pmm_get_total_pages() - pmm_get_direct_pages());
+    TEST_ASSERT_NOT_NULL(whole_high);
+    TEST_ASSERT_EQUAL(direct_limit, (uint32_t)whole_high);
+    pmm_free_pages(whole_high, pmm_get_total_pages() - pmm_get_direct_pages());
+    pmm_free_pages(direct, 4);
+    pmm_free_pages(fallback, 1);
+}
+
+void test_pmm_shared_page_refcount(void) {
+    init_pmm_for_test(1 * 1024 * 1024);
+    uint32_t free_before = pmm_get_free_pages();
+
+    void* frame = pmm_alloc_high_page();
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL(1, pmm_page_ref_count(frame));
+
+    // Trois tâches partagent la frame du texte
+    TEST_ASSERT_EQUAL(0, pmm_page_ref(frame));
+    TEST_ASSERT_EQUAL(0, pmm_page_ref(frame));
+    TEST_ASSERT_EQUAL(3, pmm_page_ref_count(frame));
+
+    TEST_ASSERT_EQUAL(0, pmm_page_unref(frame));
+    TEST_ASSERT_EQUAL(0, pmm_page_unref(frame));
+    TEST_ASSERT_EQUAL(free_before - 1, pmm_get_free_pages());
+
+    // Le dernier propriétaire rend la frame
+    TEST_ASSERT_EQUAL(1, pmm_page_unref(frame));
+    TEST_ASSERT_EQUAL(0, pmm_page_ref_count(frame));
+    TEST_ASSERT_EQUAL(free_before, pmm_get_free_pages());
+
+    // Une frame libre ne peut pas être partagée
+    TEST_ASSERT_EQUAL(-1, pmm_page_ref(frame));
+    TEST_ASSERT_EQUAL(0, pmm_page_unref(frame));
+}
+
+void test_pmm_zero_pool_refill_and_alloc(void) {
+    init_pmm_for_test(1 * 1024 * 1024);
+    uint32_t free_before = pmm_get_free_pages();
+
+    // Remplissage en inactivité : les frames réservées restent comptées libres
+    TEST_ASSERT_EQUAL(8, pmm_zero_pool_refill(8));
+    TEST_ASSERT_EQUAL(8, pmm_zero_pool_count());
+    TEST_ASSERT_EQUAL(free_before, pmm_get_free_pages());
+
+    void* frame = pmm_alloc_zeroed_page();
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ASSERT_EQUAL(7, pmm_zero_pool_count());
+    TEST_ASSERT_EQUAL(free_before - 1, pmm_get_free_pages());
+
+    uint32_t* words = (uint32_t*)((uint8_t*)&end + (uint32_t)frame);
+    for (uint32_t i = 0; i < PAGE_SIZE / sizeof(uint32_t); i++) {
+        TEST_ASSERT_EQUAL(0, words[i]);
+    }
+
+    // Le buddy épuisé se rabat sur la réserve
+    void* held[256];
+    uint32_t count = 0;
+    void* phys;
+    while (count < 256 && (phys = pmm_alloc_pages(1)) != NULL) held[count++] = phys;
+    TEST_ASSERT_EQUAL(0, pmm_zero_pool_count());
+    TEST_ASSERT_EQUAL(0, pmm_get_free_pages());
+    TEST_ASSERT_EQUAL(0, pmm_zero_pool_refill(4));
+    for (uint32_t i = 0; i < count; i++) pmm_free_pages(held[i], 1);
+    pmm_free_pages(frame, 1);
+    TEST_ASSERT_EQUAL(free_before, pmm_get_free_pages());
+}
+
+void test_pmm_block_remembers_size(void) {
+    init_pmm_for_test(1 * 1024 * 1024);
+    uint32_t free_before = pmm_get_free_pages();
+
+    void* block = pmm_alloc_block(3);
+    TEST_ASSERT_NOT_NULL(block);
+    TEST_ASSERT_EQUAL(free_before - 3, pmm_get_free_pages());
+    TEST_ASSERT_EQUAL(3, pmm_free_block(block));
+    TEST_ASSERT_EQUAL(free_before, pmm_get_free_pages());
+    // Bloc déjà rendu, puis frame réallouée hors bloc : plus d'étiquette
+    TEST_ASSERT_EQUAL(0, pmm_free_block(block));
+    void* page = pmm_alloc_pages(1);
+    TEST_ASSERT_EQUAL(0, pmm_free_block(page));
+    pmm_free_pages(page, 1);
+    TEST_ASSERT_EQUAL(free_before, pmm_get_free_pages());
+}
+
+static uint32_t memstats_free_block_pages(const os_memstats_t* stats) {
+    uint32_t pages = 0;
+    for (uint32_t order = 0; order < OS_MEM_ORDER_COUNT; order++) pages += stats->free_blocks[order] << order;
+    return pages;
+}
+
+void test_pmm_memstats_histogram_and_failures(void) {
+    os_memstats_t stats;
+    init_pmm_for_test(1 * 1024 * 1024);
+    pmm_fill_memstats(&stats);
+    TEST_ASSERT_EQUAL(pmm_get_free_pages(), stats.free_pages);
+    TEST_ASSERT_EQUAL(stats.free_pages, memstats_free_block_pages(&stats));
+    TEST_ASSERT_EQUAL(0, stats.alloc_failures);
+    uint32_t largest = stats.largest_free_run;
+    TEST_ASSERT(largest > 0 && (largest & (largest - 1)) == 0);
+
+    // L'histogramme suit le découpage des blocs sans rescan
+    void* page = pmm_alloc_pages(1);
+    TEST_ASSERT_NOT_NULL(page);
+    pmm_fill_memstats(&stats);
+    TEST_ASSERT_EQUAL(stats.free_pages, memstats_free_block_pages(&stats));
+
+    // Une demande plus grande que le plus grand bloc échoue et est comptée
+    TEST_ASSERT_NULL(pmm_alloc_pages(largest * 2));
+    TEST_ASSERT_NULL(pmm_alloc_high_pages(512));
+    pmm_fill_memstats(&stats);
+    TEST_ASSERT_EQUAL(2, stats.alloc_failures);
+    TEST_ASSERT_EQUAL(1, stats.alloc_failures_by_order[9]);
+    TEST_ASSERT_EQUAL(512, stats.last_failed_pages);
+
+    pmm_free_page(page);
+    pmm_fill_memstats(&stats);
+    TEST_ASSERT_EQUAL(largest, stats.largest_free_run);
+    TEST_ASSERT_EQUAL(stats.free_pages, memstats_free_block_pages(&stats));
+}
+
 // === TESTS DE ROBUSTESSE ===
 
 void test_pmm_double_free_detection(void) {
@@ -415,7 +628,15 @@ int main(void) {
     // Tests de performance
     RUN_TEST(test_pmm_allocation_performance);
     RUN_TEST(test_pmm_batch_allocation_performance);
+    RUN_TEST(test_pmm_fragmented_allocation_latency);
     
+    // Tests de zones
+    RUN_TEST(test_pmm_high_zone_allocation);
+    RUN_TEST(test_pmm_shared_page_refcount);
+    RUN_TEST(test_pmm_zero_pool_refill_and_alloc);
+    RUN_TEST(test_pmm_memstats_histogram_and_failures);
+    RUN_TEST(test_pmm_block_remembers_size);
+
     // Tests de robustesse
     RUN_TEST(test_pmm_double_free_detection);
     RUN_TEST(test_pmm_memory_corruption_detection);
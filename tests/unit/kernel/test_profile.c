@@ -0,0 +1,56 @@
+#include "../../framework/unity.h"
+#include "../../../kernel/profile.h"
+
+static profile_ring_t ring;
+
+static void ring_reset(void) {
+    ring.head = 0U;
+    ring.drained = 0U;
+    ring.dropped = 0U;
+}
+
+static void test_profile_reserve_then_publish(void) {
+    profile_sample_t* sample;
+    ring_reset();
+    sample = profile_ring_reserve(&ring);
+    TEST_ASSERT_TRUE(sample == &ring.samples[0]);
+    // Non publié : le vidage ne le voit pas encore
+    TEST_ASSERT_EQUAL(0, ring.head);
+    sample->pc[0] = 0x1234U;
+    profile_ring_publish(&ring);
+    TEST_ASSERT_EQUAL(1, ring.head);
+    TEST_ASSERT_TRUE(profile_ring_reserve(&ring) == &ring.samples[1]);
+}
+
+static void test_profile_full_ring_drops_new_samples(void) {
+    uint32_t i;
+    ring_reset();
+    for (i = 0U; i < PROFILE_RING_SAMPLES; i++) {
+        TEST_ASSERT_NOT_NULL(profile_ring_reserve(&ring));
+        profile_ring_publish(&ring);
+    }
+    // Les anciens, pas encore vidés, restent intacts
+    TEST_ASSERT_NULL(profile_ring_reserve(&ring));
+    TEST_ASSERT_NULL(profile_ring_reserve(&ring));
+    TEST_ASSERT_EQUAL(2, ring.dropped);
+    TEST_ASSERT_EQUAL(PROFILE_RING_SAMPLES, ring.head);
+}
+
+static void test_profile_drained_slot_is_reused(void) {
+    uint32_t i;
+    ring_reset();
+    for (i = 0U; i < PROFILE_RING_SAMPLES; i++) profile_ring_publish(&ring);
+    ring.drained = 1U;
+    TEST_ASSERT_TRUE(profile_ring_reserve(&ring) == &ring.samples[0]);
+    TEST_ASSERT_EQUAL(0, ring.dropped);
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_profile_reserve_then_publish);
+    RUN_TEST(test_profile_full_ring_drops_new_samples);
+    RUN_TEST(test_profile_drained_slot_is_reused);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
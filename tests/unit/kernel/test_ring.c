@@ -0,0 +1,97 @@
+#include "../../framework/unity.h"
+#include "../../../include/os_ring.h"
+
+static uint8_t ring_buffer[1024] __attribute__((aligned(64)));
+
+static void test_ring_geometry_is_power_of_two(void) {
+    os_ring_t* ring = os_ring_init(ring_buffer, sizeof(ring_buffer), 64U);
+    TEST_ASSERT_NOT_NULL(ring);
+    TEST_ASSERT_EQUAL(128, sizeof(os_ring_t));
+    // 896 octets de slots : 14 slots tiennent, 8 sont retenus
+    TEST_ASSERT_EQUAL(7, ring->slot_mask);
+    TEST_ASSERT_EQUAL(0, os_ring_count(ring));
+    TEST_ASSERT_NULL(os_ring_init(ring_buffer, OS_RING_HEADER_SIZE + 63U, 64U));
+    TEST_ASSERT_NULL(os_ring_init(ring_buffer, sizeof(ring_buffer), 6U));
+}
+
+static void test_ring_preserves_order_across_wraparound(void) {
+    os_ring_t* ring = os_ring_init(ring_buffer, sizeof(ring_buffer), 64U);
+    uint32_t value;
+    uint32_t next = 0U;
+    uint32_t i;
+    for (i = 0U; i < 8U; i++) TEST_ASSERT_EQUAL(0, os_ring_push(ring, &i, sizeof(i)));
+    TEST_ASSERT_EQUAL(OS_RING_FULL, os_ring_push(ring, &i, sizeof(i)));
+    for (i = 8U; i < 100U; i++) {
+        TEST_ASSERT_EQUAL(4, os_ring_pop(ring, &value, sizeof(value)));
+        TEST_ASSERT_EQUAL(next++, value);
+        TEST_ASSERT_EQUAL(0, os_ring_push(ring, &i, sizeof(i)));
+    }
+    while (os_ring_pop(ring, &value, sizeof(value)) == 4) TEST_ASSERT_EQUAL(next++, value);
+    TEST_ASSERT_EQUAL(100, next);
+    TEST_ASSERT_EQUAL(OS_RING_EMPTY, os_ring_pop(ring, &value, sizeof(value)));
+}
+
+static void test_ring_rejects_oversized_records(void) {
+    os_ring_t* ring = os_ring_init(ring_buffer, sizeof(ring_buffer), 16U);
+    uint8_t record[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    uint8_t out[4];
+    TEST_ASSERT_EQUAL(OS_RING_TOO_BIG, os_ring_push(ring, record, 13U));
+    TEST_ASSERT_EQUAL(0, os_ring_push(ring, record, 12U));
+    // Trop grand pour le tampon : l'enregistrement reste en tête
+    TEST_ASSERT_EQUAL(OS_RING_TOO_BIG, os_ring_pop(ring, out, sizeof(out)));
+    TEST_ASSERT_EQUAL(1, os_ring_count(ring));
+    TEST_ASSERT_EQUAL(12, os_ring_pop(ring, record + 4, 12U));
+}
+
+static void test_ring_doorbell_handshake(void) {
+    os_ring_t* ring = os_ring_init(ring_buffer, sizeof(ring_buffer), 64U);
+    uint32_t value = 7U;
+    // Consommateur sans attente : aucune sonnerie
+    TEST_ASSERT_EQUAL(0, os_ring_push(ring, &value, sizeof(value)));
+    TEST_ASSERT_FALSE(os_ring_needs_doorbell(ring));
+    // Un enregistrement en attente interdit le sommeil
+    TEST_ASSERT_EQUAL(0, os_ring_prepare_wait(ring));
+    TEST_ASSERT_EQUAL(0, ring->consumer_waiting);
+    TEST_ASSERT_EQUAL(4, os_ring_pop(ring, &value, sizeof(value)));
+    TEST_ASSERT_EQUAL(1, os_ring_prepare_wait(ring));
+    TEST_ASSERT_EQUAL(0, os_ring_push(ring, &value, sizeof(value)));
+    // Une rafale ne sonne qu'une fois
+    TEST_ASSERT_TRUE(os_ring_needs_doorbell(ring));
+    TEST_ASSERT_EQUAL(0, os_ring_push(ring, &value, sizeof(value)));
+    TEST_ASSERT_FALSE(os_ring_needs_doorbell(ring));
+}
+
+static void test_ring_event_reads_back_as_kernel_message(void) {
+    os_ring_t* ring = os_ring_init(ring_buffer, sizeof(ring_buffer), OS_RING_EVENT_SLOT_SIZE);
+    os_ipc_payload_t event;
+    os_ipc_message_t message;
+    uint32_t junk = 1U;
+    event.type = OS_IPC_TASK_SUPERVISION_EVENT;
+    event.size = 3U;
+    event.request_id = 9U;
+    event.data[0] = 'a';
+    event.data[1] = 'b';
+    event.data[2] = 'c';
+    TEST_ASSERT_EQUAL(0, os_ring_push(ring, &event, sizeof(event)));
+    TEST_ASSERT_EQUAL(0, os_ring_pop_event(ring, &message));
+    TEST_ASSERT_EQUAL(0, message.sender_pid);
+    TEST_ASSERT_EQUAL(OS_IPC_TASK_SUPERVISION_EVENT, message.type);
+    TEST_ASSERT_EQUAL(3, message.size);
+    TEST_ASSERT_EQUAL(9, message.request_id);
+    TEST_ASSERT_EQUAL('c', message.data[2]);
+    TEST_ASSERT_EQUAL(0, os_ring_push(ring, &junk, sizeof(junk)));
+    TEST_ASSERT_EQUAL(OS_IPC_BAD_MESSAGE, os_ring_pop_event(ring, &message));
+    TEST_ASSERT_EQUAL(OS_RING_EMPTY, os_ring_pop_event(ring, &message));
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_ring_geometry_is_power_of_two);
+    RUN_TEST(test_ring_preserves_order_across_wraparound);
+    RUN_TEST(test_ring_rejects_oversized_records);
+    RUN_TEST(test_ring_doorbell_handshake);
+    RUN_TEST(test_ring_event_reads_back_as_kernel_message);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include "../../framework/unity.h"
+#include "../../../kernel/task/runq.h"
+#include "../../../kernel/task/task.h"
+
+#define RUNQ_TEST_TASKS 8
+
+static task_t tasks[RUNQ_TEST_TASKS];
+static runq_t rq;
+
+static task_t* make_task(uint32_t index, task_type_t type, uint32_t priority) {
+    task_t* task = &tasks[index];
+    task->id = (int)index + 1;
+    task->type = type;
+    task->priority = priority;
+    task->state = TASK_READY;
+    task->run_next = NULL;
+    task->run_prev = NULL;
+    task->run_queue = NULL;
+    return task;
+}
+
+static void test_runq_empty_after_init(void) {
+    runq_init(&rq);
+    TEST_ASSERT_NULL(runq_pop_next(&rq));
+    TEST_ASSERT_FALSE(runq_has_user(&rq));
+}
+
+static void test_runq_prefers_user_then_highest_priority(void) {
+    runq_init(&rq);
+    runq_enqueue(&rq, make_task(0, TASK_TYPE_KERNEL, OS_TASK_PRIORITY_HIGH));
+    runq_enqueue(&rq, make_task(1, TASK_TYPE_USER, OS_TASK_PRIORITY_LOW));
+    runq_enqueue(&rq, make_task(2, TASK_TYPE_USER, OS_TASK_PRIORITY_HIGH));
+    runq_enqueue(&rq, make_task(3, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    TEST_ASSERT_TRUE(runq_has_user(&rq));
+    TEST_ASSERT_EQUAL(&tasks[2], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[3], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[1], runq_pop_next(&rq));
+    TEST_ASSERT_FALSE(runq_has_user(&rq));
+    TEST_ASSERT_EQUAL(&tasks[0], runq_pop_next(&rq));
+    TEST_ASSERT_NULL(runq_pop_next(&rq));
+}
+
+static void test_runq_round_robin_within_priority(void) {
+    task_t* first;
+    runq_init(&rq);
+    runq_enqueue(&rq, make_task(0, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&rq, make_task(1, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&rq, make_task(2, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    first = runq_pop_next(&rq);
+    TEST_ASSERT_EQUAL(&tasks[0], first);
+    // La tâche préemptée repasse derrière ses pairs
+    runq_enqueue(&rq, first);
+    TEST_ASSERT_EQUAL(&tasks[1], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[2], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[0], runq_pop_next(&rq));
+}
+
+static void test_runq_front_enqueue_stays_within_level(void) {
+    runq_init(&rq);
+    runq_enqueue(&rq, make_task(0, TASK_TYPE_USER, OS_TASK_PRIORITY_HIGH));
+    runq_enqueue(&rq, make_task(1, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue_front(&rq, make_task(2, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue_front(&rq, make_task(3, TASK_TYPE_USER, OS_TASK_PRIORITY_LOW));
+    TEST_ASSERT_EQUAL(&tasks[0], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[2], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[1], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[3], runq_pop_next(&rq));
+    TEST_ASSERT_NULL(runq_pop_next(&rq));
+}
+
+static void test_runq_remove_and_double_enqueue(void) {
+    runq_init(&rq);
+    runq_enqueue(&rq, make_task(0, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&rq, make_task(1, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&rq, make_task(2, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&rq, &tasks[1]);
+    runq_remove(&tasks[1]);
+    runq_remove(&tasks[1]);
+    TEST_ASSERT_NULL(tasks[1].run_queue);
+    TEST_ASSERT_EQUAL(&tasks[0], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[2], runq_pop_next(&rq));
+    TEST_ASSERT_NULL(runq_pop_next(&rq));
+}
+
+static void test_runq_priority_change_uses_queued_level(void) {
+    runq_init(&rq);
+    runq_enqueue(&rq, make_task(0, TASK_TYPE_USER, OS_TASK_PRIORITY_LOW));
+    runq_enqueue(&rq, make_task(1, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    // task_set_priority : retrait au niveau mémorisé puis remise en file
+    tasks[0].priority = OS_TASK_PRIORITY_HIGH;
+    runq_remove(&tasks[0]);
+    runq_enqueue(&rq, &tasks[0]);
+    TEST_ASSERT_EQUAL(&tasks[0], runq_pop_next(&rq));
+    TEST_ASSERT_EQUAL(&tasks[1], runq_pop_next(&rq));
+    TEST_ASSERT_NULL(runq_pop_next(&rq));
+}
+
+static void test_runq_user_count_tracks_ring3_tasks(void) {
+    runq_init(&rq);
+    runq_enqueue(&rq, make_task(0, TASK_TYPE_KERNEL, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&rq, make_task(1, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&rq, make_task(2, TASK_TYPE_USER, OS_TASK_PRIORITY_LOW));
+    TEST_ASSERT_EQUAL(2, rq.user_count);
+    runq_remove(&tasks[2]);
+    TEST_ASSERT_EQUAL(1, rq.user_count);
+    TEST_ASSERT_EQUAL(&tasks[1], runq_pop_user(&rq));
+    TEST_ASSERT_EQUAL(0, rq.user_count);
+    // Le vol ne prend jamais une tâche noyau (idle, réseau...)
+    TEST_ASSERT_NULL(runq_pop_user(&rq));
+    TEST_ASSERT_EQUAL(&tasks[0], runq_pop_next(&rq));
+}
+
+static void test_runq_steal_moves_task_between_cpus(void) {
+    runq_t victim;
+    runq_t thief;
+    runq_init(&victim);
+    runq_init(&thief);
+    runq_enqueue(&victim, make_task(0, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    runq_enqueue(&victim, make_task(1, TASK_TYPE_USER, OS_TASK_PRIORITY_NORMAL));
+    TEST_ASSERT_FALSE(runq_has_user(&thief));
+    runq_enqueue(&thief, runq_pop_user(&victim));
+    TEST_ASSERT_EQUAL(&thief, tasks[0].run_queue);
+    TEST_ASSERT_EQUAL(1, victim.user_count);
+    TEST_ASSERT_EQUAL(1, thief.user_count);
+    // runq_remove retrouve la file de la tâche sans qu'on la lui passe
+    runq_remove(&tasks[0]);
+    TEST_ASSERT_FALSE(runq_has_user(&thief));
+    TEST_ASSERT_EQUAL(&tasks[1], runq_pop_next(&victim));
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_runq_empty_after_init);
+    RUN_TEST(test_runq_prefers_user_then_highest_priority);
+    RUN_TEST(test_runq_round_robin_within_priority);
+    RUN_TEST(test_runq_front_enqueue_stays_within_level);
+    RUN_TEST(test_runq_remove_and_double_enqueue);
+    RUN_TEST(test_runq_priority_change_uses_queued_level);
+    RUN_TEST(test_runq_user_count_tracks_ring3_tasks);
+    RUN_TEST(test_runq_steal_moves_task_between_cpus);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
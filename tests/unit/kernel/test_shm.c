@@ -0,0 +1,241 @@
+/* test_shm.c - Tests unitaires des régions partagées (droits, mappings, sortie) */
+
+#include "../../framework/unity.h"
+#include "../../framework/test_kernel.h"
+#include "../../../kernel/shm.h"
+#include "../../../kernel/service_registry.h"
+
+// PMM simulé : frames numérotées avec compteur de références
+#define TEST_SHM_FRAMES 64U
+static uint32_t test_shm_refs[TEST_SHM_FRAMES];
+static uint32_t test_shm_alloc_budget;
+
+// VMM simulé : PTE utilisateur (espace, adresse) -> frame
+#define TEST_SHM_PTES 256U
+typedef struct {
+    vmm_directory_t* dir;
+    uint32_t virt;
+    uint32_t frame;
+    uint32_t flags;
+} test_shm_pte_t;
+static test_shm_pte_t test_shm_ptes[TEST_SHM_PTES];
+static vmm_directory_t owner_dir;
+static vmm_directory_t client_dir;
+
+static uint32_t frame_index(void* page) {
+    return (uint32_t)page / 4096U - 1U;
+}
+
+void* pmm_alloc_zeroed_page(void) {
+    uint32_t i;
+    if (test_shm_alloc_budget == 0U) return NULL;
+    for (i = 0U; i < TEST_SHM_FRAMES; i++) {
+        if (test_shm_refs[i] == 0U) {
+            test_shm_refs[i] = 1U;
+            test_shm_alloc_budget--;
+            return (void*)((i + 1U) * 4096U);
+        }
+    }
+    return NULL;
+}
+
+int pmm_page_ref(void* page) {
+    if (test_shm_refs[frame_index(page)] == 0U) return -1;
+    test_shm_refs[frame_index(page)]++;
+    return 0;
+}
+
+int pmm_page_unref(void* page) {
+    if (test_shm_refs[frame_index(page)] == 0U) return 0;
+    return --test_shm_refs[frame_index(page)] == 0U ? 1 : 0;
+}
+
+static test_shm_pte_t* find_pte(vmm_directory_t* dir, uint32_t virt) {
+    uint32_t i;
+    for (i = 0U; i < TEST_SHM_PTES; i++) {
+        if (test_shm_ptes[i].dir == dir && test_shm_ptes[i].virt == virt) return &test_shm_ptes[i];
+    }
+    return NULL;
+}
+
+int vmm_map_page_in_directory(vmm_directory_t* dir, void* physaddr, void* virtualaddr, uint32_t flags) {
+    test_shm_pte_t* pte = find_pte(dir, (uint32_t)virtualaddr);
+    if (!pte) pte = find_pte(NULL, 0U);
+    if (!pte) return -3;
+    pte->dir = dir;
+    pte->virt = (uint32_t)virtualaddr;
+    pte->frame = (uint32_t)physaddr;
+    pte->flags = flags;
+    return 0;
+}
+
+int vmm_unmap_page_in_directory(vmm_directory_t* dir, void* virtualaddr) {
+    test_shm_pte_t* pte = find_pte(dir, (uint32_t)virtualaddr);
+    if (!pte) return -1;
+    (void)pmm_page_unref((void*)pte->frame);
+    pte->dir = NULL;
+    pte->virt = 0U;
+    return 0;
+}
+
+// Shootdown simulé : dernier espace invalidé et nombre d'appels
+static vmm_directory_t* test_shm_shootdown_dir;
+static uint32_t test_shm_shootdowns;
+
+void smp_tlb_shootdown(struct vmm_directory* dir) {
+    test_shm_shootdown_dir = dir;
+    test_shm_shootdowns++;
+}
+
+static uint32_t mapped_pages(vmm_directory_t* dir) {
+    uint32_t i, count = 0U;
+    for (i = 0U; i < TEST_SHM_PTES; i++) {
+        if (test_shm_ptes[i].dir == dir) count++;
+    }
+    return count;
+}
+
+static uint32_t frames_in_use(void) {
+    uint32_t i, count = 0U;
+    for (i = 0U; i < TEST_SHM_FRAMES; i++) {
+        if (test_shm_refs[i] != 0U) count++;
+    }
+    return count;
+}
+
+static void shm_test_reset(void) {
+    uint32_t i;
+    for (i = 0U; i < TEST_SHM_FRAMES; i++) test_shm_refs[i] = 0U;
+    for (i = 0U; i < TEST_SHM_PTES; i++) {
+        test_shm_ptes[i].dir = NULL;
+        test_shm_ptes[i].virt = 0U;
+    }
+    test_shm_alloc_budget = TEST_SHM_FRAMES;
+    test_shm_shootdown_dir = NULL;
+    test_shm_shootdowns = 0U;
+    service_registry_init();
+    shm_init();
+    TEST_ASSERT_EQUAL(0, service_registry_register("vfs", 10));
+}
+
+static void test_shm_create_requires_service_owner(void) {
+    shm_test_reset();
+    TEST_ASSERT_EQUAL(OS_SERVICE_NOT_OWNER, shm_create("vfs", 11, &client_dir, 2U));
+    TEST_ASSERT_EQUAL(OS_SHM_BAD_ARGUMENT, shm_create("vfs", 10, &owner_dir, 0U));
+    TEST_ASSERT_EQUAL(OS_SHM_BAD_ARGUMENT, shm_create("vfs", 10, &owner_dir, OS_SHM_REGION_MAX_PAGES + 1U));
+    TEST_ASSERT_EQUAL(1, shm_create("vfs", 10, &owner_dir, 2U));
+    TEST_ASSERT_EQUAL(2, mapped_pages(&owner_dir));
+    TEST_ASSERT_TRUE((find_pte(&owner_dir, OS_SHM_WINDOW_BASE)->flags & PAGE_WRITE) != 0U);
+}
+
+static void test_shm_grant_maps_with_rights(void) {
+    test_shm_pte_t* pte;
+    int id;
+    shm_test_reset();
+    id = shm_create("vfs", 10, &owner_dir, 3U);
+    TEST_ASSERT_EQUAL(OS_SHM_DENIED, shm_map((uint32_t)id, 11, &client_dir));
+    TEST_ASSERT_EQUAL(OS_SERVICE_NOT_OWNER, shm_grant((uint32_t)id, 11, 12, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)id, 10, 11, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_EQUAL(0, shm_map((uint32_t)id, 11, &client_dir));
+    TEST_ASSERT_EQUAL(0, shm_map((uint32_t)id, 11, &client_dir));
+    TEST_ASSERT_EQUAL(3, mapped_pages(&client_dir));
+    pte = find_pte(&client_dir, (uint32_t)os_shm_address((uint32_t)id));
+    TEST_ASSERT_NOT_NULL(pte);
+    TEST_ASSERT_EQUAL(0, pte->flags & PAGE_WRITE);
+    TEST_ASSERT_EQUAL(pte->frame, find_pte(&owner_dir, OS_SHM_WINDOW_BASE)->frame);
+    // Région + propriétaire + bénéficiaire
+    TEST_ASSERT_EQUAL(3, test_shm_refs[frame_index((void*)pte->frame)]);
+    // Une hausse de droits remappe en écriture
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)id, 10, 11, SERVICE_BACKEND_RIGHT_ALL));
+    TEST_ASSERT_TRUE((find_pte(&client_dir, OS_SHM_WINDOW_BASE)->flags & PAGE_WRITE) != 0U);
+    TEST_ASSERT_EQUAL(3, test_shm_refs[frame_index((void*)pte->frame)]);
+}
+
+static void test_shm_revoke_and_lost_service(void) {
+    int id;
+    shm_test_reset();
+    id = shm_create("vfs", 10, &owner_dir, 1U);
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)id, 10, 11, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_EQUAL(0, shm_map((uint32_t)id, 11, &client_dir));
+    TEST_ASSERT_EQUAL(0, shm_revoke((uint32_t)id, 10, 11));
+    TEST_ASSERT_EQUAL(0, mapped_pages(&client_dir));
+    // Le bénéficiaire peut tourner sur un autre CPU : son TLB est invalidé
+    TEST_ASSERT_EQUAL(1, test_shm_shootdowns);
+    TEST_ASSERT_EQUAL_PTR(&client_dir, test_shm_shootdown_dir);
+    TEST_ASSERT_EQUAL(OS_SERVICE_NOT_FOUND, shm_revoke((uint32_t)id, 10, 11));
+    TEST_ASSERT_EQUAL(OS_SHM_DENIED, shm_map((uint32_t)id, 11, &client_dir));
+    // Service retiré : la région reste mais n'accorde plus rien
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)id, 10, 11, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_EQUAL(0, service_registry_remove("vfs", 10));
+    TEST_ASSERT_EQUAL(OS_SHM_DENIED, shm_map((uint32_t)id, 11, &client_dir));
+    TEST_ASSERT_EQUAL(OS_SERVICE_NOT_OWNER, shm_grant((uint32_t)id, 10, 12, SERVICE_BACKEND_RIGHT_READ));
+}
+
+static void test_shm_owner_exit_unmaps_everywhere(void) {
+    int id;
+    shm_test_reset();
+    id = shm_create("vfs", 10, &owner_dir, 4U);
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)id, 10, 11, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_EQUAL(0, shm_map((uint32_t)id, 11, &client_dir));
+    shm_remove_pid(11);
+    TEST_ASSERT_EQUAL(0, mapped_pages(&client_dir));
+    TEST_ASSERT_EQUAL(4, frames_in_use());
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)id, 10, 11, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_EQUAL(0, shm_map((uint32_t)id, 11, &client_dir));
+    shm_remove_pid(10);
+    TEST_ASSERT_NULL(shm_region((uint32_t)id));
+    TEST_ASSERT_EQUAL(0, mapped_pages(&owner_dir));
+    TEST_ASSERT_EQUAL(0, mapped_pages(&client_dir));
+    TEST_ASSERT_EQUAL(0, frames_in_use());
+}
+
+static void test_shm_create_rolls_back_on_exhaustion(void) {
+    shm_test_reset();
+    test_shm_alloc_budget = 2U;
+    TEST_ASSERT_EQUAL(OS_SHM_NO_MEMORY, shm_create("vfs", 10, &owner_dir, 3U));
+    TEST_ASSERT_EQUAL(0, frames_in_use());
+    TEST_ASSERT_EQUAL(0, mapped_pages(&owner_dir));
+    TEST_ASSERT_NULL(shm_region(1U));
+    test_shm_alloc_budget = TEST_SHM_FRAMES;
+    for (uint32_t i = 0U; i < SHM_REGION_CAPACITY; i++) {
+        TEST_ASSERT_EQUAL((int)(i + 1U), shm_create("vfs", 10, &owner_dir, 1U));
+    }
+    TEST_ASSERT_EQUAL(OS_SHM_FULL, shm_create("vfs", 10, &owner_dir, 1U));
+    TEST_ASSERT_EQUAL(0, shm_release(5U, 10));
+    TEST_ASSERT_EQUAL(5, shm_create("vfs", 10, &owner_dir, 1U));
+}
+
+static void test_shm_anonymous_region_stays_private(void) {
+    int id;
+    int shared;
+    shm_test_reset();
+    id = shm_create(NULL, 11, &client_dir, 1U);
+    TEST_ASSERT_EQUAL(1, id);
+    TEST_ASSERT_EQUAL(2, shm_create("", 11, &client_dir, 1U));
+    TEST_ASSERT_EQUAL(OS_SERVICE_NOT_OWNER, shm_grant((uint32_t)id, 11, 10, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_EQUAL(OS_SHM_DENIED, shm_map((uint32_t)id, 10, &owner_dir));
+    TEST_ASSERT_NOT_NULL(shm_writable_page((uint32_t)id, 11, 0U));
+    TEST_ASSERT_NULL(shm_writable_page((uint32_t)id, 11, 1U));
+    TEST_ASSERT_NULL(shm_writable_page((uint32_t)id, 10, 0U));
+    // Un bénéficiaire n'écrit qu'avec MUTATE et une fois mappé
+    shared = shm_create("vfs", 10, &owner_dir, 1U);
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)shared, 10, 11, SERVICE_BACKEND_RIGHT_ALL));
+    TEST_ASSERT_NULL(shm_writable_page((uint32_t)shared, 11, 0U));
+    TEST_ASSERT_EQUAL(0, shm_map((uint32_t)shared, 11, &client_dir));
+    TEST_ASSERT_EQUAL(shm_writable_page((uint32_t)shared, 10, 0U), shm_writable_page((uint32_t)shared, 11, 0U));
+    TEST_ASSERT_EQUAL(0, shm_grant((uint32_t)shared, 10, 11, SERVICE_BACKEND_RIGHT_READ));
+    TEST_ASSERT_NULL(shm_writable_page((uint32_t)shared, 11, 0U));
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_shm_create_requires_service_owner);
+    RUN_TEST(test_shm_grant_maps_with_rights);
+    RUN_TEST(test_shm_revoke_and_lost_service);
+    RUN_TEST(test_shm_owner_exit_unmaps_everywhere);
+    RUN_TEST(test_shm_create_rolls_back_on_exhaustion);
+    RUN_TEST(test_shm_anonymous_region_stays_private);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
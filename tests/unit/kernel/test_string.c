@@ -0,0 +1,128 @@
+/* Le noyau compile avec -msse2 : on active la même cible ici pour exercer
+ * le chemin SSE2 de os_mem.h sous -m32. */
+#pragma GCC target("sse2")
+
+#include "../../framework/unity.h"
+#include "../../../include/os_mem.h"
+
+#define STRING_TEST_MAX 600U
+#define STRING_BENCH_BUFFER 65536U
+#define STRING_BENCH_BYTES (4U * 1024U * 1024U)
+
+static uint8_t src_buffer[STRING_TEST_MAX + 32U] __attribute__((aligned(16)));
+static uint8_t dst_buffer[STRING_TEST_MAX + 64U] __attribute__((aligned(16)));
+static uint8_t ref_buffer[STRING_TEST_MAX + 64U] __attribute__((aligned(16)));
+static uint8_t bench_src[STRING_BENCH_BUFFER] __attribute__((aligned(16)));
+static uint8_t bench_dst[STRING_BENCH_BUFFER] __attribute__((aligned(16)));
+
+static const uint32_t sizes[] = { 0, 1, 3, 15, 16, 17, 63, 64, 65, 255, 256, 257, 300, 511, 512, 600 };
+
+static void fill_pattern(uint8_t* buffer, uint32_t size, uint8_t seed) {
+    for (uint32_t i = 0; i < size; i++) buffer[i] = (uint8_t)(seed + i * 7U);
+}
+
+static int buffers_equal(const uint8_t* a, const uint8_t* b, uint32_t size) {
+    for (uint32_t i = 0; i < size; i++) {
+        if (a[i] != b[i]) return 0;
+    }
+    return 1;
+}
+
+static void test_memcpy_matches_byte_copy_for_all_alignments(void) {
+    fill_pattern(src_buffer, sizeof(src_buffer), 0x11);
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (uint32_t dst_off = 0; dst_off < 16U; dst_off += 3U) {
+            for (uint32_t src_off = 0; src_off < 16U; src_off += 5U) {
+                uint32_t size = sizes[s];
+                fill_pattern(dst_buffer, sizeof(dst_buffer), 0xA5);
+                fill_pattern(ref_buffer, sizeof(ref_buffer), 0xA5);
+                for (uint32_t i = 0; i < size; i++) ref_buffer[dst_off + i] = src_buffer[src_off + i];
+                TEST_ASSERT_EQUAL(dst_buffer + dst_off,
+                                  os_memcpy(dst_buffer + dst_off, src_buffer + src_off, size));
+                TEST_ASSERT_TRUE(buffers_equal(dst_buffer, ref_buffer, sizeof(dst_buffer)));
+            }
+        }
+    }
+}
+
+static void test_memset_matches_byte_fill_and_stays_in_bounds(void) {
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        for (uint32_t off = 0; off < 16U; off++) {
+            uint32_t size = sizes[s];
+            fill_pattern(dst_buffer, sizeof(dst_buffer), 0x3C);
+            fill_pattern(ref_buffer, sizeof(ref_buffer), 0x3C);
+            for (uint32_t i = 0; i < size; i++) ref_buffer[off + i] = 0xE7;
+            TEST_ASSERT_EQUAL(dst_buffer + off, os_memset(dst_buffer + off, 0x1E7, size));
+            TEST_ASSERT_TRUE(buffers_equal(dst_buffer, ref_buffer, sizeof(dst_buffer)));
+        }
+    }
+}
+
+static void test_memcmp_reports_sign_of_first_difference(void) {
+    fill_pattern(src_buffer, STRING_TEST_MAX, 0x42);
+    for (uint32_t s = 1; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        uint32_t size = sizes[s];
+        uint32_t positions[3] = { 0, size / 2U, size - 1U };
+        for (uint32_t off = 0; off < 4U; off++) {
+            for (uint32_t i = 0; i < size; i++) dst_buffer[off + i] = src_buffer[i];
+            TEST_ASSERT_EQUAL(0, os_memcmp(dst_buffer + off, src_buffer, size));
+            for (uint32_t p = 0; p < 3U; p++) {
+                uint8_t saved = dst_buffer[off + positions[p]];
+                dst_buffer[off + positions[p]] = (uint8_t)(src_buffer[positions[p]] + 1U);
+                TEST_ASSERT_TRUE(os_memcmp(dst_buffer + off, src_buffer, size) > 0);
+                TEST_ASSERT_TRUE(os_memcmp(src_buffer, dst_buffer + off, size) < 0);
+                dst_buffer[off + positions[p]] = saved;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(0, os_memcmp(src_buffer, dst_buffer, 0U));
+}
+
+/* Microbenchmark : octets par cycle (x100) pour chaque tranche de taille. */
+static void bench_report(const char* op, uint32_t size, uint64_t cycles, uint32_t bytes) {
+    uint32_t per_100 = cycles == 0U ? 0U : (uint32_t)(((uint64_t)bytes * 100U) / cycles);
+    unity_print_string(op);
+    unity_print_string(" size=");
+    unity_print_number(size);
+    unity_print_string(" bytes/cycle x100=");
+    unity_print_number(per_100);
+    unity_print_string("\n");
+}
+
+static void test_string_bytes_per_cycle_by_size_bucket(void) {
+    static const uint32_t buckets[] = { 8, 64, 96, 512, 4096, 65536 };
+    volatile int sink = 0;
+
+    fill_pattern(bench_src, STRING_BENCH_BUFFER, 0x5A);
+    unity_print_string("\n=== memcpy/memset/memcmp ===\n");
+    for (uint32_t b = 0; b < sizeof(buckets) / sizeof(buckets[0]); b++) {
+        uint32_t size = buckets[b];
+        uint32_t rounds = STRING_BENCH_BYTES / size;
+        uint64_t start;
+
+        start = rdtsc();
+        for (uint32_t r = 0; r < rounds; r++) os_memcpy(bench_dst, bench_src, size);
+        bench_report("memcpy", size, rdtsc() - start, rounds * size);
+
+        start = rdtsc();
+        for (uint32_t r = 0; r < rounds; r++) os_memset(bench_dst, (int)r, size);
+        bench_report("memset", size, rdtsc() - start, rounds * size);
+
+        os_memcpy(bench_dst, bench_src, size);
+        start = rdtsc();
+        for (uint32_t r = 0; r < rounds; r++) sink += os_memcmp(bench_dst, bench_src, size);
+        bench_report("memcmp", size, rdtsc() - start, rounds * size);
+    }
+    TEST_ASSERT_EQUAL(0, sink);
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_memcpy_matches_byte_copy_for_all_alignments);
+    RUN_TEST(test_memset_matches_byte_fill_and_stays_in_bounds);
+    RUN_TEST(test_memcmp_reports_sign_of_first_difference);
+    RUN_TEST(test_string_bytes_per_cycle_by_size_bucket);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include "../../framework/unity.h"
+#include "../../../kernel/timer_wheel.h"
+
+#define WHEEL_TEST_EVENTS 64
+
+typedef struct {
+    timer_event_t event;
+    uint32_t fired_at;
+    uint32_t fire_count;
+} wheel_probe_t;
+
+static timer_wheel_t wheel;
+static wheel_probe_t probes[WHEEL_TEST_EVENTS];
+
+static void probe_fire(timer_event_t* event) {
+    wheel_probe_t* probe = (wheel_probe_t*)event;
+    probe->fired_at = wheel.now;
+    probe->fire_count++;
+}
+
+static void rearm_fire(timer_event_t* event) {
+    wheel_probe_t* probe = (wheel_probe_t*)event;
+    probe_fire(event);
+    if (probe->fire_count < 3U) timer_wheel_arm(&wheel, event, wheel.now + 10U);
+}
+
+static void probes_init(uint32_t now) {
+    timer_wheel_init(&wheel, now);
+    for (uint32_t i = 0U; i < WHEEL_TEST_EVENTS; i++) {
+        timer_event_init(&probes[i].event, probe_fire);
+        probes[i].fired_at = 0U;
+        probes[i].fire_count = 0U;
+    }
+}
+
+static void test_timer_wheel_fires_at_exact_tick(void) {
+    probes_init(100U);
+    timer_wheel_arm(&wheel, &probes[0].event, 105U);
+    TEST_ASSERT_EQUAL(0, timer_wheel_advance(&wheel, 104U));
+    TEST_ASSERT_EQUAL(1, timer_wheel_advance(&wheel, 105U));
+    TEST_ASSERT_EQUAL(105, probes[0].fired_at);
+    TEST_ASSERT_FALSE(timer_event_pending(&probes[0].event));
+    TEST_ASSERT_EQUAL(0, wheel.count);
+}
+
+static void test_timer_wheel_cascades_long_deadlines(void) {
+    probes_init(7U);
+    timer_wheel_arm(&wheel, &probes[0].event, 7U + 70U);
+    timer_wheel_arm(&wheel, &probes[1].event, 7U + 5000U);
+    timer_wheel_arm(&wheel, &probes[2].event, 7U + 300000U);
+    for (uint32_t tick = 8U; tick <= 7U + 300000U; tick++) timer_wheel_advance(&wheel, tick);
+    TEST_ASSERT_EQUAL(77, probes[0].fired_at);
+    TEST_ASSERT_EQUAL(5007, probes[1].fired_at);
+    TEST_ASSERT_EQUAL(300007, probes[2].fired_at);
+    TEST_ASSERT_EQUAL(1, probes[2].fire_count);
+}
+
+static void test_timer_wheel_batch_advance_matches_single_steps(void) {
+    uint32_t seed = 12345U;
+    probes_init(0xFFFFF000U);  // Traverse le retour à zéro du compteur
+    for (uint32_t i = 0U; i < WHEEL_TEST_EVENTS; i++) {
+        seed = seed * 1103515245U + 12345U;
+        timer_wheel_arm(&wheel, &probes[i].event, wheel.now + 1U + (seed >> 8) % 20000U);
+    }
+    TEST_ASSERT_EQUAL(WHEEL_TEST_EVENTS, timer_wheel_advance(&wheel, wheel.now + 20001U));
+    for (uint32_t i = 0U; i < WHEEL_TEST_EVENTS; i++) {
+        TEST_ASSERT_EQUAL(1, probes[i].fire_count);
+        TEST_ASSERT_EQUAL(probes[i].event.expires, probes[i].fired_at);
+    }
+}
+
+static void test_timer_wheel_cancel_and_past_deadline(void) {
+    probes_init(50U);
+    timer_wheel_arm(&wheel, &probes[0].event, 60U);
+    timer_wheel_arm(&wheel, &probes[1].event, 60U);
+    timer_wheel_cancel(&wheel, &probes[0].event);
+    timer_wheel_cancel(&wheel, &probes[0].event);
+    TEST_ASSERT_EQUAL(1, wheel.count);
+    // Échéance passée : déclenchée au tick suivant, pas un tour plus tard
+    timer_wheel_arm(&wheel, &probes[2].event, 40U);
+    TEST_ASSERT_EQUAL(1, timer_wheel_advance(&wheel, 51U));
+    TEST_ASSERT_EQUAL(51, probes[2].fired_at);
+    timer_wheel_advance(&wheel, 60U);
+    TEST_ASSERT_EQUAL(0, probes[0].fire_count);
+    TEST_ASSERT_EQUAL(1, probes[1].fire_count);
+}
+
+static void test_timer_wheel_rearm_from_callback(void) {
+    probes_init(0U);
+    timer_event_init(&probes[0].event, rearm_fire);
+    timer_wheel_arm(&wheel, &probes[0].event, 10U);
+    timer_wheel_advance(&wheel, 100U);
+    TEST_ASSERT_EQUAL(3, probes[0].fire_count);
+    TEST_ASSERT_EQUAL(30, probes[0].fired_at);
+}
+
+static void test_timer_wheel_next_delta_bounds_sleep(void) {
+    probes_init(1000U);
+    TEST_ASSERT_EQUAL(TIMER_WHEEL_NONE, timer_wheel_next_delta(&wheel));
+    timer_wheel_arm(&wheel, &probes[0].event, 1000U + 4000U);
+    // Seule une échéance de niveau 1 : réveil à la descente, avant l'échéance
+    TEST_ASSERT_EQUAL(4992U - 1000U, timer_wheel_next_delta(&wheel));
+    timer_wheel_arm(&wheel, &probes[1].event, 1000U + 9U);
+    TEST_ASSERT_EQUAL(9, timer_wheel_next_delta(&wheel));
+    timer_wheel_advance(&wheel, 1009U);
+    TEST_ASSERT_TRUE(timer_wheel_next_delta(&wheel) == 4992U - 1009U);
+    // Réveils successifs à la borne : l'échéance tombe au bon tick
+    while (probes[0].fire_count == 0U) {
+        uint32_t delta = timer_wheel_next_delta(&wheel);
+        TEST_ASSERT_TRUE(delta != TIMER_WHEEL_NONE);
+        timer_wheel_advance(&wheel, wheel.now + delta);
+    }
+    TEST_ASSERT_EQUAL(5000, probes[0].fired_at);
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_timer_wheel_fires_at_exact_tick);
+    RUN_TEST(test_timer_wheel_cascades_long_deadlines);
+    RUN_TEST(test_timer_wheel_batch_advance_matches_single_steps);
+    RUN_TEST(test_timer_wheel_cancel_and_past_deadline);
+    RUN_TEST(test_timer_wheel_rearm_from_callback);
+    RUN_TEST(test_timer_wheel_next_delta_bounds_sleep);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include "../../framework/unity.h"
+#include "../../../kernel/trace.h"
+
+static trace_ring_t ring;
+
+static void ring_reset(void) {
+    uint32_t i;
+    ring.head = 0U;
+    ring.drained = 0U;
+    for (i = 0U; i < TRACE_RING_RECORDS; i++) ring.records[i].seq = 0U;
+}
+
+static void fill(uint32_t count) {
+    uint32_t i;
+    for (i = 0U; i < count; i++) {
+        trace_ring_write(&ring, 1000U + i, OS_TRACE_SCHED_SWITCH, 0U, 7, i, i * 2U, i * 3U);
+    }
+}
+
+static void test_trace_write_then_read(void) {
+    os_trace_record_t record;
+    ring_reset();
+    trace_ring_write(&ring, 0x123456789ULL, OS_TRACE_EXEC, 2U, 5, 11U, 22U, 33U);
+    TEST_ASSERT_EQUAL(1, ring.head);
+    TEST_ASSERT_EQUAL(1, trace_ring_read(&ring, 0U, &record));
+    TEST_ASSERT_TRUE(record.tsc == 0x123456789ULL);
+    TEST_ASSERT_EQUAL(OS_TRACE_EXEC, record.event);
+    TEST_ASSERT_EQUAL(2, record.cpu);
+    TEST_ASSERT_EQUAL(5, record.pid);
+    TEST_ASSERT_EQUAL(11, record.args[0]);
+    TEST_ASSERT_EQUAL(33, record.args[2]);
+    TEST_ASSERT_EQUAL(1, record.seq);
+    // Index pas encore écrit
+    TEST_ASSERT_EQUAL(0, trace_ring_read(&ring, 1U, &record));
+}
+
+static void test_trace_overwrite_invalidates_old_index(void) {
+    os_trace_record_t record;
+    ring_reset();
+    fill(TRACE_RING_RECORDS + 3U);
+    // Les trois premiers slots portent désormais les index 128..130
+    TEST_ASSERT_EQUAL(0, trace_ring_read(&ring, 0U, &record));
+    TEST_ASSERT_EQUAL(0, trace_ring_read(&ring, 2U, &record));
+    TEST_ASSERT_EQUAL(1, trace_ring_read(&ring, TRACE_RING_RECORDS + 2U, &record));
+    TEST_ASSERT_EQUAL(TRACE_RING_RECORDS + 2U, record.args[0]);
+    TEST_ASSERT_EQUAL(1, trace_ring_read(&ring, 3U, &record));
+    TEST_ASSERT_EQUAL(3, record.args[0]);
+}
+
+static void test_trace_slot_being_written_is_rejected(void) {
+    os_trace_record_t record;
+    ring_reset();
+    fill(4U);
+    // Écrivain interrompu entre seq = 0 et la publication
+    ring.records[3].seq = 0U;
+    TEST_ASSERT_EQUAL(0, trace_ring_read(&ring, 3U, &record));
+    TEST_ASSERT_EQUAL(1, trace_ring_read(&ring, 2U, &record));
+}
+
+static void test_trace_oldest_follows_wrap(void) {
+    ring_reset();
+    TEST_ASSERT_EQUAL(0, trace_ring_oldest(&ring));
+    fill(10U);
+    TEST_ASSERT_EQUAL(0, trace_ring_oldest(&ring));
+    fill(TRACE_RING_RECORDS);
+    TEST_ASSERT_EQUAL(10, trace_ring_oldest(&ring));
+}
+
+int main(void) {
+    unity_init();
+    RUN_TEST(test_trace_write_then_read);
+    RUN_TEST(test_trace_overwrite_invalidates_old_index);
+    RUN_TEST(test_trace_slot_being_written_is_rejected);
+    RUN_TEST(test_trace_oldest_follows_wrap);
+    unity_print_results();
+    unity_cleanup();
+    return unity_stats.tests_failed == 0 ? 0 : 1;
+}
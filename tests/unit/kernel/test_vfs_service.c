@@ -70,6 +70,35 @@ static void test_read_reply_preserves_status_and_data(void) {
     TEST_ASSERT_EQUAL('\n', reply.data[2]);
 }
 
+static void test_bulk_read_carries_only_the_region_descriptor(void) {
+    os_ipc_payload_t payload;
+    os_ipc_message_t message;
+    os_vfs_bulk_read_reply_t reply;
+    char path[OS_VFS_PATH_MAX];
+    uint32_t i;
+    TEST_ASSERT_EQUAL(0, os_vfs_make_bulk_read_request(&payload, "initrd/bin/shell", 31U));
+    TEST_ASSERT_EQUAL(OS_IPC_VFS_BULK_READ, payload.type);
+    message.type = payload.type;
+    message.size = payload.size;
+    message.request_id = payload.request_id;
+    for (i = 0U; i < OS_IPC_MAX_DATA; i++) message.data[i] = payload.data[i];
+    TEST_ASSERT_EQUAL(0, os_vfs_parse_bulk_read_request(&message, path));
+    TEST_ASSERT_EQUAL('i', path[0]);
+    TEST_ASSERT_EQUAL(OS_VFS_STATUS_INVALID, os_vfs_parse_read_request(&message, path));
+    TEST_ASSERT_EQUAL(0, os_vfs_make_bulk_read_reply(&payload, OS_VFS_STATUS_OK, OS_VFS_BULK_MAX, 3U, 31U));
+    TEST_ASSERT_EQUAL(OS_VFS_BULK_READ_REPLY_SIZE, payload.size);
+    TEST_ASSERT_EQUAL(OS_VFS_STATUS_INVALID,
+                      os_vfs_make_bulk_read_reply(&payload, OS_VFS_STATUS_OK, OS_VFS_BULK_MAX + 1U, 3U, 31U));
+    message.type = payload.type;
+    message.size = payload.size;
+    message.request_id = payload.request_id;
+    for (i = 0U; i < OS_IPC_MAX_DATA; i++) message.data[i] = payload.data[i];
+    TEST_ASSERT_EQUAL(0, os_vfs_parse_bulk_read_reply(&message, &reply, 31U));
+    TEST_ASSERT_EQUAL(OS_VFS_BULK_MAX, reply.size);
+    TEST_ASSERT_EQUAL(3, reply.region);
+    TEST_ASSERT_EQUAL(OS_VFS_STATUS_INVALID, os_vfs_parse_bulk_read_reply(&message, &reply, 32U));
+}
+
 static void test_malformed_reply_is_rejected(void) {
     os_ipc_message_t message;
     os_vfs_read_reply_t reply;
@@ -688,6 +717,7 @@ int main(void) {
     RUN_TEST(test_mount_match_requires_a_declared_directory_prefix);
     RUN_TEST(test_server_can_parse_valid_request);
     RUN_TEST(test_read_reply_preserves_status_and_data);
+    RUN_TEST(test_bulk_read_carries_only_the_region_descriptor);
     RUN_TEST(test_malformed_reply_is_rejected);
     RUN_TEST(test_grant_request_is_bounded_and_validated);
     RUN_TEST(test_write_request_and_reply_are_bounded_and_correlated);
@@ -1,11 +1,13 @@
 // ai_assistant.c - Minimal assistant to answer healthcheck quickly (ASCII-only)
 
+#include "os_syscalls.h"
+
 void putc(char c) {
-    asm volatile("int $0x80" : : "a"(1), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(1), "b"(c));
 }
 
 void exit_program(int code) {
-    asm volatile("int $0x80" : : "a"(0), "b"(code));
+    asm volatile(OS_SYSCALL_INSN : : "a"(0), "b"(code));
 }
 
 int strlen(const char* s) {
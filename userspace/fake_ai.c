@@ -2,13 +2,15 @@
 // Ce programme simule un moteur d'IA en analysant les mots-cles
 // et en retournant des reponses preprogrammees.
 
+#include "os_syscalls.h"
+
 // Wrappers pour les appels systeme
 void putc(char c) { 
-    asm volatile("int $0x80" : : "a"(1), "b"(c)); 
+    asm volatile(OS_SYSCALL_INSN : : "a"(1), "b"(c)); 
 }
 
 void exit_program() { 
-    asm volatile("int $0x80" : : "a"(0)); 
+    asm volatile(OS_SYSCALL_INSN : : "a"(0)); 
 }
 
 // Fonctions utilitaires C basiques (pas de libc disponible)
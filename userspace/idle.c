@@ -2,12 +2,14 @@
  * ensuite elle boucle sur SYS_YIELD jusqu'a kill. Ne pas la lancer via exec
  * (bloquant). */
 
+#include "os_syscalls.h"
+
 void putc(char c) {
-    asm volatile("int $0x80" : : "a"(1), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(1), "b"(c));
 }
 
 void yield(void) {
-    asm volatile("int $0x80" : : "a"(4));
+    asm volatile(OS_SYSCALL_INSN : : "a"(4));
 }
 
 void main(void) {
@@ -0,0 +1,287 @@
+/* ipc_bench.c - aller-retour IPC mesuré au TSC contre ipcpong (lancé au
+ * besoin). Quatre chemins, du plus ancien au plus direct :
+ *   poll  : SYS_IPC_SEND puis SYS_IPC_RECV en boucle de yields ;
+ *   wait  : SYS_IPC_SEND puis SYS_IPC_RECV_WAIT filtré ;
+ *   call  : SYS_IPC_CALL, message court rendu en registres ;
+ *   call96: SYS_IPC_CALL, message plein passé par l'endpoint.
+ * Affiche les cycles moyens par aller-retour. Le mode ring passe les mêmes
+ * messages par deux anneaux SPSC partagés (os_ring.h), par rafales de
+ * IPC_BENCH_RING_BATCH : cycles moyens par message. */
+#include "os_syscalls.h"
+#include "os_ring.h"
+
+#define IPC_BENCH_ROUNDS_SHIFT 10U
+#define IPC_BENCH_ROUNDS (1U << IPC_BENCH_ROUNDS_SHIFT)
+#define IPC_BENCH_WARMUP 16U
+#define IPC_BENCH_PING 0x474E4950U   // "PING"
+#define IPC_BENCH_TIMEOUT_MS 1000U
+#define IPC_BENCH_LOOKUP_TRIES 256U
+// Protocole partagé avec ipc_pong.c
+#define IPC_BENCH_RING_SETUP 0x474E4952U  // "RING"
+#define IPC_BENCH_RING_STOP 0x504F5453U   // "STOP"
+#define IPC_BENCH_RING_BYTES (2U * 4096U) // Requêtes puis réponses dans la région
+#define IPC_BENCH_RING_BATCH 16U
+
+typedef int (*ipc_bench_round_fn)(int pong_pid, os_ipc_payload_t* ping, os_ipc_message_t* pong);
+
+static void putc(char value) {
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(value));
+}
+
+static void puts(const char* text) {
+    uint32_t index = 0U;
+    while (text[index] != '\0') putc(text[index++]);
+}
+
+static void print_int(int value) {
+    char digits[11];
+    int n = 0;
+    uint32_t number;
+    if (value < 0) {
+        putc('-');
+        number = (uint32_t)(-(value + 1)) + 1U;
+    } else {
+        number = (uint32_t)value;
+    }
+    if (number == 0U) {
+        putc('0');
+        return;
+    }
+    while (number > 0U && n < 11) {
+        digits[n++] = (char)('0' + (number % 10U));
+        number /= 10U;
+    }
+    while (n > 0) putc(digits[--n]);
+}
+
+static void yield(void) {
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_YIELD));
+}
+
+static int spawn(const char* path) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SPAWN), "b"(path), "c"(0));
+    return result;
+}
+
+static int service_lookup(const char* name) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_LOOKUP), "b"(name));
+    return result;
+}
+
+static int ipc_send(int target_pid, const os_ipc_payload_t* payload) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload)
+                 : "memory");
+    return result;
+}
+
+static int ipc_receive(os_ipc_message_t* message) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message) : "memory");
+    return result;
+}
+
+static int ipc_receive_wait(os_ipc_message_t* message, const os_ipc_filter_t* filter,
+                            uint32_t timeout_ms) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result)
+                 : "a"(SYS_IPC_RECV_WAIT), "b"(message), "c"(filter), "d"(timeout_ms)
+                 : "memory");
+    return result;
+}
+
+/* Un message court revient en registres (os_ipc_short_unpack). */
+static int ipc_call(int target_pid, const os_ipc_payload_t* request, os_ipc_message_t* reply,
+                    uint32_t timeout_ms) {
+    int result;
+    uint32_t sender = (uint32_t)target_pid;
+    uint32_t type = (uint32_t)request;
+    uint32_t request_id = (uint32_t)reply;
+    uint32_t word0 = timeout_ms;
+    uint32_t word1;
+    asm volatile(OS_SYSCALL_INSN
+                 : "=a"(result), "+b"(sender), "+c"(type), "+d"(request_id), "+S"(word0), "=D"(word1)
+                 : "a"(SYS_IPC_CALL)
+                 : "memory");
+    return os_ipc_short_unpack(result, sender, type, request_id, word0, word1, reply);
+}
+
+static int shm_map(uint32_t id) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_MAP), "b"(id) : "memory");
+    return result;
+}
+
+static int doorbell_wait(uint32_t timeout_ms) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_DOORBELL_WAIT), "b"(timeout_ms) : "memory");
+    return result;
+}
+
+static void doorbell_ring(int pid) {
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_DOORBELL_RING), "b"(pid) : "memory");
+}
+
+static uint64_t rdtsc(void) {
+    uint32_t low;
+    uint32_t high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+static int pong_matches(const os_ipc_payload_t* ping, const os_ipc_message_t* pong) {
+    return pong->type == ping->type && pong->request_id == ping->request_id &&
+           pong->size == ping->size;
+}
+
+static int round_poll(int pong_pid, os_ipc_payload_t* ping, os_ipc_message_t* pong) {
+    int rc = ipc_send(pong_pid, ping);
+    if (rc != 0) return rc;
+    while ((rc = ipc_receive(pong)) == OS_IPC_EMPTY) yield();
+    return rc;
+}
+
+static int round_wait(int pong_pid, os_ipc_payload_t* ping, os_ipc_message_t* pong) {
+    os_ipc_filter_t filter;
+    int rc = ipc_send(pong_pid, ping);
+    if (rc != 0) return rc;
+    filter.match = OS_IPC_MATCH_SENDER | OS_IPC_MATCH_REQUEST;
+    filter.sender_pid = pong_pid;
+    filter.type = 0U;
+    filter.request_id = ping->request_id;
+    return ipc_receive_wait(pong, &filter, IPC_BENCH_TIMEOUT_MS);
+}
+
+static int round_call(int pong_pid, os_ipc_payload_t* ping, os_ipc_message_t* pong) {
+    return ipc_call(pong_pid, ping, pong, IPC_BENCH_TIMEOUT_MS);
+}
+
+static void bench_run(const char* name, int pong_pid, ipc_bench_round_fn round, uint32_t size) {
+    os_ipc_payload_t ping;
+    os_ipc_message_t pong;
+    uint64_t start = 0U;
+    uint32_t i;
+    ping.type = IPC_BENCH_PING;
+    ping.size = size;
+    for (i = 0U; i < size; i++) ping.data[i] = (uint8_t)i;
+    for (i = 0U; i < IPC_BENCH_WARMUP + IPC_BENCH_ROUNDS; i++) {
+        int rc;
+        if (i == IPC_BENCH_WARMUP) start = rdtsc();
+        ping.request_id = i + 1U;
+        rc = round(pong_pid, &ping, &pong);
+        if (rc != 0 || !pong_matches(&ping, &pong)) {
+            puts("ipcbench ");
+            puts(name);
+            puts(" failed rc ");
+            print_int(rc);
+            puts("\n");
+            return;
+        }
+    }
+    puts("ipcbench ");
+    puts(name);
+    puts(" ");
+    print_int((int)((rdtsc() - start) >> IPC_BENCH_ROUNDS_SHIFT));
+    puts(" cycles/rt\n");
+}
+
+static void ring_failed(const char* reason, int rc) {
+    puts("ipcbench ring ");
+    puts(reason);
+    puts(" rc ");
+    print_int(rc);
+    puts("\n");
+}
+
+/* Attend un enregistrement : sonnette seulement si l'anneau est resté vide. */
+static int ring_pop_wait(os_ring_t* ring, os_ipc_payload_t* record) {
+    int rc;
+    while ((rc = os_ring_pop(ring, record, sizeof(*record))) == OS_RING_EMPTY) {
+        if (!os_ring_prepare_wait(ring)) continue;
+        rc = doorbell_wait(IPC_BENCH_TIMEOUT_MS);
+        os_ring_finish_wait(ring);
+        if (rc == 0 && os_ring_count(ring) == 0U) return OS_IPC_EMPTY;
+    }
+    return rc;
+}
+
+static void ring_push(os_ring_t* ring, int pong_pid, const os_ipc_payload_t* record) {
+    while (os_ring_push(ring, record, 12U + record->size) == OS_RING_FULL) yield();
+    if (os_ring_needs_doorbell(ring)) doorbell_ring(pong_pid);
+}
+
+static void bench_ring(int pong_pid) {
+    os_ipc_payload_t setup;
+    os_ipc_message_t reply;
+    os_ipc_payload_t record;
+    os_ring_t* requests;
+    os_ring_t* replies;
+    uint64_t start;
+    uint32_t i, j;
+    int base;
+    int rc;
+    setup.type = IPC_BENCH_RING_SETUP;
+    setup.size = 0U;
+    setup.request_id = 1U;
+    rc = ipc_call(pong_pid, &setup, &reply, IPC_BENCH_TIMEOUT_MS);
+    if (rc != 0 || reply.size != 4U) {
+        ring_failed("setup", rc);
+        return;
+    }
+    base = shm_map(os_ipc_decode_u32(reply.data));
+    if (base < 0) {
+        ring_failed("map", base);
+        return;
+    }
+    requests = (os_ring_t*)base;
+    replies = (os_ring_t*)(base + (int)IPC_BENCH_RING_BYTES);
+    record.type = IPC_BENCH_PING;
+    record.size = OS_IPC_SHORT_MAX;
+    for (i = 0U; i < OS_IPC_SHORT_MAX; i++) record.data[i] = (uint8_t)i;
+    start = rdtsc();
+    for (i = 0U; i < IPC_BENCH_ROUNDS; i += IPC_BENCH_RING_BATCH) {
+        for (j = 0U; j < IPC_BENCH_RING_BATCH; j++) {
+            record.request_id = i + j + 1U;
+            ring_push(requests, pong_pid, &record);
+        }
+        for (j = 0U; j < IPC_BENCH_RING_BATCH; j++) {
+            rc = ring_pop_wait(replies, &record);
+            if (rc < 0 || record.request_id != i + j + 1U) {
+                ring_failed("failed", rc);
+                return;
+            }
+        }
+    }
+    start = rdtsc() - start;
+    record.type = IPC_BENCH_RING_STOP;
+    record.size = 0U;
+    ring_push(requests, pong_pid, &record);
+    puts("ipcbench ring ");
+    print_int((int)(start >> IPC_BENCH_ROUNDS_SHIFT));
+    puts(" cycles/msg\n");
+}
+
+int main(void) {
+    int pong_pid = service_lookup("ipcpong");
+    uint32_t tries;
+    if (pong_pid <= 0 && spawn("bin/ipcpong") < 0) {
+        puts("ipcbench spawn ipcpong failed\n");
+        return 1;
+    }
+    for (tries = 0U; pong_pid <= 0 && tries < IPC_BENCH_LOOKUP_TRIES; tries++) {
+        yield();
+        pong_pid = service_lookup("ipcpong");
+    }
+    if (pong_pid <= 0) {
+        puts("ipcbench ipcpong unavailable\n");
+        return 1;
+    }
+    bench_run("poll", pong_pid, round_poll, OS_IPC_SHORT_MAX);
+    bench_run("wait", pong_pid, round_wait, OS_IPC_SHORT_MAX);
+    bench_run("call", pong_pid, round_call, OS_IPC_SHORT_MAX);
+    bench_run("call96", pong_pid, round_call, OS_IPC_MAX_DATA);
+    bench_ring(pong_pid);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/* ipc_pong.c - serveur d'écho de ipcbench. Chaque message revient à son
+ * émetteur avec le même type, le même request_id et les mêmes données, par
+ * SYS_IPC_REPLY_WAIT : la réponse et l'attente suivante font un seul appel.
+ * IPC_BENCH_RING_SETUP passe en écho par anneaux partagés (os_ring.h)
+ * jusqu'à IPC_BENCH_RING_STOP, un délai ou un message IPC. */
+#include "os_syscalls.h"
+#include "os_ring.h"
+
+// Protocole partagé avec ipc_bench.c
+#define IPC_BENCH_RING_SETUP 0x474E4952U  // "RING"
+#define IPC_BENCH_RING_STOP 0x504F5453U   // "STOP"
+#define IPC_BENCH_RING_BYTES (2U * 4096U)
+#define IPC_PONG_RING_PAGES 4U
+#define IPC_PONG_RING_SLOT 128U
+#define IPC_PONG_RING_IDLE_MS 1000U
+
+static void putc(char value) {
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(value));
+}
+
+static void puts(const char* text) {
+    uint32_t index = 0U;
+    while (text[index] != '\0') putc(text[index++]);
+}
+
+static void yield(void) {
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_YIELD));
+}
+
+static int service_register(const char* name) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
+    return result;
+}
+
+static int ipc_send(int target_pid, const os_ipc_payload_t* payload) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload)
+                 : "memory");
+    return result;
+}
+
+static int shm_create(const char* name, uint32_t pages) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_CREATE), "b"(name), "c"(pages) : "memory");
+    return result;
+}
+
+static int shm_grant(uint32_t id, int pid, uint32_t rights) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_GRANT), "b"(id), "c"(pid), "d"(rights));
+    return result;
+}
+
+static int shm_revoke(uint32_t id, int pid) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_REVOKE), "b"(id), "c"(pid) : "memory");
+    return result;
+}
+
+static int doorbell_wait(uint32_t timeout_ms) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_DOORBELL_WAIT), "b"(timeout_ms) : "memory");
+    return result;
+}
+
+static void doorbell_ring(int pid) {
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_DOORBELL_RING), "b"(pid) : "memory");
+}
+
+/* Un message court revient en registres (os_ipc_short_unpack). */
+static int ipc_reply_wait(int client_pid, const os_ipc_payload_t* reply, os_ipc_message_t* message) {
+    int result;
+    uint32_t sender = (uint32_t)client_pid;
+    uint32_t type = (uint32_t)reply;
+    uint32_t request_id = (uint32_t)message;
+    uint32_t word0 = OS_IPC_WAIT_FOREVER;
+    uint32_t word1;
+    asm volatile(OS_SYSCALL_INSN
+                 : "=a"(result), "+b"(sender), "+c"(type), "+d"(request_id), "+S"(word0), "=D"(word1)
+                 : "a"(SYS_IPC_REPLY_WAIT)
+                 : "memory");
+    return os_ipc_short_unpack(result, sender, type, request_id, word0, word1, message);
+}
+
+/* Écho d'anneau à anneau ; l'attente ne coûte un syscall que si la file
+ * de requêtes est restée vide après os_ring_prepare_wait(). */
+static void ring_serve(os_ring_t* requests, os_ring_t* replies, int client) {
+    os_ipc_payload_t record;
+    int size;
+    for (;;) {
+        size = os_ring_pop(requests, &record, sizeof(record));
+        if (size == OS_RING_EMPTY) {
+            if (!os_ring_prepare_wait(requests)) continue;
+            size = doorbell_wait(IPC_PONG_RING_IDLE_MS);
+            os_ring_finish_wait(requests);
+            if (size == 0 && os_ring_count(requests) == 0U) return;
+            continue;
+        }
+        if (size < 12 || record.type == IPC_BENCH_RING_STOP) return;
+        while (os_ring_push(replies, &record, (uint32_t)size) == OS_RING_FULL) yield();
+        if (os_ring_needs_doorbell(replies)) doorbell_ring(client);
+    }
+}
+
+/* Région créée au premier passage puis accordée à chaque client en
+ * lecture-écriture, retirée à la fin de la série. */
+static void ring_session(int client, uint32_t request_id) {
+    static int region = 0;
+    os_ipc_payload_t reply;
+    uint8_t* base;
+    if (region <= 0) region = shm_create("ipcpong", IPC_PONG_RING_PAGES);
+    if (region <= 0 || shm_grant((uint32_t)region, client, OS_SHM_RIGHT_READ | OS_SHM_RIGHT_WRITE) != 0) {
+        puts("ipcpong ring setup failed\n");
+        return;
+    }
+    base = (uint8_t*)os_shm_address((uint32_t)region);
+    (void)os_ring_init(base, IPC_BENCH_RING_BYTES, IPC_PONG_RING_SLOT);
+    (void)os_ring_init(base + IPC_BENCH_RING_BYTES, IPC_BENCH_RING_BYTES, IPC_PONG_RING_SLOT);
+    reply.type = IPC_BENCH_RING_SETUP;
+    reply.request_id = request_id;
+    reply.size = 4U;
+    os_ipc_encode_u32(reply.data, (uint32_t)region);
+    if (ipc_send(client, &reply) == 0) {
+        ring_serve((os_ring_t*)base, (os_ring_t*)(base + IPC_BENCH_RING_BYTES), client);
+    }
+    (void)shm_revoke((uint32_t)region, client);
+}
+
+void main(void) {
+    os_ipc_message_t message;
+    os_ipc_payload_t reply;
+    int client = 0;
+    uint32_t i;
+    if (service_register("ipcpong") != 0) {
+        puts("ipcpong register failed\n");
+        for (;;) yield();
+    }
+    puts("ipcpong ready\n");
+    for (;;) {
+        if (ipc_reply_wait(client, &reply, &message) != 0) {
+            client = 0;
+            continue;
+        }
+        if (message.type == IPC_BENCH_RING_SETUP) {
+            ring_session(message.sender_pid, message.request_id);
+            client = 0;
+            continue;
+        }
+        reply.type = message.type;
+        reply.request_id = message.request_id;
+        reply.size = message.size;
+        for (i = 0U; i < message.size; i++) reply.data[i] = message.data[i];
+        client = message.sender_pid;
+    }
+}
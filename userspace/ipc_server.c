@@ -1,7 +1,7 @@
 #include "os_syscalls.h"
 
 static void putc(char c) {
-    asm volatile("int $0x80" : : "a"(SYS_PUTC), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(c));
 }
 
 static void puts(const char* text) {
@@ -30,21 +30,20 @@ static void print_int(int value) {
     while (n > 0) putc(digits[--n]);
 }
 
-static int ipc_receive(os_ipc_message_t* message) {
+/* Bloque jusqu'au prochain message : le dépôt réveille le serveur. */
+static int ipc_receive_wait(os_ipc_message_t* message) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result)
+                 : "a"(SYS_IPC_RECV_WAIT), "b"(message), "c"(0), "d"(OS_IPC_WAIT_FOREVER)
+                 : "memory");
     return result;
 }
 
-static void yield(void) {
-    asm volatile("int $0x80" : : "a"(SYS_YIELD));
-}
-
 void main(void) {
     os_ipc_message_t message;
     puts("ipc_server ready\n");
     for (;;) {
-        int rc = ipc_receive(&message);
+        int rc = ipc_receive_wait(&message);
         if (rc == 0) {
             uint32_t i;
             puts("ipc recv from ");
@@ -55,6 +54,5 @@ void main(void) {
             for (i = 0U; i < message.size; i++) putc((char)message.data[i]);
             putc('\n');
         }
-        yield();
     }
 }
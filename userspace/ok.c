@@ -1,7 +1,9 @@
 /* ok.c - ELF minimal pour SYS_EXEC. Affiche exec ok et sort (start.s). */
 
+#include "os_syscalls.h"
+
 void putc(char c) {
-    asm volatile("int $0x80" : : "a"(1), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(1), "b"(c));
 }
 
 int main(void) {
@@ -1,6 +1,7 @@
 /* ramfs.c - VFS RAM (table de nœuds en mémoire). Sans libc. */
 
 #include "ramfs.h"
+#include "os_mem.h"
 
 typedef struct {
     int used;
@@ -50,7 +51,7 @@ static void rf_strcpy(char *d, const char *s) {
 }
 
 static void rf_memcpy(char *d, const char *s, int n) {
-    for (int i = 0; i < n; i++) d[i] = s[i];
+    if (n > 0) os_memcpy(d, s, (uint32_t)n);
 }
 
 static int rf_push_part(char parts[][64], int *n, const char *start, int len) {
@@ -1,7 +1,7 @@
 #include "os_syscalls.h"
 
 static void putc(char c) {
-    asm volatile("int $0x80" : : "a"(SYS_PUTC), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(c));
 }
 
 static void puts(const char* text) {
@@ -41,24 +41,24 @@ static int string_equal(const char* left, const char* right) {
 
 static int service_register(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
     return result;
 }
 
 static int service_notify(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_NOTIFY), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_NOTIFY), "b"(name));
     return result;
 }
 
 static int ipc_receive(os_ipc_message_t* message) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
     return result;
 }
 
 static void yield(void) {
-    asm volatile("int $0x80" : : "a"(SYS_YIELD));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_YIELD));
 }
 
 void main(void) {
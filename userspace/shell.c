@@ -8,6 +8,10 @@
 #include "os_syscalls.h"
 #include "os_vfs_service.h"
 #include "os_ipc_deferred.h"
+#include "os_arena.h"
+#include "os_batch.h"
+#include "os_trace.h"
+#include "os_perf.h"
 
 // ==============================================================================
 // STRUCTURES ET DÉFINITIONS
@@ -84,503 +88,584 @@ typedef struct {
 
 // Wrappers pour les appels système
 void putc(char c) { 
-    asm volatile("int $0x80" : : "a"(1), "b"(c)); 
+    asm volatile(OS_SYSCALL_INSN : : "a"(1), "b"(c)); 
 }
 
 void exit_program(int code) { 
-    asm volatile("int $0x80" : : "a"(0), "b"(code)); 
+    asm volatile(OS_SYSCALL_INSN : : "a"(0), "b"(code)); 
 }
 
 void gets(char* buffer, int size) { 
-    asm volatile("int $0x80" : : "a"(5), "b"(buffer), "c"(size)); 
+    asm volatile(OS_SYSCALL_INSN : : "a"(5), "b"(buffer), "c"(size)); 
 }
 
 int sys_getchar(void) {
     int c;
-    asm volatile("int $0x80" : "=a"(c) : "a"(2));
+    asm volatile(OS_SYSCALL_INSN : "=a"(c) : "a"(2));
     return c;
 }
 
 int exec(const char* path, char* argv[]) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(6), "b"(path), "c"(argv));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(6), "b"(path), "c"(argv));
     return result;
 }
 
 int spawn(const char* path, char* argv[]) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(7), "b"(path), "c"(argv));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(7), "b"(path), "c"(argv));
     return result;
 }
 
 void yield() {
-    asm volatile("int $0x80" : : "a"(4));
+    asm volatile(OS_SYSCALL_INSN : : "a"(4));
 }
 
 int sys_listdir(const char* path, os_dirent_t* out, int max_n) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_LISTDIR), "b"(path), "c"(out), "d"(max_n));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_LISTDIR), "b"(path), "c"(out), "d"(max_n));
     return result;
 }
 
 int sys_readfile(const char* path, char* buf, int max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_READFILE), "b"(path), "c"(buf), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_READFILE), "b"(path), "c"(buf), "d"(max));
     return result;
 }
 
 int sys_getpid(void) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_GETPID));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_GETPID));
+    return result;
+}
+
+int sys_trace_read(os_trace_record_t* out, unsigned int capacity) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TRACE_READ), "b"(out), "c"(capacity) : "memory");
+    return result;
+}
+
+int sys_perf_read(unsigned int first, os_perf_stat_t* out, unsigned int capacity) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_PERF_READ), "b"(first), "c"(out), "d"(capacity) : "memory");
+    return result;
+}
+
+int sys_perf_reset(void) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_PERF_RESET));
+    return result;
+}
+
+int sys_profile(unsigned int multiplier) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_PROFILE), "b"(multiplier));
     return result;
 }
 
 int sys_ps(os_proc_t* out, int max_n) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_PS), "b"(out), "c"(max_n));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_PS), "b"(out), "c"(max_n));
     return result;
 }
 
 int sys_kill_pid(int pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_KILL), "b"(pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_KILL), "b"(pid));
     return result;
 }
 
 unsigned int sys_ticks(void) {
     unsigned int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TICKS));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TICKS));
     return result;
 }
 
 unsigned int sys_net_status(void) {
     unsigned int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_NET_STATUS));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_NET_STATUS));
     return result;
 }
 
 unsigned int sys_llm_session_status(void) {
     unsigned int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_LLM_SESSION_STATUS));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_LLM_SESSION_STATUS));
     return result;
 }
 
 int sys_llm_acquire_start(const os_llm_acquire_start_request_t* request) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_LLM_ACQUIRE_START), "b"(request));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_LLM_ACQUIRE_START), "b"(request));
     return result;
 }
 int sys_llm_configure_openai(const os_llm_openai_credential_request_t* request) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_LLM_OPENAI_CREDENTIAL), "b"(request));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_LLM_OPENAI_CREDENTIAL), "b"(request));
     return result;
 }
 
 int sys_llm_poll_tls(void) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_LLM_POLL_TLS));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_LLM_POLL_TLS));
     return result;
 }
 
 int sys_llm_request(const os_llm_request_t* request) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_LLM_REQUEST), "b"(request));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_LLM_REQUEST), "b"(request));
     return result;
 }
 
 int sys_llm_poll_text(os_llm_text_result_t* result) {
     int status;
-    asm volatile("int $0x80" : "=a"(status) : "a"(SYS_LLM_POLL_TEXT), "b"(result));
+    asm volatile(OS_SYSCALL_INSN : "=a"(status) : "a"(SYS_LLM_POLL_TEXT), "b"(result));
     return status;
 }
 
 int sys_llm_poll_sse(os_llm_text_result_t* result) {
     int status;
-    asm volatile("int $0x80" : "=a"(status) : "a"(SYS_LLM_POLL_SSE), "b"(result));
+    asm volatile(OS_SYSCALL_INSN : "=a"(status) : "a"(SYS_LLM_POLL_SSE), "b"(result));
     return status;
 }
 
 int sys_llm_reset_for_request(void) {
     int status;
-    asm volatile("int $0x80" : "=a"(status) : "a"(SYS_LLM_RESET_FOR_REQUEST));
+    asm volatile(OS_SYSCALL_INSN : "=a"(status) : "a"(SYS_LLM_RESET_FOR_REQUEST));
     return status;
 }
 
 int sys_llm_close(void) {
     int status;
-    asm volatile("int $0x80" : "=a"(status) : "a"(SYS_LLM_CLOSE));
+    asm volatile(OS_SYSCALL_INSN : "=a"(status) : "a"(SYS_LLM_CLOSE));
     return status;
 }
 
 int sys_meminfo(os_meminfo_t* info) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_MEMINFO), "b"(info));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_MEMINFO), "b"(info));
+    return result;
+}
+
+int sys_memstats(os_memstats_t* out) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_MEMSTATS), "b"(out) : "memory");
     return result;
 }
 
 int sys_task_metrics(int pid, os_task_metrics_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_METRICS), "b"(pid), "c"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_METRICS), "b"(pid), "c"(out));
     return result;
 }
 
 int sys_task_set_priority(int pid, unsigned int priority) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SET_PRIORITY), "b"(pid), "c"(priority));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SET_PRIORITY), "b"(pid), "c"(priority));
     return result;
 }
 
 int sys_task_wait(int pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_WAIT), "b"(pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_WAIT), "b"(pid));
     return result;
 }
 
 int sys_task_set_name(int pid, const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SET_NAME), "b"(pid), "c"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SET_NAME), "b"(pid), "c"(name));
     return result;
 }
 
 int sys_task_capacity(os_task_capacity_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CAPACITY), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CAPACITY), "b"(out));
     return result;
 }
 
 int sys_task_child_result(int pid, os_task_exit_result_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT), "b"(pid), "c"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT), "b"(pid), "c"(out));
     return result;
 }
 
 int sys_task_child_result_list(os_task_exit_history_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_LIST), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_LIST), "b"(out));
     return result;
 }
 
 int sys_task_child_result_ack(void) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_ACK));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_ACK));
     return result;
 }
 
 int sys_task_child_result_observe(uint32_t expected, os_task_exit_history_observation_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_OBSERVE), "b"(expected), "c"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_OBSERVE), "b"(expected), "c"(out));
     return result;
 }
 
 int sys_task_child_result_find(int pid, os_task_exit_result_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_FIND), "b"(pid), "c"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_FIND), "b"(pid), "c"(out));
     return result;
 }
 
 int sys_task_child_result_forget(int pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_FORGET), "b"(pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILD_RESULT_FORGET), "b"(pid));
     return result;
 }
 
 int sys_task_suspend(int pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUSPEND), "b"(pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUSPEND), "b"(pid));
     return result;
 }
 
 int sys_task_resume(int pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_RESUME), "b"(pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_RESUME), "b"(pid));
     return result;
 }
 
 int sys_task_kill_children(void) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_KILL_CHILDREN));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_KILL_CHILDREN));
     return result;
 }
 
 int sys_task_children(os_task_children_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILDREN), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILDREN), "b"(out));
     return result;
 }
 
 int sys_task_wait_any(void) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_WAIT_ANY));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_WAIT_ANY));
     return result;
 }
 
 int sys_task_child_exit_count(os_task_child_exit_count_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_CHILD_EXIT_COUNT), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_CHILD_EXIT_COUNT), "b"(out));
     return result;
 }
 
 int sys_task_delegate_child(int child_pid, int supervisor_pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_DELEGATE_CHILD),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_DELEGATE_CHILD),
                  "b"(child_pid), "c"(supervisor_pid));
     return result;
 }
 
 int sys_task_supervision_events(os_task_supervision_events_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENTS), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENTS), "b"(out));
     return result;
 }
 
 int sys_task_supervision_events_ack(void) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENTS_ACK));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENTS_ACK));
     return result;
 }
 
 int sys_task_supervision_events_observe(uint32_t expected_generation,
                                         os_task_supervision_events_observation_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENTS_OBSERVE),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENTS_OBSERVE),
                  "b"(expected_generation), "c"(out));
     return result;
 }
 
 int sys_task_supervision_event_find(uint32_t sequence, os_task_supervision_event_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENT_FIND),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENT_FIND),
                  "b"(sequence), "c"(out));
     return result;
 }
 
 int sys_task_supervision_event_forget(uint32_t sequence) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENT_FORGET),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENT_FORGET),
                  "b"(sequence));
     return result;
 }
 
 int sys_task_supervision_summary(os_task_supervision_summary_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_SUMMARY), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_SUMMARY), "b"(out));
     return result;
 }
 
 int sys_task_supervision_notify(uint32_t enabled) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY), "b"(enabled));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY), "b"(enabled));
     return result;
 }
 
 int sys_task_supervision_notify_filter(uint32_t mask) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_FILTER), "b"(mask));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_FILTER), "b"(mask));
     return result;
 }
 
 int sys_task_supervision_notify_status(os_task_supervision_notify_status_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_STATUS), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_STATUS), "b"(out));
     return result;
 }
 
 int sys_task_supervision_watch(int child_pid, uint32_t enabled) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_WATCH),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_WATCH),
                  "b"(child_pid), "c"(enabled));
     return result;
 }
 
 int sys_task_supervision_watch_status(os_task_supervision_watch_status_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_WATCH_STATUS), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_WATCH_STATUS), "b"(out));
     return result;
 }
 
 int sys_task_supervision_delivery_stats(os_task_supervision_delivery_stats_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_DELIVERY_STATS), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_DELIVERY_STATS), "b"(out));
     return result;
 }
 
 int sys_task_supervision_delivery_stats_ack(void) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_DELIVERY_STATS_ACK));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_DELIVERY_STATS_ACK));
     return result;
 }
 
 int sys_task_supervision_event_replay(uint32_t sequence) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENT_REPLAY), "b"(sequence));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_EVENT_REPLAY), "b"(sequence));
     return result;
 }
 
 int sys_task_supervision_priority(int child_pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_PRIORITY), "b"(child_pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_PRIORITY), "b"(child_pid));
     return result;
 }
 
 int sys_task_supervision_priority_status(os_task_supervision_priority_status_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_PRIORITY_STATUS), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_PRIORITY_STATUS), "b"(out));
     return result;
 }
 
 int sys_task_supervision_notify_budget(uint32_t limit) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_BUDGET), "b"(limit));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_BUDGET), "b"(limit));
     return result;
 }
 
 int sys_task_supervision_notify_budget_status(os_task_supervision_notify_budget_status_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_BUDGET_STATUS), "b"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TASK_SUPERVISION_NOTIFY_BUDGET_STATUS), "b"(out));
     return result;
 }
 
 int sys_fat16_read(const char* name, char* buffer, uint32_t max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT16_READ), "b"(name), "c"(buffer), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT16_READ), "b"(name), "c"(buffer), "d"(max));
     return result;
 }
 
 int sys_fat16_list(os_fat16_dirent_t* out, uint32_t capacity) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT16_LIST), "b"(out), "c"(capacity));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT16_LIST), "b"(out), "c"(capacity));
     return result;
 }
 
 int sys_mkdir(const char* path) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_MKDIR), "b"(path));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_MKDIR), "b"(path));
     return result;
 }
 
 int sys_unlink(const char* path) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_UNLINK), "b"(path));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_UNLINK), "b"(path));
     return result;
 }
 
 int sys_writefile(const char* path, const char* buf, int n) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_WRITEFILE), "b"(path), "c"(buf), "d"(n));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_WRITEFILE), "b"(path), "c"(buf), "d"(n));
     return result;
 }
 
 int sys_stat(const char* path, os_dirent_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_STAT), "b"(path), "c"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_STAT), "b"(path), "c"(out));
     return result;
 }
 
 int sys_rename(const char* oldpath, const char* newpath) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_RENAME), "b"(oldpath), "c"(newpath));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_RENAME), "b"(oldpath), "c"(newpath));
     return result;
 }
 
 int sys_copy(const char* src, const char* dst) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_COPY), "b"(src), "c"(dst));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_COPY), "b"(src), "c"(dst));
     return result;
 }
 
 int sys_append(const char* path, const char* buf, int n) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_APPEND), "b"(path), "c"(buf), "d"(n));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_APPEND), "b"(path), "c"(buf), "d"(n));
     return result;
 }
 
 int sys_gpt2_generate(const char* prompt, char* out, int max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_GPT2_GENERATE), "b"(prompt), "c"(out), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_GPT2_GENERATE), "b"(prompt), "c"(out), "d"(max));
     return result;
 }
 
 int sys_gpt2_gguf_generate(const char* prompt, char* out, int max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_GPT2_GGUF_GENERATE), "b"(prompt), "c"(out), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_GPT2_GGUF_GENERATE), "b"(prompt), "c"(out), "d"(max));
     return result;
 }
 
 int sys_gpt2_gguf_continue(char* out, int max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_GPT2_GGUF_CONTINUE), "c"(out), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_GPT2_GGUF_CONTINUE), "c"(out), "d"(max));
     return result;
 }
 
 int sys_ipc_send(int target_pid, const os_ipc_payload_t* payload) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
     return result;
 }
 
 int sys_ipc_receive(os_ipc_message_t* message) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
+    return result;
+}
+
+int sys_ipc_receive_wait(os_ipc_message_t* message, const os_ipc_filter_t* filter,
+                         unsigned int timeout_ms) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result)
+                 : "a"(SYS_IPC_RECV_WAIT), "b"(message), "c"(filter), "d"(timeout_ms)
+                 : "memory");
+    return result;
+}
+
+/* Un message court revient en registres (os_ipc_short_unpack). */
+int sys_ipc_call(int target_pid, const os_ipc_payload_t* request, os_ipc_message_t* reply,
+                 unsigned int timeout_ms) {
+    int result;
+    uint32_t sender = (uint32_t)target_pid;
+    uint32_t type = (uint32_t)request;
+    uint32_t request_id = (uint32_t)reply;
+    uint32_t word0 = timeout_ms;
+    uint32_t word1;
+    asm volatile(OS_SYSCALL_INSN
+                 : "=a"(result), "+b"(sender), "+c"(type), "+d"(request_id), "+S"(word0), "=D"(word1)
+                 : "a"(SYS_IPC_CALL)
+                 : "memory");
+    return os_ipc_short_unpack(result, sender, type, request_id, word0, word1, reply);
+}
+
+/* Renvoie l'adresse de la région mappée, ou un code OS_SHM_* négatif. */
+int sys_shm_map(unsigned int region) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_MAP), "b"(region));
+    return result;
+}
+
+/* Sans nom : région anonyme, privée au shell. */
+int sys_shm_create(const char* name, unsigned int pages) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_CREATE), "b"(name), "c"(pages) : "memory");
+    return result;
+}
+
+int sys_batch(unsigned int region) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_BATCH), "b"(region) : "memory");
     return result;
 }
 
 int sys_service_register(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
     return result;
 }
 
 int sys_service_lookup(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_LOOKUP), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_LOOKUP), "b"(name));
     return result;
 }
 
 int sys_service_status(const char* name, os_service_status_t* status) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_STATUS), "b"(name), "c"(status));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_STATUS), "b"(name), "c"(status));
     return result;
 }
 
 int sys_service_grant(const char* name, int target_pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_GRANT), "b"(name), "c"(target_pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_GRANT), "b"(name), "c"(target_pid));
     return result;
 }
 
 int sys_service_notify(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_NOTIFY), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_NOTIFY), "b"(name));
     return result;
 }
 
 int sys_vfs_backend_read(const char* path, char* buffer, uint32_t max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_BACKEND_READ), "b"(path), "c"(buffer), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_BACKEND_READ), "b"(path), "c"(buffer), "d"(max));
     return result;
 }
 
 int sys_vfs_backend_write(const char* path, const char* data, uint32_t size) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_BACKEND_WRITE), "b"(path), "c"(data), "d"(size));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_BACKEND_WRITE), "b"(path), "c"(data), "d"(size));
     return result;
 }
 
 int sys_vfs_overlay_unlink(const char* path) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_UNLINK), "b"(path));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_UNLINK), "b"(path));
     return result;
 }
 
 int sys_vfs_overlay_rename(const char* oldpath, const char* newpath) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_RENAME), "b"(oldpath), "c"(newpath));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_RENAME), "b"(oldpath), "c"(newpath));
     return result;
 }
 
 static uint32_t vfs_request_counter = 0U;
 static os_ipc_deferred_t ipc_deferred;
 
+/* Tampons transitoires d'une commande : remis à zéro à chaque ligne saisie. */
+#define SHELL_SCRATCH_SIZE 8192U
+#define SHELL_FILE_BUFFER_SIZE 1024U
+static uint8_t shell_scratch_buffer[SHELL_SCRATCH_SIZE];
+static os_arena_t shell_scratch;
+
 static uint32_t next_vfs_request_id(void) {
     vfs_request_counter++;
     if (vfs_request_counter == 0U) vfs_request_counter++;
@@ -589,20 +674,25 @@ static uint32_t next_vfs_request_id(void) {
 
 /* Routeur général Ring 3 des réponses IPC. Une corrélation comprend le PID
  * source, le type et l’identifiant : les messages discordants sont conservés
- * dans une file statique pour leur consommateur légitime. */
-#define IPC_REPLY_WAIT_TURNS 8U
-#define VFS_READ_REPLY_WAIT_TURNS 24U
-static int wait_ipc_reply_turns(int expected_sender, uint32_t type, uint32_t request_id,
-                                os_ipc_message_t* out, uint32_t turns) {
+ * dans une file statique pour leur consommateur légitime. L'attente est bornée
+ * en temps ; le shell reste bloqué dans le noyau jusqu'au message suivant. La
+ * réception n'est pas filtrée : l'endpoint ne tient que quatre messages, les
+ * discordants doivent en sortir pour laisser passer la réponse. */
+#define IPC_REPLY_TIMEOUT_MS 100U
+#define VFS_READ_REPLY_TIMEOUT_MS 300U
+static int wait_ipc_reply_timeout(int expected_sender, uint32_t type, uint32_t request_id,
+                                  os_ipc_message_t* out, uint32_t timeout_ms) {
     int rc;
-    uint32_t attempt;
+    uint32_t deadline;
     if (!out || expected_sender <= 0) return OS_IPC_BAD_MESSAGE;
     rc = os_ipc_deferred_take_matching_from(&ipc_deferred, expected_sender, type,
                                             request_id, out);
-    for (attempt = 0U; attempt < turns && rc == OS_IPC_EMPTY; attempt++) {
+    deadline = sys_ticks() + (timeout_ms + OS_TIMER_MS_PER_TICK - 1U) / OS_TIMER_MS_PER_TICK;
+    while (rc == OS_IPC_EMPTY) {
+        int32_t remaining = (int32_t)(deadline - sys_ticks());
         int saved;
-        yield();
-        rc = sys_ipc_receive(out);
+        if (remaining <= 0) break;
+        rc = sys_ipc_receive_wait(out, 0, (uint32_t)remaining * OS_TIMER_MS_PER_TICK);
         if (rc == 0) {
             if (out->sender_pid == expected_sender && out->type == type &&
                 out->request_id == request_id) return 0;
@@ -615,12 +705,7 @@ static int wait_ipc_reply_turns(int expected_sender, uint32_t type, uint32_t req
 
 static int wait_ipc_reply(int expected_sender, uint32_t type, uint32_t request_id,
                           os_ipc_message_t* out) {
-    return wait_ipc_reply_turns(expected_sender, type, request_id, out, IPC_REPLY_WAIT_TURNS);
-}
-
-static int wait_vfs_read_reply(int expected_sender, uint32_t request_id, os_ipc_message_t* out) {
-    return wait_ipc_reply_turns(expected_sender, OS_IPC_VFS_READ_REPLY, request_id, out,
-                                VFS_READ_REPLY_WAIT_TURNS);
+    return wait_ipc_reply_timeout(expected_sender, type, request_id, out, IPC_REPLY_TIMEOUT_MS);
 }
 
 static void print_fs_err(const char* cmd, int rc);
@@ -926,6 +1011,7 @@ void cmd_help(shell_context_t* ctx, char args[][128], int arg_count) {
     
     print_colored("COMMANDES SYSTÈME :\n", COLOR_YELLOW);
     print_string("  ls [path]          - Lister initrd + overlay noyau\n");
+    print_string("  ls -R [path]       - Arborescence, un SYS_BATCH par niveau\n");
     print_string("  cat <file>         - Afficher un fichier (overlay puis initrd)\n");
     print_string("  stat <path>        - Type et taille (syscall SYS_STAT)\n");
     print_string("  test f|d|e <path>  - Tester fichier/dossier (SYS_STAT)\n");
@@ -962,6 +1048,7 @@ void cmd_help(shell_context_t* ctx, char args[][128], int arg_count) {
     print_string("  vfs-backend-list      - Lister les profils backend VFS actifs\n");
     print_string("  vfs-backend-observe <generation> - Observer un inventaire backend VFS\n");
     print_string("  vfs-read <fichier>   - Lire un fichier via le service VFS nomme\n");
+    print_string("  vfs-read-bulk <fichier> - Lire jusqu'a 32 Kio via une region partagee VFS\n");
     print_string("  vfs-stat <fichier>   - Lire les metadonnees via le service VFS nomme\n");
     print_string("  vfs-list <repertoire/> - Lister un repertoire monte via le service VFS\n");
     print_string("  vfs-mkdir <chemin> - Creer un repertoire via un montage overlay VFS\n");
@@ -976,7 +1063,7 @@ void cmd_help(shell_context_t* ctx, char args[][128], int arg_count) {
     print_string("  vfs-rename <src> <dst> - Renommer via le montage VFS overlay/\n");
     print_string("  kill <pid>         - Terminer un processus\n");
     print_string("  jobs               - Afficher les tâches\n");
-    print_string("  top                - Moniteur système\n");
+    print_string("  top                - Moniteur système (pages résidentes, fragmentation)\n");
     print_string("  getpid             - PID du shell (syscall SYS_GETPID)\n");
     
     print_colored("\nCOMMANDES SYSTÈME :\n", COLOR_YELLOW);
@@ -1021,6 +1108,9 @@ void cmd_help(shell_context_t* ctx, char args[][128], int arg_count) {
     print_string("  wait <pid>         - Attendre la sortie d’un enfant direct\n");
     print_string("  wait-result <pid>  - Attendre puis afficher le résultat enfant\n");
     print_string("  mem                - Utilisation mémoire\n");
+    print_string("  trace [n]          - Derniers événements de la trace noyau\n");
+    print_string("  perf [reset|hist c] - Cycles TSC des syscalls, IRQ et de schedule()\n");
+    print_string("  profile start [n]|stop - Échantillonnage IRQ0 vers le port série\n");
     print_string("  uptime             - Temps de fonctionnement\n");
     print_string("  date               - Date et heure\n");
     print_string("  whoami             - Utilisateur courant\n");
@@ -1082,6 +1172,99 @@ void cmd_help(shell_context_t* ctx, char args[][128], int arg_count) {
     print_colored("    Si le mode IA est activé, posez des questions sans 'ai'.\n\n", COLOR_GREEN);
 }
 
+#define SHELL_BATCH_PAGES 2U
+#define SHELL_LS_DIRS 8
+#define SHELL_LS_ENTRIES 32
+#define SHELL_LS_DEPTH 8
+
+static os_batch_t shell_batch;
+static int shell_batch_region = 0;
+static char ls_dirs[2][SHELL_LS_DIRS][RAMFS_PATH_MAX];
+static os_dirent_t ls_entries[SHELL_LS_DIRS][SHELL_LS_ENTRIES];
+
+/* Files de soumission et de complétion du shell, créées au premier lot. */
+static os_batch_t* shell_batch_get(void) {
+    int region;
+    if (shell_batch_region > 0) return &shell_batch;
+    region = sys_shm_create(NULL, SHELL_BATCH_PAGES);
+    if (region <= 0) return NULL;
+    if (os_batch_init(&shell_batch, os_shm_address((uint32_t)region), SHELL_BATCH_PAGES * 4096U) != 0) {
+        return NULL;
+    }
+    shell_batch_region = region;
+    return &shell_batch;
+}
+
+/* ls -R : les répertoires d'un niveau sont listés par un seul SYS_BATCH
+ * (SHELL_LS_DIRS au plus), au lieu d'un SYS_LISTDIR chacun. */
+static void cmd_ls_recursive(const char* root) {
+    os_batch_t* batch = shell_batch_get();
+    os_batch_cqe_t cqe;
+    int counts[SHELL_LS_DIRS];
+    int level = 0;
+    int n = 1;
+    int calls = 0;
+    int shown = 0;
+    int skipped = 0;
+
+    if (!batch) {
+        print_error("ls -R: lot de syscalls indisponible");
+        return;
+    }
+    strcpy(ls_dirs[0][0], root);
+    for (int depth = 0; n > 0 && depth < SHELL_LS_DEPTH; depth++) {
+        int next = 0;
+        for (int i = 0; i < n; i++) {
+            counts[i] = -1;
+            (void)os_batch_push(batch, SYS_LISTDIR, (uint32_t)i, (uint32_t)ls_dirs[level][i],
+                                (uint32_t)ls_entries[i], SHELL_LS_ENTRIES, 0U);
+        }
+        (void)sys_batch((unsigned int)shell_batch_region);
+        calls++;
+        while (os_batch_reap(batch, &cqe) == 0) {
+            if (cqe.user_data < (uint32_t)n) counts[cqe.user_data] = cqe.result;
+        }
+        for (int i = 0; i < n; i++) {
+            print_colored("\n", COLOR_CYAN);
+            print_colored(ls_dirs[level][i], COLOR_CYAN);
+            print_colored(":\n", COLOR_CYAN);
+            if (counts[i] < 0) {
+                print_string("  (introuvable)\n");
+                continue;
+            }
+            for (int j = 0; j < counts[i]; j++) {
+                const os_dirent_t* entry = &ls_entries[i][j];
+                if (entry->flags == OS_DIRENT_DIR) {
+                    print_colored("drwxr-xr-x  ", COLOR_BLUE);
+                    print_colored(entry->name, COLOR_BLUE);
+                    print_string("/\n");
+                    if (next < SHELL_LS_DIRS) {
+                        ramfs_resolve(ls_dirs[level][i], entry->name, ls_dirs[level ^ 1][next++], RAMFS_PATH_MAX);
+                    } else {
+                        skipped++;
+                    }
+                } else {
+                    print_string("-rw-r--r--  ");
+                    print_int((int)entry->size);
+                    print_string("  ");
+                    print_string(entry->name);
+                    print_string("\n");
+                }
+                shown++;
+            }
+        }
+        level ^= 1;
+        n = next;
+    }
+    print_string("Total: ");
+    print_int(shown);
+    print_string(" elements, ");
+    print_int(calls);
+    print_string(" SYS_BATCH");
+    if (skipped > 0 || n > 0) print_string(" (arborescence tronquee)");
+    print_string("\n\n");
+}
+
 void cmd_ls(shell_context_t* ctx, char args[][128], int arg_count) {
     char path[RAMFS_PATH_MAX];
     os_dirent_t kents[32];
@@ -1089,6 +1272,11 @@ void cmd_ls(shell_context_t* ctx, char args[][128], int arg_count) {
     int kn, rn;
     int shown = 0;
 
+    if (arg_count > 0 && strcmp(args[0], "-R") == 0) {
+        resolve_arg(ctx, arg_count > 1 ? args[1] : ".", path);
+        cmd_ls_recursive(path);
+        return;
+    }
     if (arg_count > 0) resolve_arg(ctx, args[0], path);
     else resolve_arg(ctx, ".", path);
 
@@ -1161,10 +1349,10 @@ static const char* proc_state_str(int st) {
 }
 
 void cmd_ps(shell_context_t* ctx, char args[][128], int arg_count) {
-    os_proc_t procs[16];
+    os_proc_t procs[OS_TASK_GLOBAL_CAPACITY];
     int n;
     (void)ctx; (void)args; (void)arg_count;
-    n = sys_ps(procs, 16);
+    n = sys_ps(procs, (int)OS_TASK_GLOBAL_CAPACITY);
     print_colored("\n=== Processus (noyau) ===\n", COLOR_CYAN);
     print_colored("  PID  PPID  STAT  TYPE  COMMAND\n", COLOR_YELLOW);
     if (n < 0) n = 0;
@@ -1819,11 +2007,12 @@ static void cmd_fat16_list(shell_context_t* ctx, char args[][128], int arg_count
 }
 
 static void cmd_fat16_cat(shell_context_t* ctx, char args[][128], int arg_count) {
-    char buffer[4096];
+    char* buffer = (char*)os_arena_alloc(&shell_scratch, 4096U);
     int rc;
     (void)ctx;
     if (arg_count != 1) { print_error("Usage: fat16-cat <8.3>"); return; }
-    rc = sys_fat16_read(args[0], buffer, sizeof(buffer));
+    if (!buffer) { print_error("fat16-cat: memoire de travail epuisee"); return; }
+    rc = sys_fat16_read(args[0], buffer, 4096U);
     if (rc < 0) { print_error("fat16-cat: lecture impossible"); return; }
     print_string("fat16-cat ok "); print_uint((uint32_t)rc); print_string("\n");
     for (int i = 0; i < rc; i++) putc(buffer[i]);
@@ -2166,6 +2355,191 @@ void cmd_sysinfo(shell_context_t* ctx, char args[][128], int arg_count) {
     }
 }
 
+#define SHELL_TRACE_DEFAULT 16
+#define SHELL_TRACE_MAX 64
+
+void cmd_trace(shell_context_t* ctx, char args[][128], int arg_count) {
+    static os_trace_record_t records[SHELL_TRACE_MAX];
+    int wanted = SHELL_TRACE_DEFAULT;
+    int count;
+    (void)ctx;
+    if (arg_count > 0) wanted = parse_int(args[0]);
+    if (arg_count > 1 || wanted <= 0) {
+        print_error("usage: trace [n]");
+        return;
+    }
+    if (wanted > SHELL_TRACE_MAX) wanted = SHELL_TRACE_MAX;
+    count = sys_trace_read(records, (unsigned int)wanted);
+    if (count < 0) {
+        print_error("trace: syscall indisponible");
+        return;
+    }
+    print_string("trace ok "); print_uint((uint32_t)count); print_string("\n");
+    // Horodatage relatif au plus ancien enregistrement affiché (cycles TSC)
+    for (int i = 0; i < count; i++) {
+        const os_trace_record_t* record = &records[i];
+        print_string("cpu"); print_uint(record->cpu);
+        print_string(" +"); print_uint((uint32_t)(record->tsc - records[0].tsc));
+        print_string(" pid "); print_int(record->pid);
+        print_string(" "); print_string(os_trace_event_name(record->event));
+        for (int a = 0; a < 3; a++) {
+            print_string(" "); print_uint(record->args[a]);
+        }
+        print_string("\n");
+    }
+}
+
+#define SHELL_PERF_CHUNK 16
+
+/* Division 64/32 par décalages : l'espace utilisateur n'a pas de libgcc. */
+static uint64_t perf_div_u64(uint64_t n, uint32_t d) {
+    uint64_t q = 0, r = 0;
+    for (int i = 63; i >= 0; i--) {
+        r = (r << 1) | ((n >> i) & 1U);
+        if (r >= d) {
+            r -= d;
+            q |= (uint64_t)1 << i;
+        }
+    }
+    return q;
+}
+
+static void print_u64(uint64_t v) {
+    char buf[24];
+    int i = 0;
+    do {
+        uint64_t q = perf_div_u64(v, 10U);
+        buf[i++] = (char)('0' + (uint32_t)(v - q * 10U));
+        v = q;
+    } while (v != 0U);
+    while (i > 0) putc(buf[--i]);
+}
+
+static void perf_print_slot(uint32_t slot) {
+    if (slot < MAX_SYSCALLS) {
+        print_string("sys "); print_uint(slot);
+    } else if (slot < OS_PERF_SLOT_LAPIC_TIMER) {
+        print_string("irq"); print_uint(slot - OS_PERF_SLOT_IRQ(0));
+    } else if (slot == OS_PERF_SLOT_LAPIC_TIMER) {
+        print_string("lapic-timer");
+    } else if (slot == OS_PERF_SLOT_RESCHED_IPI) {
+        print_string("resched-ipi");
+    } else {
+        print_string("schedule");
+    }
+}
+
+/* sched, lapic, ipi, irqN ou numéro de syscall ; -1 si inconnu. */
+static int perf_parse_slot(const char* name) {
+    int n;
+    if (strcmp(name, "schedule") == 0 || strcmp(name, "sched") == 0) return (int)OS_PERF_SLOT_SCHEDULE;
+    if (strcmp(name, "lapic") == 0 || strcmp(name, "lapic-timer") == 0) return (int)OS_PERF_SLOT_LAPIC_TIMER;
+    if (strcmp(name, "ipi") == 0 || strcmp(name, "resched-ipi") == 0) return (int)OS_PERF_SLOT_RESCHED_IPI;
+    if (strncmp(name, "irq", 3) == 0) {
+        if (name[3] < '0' || name[3] > '9') return -1;
+        n = parse_int(name + 3);
+        return n < (int)OS_PERF_IRQ_LINES ? (int)OS_PERF_SLOT_IRQ(n) : -1;
+    }
+    if (name[0] < '0' || name[0] > '9') return -1;
+    n = parse_int(name);
+    return n < (int)MAX_SYSCALLS ? n : -1;
+}
+
+static void perf_print_stat(uint32_t slot, const os_perf_stat_t* stat) {
+    perf_print_slot(slot);
+    print_string(" n "); print_uint(stat->count);
+    print_string(" moy "); print_u64(perf_div_u64(stat->total, stat->count));
+    print_string(" min "); print_u64(stat->min);
+    print_string(" max "); print_u64(stat->max);
+    print_string("\n");
+}
+
+/* perf : coût en cycles TSC des syscalls, IRQ et de schedule() depuis le
+ * dernier perf reset ; perf hist <case> détaille l'histogramme log2. */
+void cmd_perf(shell_context_t* ctx, char args[][128], int arg_count) {
+    static os_perf_stat_t stats[SHELL_PERF_CHUNK];
+    uint32_t shown = 0U;
+    (void)ctx;
+    if (arg_count == 1 && strcmp(args[0], "reset") == 0) {
+        if (sys_perf_reset() != 0) {
+            print_error("perf: syscall indisponible");
+            return;
+        }
+        print_string("perf reset ok\n");
+        return;
+    }
+    if (arg_count == 2 && strcmp(args[0], "hist") == 0) {
+        int slot = perf_parse_slot(args[1]);
+        if (slot < 0) {
+            print_error("perf: case inconnue");
+            return;
+        }
+        if (sys_perf_read((unsigned int)slot, stats, 1U) != 1) {
+            print_error("perf: syscall indisponible");
+            return;
+        }
+        if (stats[0].count == 0U) {
+            perf_print_slot((uint32_t)slot); print_string(" vide\n");
+            return;
+        }
+        perf_print_stat((uint32_t)slot, &stats[0]);
+        for (uint32_t b = 0; b < OS_PERF_HIST_BUCKETS; b++) {
+            if (stats[0].hist[b] == 0U) continue;
+            print_string("  2^"); print_uint(b);
+            print_string(" "); print_uint(stats[0].hist[b]);
+            print_string("\n");
+        }
+        return;
+    }
+    if (arg_count != 0) {
+        print_error("usage: perf [reset | hist <sched|lapic|ipi|irqN|numero>]");
+        return;
+    }
+    for (uint32_t first = 0; first < OS_PERF_SLOT_COUNT; first += SHELL_PERF_CHUNK) {
+        int count = sys_perf_read(first, stats, SHELL_PERF_CHUNK);
+        if (count < 0) {
+            print_error("perf: syscall indisponible");
+            return;
+        }
+        for (int i = 0; i < count; i++) {
+            if (stats[i].count == 0U) continue;
+            perf_print_stat(first + (uint32_t)i, &stats[i]);
+            shown++;
+        }
+    }
+    print_string("perf ok "); print_uint(shown); print_string("\n");
+}
+
+/* profile start [n] : échantillonnage à n fois la cadence IRQ0 ; profile
+ * stop vide les échantillons sur le port série (scripts/profile_symbolize.py). */
+void cmd_profile(shell_context_t* ctx, char args[][128], int arg_count) {
+    int rc;
+    (void)ctx;
+    if (arg_count >= 1 && arg_count <= 2 && strcmp(args[0], "start") == 0) {
+        int multiplier = arg_count == 2 ? parse_int(args[1]) : 1;
+        if (multiplier <= 0 || multiplier > (int)OS_PROFILE_MAX_MULTIPLIER) {
+            print_error("profile: cadence 1 a 10");
+            return;
+        }
+        if (sys_profile((unsigned int)multiplier) != 0) {
+            print_error("profile: syscall indisponible");
+            return;
+        }
+        print_string("profile start ok "); print_uint((uint32_t)multiplier); print_string("\n");
+        return;
+    }
+    if (arg_count == 1 && strcmp(args[0], "stop") == 0) {
+        rc = sys_profile(0U);
+        if (rc < 0) {
+            print_error("profile: aucune session");
+            return;
+        }
+        print_string("profile stop ok "); print_uint((uint32_t)rc); print_string("\n");
+        return;
+    }
+    print_error("usage: profile start [1-10] | profile stop");
+}
+
 void cmd_mem(shell_context_t* ctx, char args[][128], int arg_count) {
     os_meminfo_t mi;
     (void)ctx; (void)args; (void)arg_count;
@@ -2182,6 +2556,24 @@ void cmd_mem(shell_context_t* ctx, char args[][128], int arg_count) {
     print_string("\n  Libres : ");
     print_int((int)mi.free_pages);
     print_string("\n  Taille page : 4 KB\n");
+    print_colored("Tas noyau (slabs) :\n", COLOR_YELLOW);
+    for (uint32_t i = 0; i < OS_HEAP_CLASS_COUNT; i++) {
+        const os_heap_cache_info_t* cache = &mi.heap_caches[i];
+        print_string("  ");
+        print_int((int)cache->object_size);
+        print_string(" o : ");
+        print_int((int)cache->objects_in_use);
+        print_string(" utilises, ");
+        print_int((int)cache->objects_free);
+        print_string(" libres, ");
+        print_int((int)cache->slab_pages);
+        print_string(" pages\n");
+    }
+    print_string("  Grandes allocations : ");
+    print_int((int)mi.heap_large_allocs);
+    print_string(" (");
+    print_int((int)mi.heap_large_pages);
+    print_string(" pages)\n");
     print_string("mem ok ");
     print_int((int)mi.total_pages);
     print_string(" ");
@@ -2508,16 +2900,16 @@ static void cmd_cd(shell_context_t* ctx, char args[][128], int arg_count) {
 
 static void cmd_cat(shell_context_t* ctx, char args[][128], int arg_count) {
     char path[RAMFS_PATH_MAX];
-    char kbuf[1024];
+    char* kbuf = (char*)os_arena_alloc(&shell_scratch, SHELL_FILE_BUFFER_SIZE);
     const char* data;
     int size = 0;
-    int kn;
+    int kn = -1;
     if (arg_count == 0) {
         print_error("cat: fichier manquant");
         return;
     }
     resolve_arg(ctx, args[0], path);
-    kn = sys_readfile(path, kbuf, sizeof(kbuf));
+    if (kbuf) kn = sys_readfile(path, kbuf, (int)SHELL_FILE_BUFFER_SIZE);
     if (kn >= 0) {
         for (int i = 0; i < kn; i++) putc(kbuf[i]);
         if (kn == 0 || kbuf[kn - 1] != '\n') print_string("\n");
@@ -2538,11 +2930,11 @@ static void cmd_cat(shell_context_t* ctx, char args[][128], int arg_count) {
 
 static int is_builtin(const char* cmd) {
     static const char* names[] = {
-        "help", "ls", "dir", "ps", "task-metrics", "task-priority", "task-name", "task-capacity", "task-suspend", "task-resume", "kill-children", "children", "wait-any-result", "child-exit-count", "task-delegate", "task-events", "task-events-observe", "task-events-clear", "task-event", "task-events-forget", "task-summary", "task-events-notify", "task-events-filter", "task-events-notify-status", "task-events-watch", "task-events-unwatch", "task-events-watch-clear", "task-events-watch-status", "task-events-notify-stats", "task-events-notify-stats-clear", "task-event-replay", "task-priority-child", "task-priority-child-status", "task-events-budget", "task-events-budget-status", "fat16-list", "fat16-cat", "child-result", "child-result-any", "child-results", "child-results-clear", "child-results-observe", "child-results-forget", "wait", "wait-result", "sysinfo", "info", "mem", "memory",
+        "help", "ls", "dir", "ps", "task-metrics", "task-priority", "task-name", "task-capacity", "task-suspend", "task-resume", "kill-children", "children", "wait-any-result", "child-exit-count", "task-delegate", "task-events", "task-events-observe", "task-events-clear", "task-event", "task-events-forget", "task-summary", "task-events-notify", "task-events-filter", "task-events-notify-status", "task-events-watch", "task-events-unwatch", "task-events-watch-clear", "task-events-watch-status", "task-events-notify-stats", "task-events-notify-stats-clear", "task-event-replay", "task-priority-child", "task-priority-child-status", "task-events-budget", "task-events-budget-status", "fat16-list", "fat16-cat", "child-result", "child-result-any", "child-results", "child-results-clear", "child-results-observe", "child-results-forget", "wait", "wait-result", "sysinfo", "info", "mem", "memory", "trace", "perf", "profile",
         "history", "env", "echo", "write", "append", "touch", "clear", "cls", "exit", "quit",
         "ai", "ai-mode", "ai-help", "ai-test", "ai-stats", "ai-provider", "ai-model", "ai-runtime", "ai-continue", "net-status",
         "cd", "pwd", "cat", "stat", "test", "[", "mkdir", "rmdir", "cp", "mv", "rm",
-        "kill", "spawn", "yield", "ipc-send", "ipc-recv", "service-publish", "service-grant", "service-find", "service-status", "service-watch", "vfs-backend-probe", "vfs-backend-write-probe", "vfs-backend-remove-probe", "vfs-backend-rename-probe", "vfs-grant", "vfs-read", "vfs-stat", "vfs-stats", "vfs-mount-add", "vfs-mount-remove", "vfs-write", "vfs-remove", "vfs-rename", "vfs-mkdir", "vfs-rmdir", "jobs", "top", "getpid", "uptime", "date", "whoami",
+        "kill", "spawn", "yield", "ipc-send", "ipc-recv", "service-publish", "service-grant", "service-find", "service-status", "service-watch", "vfs-backend-probe", "vfs-backend-write-probe", "vfs-backend-remove-probe", "vfs-backend-rename-probe", "vfs-grant", "vfs-read", "vfs-read-bulk", "vfs-stat", "vfs-stats", "vfs-mount-add", "vfs-mount-remove", "vfs-write", "vfs-remove", "vfs-rename", "vfs-mkdir", "vfs-rmdir", "jobs", "top", "getpid", "uptime", "date", "whoami",
         "alias", "unalias", "export", "which", "rc",
         "grep", "wc", "sort", "head", "tail",
         "logout", "reboot", "shutdown",
@@ -3556,13 +3948,13 @@ static void cmd_vfs_read(shell_context_t* ctx, char args[][128], int arg_count)
         ctx->last_rc = rc;
         return;
     }
-    rc = sys_ipc_send(pid, &request);
-    if (rc != 0) {
+    // Appel synchrone : le CPU passe au médiateur, puis revient avec la réponse
+    rc = sys_ipc_call(pid, &request, &message, VFS_READ_REPLY_TIMEOUT_MS);
+    if (rc != 0 && rc != OS_IPC_EMPTY) {
         print_error("vfs-read: service indisponible");
         ctx->last_rc = rc;
         return;
     }
-    rc = wait_vfs_read_reply(pid, request_id, &message);
     if (rc == 0) rc = os_vfs_parse_read_reply(&message, &reply, request_id);
     if (rc != 0) {
         print_error("vfs-read: reponse VFS absente ou invalide");
@@ -3587,6 +3979,71 @@ static void cmd_vfs_read(shell_context_t* ctx, char args[][128], int arg_count)
     if (reply.size == 0U || reply.data[reply.size - 1U] != '\n') print_string("\n");
 }
 
+/* Seul le descripteur transite par l'IPC : le contenu se lit dans la région
+ * partagée que le médiateur a remplie et accordée en lecture. */
+static void cmd_vfs_read_bulk(shell_context_t* ctx, char args[][128], int arg_count) {
+    os_ipc_payload_t request;
+    os_ipc_message_t message;
+    os_vfs_bulk_read_reply_t reply;
+    const char* data;
+    int pid;
+    int rc;
+    uint32_t request_id;
+    uint32_t i;
+    if (arg_count != 1) {
+        print_error("Usage: vfs-read-bulk <chemin>");
+        return;
+    }
+    pid = sys_service_lookup("vfs");
+    if (pid <= 0) {
+        print_error("vfs-read-bulk: service vfs indisponible");
+        ctx->last_rc = pid;
+        return;
+    }
+    request_id = next_vfs_request_id();
+    rc = os_vfs_make_bulk_read_request(&request, args[0], request_id);
+    if (rc != 0) {
+        print_error("vfs-read-bulk: chemin invalide ou trop long");
+        ctx->last_rc = rc;
+        return;
+    }
+    rc = sys_ipc_call(pid, &request, &message, VFS_READ_REPLY_TIMEOUT_MS);
+    if (rc != 0 && rc != OS_IPC_EMPTY) {
+        print_error("vfs-read-bulk: service indisponible");
+        ctx->last_rc = rc;
+        return;
+    }
+    if (rc == 0) rc = os_vfs_parse_bulk_read_reply(&message, &reply, request_id);
+    if (rc != 0) {
+        print_error("vfs-read-bulk: reponse VFS absente ou invalide");
+        ctx->last_rc = rc;
+        return;
+    }
+    ctx->last_rc = reply.status;
+    if (reply.status != OS_VFS_STATUS_OK) {
+        if (reply.status == OS_VFS_STATUS_NOT_MOUNTED) {
+            print_error("vfs-read-bulk: chemin hors montage");
+        } else {
+            print_error("vfs-read-bulk: lecture refusee ou fichier absent");
+        }
+        return;
+    }
+    rc = sys_shm_map(reply.region);
+    if (rc < 0) {
+        print_error("vfs-read-bulk: region partagee refusee");
+        ctx->last_rc = rc;
+        return;
+    }
+    data = (const char*)rc;
+    print_string("vfs-read-bulk ok ");
+    print_int((int)reply.size);
+    print_string(" region ");
+    print_int((int)reply.region);
+    print_string(" data ");
+    for (i = 0U; i < reply.size; i++) putc(data[i]);
+    if (reply.size == 0U || data[reply.size - 1U] != '\n') print_string("\n");
+}
+
 static void cmd_vfs_mkdir(shell_context_t* ctx, char args[][128], int arg_count) {
     os_ipc_payload_t request; os_ipc_message_t message;
     int pid, rc, status; uint32_t request_id;
@@ -3709,8 +4166,8 @@ static void cmd_vfs_list_page(shell_context_t* ctx, char args[][128], int arg_co
     if (rc != 0) { print_error("vfs-list-page: repertoire ou index invalide"); ctx->last_rc = rc; return; }
     rc = sys_ipc_send(pid, &request);
     if (rc != 0) { print_error("vfs-list-page: service indisponible"); ctx->last_rc = rc; return; }
-    rc = wait_ipc_reply_turns(pid, OS_IPC_VFS_LIST_PAGE_REPLY, request_id, &message,
-                              VFS_READ_REPLY_WAIT_TURNS);
+    rc = wait_ipc_reply_timeout(pid, OS_IPC_VFS_LIST_PAGE_REPLY, request_id, &message,
+                                VFS_READ_REPLY_TIMEOUT_MS);
     if (rc == 0) rc = os_vfs_parse_list_page_reply(&message, &reply, request_id);
 
     if (rc != 0) { print_error("vfs-list-page: reponse VFS absente ou invalide"); ctx->last_rc = rc; return; }
@@ -3744,8 +4201,8 @@ static void cmd_vfs_list_observe(shell_context_t* ctx, char args[][128], int arg
     if (rc != 0) { print_error("vfs-list-observe: argument invalide"); ctx->last_rc = rc; return; }
     rc = sys_ipc_send(pid, &request);
     if (rc != 0) { print_error("vfs-list-observe: service indisponible"); ctx->last_rc = rc; return; }
-    rc = wait_ipc_reply_turns(pid, OS_IPC_VFS_LIST_OBSERVE_REPLY, request_id, &message,
-                              VFS_READ_REPLY_WAIT_TURNS);
+    rc = wait_ipc_reply_timeout(pid, OS_IPC_VFS_LIST_OBSERVE_REPLY, request_id, &message,
+                                VFS_READ_REPLY_TIMEOUT_MS);
     if (rc == 0) rc = os_vfs_parse_list_observe_reply(&message, &reply, request_id);
 
     if (rc != 0) { print_error("vfs-list-observe: reponse VFS absente ou invalide"); ctx->last_rc = rc; return; }
@@ -3839,11 +4296,11 @@ static void cmd_yield(shell_context_t* ctx, char args[][128], int arg_count) {
 }
 
 static void cmd_jobs(shell_context_t* ctx, char args[][128], int arg_count) {
-    os_proc_t procs[16];
+    os_proc_t procs[OS_TASK_GLOBAL_CAPACITY];
     int n;
     int shown = 0;
     (void)ctx; (void)args; (void)arg_count;
-    n = sys_ps(procs, 16);
+    n = sys_ps(procs, (int)OS_TASK_GLOBAL_CAPACITY);
     print_colored("\n=== Jobs ===\n", COLOR_CYAN);
     for (int i = 0; i < n; i++) {
         if (procs[i].type != OS_TASK_USER) continue;
@@ -3862,11 +4319,48 @@ static void cmd_jobs(shell_context_t* ctx, char args[][128], int arg_count) {
     print_string("\n");
 }
 
+static const os_task_mem_t* top_find_task_mem(const os_memstats_t* stats, int pid) {
+    for (uint32_t i = 0; i < stats->task_count && i < OS_TASK_GLOBAL_CAPACITY; i++) {
+        if (stats->tasks[i].pid == pid) return &stats->tasks[i];
+    }
+    return 0;
+}
+
+static void top_print_memstats(const os_memstats_t* stats) {
+    print_string("mem: ");
+    print_int((int)stats->free_pages);
+    print_string("/");
+    print_int((int)stats->total_pages);
+    print_string(" pages libres  zero: ");
+    print_int((int)stats->zero_pool_pages);
+    print_string("  plus grand bloc: ");
+    print_int((int)stats->largest_free_run);
+    print_string("\nechecs alloc: ");
+    print_int((int)stats->alloc_failures);
+    if (stats->alloc_failures > 0) {
+        print_string(" (dernier ");
+        print_int((int)stats->last_failed_pages);
+        print_string(" pages)");
+    }
+    print_string("\nblocs libres (ordre:nombre):");
+    for (uint32_t order = 0; order < OS_MEM_ORDER_COUNT; order++) {
+        if (stats->free_blocks[order] == 0) continue;
+        print_string(" ");
+        print_int((int)order);
+        print_string(":");
+        print_int((int)stats->free_blocks[order]);
+    }
+    print_string("\n");
+}
+
 static void cmd_top(shell_context_t* ctx, char args[][128], int arg_count) {
-    os_proc_t procs[16];
+    os_proc_t procs[OS_TASK_GLOBAL_CAPACITY];
+    static os_memstats_t stats;
+    int has_stats;
     int n;
     (void)args; (void)arg_count;
-    n = sys_ps(procs, 16);
+    n = sys_ps(procs, (int)OS_TASK_GLOBAL_CAPACITY);
+    has_stats = sys_memstats(&stats) == 0;
     print_colored("\n=== top (noyau) ===\n", COLOR_CYAN);
     print_string("ticks: ");
     print_int((int)sys_ticks());
@@ -3875,14 +4369,20 @@ static void cmd_top(shell_context_t* ctx, char args[][128], int arg_count) {
     print_string("  tasks: ");
     print_int(n < 0 ? 0 : n);
     print_string("\n");
-    print_colored("  PID  STAT  TYPE  COMMAND\n", COLOR_YELLOW);
+    if (has_stats) top_print_memstats(&stats);
+    print_colored("  PID  STAT  TYPE  RSS  PT  COMMAND\n", COLOR_YELLOW);
     for (int i = 0; i < n; i++) {
+        const os_task_mem_t* mem = has_stats ? top_find_task_mem(&stats, procs[i].pid) : 0;
         print_string("  ");
         print_int(procs[i].pid);
         print_string("    ");
         print_string(proc_state_str(procs[i].state));
         print_string("     ");
         print_string(procs[i].type == OS_TASK_USER ? "user  " : "kern  ");
+        print_int(mem ? (int)mem->resident_pages : 0);
+        print_string("  ");
+        print_int(mem ? (int)mem->table_pages : 0);
+        print_string("  ");
         print_string(procs[i].name);
         print_string("\n");
     }
@@ -4072,14 +4572,14 @@ static void cmd_export(shell_context_t* ctx, char args[][128], int arg_count) {
 static int load_file_lines(shell_context_t* ctx, const char* filearg,
                            char lines[][128], int max_lines) {
     char path[RAMFS_PATH_MAX];
-    char kbuf[1024];
+    char* kbuf = (char*)os_arena_alloc(&shell_scratch, SHELL_FILE_BUFFER_SIZE);
     const char* data;
     int size = 0;
     int pos = 0;
     int n = 0;
-    int kn;
+    int kn = -1;
     resolve_arg(ctx, filearg, path);
-    kn = sys_readfile(path, kbuf, (int)sizeof(kbuf));
+    if (kbuf) kn = sys_readfile(path, kbuf, (int)SHELL_FILE_BUFFER_SIZE);
     if (kn >= 0) {
         data = kbuf;
         size = kn;
@@ -4130,18 +4630,18 @@ static void cmd_grep(shell_context_t* ctx, char args[][128], int arg_count) {
 
 static void cmd_wc(shell_context_t* ctx, char args[][128], int arg_count) {
     char path[RAMFS_PATH_MAX];
-    char kbuf[1024];
+    char* kbuf = (char*)os_arena_alloc(&shell_scratch, SHELL_FILE_BUFFER_SIZE);
     const char* data;
     int size = 0;
     int lines = 0, words = 0, chars = 0;
     int in_word = 0;
-    int kn;
+    int kn = -1;
     if (arg_count == 0) {
         print_error("wc: fichier manquant");
         return;
     }
     resolve_arg(ctx, args[0], path);
-    kn = sys_readfile(path, kbuf, (int)sizeof(kbuf));
+    if (kbuf) kn = sys_readfile(path, kbuf, (int)SHELL_FILE_BUFFER_SIZE);
     if (kn >= 0) {
         data = kbuf;
         size = kn;
@@ -5015,6 +5515,15 @@ int execute_builtin_command(shell_context_t* ctx, const char* command,
     } else if (strcmp(command, "mem") == 0 || strcmp(command, "memory") == 0) {
         cmd_mem(ctx, args, arg_count);
         return 1;
+    } else if (strcmp(command, "trace") == 0) {
+        cmd_trace(ctx, args, arg_count);
+        return 1;
+    } else if (strcmp(command, "perf") == 0) {
+        cmd_perf(ctx, args, arg_count);
+        return 1;
+    } else if (strcmp(command, "profile") == 0) {
+        cmd_profile(ctx, args, arg_count);
+        return 1;
     } else if (strcmp(command, "history") == 0) {
         cmd_history(ctx, args, arg_count);
         return 1;
@@ -5156,6 +5665,9 @@ int execute_builtin_command(shell_context_t* ctx, const char* command,
     } else if (strcmp(command, "vfs-read") == 0) {
         cmd_vfs_read(ctx, args, arg_count);
         return 1;
+    } else if (strcmp(command, "vfs-read-bulk") == 0) {
+        cmd_vfs_read_bulk(ctx, args, arg_count);
+        return 1;
     } else if (strcmp(command, "vfs-stat") == 0) {
         cmd_vfs_stat(ctx, args, arg_count);
         return 1;
@@ -5347,6 +5859,10 @@ void handle_line(shell_context_t* ctx, char* input_buffer) {
     if (strlen(input_buffer) == 0) {
         return;
     }
+    if (!shell_scratch.base) {
+        os_arena_init(&shell_scratch, shell_scratch_buffer, SHELL_SCRATCH_SIZE);
+    }
+    os_arena_reset(&shell_scratch);
     
     // Ne jamais conserver un bearer OpenAI dans l'historique du shell.
     if (strncmp(input_buffer, "ai-credential ", 14U) == 0)
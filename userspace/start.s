@@ -2,11 +2,23 @@
 
 .section .text
 .global _start
+.global os_syscall
+.global os_syscall_int80
+.global os_sysenter_ready
 
 _start:
     # La pile est déjà initialisée par le noyau.
     # On peut l'utiliser directement.
-    
+
+    # SYSENTER disponible (CPUID.1:EDX.SEP) : os_syscall prend l'entrée rapide
+    movl %ebx, %esi          # CPUID écrase EBX
+    movl $1, %eax
+    cpuid
+    shrl $11, %edx
+    andl $1, %edx
+    movl %edx, os_sysenter_ready
+    movl %esi, %ebx
+
     # Construire argc/argv minimal depuis EBX (le noyau place la question dans EBX)
     # argv = { NULL, (char*)EBX, NULL }, argc = 2
     movl %ebx, %eax          # EAX = pointeur question (ou 0)
@@ -19,12 +31,39 @@ _start:
     call main
     addl $8, %esp            # nettoyer les 2 arguments pushes
     addl $12, %esp           # liberer l'espace argv temporaire
-    
+
     # Si main() retourne, appeler exit
     movl %eax, %ebx         # Code de retour de main
     movl $0, %eax           # SYS_EXIT
-    int $0x80               # Appel système
-    
+    call os_syscall         # Appel système
+
     # Boucle infinie au cas où
     jmp .
 
+# Appel système : mêmes registres qu'INT 0x80 (EAX numéro puis résultat).
+# Cadre os_vsyscall_frame_t empilé, adresse dans EBP ; SYSEXIT revient sur
+# 1: avec ESP sur l'EBP sauvé. Un appel qui rend ECX/EDX revient par IRET
+# directement sur l'appelant.
+os_syscall:
+    cmpl $0, os_sysenter_ready
+    je os_syscall_int80
+    push %ecx
+    push %edx
+    push %ebp
+    push $1f
+    movl %esp, %ebp
+    sysenter
+1:
+    pop %ebp
+    pop %edx
+    pop %ecx
+    ret
+
+# Chemin INT 0x80, gardé pour les CPU sans SEP et pour les mesures
+os_syscall_int80:
+    int $0x80
+    ret
+
+.section .data
+os_sysenter_ready:
+    .long 0
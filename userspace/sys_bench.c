@@ -0,0 +1,84 @@
+/* sys_bench.c - coût d'un syscall trivial mesuré au TSC, par INT 0x80 puis
+ * par SYSENTER (os_syscall, userspace/start.s). SYS_GETPID et SYS_TICKS ne
+ * font presque rien côté noyau : l'écart est celui de l'entrée et du retour.
+ * Affiche les cycles moyens par appel. */
+#include "os_syscalls.h"
+
+#define SYS_BENCH_ROUNDS_SHIFT 12U
+#define SYS_BENCH_ROUNDS (1U << SYS_BENCH_ROUNDS_SHIFT)
+#define SYS_BENCH_WARMUP 64U
+
+extern uint32_t os_sysenter_ready;
+
+typedef uint32_t (*sys_bench_call_fn)(uint32_t number);
+
+static void putc(char value) {
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(value));
+}
+
+static void puts(const char* text) {
+    uint32_t index = 0U;
+    while (text[index] != '\0') putc(text[index++]);
+}
+
+static void print_uint(uint32_t number) {
+    char digits[10];
+    int n = 0;
+    if (number == 0U) {
+        putc('0');
+        return;
+    }
+    while (number > 0U && n < 10) {
+        digits[n++] = (char)('0' + (number % 10U));
+        number /= 10U;
+    }
+    while (n > 0) putc(digits[--n]);
+}
+
+/* Deux chemins au même coût d'appel : seule l'instruction d'entrée change. */
+static uint32_t call_int80(uint32_t number) {
+    uint32_t result;
+    asm volatile("call os_syscall_int80" : "=a"(result) : "a"(number) : "memory");
+    return result;
+}
+
+static uint32_t call_sysenter(uint32_t number) {
+    uint32_t result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(number) : "memory");
+    return result;
+}
+
+static uint64_t rdtsc(void) {
+    uint32_t low;
+    uint32_t high;
+    asm volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+static void bench_run(const char* name, const char* path, sys_bench_call_fn call, uint32_t number) {
+    uint64_t start = 0U;
+    uint32_t i;
+    for (i = 0U; i < SYS_BENCH_WARMUP + SYS_BENCH_ROUNDS; i++) {
+        if (i == SYS_BENCH_WARMUP) start = rdtsc();
+        (void)call(number);
+    }
+    puts("sysbench ");
+    puts(name);
+    puts(" ");
+    puts(path);
+    puts(" ");
+    print_uint((uint32_t)((rdtsc() - start) >> SYS_BENCH_ROUNDS_SHIFT));
+    puts(" cycles/call\n");
+}
+
+int main(void) {
+    bench_run("getpid", "int80", call_int80, SYS_GETPID);
+    bench_run("ticks", "int80", call_int80, SYS_TICKS);
+    if (!os_sysenter_ready) {
+        puts("sysbench sysenter unavailable (no SEP)\n");
+        return 0;
+    }
+    bench_run("getpid", "sysenter", call_sysenter, SYS_GETPID);
+    bench_run("ticks", "sysenter", call_sysenter, SYS_TICKS);
+    return 0;
+}
@@ -1,28 +1,30 @@
 // Ce programme n'a accès à AUCUNE fonction du noyau directement.
 // Il ne peut communiquer que via les appels système.
 
+#include "os_syscalls.h"
+
 // Fonction "wrapper" pour l'appel système putc
 void putc(char c) {
     // Syscall 1 = putc
-    asm volatile("int $0x80" : : "a"(1), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(1), "b"(c));
 }
 
 // Fonction "wrapper" pour l'appel système puts
 void puts(const char* str) {
     // Syscall 3 = puts
-    asm volatile("int $0x80" : : "a"(3), "b"(str));
+    asm volatile(OS_SYSCALL_INSN : : "a"(3), "b"(str));
 }
 
 // Fonction "wrapper" pour l'appel système yield
 void yield() {
     // Syscall 4 = yield
-    asm volatile("int $0x80" : : "a"(4));
+    asm volatile(OS_SYSCALL_INSN : : "a"(4));
 }
 
 // Fonction "wrapper" pour l'appel système exit
 void exit(int code) {
     // Syscall 0 = exit
-    asm volatile("int $0x80" : : "a"(0), "b"(code));
+    asm volatile(OS_SYSCALL_INSN : : "a"(0), "b"(code));
 }
 
 // Fonction utilitaire pour calculer la longueur d'une chaîne
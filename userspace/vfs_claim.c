@@ -1,7 +1,7 @@
 #include "os_syscalls.h"
 
 static void putc(char c) {
-    asm volatile("int $0x80" : : "a"(SYS_PUTC), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(c));
 }
 
 static void puts(const char* text) {
@@ -10,18 +10,18 @@ static void puts(const char* text) {
 }
 
 static void yield(void) {
-    asm volatile("int $0x80" : : "a"(SYS_YIELD));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_YIELD));
 }
 
 static int service_register(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
     return result;
 }
 
 static int backend_read(const char* path, char* buffer, uint32_t max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_BACKEND_READ), "b"(path), "c"(buffer), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_BACKEND_READ), "b"(path), "c"(buffer), "d"(max));
     return result;
 }
 
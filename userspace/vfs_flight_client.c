@@ -1,7 +1,7 @@
 #include "os_vfs_service.h"
 
 static void putc(char value) {
-    asm volatile("int $0x80" : : "a"(SYS_PUTC), "b"(value));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(value));
 }
 
 static void puts(const char* text) {
@@ -11,24 +11,24 @@ static void puts(const char* text) {
 
 static int ipc_receive(os_ipc_message_t* message) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
     return result;
 }
 
 static int ipc_send(int target_pid, const os_ipc_payload_t* payload) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
     return result;
 }
 
 static int service_lookup(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_LOOKUP), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_LOOKUP), "b"(name));
     return result;
 }
 
 static void yield(void) {
-    asm volatile("int $0x80" : : "a"(SYS_YIELD));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_YIELD));
 }
 
 static int data_equal(const uint8_t* data, uint32_t size, const char* expected) {
@@ -1,8 +1,19 @@
 #include "os_syscalls.h"
 #include "os_vfs_service.h"
+#include "os_arena.h"
+
+/* Temporaires d'une requête (listes de dirents), remis à zéro à chaque message. */
+#define VFS_SCRATCH_SIZE 2048U
+static uint8_t vfs_scratch_buffer[VFS_SCRATCH_SIZE];
+static os_arena_t vfs_scratch;
+
+static os_dirent_t* vfs_scratch_entries(void) {
+    return (os_dirent_t*)os_arena_alloc(&vfs_scratch,
+                                        (OS_VFS_LIST_ENTRY_MAX + 1U) * (uint32_t)sizeof(os_dirent_t));
+}
 
 static void putc(char c) {
-    asm volatile("int $0x80" : : "a"(SYS_PUTC), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(c));
 }
 
 static void puts(const char* text) {
@@ -10,74 +21,103 @@ static void puts(const char* text) {
     while (text[i] != '\0') putc(text[i++]);
 }
 
-static int ipc_receive(os_ipc_message_t* message) {
+/* Répond au client précédent (0 : aucun) puis attend le message suivant ; un
+ * message court revient en registres (os_ipc_short_unpack). */
+static int ipc_reply_wait(int client_pid, const os_ipc_payload_t* reply, os_ipc_message_t* message,
+                          uint32_t timeout_ms) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
-    return result;
+    uint32_t sender = (uint32_t)client_pid;
+    uint32_t type = (uint32_t)reply;
+    uint32_t request_id = (uint32_t)message;
+    uint32_t word0 = timeout_ms;
+    uint32_t word1;
+    asm volatile(OS_SYSCALL_INSN
+                 : "=a"(result), "+b"(sender), "+c"(type), "+d"(request_id), "+S"(word0), "=D"(word1)
+                 : "a"(SYS_IPC_REPLY_WAIT)
+                 : "memory");
+    return os_ipc_short_unpack(result, sender, type, request_id, word0, word1, message);
 }
 
 static int ipc_send(int target_pid, const os_ipc_payload_t* payload) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
     return result;
 }
 
 static int service_register(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
     return result;
 }
 
 static int service_lookup(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_LOOKUP), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_LOOKUP), "b"(name));
     return result;
 }
 
 static int service_grant(const char* name, int target_pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_GRANT), "b"(name), "c"(target_pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_GRANT), "b"(name), "c"(target_pid));
     return result;
 }
 
 static int service_backend_grant(const char* name, int target_pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_BACKEND_GRANT), "b"(name), "c"(target_pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_BACKEND_GRANT), "b"(name), "c"(target_pid));
     return result;
 }
 
 static int service_backend_grant_scoped(const char* name, int target_pid, uint32_t rights) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_BACKEND_GRANT_SCOPED), "b"(name), "c"(target_pid), "d"(rights));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_BACKEND_GRANT_SCOPED), "b"(name), "c"(target_pid), "d"(rights));
     return result;
 }
 
 static int service_backend_revoke(const char* name, int target_pid) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_BACKEND_REVOKE), "b"(name), "c"(target_pid));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_BACKEND_REVOKE), "b"(name), "c"(target_pid));
     return result;
 }
 
 static int service_backend_status(const char* name, int target_pid, uint32_t* rights) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_BACKEND_STATUS), "b"(name), "c"(target_pid), "d"(rights));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_BACKEND_STATUS), "b"(name), "c"(target_pid), "d"(rights));
     return result;
 }
 
 static int service_backend_list(const char* name, os_service_backend_list_t* list) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_BACKEND_LIST), "b"(name), "c"(list));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_BACKEND_LIST), "b"(name), "c"(list));
     return result;
 }
 
 static int service_backend_observe(const char* name, uint32_t expected_generation,
                                    os_service_backend_snapshot_t* snapshot) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_BACKEND_OBSERVE), "b"(name),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_BACKEND_OBSERVE), "b"(name),
                  "c"(expected_generation), "d"(snapshot));
     return result;
 }
 
+static int shm_create(const char* name, uint32_t pages) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_CREATE), "b"(name), "c"(pages));
+    return result;
+}
+
+static int shm_grant(uint32_t region, int target_pid, uint32_t rights) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_GRANT), "b"(region), "c"(target_pid), "d"(rights));
+    return result;
+}
+
+static int shm_release(uint32_t region) {
+    int result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SHM_RELEASE), "b"(region));
+    return result;
+}
+
 static void print_int(int value) {
     char digits[12];
     int n = 0;
@@ -104,37 +144,37 @@ static int string_equal_ascii_fold(const char* left, const char* right) {
 
 static int backend_initrd_read(const char* path, char* buffer, uint32_t max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_INITRD_READ), "b"(path), "c"(buffer), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_INITRD_READ), "b"(path), "c"(buffer), "d"(max));
     return result;
 }
 
 static int backend_overlay_read(const char* path, char* buffer, uint32_t max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_READ), "b"(path), "c"(buffer), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_READ), "b"(path), "c"(buffer), "d"(max));
     return result;
 }
 static int backend_fat16_read(const char* path, char* buffer, uint32_t max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT16_READ), "b"(path), "c"(buffer), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT16_READ), "b"(path), "c"(buffer), "d"(max));
     return result;
 }
 static int backend_fat16_listdir(const char* path, os_dirent_t* out, int max_n) {
     int result;
     if (!path || path[0] != '/' || path[1] != '\0') return -1;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT16_LIST), "b"(out), "c"(max_n));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT16_LIST), "b"(out), "c"(max_n));
     return result;
 }
 static int backend_fat16_listdir_page(const char* path, os_dirent_t* out, uint32_t start) {
     int result;
     if (!path || path[0] != '/' || path[1] != '\0') return -1;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT16_LIST_PAGE), "b"(out),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT16_LIST_PAGE), "b"(out),
                  "c"(OS_VFS_LIST_ENTRY_MAX + 1U), "d"(start));
     return result;
 }
 static int backend_fat16_stat(const char* path, os_dirent_t* out) {
-    os_dirent_t entries[OS_VFS_LIST_ENTRY_MAX + 1U];
+    os_dirent_t* entries = vfs_scratch_entries();
     int count, i;
-    if (!path || !out || path[0] == '\0' || path[0] == '/') return -1;
+    if (!entries || !path || !out || path[0] == '\0' || path[0] == '/') return -1;
     count = backend_fat16_listdir("/", entries, (int)(OS_VFS_LIST_ENTRY_MAX + 1U));
     if (count < 0) return count;
     for (i = 0; i < count; i++) {
@@ -150,46 +190,46 @@ static int backend_fat16_create(const char* path, const uint8_t* data, uint32_t
     int result;
     if (!path || path[0] == '\0' || path[0] == '/') return OS_VFS_STATUS_INVALID;
     if (backend_fat16_stat(path, &existing) == 0) return OS_VFS_STATUS_INVALID;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_FAT16_CREATE),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_FAT16_CREATE),
                  "b"(path), "c"(data), "d"(size));
     return result;
 }
 static int backend_fat16_remove(const char* path) {
     int result;
     if (!path || path[0] == '\0' || path[0] == '/') return OS_VFS_STATUS_INVALID;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_FAT16_UNLINK), "b"(path));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_FAT16_UNLINK), "b"(path));
     return result;
 }
 static int backend_fat16_rename(const char* oldpath, const char* newpath) {
     int result;
     if (!oldpath || !newpath || oldpath[0] == '\0' || newpath[0] == '\0' ||
         oldpath[0] == '/' || newpath[0] == '/') return OS_VFS_STATUS_INVALID;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_FAT16_RENAME),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_FAT16_RENAME),
                  "b"(oldpath), "c"(newpath));
     return result;
 }
 static int backend_fat32_read(const char* path, char* buffer, uint32_t max) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT32_READ), "b"(path), "c"(buffer), "d"(max));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT32_READ), "b"(path), "c"(buffer), "d"(max));
     return result;
 }
 static int backend_fat32_listdir(const char* path, os_dirent_t* out, int max_n) {
     int result;
     if (!path || path[0] != '/' || path[1] != '\0') return -1;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT32_LIST), "b"(out), "c"(max_n));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT32_LIST), "b"(out), "c"(max_n));
     return result;
 }
 static int backend_fat32_listdir_page(const char* path, os_dirent_t* out, uint32_t start) {
     int result;
     if (!path || path[0] != '/' || path[1] != '\0') return -1;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_FAT32_LIST_PAGE), "b"(out),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_FAT32_LIST_PAGE), "b"(out),
                  "c"(OS_VFS_LIST_ENTRY_MAX + 1U), "d"(start));
     return result;
 }
 static int backend_fat32_stat(const char* path, os_dirent_t* out) {
-    os_dirent_t entries[OS_VFS_LIST_ENTRY_MAX + 1U];
+    os_dirent_t* entries = vfs_scratch_entries();
     int count, i;
-    if (!path || !out || path[0] == '\0' || path[0] == '/') return -1;
+    if (!entries || !path || !out || path[0] == '\0' || path[0] == '/') return -1;
     count = backend_fat32_listdir("/", entries, (int)(OS_VFS_LIST_ENTRY_MAX + 1U));
     if (count < 0) return count;
     for (i = 0; i < count; i++) {
@@ -200,71 +240,71 @@ static int backend_fat32_stat(const char* path, os_dirent_t* out) {
 
 static int backend_initrd_stat(const char* path, os_dirent_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_INITRD_STAT), "b"(path), "c"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_INITRD_STAT), "b"(path), "c"(out));
     return result;
 }
 
 static int backend_overlay_stat(const char* path, os_dirent_t* out) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_STAT), "b"(path), "c"(out));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_STAT), "b"(path), "c"(out));
     return result;
 }
 
 static int backend_initrd_listdir(const char* path, os_dirent_t* out, int max_n) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_INITRD_LISTDIR),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_INITRD_LISTDIR),
                  "b"(path), "c"(out), "d"(max_n));
     return result;
 }
 
 static int backend_overlay_listdir(const char* path, os_dirent_t* out, int max_n) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_LISTDIR),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_LISTDIR),
                  "b"(path), "c"(out), "d"(max_n));
     return result;
 }
 
 static int backend_initrd_listdir_page(const char* path, os_dirent_t* out, uint32_t start) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_INITRD_LISTDIR_PAGE),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_INITRD_LISTDIR_PAGE),
                  "b"(path), "c"(out), "d"(start));
     return result;
 }
 
 static int backend_overlay_listdir_page(const char* path, os_dirent_t* out, uint32_t start) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_LISTDIR_PAGE),
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_LISTDIR_PAGE),
                  "b"(path), "c"(out), "d"(start));
     return result;
 }
 
 static int backend_write(const char* path, const uint8_t* data, uint32_t size) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_BACKEND_WRITE), "b"(path), "c"(data), "d"(size));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_BACKEND_WRITE), "b"(path), "c"(data), "d"(size));
     return result;
 }
 
 static int backend_mkdir(const char* path) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_MKDIR), "b"(path));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_MKDIR), "b"(path));
     return result;
 }
 
 static int backend_rmdir(const char* path) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_RMDIR), "b"(path));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_RMDIR), "b"(path));
     return result;
 }
 
 static int backend_remove(const char* path) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_UNLINK), "b"(path));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_UNLINK), "b"(path));
     return result;
 }
 
 static int backend_rename(const char* oldpath, const char* newpath) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_VFS_OVERLAY_RENAME), "b"(oldpath), "c"(newpath));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_VFS_OVERLAY_RENAME), "b"(oldpath), "c"(newpath));
     return result;
 }
 
@@ -303,7 +343,13 @@ static const vfs_backend_ops_t* vfs_backend_ops_for(uint32_t source) {
 }
 
 static void yield(void) {
-    asm volatile("int $0x80" : : "a"(SYS_YIELD));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_YIELD));
+}
+
+static uint32_t ticks(void) {
+    uint32_t result;
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_TICKS));
+    return result;
 }
 
 static int string_equal(const char* left, const char* right) {
@@ -402,7 +448,9 @@ static uint32_t vfs_list_generation = 1U;
 #define VFS_VIRTUAL_VIEW_INFO 0U
 #define VFS_VIRTUAL_VIEW_STATS 1U
 #define VFS_VIRTUAL_VIEW_MOUNTS 2U
-#define VFS_VIRTUAL_PENDING_TURNS_MAX 8U
+/* Délai du worker virtuel, sous celui du client (VFS_READ_REPLY_TIMEOUT_MS du
+ * shell) pour que la réponse locale de repli lui parvienne. */
+#define VFS_VIRTUAL_PENDING_TIMEOUT_TICKS (100U / OS_TIMER_MS_PER_TICK)
 
 static int read_virtual(const char* path, uint8_t* data, uint32_t* size);
 static int list_virtual_mounts_page(uint32_t start, uint8_t* data, uint32_t data_max,
@@ -418,7 +466,7 @@ typedef struct {
     uint32_t mount_index;
     uint32_t mount_start;
     uint32_t mount_written;
-    uint32_t turns;
+    uint32_t deadline;
     uint8_t mount_data[OS_VFS_READ_MAX];
 } vfs_virtual_pending_t;
 static vfs_virtual_pending_t vfs_virtual_pending;
@@ -433,7 +481,7 @@ static void vfs_virtual_reset(void) {
     vfs_virtual_pending.mount_index = 0U;
     vfs_virtual_pending.mount_start = 0U;
     vfs_virtual_pending.mount_written = 0U;
-    vfs_virtual_pending.turns = 0U;
+    vfs_virtual_pending.deadline = 0U;
 }
 
 static int vfs_virtual_lookup(void) {
@@ -453,7 +501,7 @@ static int vfs_virtual_begin(int worker_pid, int client_pid, uint32_t request_id
     vfs_virtual_pending.mount_index = 0U;
     vfs_virtual_pending.mount_start = 0U;
     vfs_virtual_pending.mount_written = 0U;
-    vfs_virtual_pending.turns = 0U;
+    vfs_virtual_pending.deadline = ticks() + VFS_VIRTUAL_PENDING_TIMEOUT_TICKS;
     return 0;
 }
 
@@ -593,7 +641,7 @@ static int vfs_virtual_recover_if_worker_missing(os_ipc_payload_t* reply_payload
 
 static int vfs_virtual_recover_if_timed_out(os_ipc_payload_t* reply_payload) {
     if (!vfs_virtual_pending.active ||
-        vfs_virtual_pending.turns < VFS_VIRTUAL_PENDING_TURNS_MAX) return 0;
+        (int32_t)(ticks() - vfs_virtual_pending.deadline) < 0) return 0;
     if (vfs_virtual_reply_local(reply_payload)) {
         vfs_virtual_timeouts++;
         return 1;
@@ -601,11 +649,13 @@ static int vfs_virtual_recover_if_timed_out(os_ipc_payload_t* reply_payload) {
     return 0;
 }
 
-static void vfs_virtual_advance_turn(void) {
-    if (vfs_virtual_pending.active &&
-        vfs_virtual_pending.turns < VFS_VIRTUAL_PENDING_TURNS_MAX) {
-        vfs_virtual_pending.turns++;
-    }
+/* Délai de réception : l'échéance de la requête déléguée, sinon aucun. */
+static uint32_t vfs_virtual_wait_ms(void) {
+    int32_t remaining;
+    if (!vfs_virtual_pending.active) return OS_IPC_WAIT_FOREVER;
+    remaining = (int32_t)(vfs_virtual_pending.deadline - ticks());
+    if (remaining <= 0) return 0U;
+    return (uint32_t)remaining * OS_TIMER_MS_PER_TICK;
 }
 
 static int vfs_virtual_complete(const os_ipc_message_t* message, os_ipc_payload_t* reply_payload) {
@@ -797,7 +847,7 @@ static int read_virtual(const char* path, uint8_t* data, uint32_t* size) {
 
 /* Le backend ne reçoit jamais un chemin global : uniquement le suffixe d’un
  * montage déclaré par ce médiateur. */
-static int read_mounted_backend(const char* path, uint8_t* data, uint32_t* size) {
+static int read_mounted_backend(const char* path, uint8_t* data, uint32_t data_max, uint32_t* size) {
     uint32_t i;
     for (i = 0U; i < vfs_mount_count; i++) {
         const char* relative = 0;
@@ -805,7 +855,7 @@ static int read_mounted_backend(const char* path, uint8_t* data, uint32_t* size)
             const vfs_backend_ops_t* ops = vfs_backend_ops_for(vfs_mounts[i].source);
             int read;
             if (!ops || !ops->read) return OS_VFS_STATUS_NOT_MOUNTED;
-            read = ops->read(relative, (char*)data, OS_VFS_READ_MAX);
+            read = ops->read(relative, (char*)data, data_max);
             if (read < 0) return read;
             *size = (uint32_t)read;
             return OS_VFS_STATUS_OK;
@@ -814,6 +864,55 @@ static int read_mounted_backend(const char* path, uint8_t* data, uint32_t* size)
     return OS_VFS_STATUS_NOT_MOUNTED;
 }
 
+/* Une région de lecture en masse par client récent, réutilisée d'une requête
+ * à l'autre ; la plus ancienne est détruite (donc démappée) quand il en faut
+ * une nouvelle. Le client lit entre la réponse et sa requête suivante. */
+#define VFS_BULK_CLIENTS 4U
+typedef struct {
+    int pid;
+    uint32_t region;
+} vfs_bulk_client_t;
+static vfs_bulk_client_t vfs_bulk_clients[VFS_BULK_CLIENTS];
+static uint32_t vfs_bulk_victim;
+
+static int vfs_bulk_region_for(int client_pid, uint32_t* region_out) {
+    vfs_bulk_client_t* slot = 0;
+    uint32_t i;
+    int created;
+    for (i = 0U; i < VFS_BULK_CLIENTS; i++) {
+        if (vfs_bulk_clients[i].pid == client_pid) slot = &vfs_bulk_clients[i];
+    }
+    if (!slot) {
+        for (i = 0U; i < VFS_BULK_CLIENTS && !slot; i++) {
+            if (vfs_bulk_clients[i].pid == 0) slot = &vfs_bulk_clients[i];
+        }
+        if (!slot) {
+            slot = &vfs_bulk_clients[vfs_bulk_victim];
+            vfs_bulk_victim = (vfs_bulk_victim + 1U) % VFS_BULK_CLIENTS;
+            (void)shm_release(slot->region);
+            slot->pid = 0;
+        }
+        created = shm_create("vfs", OS_VFS_BULK_PAGES);
+        if (created < 0) return created;
+        slot->pid = client_pid;
+        slot->region = (uint32_t)created;
+    }
+    // Idempotent : la capacité disparaît avec le client, le PID peut revenir
+    created = shm_grant(slot->region, client_pid, OS_SHM_RIGHT_READ);
+    if (created < 0) return created;
+    *region_out = slot->region;
+    return OS_VFS_STATUS_OK;
+}
+
+static int bulk_read(const char* path, int client_pid, uint32_t* size, uint32_t* region) {
+    uint8_t* window;
+    int status = vfs_bulk_region_for(client_pid, region);
+    if (status != OS_VFS_STATUS_OK) return status;
+    window = (uint8_t*)os_shm_address(*region);
+    if (read_virtual(path, window, size)) return OS_VFS_STATUS_OK;
+    return read_mounted_backend(path, window, OS_VFS_BULK_MAX, size);
+}
+
 /* Les mutations sont déléguées uniquement aux callbacks explicitement publiés par la source. */
 static int stat_mounted_backend(const char* path, os_dirent_t* out) {
     uint32_t i;
@@ -849,13 +948,13 @@ static int list_path_matches_mount(const char* path, const char* mount,
 
 static int list_mounted_backend(const char* path, uint8_t* data, uint32_t* size,
                                 uint32_t* count) {
-    os_dirent_t entries[OS_VFS_LIST_ENTRY_MAX + 1U];
+    os_dirent_t* entries = vfs_scratch_entries();
     uint32_t mount_index;
     uint32_t written = 0U;
     uint32_t emitted = 0U;
     int listed;
     int status = OS_VFS_STATUS_OK;
-    if (!path || !data || !size || !count) return OS_VFS_STATUS_INVALID;
+    if (!entries || !path || !data || !size || !count) return OS_VFS_STATUS_INVALID;
     for (mount_index = 0U; mount_index < vfs_mount_count; mount_index++) {
         const char* relative = 0;
         if (list_path_matches_mount(path, vfs_mounts[mount_index].prefix, &relative)) {
@@ -919,13 +1018,13 @@ static int list_virtual_mounts_page(uint32_t start, uint8_t* data, uint32_t data
 static int list_mounted_backend_page(const char* path, uint32_t start, uint8_t* data,
                                      uint32_t data_max, uint32_t* size, uint32_t* count,
                                      uint32_t* next_start) {
-    os_dirent_t entries[OS_VFS_LIST_ENTRY_MAX + 1U];
+    os_dirent_t* entries = vfs_scratch_entries();
     uint32_t mount_index;
     uint32_t written = 0U;
     uint32_t emitted = 0U;
     int listed;
     int status = OS_VFS_STATUS_OK;
-    if (!path || !data || data_max == 0U || !size || !count || !next_start) return OS_VFS_STATUS_INVALID;
+    if (!entries || !path || !data || data_max == 0U || !size || !count || !next_start) return OS_VFS_STATUS_INVALID;
     *next_start = OS_VFS_LIST_PAGE_END;
     for (mount_index = 0U; mount_index < vfs_mount_count; mount_index++) {
         const char* relative = 0;
@@ -1033,6 +1132,7 @@ void main(void) {
     uint8_t data[OS_VFS_READ_MAX];
     uint8_t write_data[OS_VFS_WRITE_MAX];
     os_dirent_t metadata;
+    int reply_pid = 0;
     if (service_register("vfs") != 0) {
         puts("vfsserver register failed\n");
         for (;;) yield();
@@ -1040,19 +1140,21 @@ void main(void) {
     puts("vfsserver ready vfs\n");
     puts("vfsserver mount initrd/ ro\n");
     puts("vfsserver mount overlay/ rw\n");
+    os_arena_init(&vfs_scratch, vfs_scratch_buffer, VFS_SCRATCH_SIZE);
     for (;;) {
-        int received = ipc_receive(&message);
+        int received;
+        os_arena_reset(&vfs_scratch);
+        // Réponse du tour précédent, puis blocage jusqu'au prochain message ou
+        // à l'échéance du worker en attente
+        received = ipc_reply_wait(reply_pid, &reply_payload, &message, vfs_virtual_wait_ms());
+        reply_pid = 0;
         if (received == 0 && vfs_virtual_complete(&message, &reply_payload)) {
-            yield();
             continue;
         }
         if (vfs_virtual_recover_if_worker_missing(&reply_payload)) {
             puts("vfsserver virtual worker fallback local\n");
-        } else {
-            vfs_virtual_advance_turn();
-            if (vfs_virtual_recover_if_timed_out(&reply_payload)) {
-                puts("vfsserver virtual worker timeout local\n");
-            }
+        } else if (vfs_virtual_recover_if_timed_out(&reply_payload)) {
+            puts("vfsserver virtual worker timeout local\n");
         }
         if (received == 0 && message.type == OS_IPC_VFS_LIST) {
             int status;
@@ -1066,7 +1168,7 @@ void main(void) {
             }
             if (os_vfs_make_list_reply(&reply_payload, status, count, data, size,
                                        message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_LIST_PAGE) {
             int status;
@@ -1080,7 +1182,6 @@ void main(void) {
                 status = vfs_virtual_submit_mount_page(start, message.sender_pid, message.request_id);
                 if (status == 0) {
                     puts("vfsserver delegated mount page\n");
-                    yield();
                     continue;
                 }
                 status = list_virtual_mounts_page(start, data, OS_VFS_LIST_PAGE_DATA_MAX,
@@ -1093,7 +1194,7 @@ void main(void) {
             }
             if (os_vfs_make_list_page_reply(&reply_payload, status, count, next_start,
                                             data, size, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_LIST_OBSERVE) {
             int status;
@@ -1111,7 +1212,6 @@ void main(void) {
                 status = vfs_virtual_submit_mount_observe(start, message.sender_pid, message.request_id);
                 if (status == 0) {
                     puts("vfsserver delegated mount observe\n");
-                    yield();
                     continue;
                 }
                 status = list_virtual_mounts_page(start, data, OS_VFS_LIST_OBSERVE_DATA_MAX,
@@ -1125,7 +1225,7 @@ void main(void) {
             if (os_vfs_make_list_observe_reply(&reply_payload, status, count, next_start,
                                                vfs_list_generation, data, size,
                                                message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_STAT) {
             int status;
@@ -1141,7 +1241,7 @@ void main(void) {
                                        status == 0 ? metadata.size : 0U,
                                        status == 0 ? metadata.flags : 0U,
                                        message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_READ) {
             int status;
@@ -1152,19 +1252,16 @@ void main(void) {
             if (status == 0 && string_equal(path, "vfs-info") &&
                 vfs_virtual_submit(path, message.sender_pid, message.request_id) == 0) {
                 puts("vfsserver delegated vfs-info\n");
-                yield();
                 continue;
             }
             if (status == 0 && string_equal(path, "vfs-stats") &&
                 vfs_virtual_submit_stats(message.sender_pid, message.request_id) == 0) {
                 puts("vfsserver delegated vfs-stats\n");
-                yield();
                 continue;
             }
             if (status == 0 && string_equal(path, "vfs-mounts") &&
                 vfs_virtual_submit_mounts(message.sender_pid, message.request_id) == 0) {
                 puts("vfsserver delegated vfs-mounts\n");
-                yield();
                 continue;
             }
             if (status == 0) {
@@ -1174,7 +1271,7 @@ void main(void) {
                     else if (string_equal(path, "vfs-stats")) puts("vfsserver virtual vfs-stats local\n");
                     else puts("vfsserver virtual vfs-worker local\n");
                 } else {
-                    status = read_mounted_backend(path, data, &size);
+                    status = read_mounted_backend(path, data, OS_VFS_READ_MAX, &size);
                     if (status == OS_VFS_STATUS_NOT_MOUNTED) {
                         puts("vfsserver path outside mounts\n");
                     }
@@ -1182,7 +1279,21 @@ void main(void) {
             }
             if (os_vfs_make_read_reply(&reply_payload, status, data, size,
                                        message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
+            }
+        } else if (received == 0 && message.type == OS_IPC_VFS_BULK_READ) {
+            int status;
+            uint32_t size = 0U;
+            uint32_t region = 0U;
+            vfs_read_requests++;
+            puts("vfsserver bulk read request\n");
+            status = os_vfs_parse_bulk_read_request(&message, path);
+            if (status == 0) status = bulk_read(path, message.sender_pid, &size, &region);
+            if (status == OS_VFS_STATUS_NOT_MOUNTED) puts("vfsserver path outside mounts\n");
+            if (status != OS_VFS_STATUS_OK) size = 0U;
+            if (os_vfs_make_bulk_read_reply(&reply_payload, status, size, region,
+                                            message.request_id) == 0) {
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_WRITE) {
             int status;
@@ -1198,7 +1309,7 @@ void main(void) {
             }
             if (status == OS_VFS_STATUS_OK) vfs_list_generation++;
             if (os_vfs_make_write_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_MKDIR) {
             int status;
@@ -1210,7 +1321,7 @@ void main(void) {
             }
             if (status == OS_VFS_STATUS_OK) vfs_list_generation++;
             if (os_vfs_make_mkdir_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_RMDIR) {
             int status;
@@ -1222,7 +1333,7 @@ void main(void) {
             }
             if (status == OS_VFS_STATUS_OK) vfs_list_generation++;
             if (os_vfs_make_rmdir_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_REMOVE) {
             int status;
@@ -1237,7 +1348,7 @@ void main(void) {
             }
             if (status == OS_VFS_STATUS_OK) vfs_list_generation++;
             if (os_vfs_make_remove_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_RENAME) {
             int status;
@@ -1252,7 +1363,7 @@ void main(void) {
             }
             if (status == OS_VFS_STATUS_OK) vfs_list_generation++;
             if (os_vfs_make_rename_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_MOUNT_ADD) {
             uint32_t source;
@@ -1274,7 +1385,7 @@ void main(void) {
             if (status == OS_VFS_STATUS_OK) vfs_list_generation++;
             if (os_vfs_make_mount_reply(&reply_payload, OS_IPC_VFS_MOUNT_ADD_REPLY,
                                         status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_MOUNT_REMOVE) {
             int status;
@@ -1293,7 +1404,7 @@ void main(void) {
             if (status == OS_VFS_STATUS_OK) vfs_list_generation++;
             if (os_vfs_make_mount_reply(&reply_payload, OS_IPC_VFS_MOUNT_REMOVE_REPLY,
                                         status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_BACKEND_GRANT) {
             int target_pid;
@@ -1302,7 +1413,7 @@ void main(void) {
             status = os_vfs_parse_backend_grant_request(&message, &target_pid);
             if (status == 0) status = service_backend_grant("vfs", target_pid);
             if (os_vfs_make_backend_grant_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_BACKEND_GRANT_SCOPED) {
             int target_pid;
@@ -1312,7 +1423,7 @@ void main(void) {
             status = os_vfs_parse_backend_grant_scoped_request(&message, &target_pid, &rights);
             if (status == 0) status = service_backend_grant_scoped("vfs", target_pid, rights);
             if (os_vfs_make_backend_grant_scoped_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_BACKEND_REVOKE) {
             int target_pid;
@@ -1321,7 +1432,7 @@ void main(void) {
             status = os_vfs_parse_backend_revoke_request(&message, &target_pid);
             if (status == 0) status = service_backend_revoke("vfs", target_pid);
             if (os_vfs_make_backend_revoke_reply(&reply_payload, status, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_BACKEND_STATUS) {
             int target_pid;
@@ -1332,7 +1443,7 @@ void main(void) {
             if (status == 0) status = service_backend_status("vfs", target_pid, &rights);
             if (status != 0) rights = 0U;
             if (os_vfs_make_backend_status_reply(&reply_payload, status, rights, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_BACKEND_OBSERVE) {
             os_service_backend_snapshot_t snapshot;
@@ -1349,7 +1460,7 @@ void main(void) {
             status = os_vfs_parse_backend_observe_request(&message, &expected_generation);
             if (status == 0) status = service_backend_observe("vfs", expected_generation, &snapshot);
             if (os_vfs_make_backend_observe_reply(&reply_payload, status, &snapshot, message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_BACKEND_LIST) {
             os_service_backend_list_t list;
@@ -1360,7 +1471,7 @@ void main(void) {
             if (os_vfs_make_backend_list_reply(&reply_payload, status,
                                                status == 0 ? &list : (const os_service_backend_list_t*)0,
                                                message.request_id) == 0) {
-                (void)ipc_send(message.sender_pid, &reply_payload);
+                reply_pid = message.sender_pid;
             }
         } else if (received == 0 && message.type == OS_IPC_VFS_GRANT) {
             int target_pid;
@@ -1380,6 +1491,5 @@ void main(void) {
         } else if (received == 0) {
             puts("vfsserver unsupported message\n");
         }
-        yield();
     }
 }
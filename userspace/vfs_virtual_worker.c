@@ -1,7 +1,7 @@
 #include "os_vfs_service.h"
 
 static void putc(char value) {
-    asm volatile("int $0x80" : : "a"(SYS_PUTC), "b"(value));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_PUTC), "b"(value));
 }
 
 static void puts(const char* text) {
@@ -9,26 +9,29 @@ static void puts(const char* text) {
     while (text[index] != '\0') putc(text[index++]);
 }
 
-static int ipc_receive(os_ipc_message_t* message) {
+/* Bloque jusqu'au prochain message : le dépôt réveille le serveur. */
+static int ipc_receive_wait(os_ipc_message_t* message) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_RECV), "b"(message));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result)
+                 : "a"(SYS_IPC_RECV_WAIT), "b"(message), "c"(0), "d"(OS_IPC_WAIT_FOREVER)
+                 : "memory");
     return result;
 }
 
 static int ipc_send(int target_pid, const os_ipc_payload_t* payload) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_IPC_SEND), "b"(target_pid), "c"(payload));
     return result;
 }
 
 static int service_register(const char* name) {
     int result;
-    asm volatile("int $0x80" : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
+    asm volatile(OS_SYSCALL_INSN : "=a"(result) : "a"(SYS_SERVICE_REGISTER), "b"(name));
     return result;
 }
 
 static void yield(void) {
-    asm volatile("int $0x80" : : "a"(SYS_YIELD));
+    asm volatile(OS_SYSCALL_INSN : : "a"(SYS_YIELD));
 }
 
 static int string_equal(const char* left, const char* right) {
@@ -88,7 +91,7 @@ void main(void) {
     }
     puts("vfsvirtual ready\n");
     for (;;) {
-        int received = ipc_receive(&message);
+        int received = ipc_receive_wait(&message);
         if (received == 0 && message.type == OS_IPC_VFS_WORKER_READ &&
             os_vfs_parse_worker_read_request(&message, path) == OS_VFS_STATUS_OK) {
             uint32_t size = 0U;
@@ -126,6 +129,5 @@ void main(void) {
                 }
             }
         }
-        yield();
     }
 }
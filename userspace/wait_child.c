@@ -3,14 +3,16 @@
  * sous QEMU ; une fois le parent WAITING, l’enfant reprend immédiatement puis
  * sort normalement via start.s. */
 
+#include "os_syscalls.h"
+
 #define WAIT_CHILD_YIELDS 64
 
 void putc(char c) {
-    asm volatile("int $0x80" : : "a"(1), "b"(c));
+    asm volatile(OS_SYSCALL_INSN : : "a"(1), "b"(c));
 }
 
 void yield(void) {
-    asm volatile("int $0x80" : : "a"(4));
+    asm volatile(OS_SYSCALL_INSN : : "a"(4));
 }
 
 static void puts_local(const char* text) {